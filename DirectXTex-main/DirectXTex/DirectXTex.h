@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -246,6 +247,9 @@ namespace DirectX
 
         TGA_FLAGS_DEFAULT_SRGB = 0x80,
         // If no colorspace is specified in TGA 2.0 metadata, assume sRGB
+
+        TGA_FLAGS_RLE = 0x100,
+        // Writes RLE compressed files (image type 10 or 11) instead of uncompressed
     };
 
     enum WIC_FLAGS : unsigned long
@@ -339,6 +343,197 @@ namespace DirectX
         _In_z_ const wchar_t* szFile,
         _Out_ TexMetadata& metadata) noexcept;
 
+    // Batch metadata scanner
+    HRESULT __cdecl GetMetadataFromFiles(
+        _In_reads_(nfiles) const wchar_t* const* szFiles, _In_ size_t nfiles,
+        _In_ DDS_FLAGS ddsFlags, _In_ TGA_FLAGS tgaFlags,
+        _Out_writes_all_(nfiles) TexMetadata* metadata,
+        _Out_writes_all_(nfiles) HRESULT* results,
+        _In_ size_t maxThreads = 0) noexcept;
+        // Probes the headers of DDS, TGA, and HDR files (chosen by file extension) concurrently using small positioned reads
+        // The result for each file is returned in results; other file types report HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED)
+        // maxThreads of 0 picks a default suited to I/O-bound work
+
+    //---------------------------------------------------------------------------------
+    // Memory allocation for ScratchImage and Blob buffers
+    class IAllocator
+    {
+    public:
+        virtual ~IAllocator() = default;
+
+        virtual void* __cdecl Allocate(_In_ size_t size, _In_ size_t alignment) noexcept = 0;
+        virtual void __cdecl Free(_In_opt_ void* ptr, _In_ size_t size) noexcept = 0;
+            // size is always the value that was passed to Allocate for ptr
+    };
+
+    IAllocator* __cdecl GetSystemAllocator() noexcept;
+
+    IAllocator* __cdecl GetDefaultAllocator() noexcept;
+    void __cdecl SetDefaultAllocator(_In_opt_ IAllocator* allocator) noexcept;
+        // Used by any ScratchImage or Blob without its own allocator; nullptr restores the system allocator
+        // The allocator must outlive every buffer allocated from it
+
+    struct AllocatorStats
+    {
+        uint64_t allocations;   // Calls to Allocate that succeeded
+        uint64_t frees;         // Calls to Free
+        uint64_t poolHits;      // Allocations served from a cached buffer
+        size_t   currentBytes;  // Bytes handed out and not yet freed (rounded up to the size class)
+        size_t   peakBytes;     // High-water mark of currentBytes
+        size_t   cachedBytes;   // Bytes held by the pool for reuse
+    };
+
+    enum POOL_FLAGS : unsigned long
+    {
+        POOL_FLAGS_NONE = 0x0,
+
+        POOL_FLAGS_HUGE_PAGES = 0x1,
+            // Backs large buffers with huge (large) pages where the OS allows it, otherwise falls back to normal pages
+    };
+
+    class BufferPool : public IAllocator
+    {
+    public:
+        explicit BufferPool(_In_ size_t maxCachedBytes = 256 * 1024 * 1024, _In_ POOL_FLAGS flags = POOL_FLAGS_NONE) noexcept;
+        ~BufferPool() override;
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        void* __cdecl Allocate(_In_ size_t size, _In_ size_t alignment) noexcept override;
+            // Rounds size up to a size class (at most 25% larger) and reuses a cached buffer of that class when available
+            // alignment can be at most 64
+
+        void __cdecl Free(_In_opt_ void* ptr, _In_ size_t size) noexcept override;
+            // Caches the buffer for reuse unless that would exceed maxCachedBytes
+
+        void __cdecl Trim() noexcept;
+            // Returns all cached buffers to the OS
+
+        AllocatorStats __cdecl GetStats() const noexcept;
+        void __cdecl ResetPeak() noexcept;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> pImpl;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Instrumentation
+    enum TRACE_OPERATION : uint32_t
+    {
+        TRACE_OP_COMPRESS = 0,
+        TRACE_OP_CONVERT,
+        TRACE_OP_RESIZE,
+        TRACE_OP_GENERATE_MIPMAPS,
+        TRACE_OP_LOAD,
+        TRACE_OP_SAVE,
+    };
+
+    struct TraceEvent
+    {
+        const char*     name;           // Name of the library function
+        TRACE_OPERATION operation;
+        DXGI_FORMAT     format;         // Source format (decoded format for load functions)
+        DXGI_FORMAT     targetFormat;   // Requested format for Convert and Compress, otherwise DXGI_FORMAT_UNKNOWN
+        size_t          width;
+        size_t          height;
+        size_t          depth;
+        size_t          arraySize;
+        size_t          mipLevels;
+        uint64_t        bytes;          // Size of the source image data (decoded image data for load functions)
+        uint64_t        threadId;
+    };
+
+    class ITraceSink
+    {
+    public:
+        virtual ~ITraceSink() = default;
+
+        virtual void __cdecl BeginZone(_In_ const TraceEvent& event) noexcept = 0;
+        virtual void __cdecl EndZone(_In_ const TraceEvent& event) noexcept = 0;
+            // Called on the same thread as the matching BeginZone; load functions fill in the format and dimensions
+            // A public function called by another of the same operation (SaveToDDSFile going through
+            // SaveToDDSMemory, for example) doesn't get a zone of its own
+
+        virtual void __cdecl Counter(_In_z_ const char* name, _In_ int64_t value) noexcept = 0;
+    };
+
+    ITraceSink* __cdecl GetTraceSink() noexcept;
+    void __cdecl SetTraceSink(_In_opt_ ITraceSink* sink) noexcept;
+        // Only called by a library built with DIRECTX_TEX_INSTRUMENTATION; the sink must outlive any operation in flight
+
+    class ChromeTraceSink : public ITraceSink
+    {
+    public:
+        ChromeTraceSink() noexcept;
+        ~ChromeTraceSink() override;
+
+        ChromeTraceSink(const ChromeTraceSink&) = delete;
+        ChromeTraceSink& operator=(const ChromeTraceSink&) = delete;
+
+        void __cdecl BeginZone(_In_ const TraceEvent& event) noexcept override;
+        void __cdecl EndZone(_In_ const TraceEvent& event) noexcept override;
+        void __cdecl Counter(_In_z_ const char* name, _In_ int64_t value) noexcept override;
+
+        HRESULT __cdecl SaveToFile(_In_z_ const wchar_t* szFile) const noexcept;
+            // Writes the events recorded so far in the Chrome trace event JSON format (chrome://tracing, Perfetto)
+
+        void __cdecl Clear() noexcept;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> pImpl;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Progress reporting and cancellation
+    class ProgressContext
+    {
+    public:
+        using Callback = std::function<bool __cdecl(size_t completed, size_t total)>;
+            // Return false to cancel. May be called from any worker thread, but never concurrently
+
+        ProgressContext() noexcept;
+        explicit ProgressContext(_In_ Callback callback) noexcept;
+        ~ProgressContext();
+
+        ProgressContext(const ProgressContext&) = delete;
+        ProgressContext& operator=(const ProgressContext&) = delete;
+
+        void __cdecl Cancel() noexcept;
+            // Safe to call from any thread; the operation in progress returns E_ABORT
+
+        bool __cdecl IsCancelled() const noexcept;
+
+        void __cdecl Reset() noexcept;
+            // Clears a previous cancellation so the context can be reused
+
+        bool __cdecl Report(_In_ size_t completed, _In_ size_t total) noexcept;
+            // Used by the library to invoke the callback; returns false once cancelled
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> pImpl;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Worker thread policy (TEX_COMPRESS_PARALLEL)
+    struct ThreadPolicy
+    {
+        size_t          maxThreads;     // 0 uses one worker per available processor
+        const uint32_t* processors;     // Optional logical processor indices the workers are restricted to
+        size_t          processorCount;
+        int32_t         numaNode;       // Restrict workers to the processors of this NUMA node, or -1; ignored if processors are given
+    };
+
+    HRESULT __cdecl SetDefaultThreadPolicy(_In_opt_ const ThreadPolicy* policy) noexcept;
+        // Process-wide default; nullptr restores the default of using every processor
+
+    HRESULT __cdecl SetCallingThreadPolicy(_In_opt_ const ThreadPolicy* policy) noexcept;
+        // Overrides the default for library calls made from the calling thread; nullptr removes the override
+        // On Windows, the processors must be in a single processor group
+
     //---------------------------------------------------------------------------------
     // Bitmap image container
     struct Image
@@ -355,12 +550,16 @@ namespace DirectX
     {
     public:
         ScratchImage() noexcept
-            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr) {}
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(nullptr), m_memoryAllocator(nullptr) {}
+        explicit ScratchImage(_In_opt_ IAllocator* allocator) noexcept
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(allocator), m_memoryAllocator(nullptr) {}
         ScratchImage(ScratchImage&& moveFrom) noexcept
-            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr) { *this = std::move(moveFrom); }
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(moveFrom.m_allocator), m_memoryAllocator(nullptr) { *this = std::move(moveFrom); }
         ~ScratchImage() { Release(); }
 
         ScratchImage& __cdecl operator= (ScratchImage&& moveFrom) noexcept;
+            // Moves take the source's allocator setting along with its storage; the source keeps
+            // its setting so it can be reinitialized with the same allocator
 
         ScratchImage(const ScratchImage&) = delete;
         ScratchImage& operator=(const ScratchImage&) = delete;
@@ -377,6 +576,16 @@ namespace DirectX
         HRESULT __cdecl InitializeCubeFromImages(_In_reads_(nImages) const Image* images, _In_ size_t nImages, _In_ CP_FLAGS flags = CP_FLAGS_NONE) noexcept;
         HRESULT __cdecl Initialize3DFromImages(_In_reads_(depth) const Image* images, _In_ size_t depth, _In_ CP_FLAGS flags = CP_FLAGS_NONE) noexcept;
 
+        HRESULT __cdecl InitializeFromMemory(_In_ const TexMetadata& mdata, _Inout_updates_bytes_(size) uint8_t* pixels, _In_ size_t size, _In_ CP_FLAGS flags = CP_FLAGS_NONE, _In_opt_ IAllocator* owner = nullptr) noexcept;
+            // Lays out the image array over existing memory without copying it. With an owner, the
+            // buffer is adopted and returned via owner->Free(pixels, size) on Release; without one,
+            // this is a non-owning view and the memory must outlive the ScratchImage
+        HRESULT __cdecl InitializeFromMemory(_In_ const TexMetadata& mdata, _Inout_updates_bytes_(size) uint8_t* pixels, _In_ size_t size, _In_ size_t rowPitch, _In_ size_t slicePitch, _In_ CP_FLAGS flags = CP_FLAGS_NONE, _In_opt_ IAllocator* owner = nullptr) noexcept;
+            // As above, but with caller-supplied pitches for padded layouts such as Direct3D 12 readback
+            // buffers. Only a single mip level is supported; each array item or depth slice starts slicePitch
+            // bytes after the previous one. Pitches must be at least the ComputePitch minimum for the flags,
+            // and size must be at least slicePitch times the number of items or slices
+
         void __cdecl Release() noexcept;
 
         bool __cdecl OverrideFormat(_In_ DXGI_FORMAT f) noexcept;
@@ -390,14 +599,22 @@ namespace DirectX
         uint8_t* __cdecl GetPixels() const noexcept { return m_memory; }
         size_t __cdecl GetPixelsSize() const noexcept { return m_size; }
 
+        bool __cdecl IsView() const noexcept { return m_memory && !m_memoryAllocator; }
+
         bool __cdecl IsAlphaAllOpaque() const noexcept;
 
+        IAllocator* __cdecl GetAllocator() const noexcept { return m_allocator; }
+        void __cdecl SetAllocator(_In_opt_ IAllocator* allocator) noexcept { m_allocator = allocator; }
+            // Allocator for subsequent Initialize calls; nullptr uses the default allocator
+
     private:
         size_t      m_nimages;
         size_t      m_size;
         TexMetadata m_metadata;
         Image*      m_image;
         uint8_t*    m_memory;
+        IAllocator* m_allocator;
+        IAllocator* m_memoryAllocator;
     };
 
     //---------------------------------------------------------------------------------
@@ -405,11 +622,14 @@ namespace DirectX
     class Blob
     {
     public:
-        Blob() noexcept : m_buffer(nullptr), m_size(0) {}
-        Blob(Blob&& moveFrom) noexcept : m_buffer(nullptr), m_size(0) { *this = std::move(moveFrom); }
+        Blob() noexcept : m_buffer(nullptr), m_size(0), m_capacity(0), m_allocator(nullptr), m_bufferAllocator(nullptr) {}
+        explicit Blob(_In_opt_ IAllocator* allocator) noexcept : m_buffer(nullptr), m_size(0), m_capacity(0), m_allocator(allocator), m_bufferAllocator(nullptr) {}
+        Blob(Blob&& moveFrom) noexcept : m_buffer(nullptr), m_size(0), m_capacity(0), m_allocator(moveFrom.m_allocator), m_bufferAllocator(nullptr) { *this = std::move(moveFrom); }
         ~Blob() { Release(); }
 
         Blob& __cdecl operator= (Blob&& moveFrom) noexcept;
+            // Moves take the source's allocator setting along with its storage; the source keeps
+            // its setting so it can be reinitialized with the same allocator
 
         Blob(const Blob&) = delete;
         Blob& operator=(const Blob&) = delete;
@@ -427,14 +647,24 @@ namespace DirectX
         HRESULT __cdecl Trim(size_t size) noexcept;
             // Shorten size without reallocation
 
+        IAllocator* __cdecl GetAllocator() const noexcept { return m_allocator; }
+        void __cdecl SetAllocator(_In_opt_ IAllocator* allocator) noexcept { m_allocator = allocator; }
+            // Allocator for subsequent Initialize/Resize calls; nullptr uses the default allocator
+
     private:
-        void*   m_buffer;
-        size_t  m_size;
+        void*       m_buffer;
+        size_t      m_size;
+        size_t      m_capacity;
+        IAllocator* m_allocator;
+        IAllocator* m_bufferAllocator;
     };
 
     //---------------------------------------------------------------------------------
     // Image I/O
 
+    using WriteCallback = std::function<HRESULT __cdecl(_In_reads_bytes_(size) const void* pData, _In_ size_t size)>;
+        // Receives the serialized file in order as a series of chunks; pData is only valid during the call
+
     // DDS operations
     HRESULT __cdecl LoadFromDDSMemory(
         _In_reads_bytes_(size) const void* pSource, _In_ size_t size,
@@ -454,6 +684,21 @@ namespace DirectX
         _In_ DDS_FLAGS flags,
         _Out_ Blob& blob) noexcept;
 
+    HRESULT __cdecl GetDDSSaveSize(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DDS_FLAGS flags,
+        _Out_ size_t& required) noexcept;
+    HRESULT __cdecl SaveToDDSMemory(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DDS_FLAGS flags,
+        _Out_writes_bytes_to_(size, *written) void* pDestination, _In_ size_t size, _Out_opt_ size_t* written) noexcept;
+    HRESULT __cdecl SaveToDDSCallback(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DDS_FLAGS flags,
+        _In_ WriteCallback writer);
+        // GetDDSSaveSize returns the exact file size. The callback form passes image rows straight
+        // through when their pitch matches the DDS layout, so no staging copy is made
+
     HRESULT __cdecl SaveToDDSFile(_In_ const Image& image, _In_ DDS_FLAGS flags, _In_z_ const wchar_t* szFile) noexcept;
     HRESULT __cdecl SaveToDDSFile(
         _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
@@ -468,6 +713,13 @@ namespace DirectX
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
 
     HRESULT __cdecl SaveToHDRMemory(_In_ const Image& image, _Out_ Blob& blob) noexcept;
+    HRESULT __cdecl GetHDRSaveSize(_In_ const Image& image, _Out_ size_t& required) noexcept;
+    HRESULT __cdecl SaveToHDRMemory(
+        _In_ const Image& image,
+        _Out_writes_bytes_to_(size, *written) void* pDestination, _In_ size_t size, _Out_opt_ size_t* written) noexcept;
+    HRESULT __cdecl SaveToHDRCallback(_In_ const Image& image, _In_ WriteCallback writer);
+        // GetHDRSaveSize returns an upper bound since the RLE encoded size depends on the content;
+        // 'written' reports the actual size
     HRESULT __cdecl SaveToHDRFile(_In_ const Image& image, _In_z_ const wchar_t* szFile) noexcept;
 
     // TGA operations
@@ -483,6 +735,17 @@ namespace DirectX
     HRESULT __cdecl SaveToTGAMemory(_In_ const Image& image,
         _In_ TGA_FLAGS flags,
         _Out_ Blob& blob, _In_opt_ const TexMetadata* metadata = nullptr) noexcept;
+    HRESULT __cdecl GetTGASaveSize(_In_ const Image& image,
+        _In_ TGA_FLAGS flags,
+        _Out_ size_t& required, _In_opt_ const TexMetadata* metadata = nullptr) noexcept;
+    HRESULT __cdecl SaveToTGAMemory(_In_ const Image& image,
+        _In_ TGA_FLAGS flags,
+        _Out_writes_bytes_to_(size, *written) void* pDestination, _In_ size_t size, _Out_opt_ size_t* written,
+        _In_opt_ const TexMetadata* metadata = nullptr) noexcept;
+    HRESULT __cdecl SaveToTGACallback(_In_ const Image& image,
+        _In_ TGA_FLAGS flags,
+        _In_ WriteCallback writer, _In_opt_ const TexMetadata* metadata = nullptr);
+        // With TGA_FLAGS_RLE, GetTGASaveSize returns an upper bound and 'written' reports the actual size
     HRESULT __cdecl SaveToTGAFile(_In_ const Image& image,
         _In_ TGA_FLAGS flags,
         _In_z_ const wchar_t* szFile, _In_opt_ const TexMetadata* metadata = nullptr) noexcept;
@@ -544,13 +807,32 @@ namespace DirectX
         TEX_FR_FLIP_VERTICAL = 0x10,
     };
 
-#ifdef _WIN32
     HRESULT __cdecl FlipRotate(_In_ const Image& srcImage, _In_ TEX_FR_FLAGS flags, _Out_ ScratchImage& image) noexcept;
     HRESULT __cdecl FlipRotate(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ TEX_FR_FLAGS flags, _Out_ ScratchImage& result) noexcept;
-        // Flip and/or rotate image
-#endif
+        // Flip and/or rotate image; rotation is clockwise and flips apply to the rotated image
+        // BC1 through BC5 are remapped without recompression if partial blocks don't move
+
+    enum TEX_SWIZZLE_CHANNEL : uint32_t
+    {
+        TEX_SWIZZLE_RED = 0,
+        TEX_SWIZZLE_GREEN = 1,
+        TEX_SWIZZLE_BLUE = 2,
+        TEX_SWIZZLE_ALPHA = 3,
+
+        TEX_SWIZZLE_ZERO = 4,
+        TEX_SWIZZLE_ONE = 5,
+        // Fills the channel with 0 or 1 (1 is the integer 1 for UINT and SINT formats)
+    };
+
+    HRESULT __cdecl SwizzleChannels(
+        _In_ const Image& srcImage, _In_reads_(4) const uint32_t* channels, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl SwizzleChannels(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_reads_(4) const uint32_t* channels, _Out_ ScratchImage& result) noexcept;
+        // Each channels[] entry is a TEX_SWIZZLE_CHANNEL selecting the source of that RGBA channel
+        // 8-bit and 16-bit RGBA, RG, and R formats (other than SNORM and SINT) are remapped without a float round trip
 
     enum TEX_FILTER_FLAGS : unsigned long
     {
@@ -613,22 +895,25 @@ namespace DirectX
     HRESULT __cdecl Resize(
         _In_ const Image& srcImage, _In_ size_t width, _In_ size_t height,
         _In_ TEX_FILTER_FLAGS filter,
-        _Out_ ScratchImage& image) noexcept;
+        _Out_ ScratchImage& image, _In_opt_ ProgressContext* progress = nullptr) noexcept;
     HRESULT __cdecl Resize(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
-        _In_ size_t width, _In_ size_t height, _In_ TEX_FILTER_FLAGS filter, _Out_ ScratchImage& result) noexcept;
+        _In_ size_t width, _In_ size_t height, _In_ TEX_FILTER_FLAGS filter, _Out_ ScratchImage& result,
+        _In_opt_ ProgressContext* progress = nullptr) noexcept;
         // Resize the image to width x height. Defaults to Fant filtering.
         // Note for a complex resize, the result will always have mipLevels == 1
+        // The WIC filters can only be cancelled between images
 
     constexpr float TEX_THRESHOLD_DEFAULT = 0.5f;
         // Default value for alpha threshold used when converting to 1-bit alpha
 
     HRESULT __cdecl Convert(
         _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_FILTER_FLAGS filter, _In_ float threshold,
-        _Out_ ScratchImage& image) noexcept;
+        _Out_ ScratchImage& image, _In_opt_ ProgressContext* progress = nullptr) noexcept;
     HRESULT __cdecl Convert(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
-        _In_ DXGI_FORMAT format, _In_ TEX_FILTER_FLAGS filter, _In_ float threshold, _Out_ ScratchImage& result) noexcept;
+        _In_ DXGI_FORMAT format, _In_ TEX_FILTER_FLAGS filter, _In_ float threshold, _Out_ ScratchImage& result,
+        _In_opt_ ProgressContext* progress = nullptr) noexcept;
         // Convert the image to a new format
 
     HRESULT __cdecl ConvertToSinglePlane(_In_ const Image& srcImage, _Out_ ScratchImage& image) noexcept;
@@ -639,19 +924,21 @@ namespace DirectX
 
     HRESULT __cdecl GenerateMipMaps(
         _In_ const Image& baseImage, _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels,
-        _Inout_ ScratchImage& mipChain, _In_ bool allow1D = false) noexcept;
+        _Inout_ ScratchImage& mipChain, _In_ bool allow1D = false, _In_opt_ ProgressContext* progress = nullptr) noexcept;
     HRESULT __cdecl GenerateMipMaps(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
-        _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels, _Inout_ ScratchImage& mipChain);
+        _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels, _Inout_ ScratchImage& mipChain,
+        _In_opt_ ProgressContext* progress = nullptr);
         // levels of '0' indicates a full mipchain, otherwise is generates that number of total levels (including the source base image)
         // Defaults to Fant filtering which is equivalent to a box filter
 
     HRESULT __cdecl GenerateMipMaps3D(
         _In_reads_(depth) const Image* baseImages, _In_ size_t depth, _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels,
-        _Out_ ScratchImage& mipChain) noexcept;
+        _Out_ ScratchImage& mipChain, _In_opt_ ProgressContext* progress = nullptr) noexcept;
     HRESULT __cdecl GenerateMipMaps3D(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
-        _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels, _Out_ ScratchImage& mipChain);
+        _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels, _Out_ ScratchImage& mipChain,
+        _In_opt_ ProgressContext* progress = nullptr);
         // levels of '0' indicates a full mipchain, otherwise is generates that number of total levels (including the source base image)
         // Defaults to Fant filtering which is equivalent to a box filter
 
@@ -717,11 +1004,13 @@ namespace DirectX
 
     HRESULT __cdecl Compress(
         _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold,
-        _Out_ ScratchImage& cImage) noexcept;
+        _Out_ ScratchImage& cImage, _In_opt_ ProgressContext* progress = nullptr) noexcept;
     HRESULT __cdecl Compress(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
-        _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages) noexcept;
+        _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages,
+        _In_opt_ ProgressContext* progress = nullptr) noexcept;
         // Note that threshold is only used by BC1. TEX_THRESHOLD_DEFAULT is a typical value to use
+        // Progress is reported in 4x4 blocks; a cancelled call returns E_ABORT
 
 #if defined(__d3d11_h__) || defined(__d3d11_x_h__)
     HRESULT __cdecl Compress(
@@ -738,6 +1027,37 @@ namespace DirectX
         _In_reads_(nimages) const Image* cImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _Out_ ScratchImage& images) noexcept;
 
+    enum AUTO_FORMAT_FLAGS : unsigned long
+    {
+        AUTO_FORMAT_DEFAULT = 0,
+
+        AUTO_FORMAT_UNCOMPRESSED = 0x1,
+        // Only consider R8, R8G8, and R8G8B8A8 formats
+
+        AUTO_FORMAT_BC7_FULL = 0x2,
+        // Trial BC7 compression uses the default modes rather than TEX_COMPRESS_BC7_QUICK
+    };
+
+    struct AutoFormatResult
+    {
+        DXGI_FORMAT     format;
+        size_t          channels;       // Number of channels that carry data
+        bool            grayscale;      // Red, green, and blue are equal, so the format stores only red
+        bool            alphaOpaque;
+        bool            alphaBinary;    // Alpha is only ever 0 or 1
+        float           psnr;           // Lowest PSNR of any image in the chosen format (infinity if lossless)
+    };
+
+    HRESULT __cdecl SelectCompactFormat(
+        _In_ const Image& srcImage, _In_ float minPSNR, _In_ AUTO_FORMAT_FLAGS flags,
+        _Out_ AutoFormatResult& result) noexcept;
+    HRESULT __cdecl SelectCompactFormat(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ float minPSNR, _In_ AUTO_FORMAT_FLAGS flags, _Out_ AutoFormatResult& result) noexcept;
+        // Picks the smallest of BC4, BC5, BC1, BC7, R8, R8G8, or R8G8B8A8 where every image stays within minPSNR,
+        // measured on the mean squared error of the four RGBA channels
+        // Candidates are trial compressed, so this costs about as much as compressing to each of them
+
     //---------------------------------------------------------------------------------
     // Normal map operations
 
@@ -763,6 +1083,9 @@ namespace DirectX
 
         CNMAP_COMPUTE_OCCLUSION = 0x8000,
         // Computes a crude occlusion term stored in the alpha channel
+
+        CNMAP_GENERATE_MIPS = 0x10000,
+        // Also generates a full mip chain, renormalizing the box filtered normals at each level
     };
 
     HRESULT __cdecl ComputeNormalMap(
@@ -789,6 +1112,30 @@ namespace DirectX
     HRESULT __cdecl CopyRectangle(
         _In_ const Image& srcImage, _In_ const Rect& srcRect, _In_ const Image& dstImage,
         _In_ TEX_FILTER_FLAGS filter, _In_ size_t xOffset, _In_ size_t yOffset) noexcept;
+        // Images of the same format are copied without conversion; for BC formats the rectangle
+        // and offset must be 4x4 block aligned
+
+    enum ATLAS_FLAGS : unsigned long
+    {
+        ATLAS_DEFAULT = 0,
+
+        ATLAS_POW2 = 0x1,
+        // Rounds the atlas width and height up to powers of two
+    };
+
+    HRESULT __cdecl PackAtlas(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages,
+        _In_ size_t maxWidth, _In_ size_t maxHeight, _In_ size_t padding, _In_ ATLAS_FLAGS flags,
+        _Out_writes_(nimages) Rect* placements, _Out_ size_t& width, _Out_ size_t& height) noexcept;
+        // Skyline bottom-left packing of the image extents; returns E_NOT_SUFFICIENT_BUFFER if they
+        // don't fit within maxWidth x maxHeight. Each placement keeps 'padding' pixels clear on every side
+
+    HRESULT __cdecl CreateAtlas(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ DXGI_FORMAT format,
+        _In_ size_t maxWidth, _In_ size_t maxHeight, _In_ size_t padding, _In_ ATLAS_FLAGS flags,
+        _In_ TEX_FILTER_FLAGS filter, _Out_writes_(nimages) Rect* placements, _Out_ ScratchImage& atlas) noexcept;
+        // Packs the images with PackAtlas and copies them into a single image, with the padding
+        // filled by repeating the edge pixels. Compressed images must be decompressed first
 
     enum CMSE_FLAGS : unsigned long
     {
@@ -811,6 +1158,21 @@ namespace DirectX
 
     HRESULT __cdecl ComputeMSE(_In_ const Image& image1, _In_ const Image& image2, _Out_ float& mse, _Out_writes_opt_(4) float* mseV, _In_ CMSE_FLAGS flags = CMSE_DEFAULT) noexcept;
 
+    enum CSSIM_FLAGS : unsigned long
+    {
+        CSSIM_DEFAULT = 0,
+
+        CSSIM_MULTISCALE = 0x1,
+        // Computes multi-scale SSIM over up to five dyadic scales rather than single-scale SSIM
+    };
+
+    HRESULT __cdecl ComputeSSIM(
+        _In_ const Image& image1, _In_ const Image& image2, _Out_ float& ssim, _Out_writes_opt_(4) float* ssimV,
+        _In_ CMSE_FLAGS flags = CMSE_DEFAULT, _In_ CSSIM_FLAGS ssimFlags = CSSIM_DEFAULT,
+        _Out_opt_ ScratchImage* tileMap = nullptr, _In_ size_t tileSize = 16) noexcept;
+        // Structural similarity using an 11x11 Gaussian window (1.0 is identical); CMSE_FLAGS apply as for ComputeMSE
+        // tileMap receives the mean full-resolution SSIM of each tileSize x tileSize tile as R32G32B32A32_FLOAT
+
     HRESULT __cdecl EvaluateImage(
         _In_ const Image& image,
         _In_ std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc);
@@ -818,6 +1180,34 @@ namespace DirectX
         _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc);
 
+    struct ImageStatistics
+    {
+        static constexpr size_t HISTOGRAM_BINS = 256;
+
+        size_t          pixelCount;
+        XMFLOAT4        minimum;                // Per-channel statistics cover finite values only
+        XMFLOAT4        maximum;
+        XMFLOAT4        average;
+        XMFLOAT4        variance;
+        XMFLOAT4        standardDeviation;
+        float           luminance;              // Maximum of 0.3 R + 0.59 G + 0.11 B
+        size_t          nanCount[4];
+        size_t          infiniteCount[4];
+        size_t          denormalCount[4];       // Denormal as 32-bit floats after decoding
+        bool            constantChannel[4];     // Every pixel has the same finite value; [3] is constant alpha
+        float           histogramMin;
+        float           histogramMax;
+        size_t          histogram[4][HISTOGRAM_BINS];   // Out of range values are counted in the first or last bin
+    };
+
+    HRESULT __cdecl EvaluateImageStatistics(
+        _In_ const Image& image, _Out_ ImageStatistics& stats,
+        _In_ float histogramMin = 0.f, _In_ float histogramMax = 1.f) noexcept;
+    HRESULT __cdecl EvaluateImageStatistics(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _Out_ ImageStatistics& stats, _In_ float histogramMin = 0.f, _In_ float histogramMax = 1.f) noexcept;
+        // Collects all the statistics in a single multi-threaded pass over the pixels
+
     HRESULT __cdecl TransformImage(
         _In_ const Image& image,
         _In_ std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels,
@@ -0,0 +1,355 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexAllocator.cpp
+//
+// DirectX Texture Library - Buffer allocation and pooling
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <atomic>
+#include <mutex>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace DirectX;
+
+#if defined(_WIN32) && (!defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP))
+#define USE_VIRTUALALLOC
+#elif defined(__linux__)
+#define USE_MMAP
+#endif
+
+namespace
+{
+#ifndef _WIN32
+    inline void * _aligned_malloc(size_t size, size_t alignment)
+    {
+        size = (size + alignment - 1) & ~(alignment - 1);
+        return std::aligned_alloc(alignment, size);
+    }
+
+#define _aligned_free free
+#endif
+
+    //-------------------------------------------------------------------------------------
+    // System allocator
+    //-------------------------------------------------------------------------------------
+    class SystemAllocator : public IAllocator
+    {
+    public:
+        void* __cdecl Allocate(size_t size, size_t alignment) noexcept override
+        {
+            return _aligned_malloc(size, alignment);
+        }
+
+        void __cdecl Free(void* ptr, size_t) noexcept override
+        {
+            if (ptr)
+            {
+                _aligned_free(ptr);
+            }
+        }
+    };
+
+    SystemAllocator s_systemAllocator;
+    std::atomic<IAllocator*> s_defaultAllocator(nullptr);
+
+    //-------------------------------------------------------------------------------------
+    // Size classes: four per power of two, starting at 4 KB, so a buffer is never more
+    // than 25% larger than requested
+    //-------------------------------------------------------------------------------------
+    constexpr size_t POOL_MIN_CLASS_SHIFT = 12;
+    constexpr size_t POOL_CLASS_STEPS = 4;
+    constexpr size_t POOL_MAX_CLASS_SHIFT = sizeof(size_t) * 8 - 2;
+    constexpr size_t POOL_CLASSES = (POOL_MAX_CLASS_SHIFT - POOL_MIN_CLASS_SHIFT) * POOL_CLASS_STEPS + 1;
+    constexpr size_t POOL_MAX_SIZE = size_t(1) << POOL_MAX_CLASS_SHIFT;
+    constexpr size_t POOL_ALIGNMENT = 64;
+
+    inline size_t GetSizeClass(size_t size, size_t& index) noexcept
+    {
+        assert(size > 0 && size <= POOL_MAX_SIZE);
+
+        if (size <= (size_t(1) << POOL_MIN_CLASS_SHIFT))
+        {
+            index = 0;
+            return size_t(1) << POOL_MIN_CLASS_SHIFT;
+        }
+
+        size_t shift = POOL_MIN_CLASS_SHIFT;
+        while ((size - 1) >> (shift + 1))
+            ++shift;
+
+        const size_t base = size_t(1) << shift;
+        const size_t step = base / POOL_CLASS_STEPS;
+        const size_t n = (size - base + step - 1) / step;
+
+        index = (shift - POOL_MIN_CLASS_SHIFT) * POOL_CLASS_STEPS + n;
+        return base + n * step;
+    }
+
+    inline size_t GetClassSize(size_t index) noexcept
+    {
+        if (!index)
+            return size_t(1) << POOL_MIN_CLASS_SHIFT;
+
+        const size_t base = size_t(1) << (POOL_MIN_CLASS_SHIFT + (index - 1) / POOL_CLASS_STEPS);
+        const size_t n = ((index - 1) % POOL_CLASS_STEPS) + 1;
+        return base + n * (base / POOL_CLASS_STEPS);
+    }
+}
+
+
+//=====================================================================================
+// Default allocator
+//=====================================================================================
+
+IAllocator* DirectX::GetSystemAllocator() noexcept
+{
+    return &s_systemAllocator;
+}
+
+IAllocator* DirectX::GetDefaultAllocator() noexcept
+{
+    IAllocator* allocator = s_defaultAllocator.load(std::memory_order_acquire);
+    return (allocator) ? allocator : &s_systemAllocator;
+}
+
+_Use_decl_annotations_
+void DirectX::SetDefaultAllocator(IAllocator* allocator) noexcept
+{
+    s_defaultAllocator.store(allocator, std::memory_order_release);
+}
+
+
+//=====================================================================================
+// BufferPool - Size-class pool of recycled buffers
+//=====================================================================================
+
+struct BufferPool::Impl
+{
+    std::mutex      mutex;
+    void*           freeLists[POOL_CLASSES];    // Singly-linked through the first bytes of each cached buffer
+    size_t          maxCachedBytes;
+    size_t          largePageSize;
+    AllocatorStats  stats;
+
+    Impl(size_t maxCached, POOL_FLAGS flags) noexcept :
+        freeLists{},
+        maxCachedBytes(maxCached),
+        largePageSize(0),
+        stats{}
+    {
+        if (flags & POOL_FLAGS_HUGE_PAGES)
+        {
+        #if defined(USE_VIRTUALALLOC)
+            largePageSize = GetLargePageMinimum();
+        #elif defined(USE_MMAP)
+            largePageSize = 2 * 1024 * 1024;
+        #endif
+        }
+    }
+
+    bool UseLargePages(size_t classSize) const noexcept
+    {
+        return (largePageSize > 0) && (classSize >= largePageSize);
+    }
+
+    size_t LargePageRoundUp(size_t classSize) const noexcept
+    {
+        return (classSize + largePageSize - 1) / largePageSize * largePageSize;
+    }
+
+    void* AllocateBlock(size_t classSize) const noexcept
+    {
+        if (UseLargePages(classSize))
+        {
+            const size_t bytes = LargePageRoundUp(classSize);
+
+        #if defined(USE_VIRTUALALLOC)
+            // Large pages need the 'Lock pages in memory' privilege, so fall back to normal pages
+            void* ptr = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (!ptr)
+            {
+                ptr = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            }
+            return ptr;
+        #elif defined(USE_MMAP)
+            void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED)
+                return nullptr;
+
+        #ifdef MADV_HUGEPAGE
+            // Transparent huge pages are only a hint
+            madvise(ptr, bytes, MADV_HUGEPAGE);
+        #endif
+            return ptr;
+        #endif
+        }
+
+        return _aligned_malloc(classSize, POOL_ALIGNMENT);
+    }
+
+    void FreeBlock(void* ptr, size_t classSize) const noexcept
+    {
+        if (UseLargePages(classSize))
+        {
+        #if defined(USE_VIRTUALALLOC)
+            VirtualFree(ptr, 0, MEM_RELEASE);
+            return;
+        #elif defined(USE_MMAP)
+            munmap(ptr, LargePageRoundUp(classSize));
+            return;
+        #endif
+        }
+
+        _aligned_free(ptr);
+    }
+};
+
+_Use_decl_annotations_
+BufferPool::BufferPool(size_t maxCachedBytes, POOL_FLAGS flags) noexcept :
+    pImpl(new (std::nothrow) Impl(maxCachedBytes, flags))
+{
+}
+
+BufferPool::~BufferPool()
+{
+    Trim();
+}
+
+_Use_decl_annotations_
+void* BufferPool::Allocate(size_t size, size_t alignment) noexcept
+{
+    if (!size || !alignment || alignment > POOL_ALIGNMENT || (alignment & (alignment - 1)) != 0)
+        return nullptr;
+
+    if (!pImpl)
+        return s_systemAllocator.Allocate(size, alignment);
+
+    if (size > POOL_MAX_SIZE)
+        return nullptr;
+
+    size_t index;
+    const size_t classSize = GetSizeClass(size, index);
+
+    void* ptr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+        ptr = pImpl->freeLists[index];
+        if (ptr)
+        {
+            pImpl->freeLists[index] = *static_cast<void**>(ptr);
+            pImpl->stats.cachedBytes -= classSize;
+            ++pImpl->stats.poolHits;
+        }
+    }
+
+    if (!ptr)
+    {
+        ptr = pImpl->AllocateBlock(classSize);
+        if (!ptr)
+        {
+            // Give the cached buffers back and try again
+            Trim();
+
+            ptr = pImpl->AllocateBlock(classSize);
+            if (!ptr)
+                return nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+    ++pImpl->stats.allocations;
+    pImpl->stats.currentBytes += classSize;
+    pImpl->stats.peakBytes = std::max(pImpl->stats.peakBytes, pImpl->stats.currentBytes);
+
+    return ptr;
+}
+
+_Use_decl_annotations_
+void BufferPool::Free(void* ptr, size_t size) noexcept
+{
+    if (!ptr)
+        return;
+
+    if (!pImpl)
+    {
+        s_systemAllocator.Free(ptr, size);
+        return;
+    }
+
+    size_t index;
+    const size_t classSize = GetSizeClass(size, index);
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+        ++pImpl->stats.frees;
+        pImpl->stats.currentBytes -= classSize;
+
+        if (pImpl->stats.cachedBytes + classSize <= pImpl->maxCachedBytes)
+        {
+            *static_cast<void**>(ptr) = pImpl->freeLists[index];
+            pImpl->freeLists[index] = ptr;
+            pImpl->stats.cachedBytes += classSize;
+            return;
+        }
+    }
+
+    pImpl->FreeBlock(ptr, classSize);
+}
+
+void BufferPool::Trim() noexcept
+{
+    if (!pImpl)
+        return;
+
+    void* lists[POOL_CLASSES];
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+        memcpy(lists, pImpl->freeLists, sizeof(lists));
+        memset(pImpl->freeLists, 0, sizeof(pImpl->freeLists));
+        pImpl->stats.cachedBytes = 0;
+    }
+
+    for (size_t index = 0; index < POOL_CLASSES; ++index)
+    {
+        const size_t classSize = GetClassSize(index);
+
+        void* ptr = lists[index];
+        while (ptr)
+        {
+            void* next = *static_cast<void**>(ptr);
+            pImpl->FreeBlock(ptr, classSize);
+            ptr = next;
+        }
+    }
+}
+
+AllocatorStats BufferPool::GetStats() const noexcept
+{
+    if (!pImpl)
+        return AllocatorStats{};
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->stats;
+}
+
+void BufferPool::ResetPeak() noexcept
+{
+    if (!pImpl)
+        return;
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->stats.peakBytes = pImpl->stats.currentBytes;
+}
@@ -0,0 +1,431 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexAtlas.cpp
+//
+// DirectX Texture Library - Texture atlas packing
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::Internal;
+
+namespace
+{
+    // Each trial atlas width is this much wider than the last
+    constexpr float ATLAS_WIDTH_STEP = 1.25f;
+
+    struct SkylineNode
+    {
+        size_t x;
+        size_t y;
+        size_t w;
+    };
+
+    struct AtlasItem
+    {
+        size_t index;
+        size_t w;
+        size_t h;
+    };
+
+    size_t RoundUpPow2(size_t value) noexcept
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Skyline bottom-left packer for a fixed atlas width. Returns the width and height used,
+    // and false if an item is wider than the atlas.
+    //-------------------------------------------------------------------------------------
+    bool PackSkyline(
+        const std::vector<AtlasItem>& items,
+        size_t atlasWidth,
+        std::vector<SkylineNode>& skyline,
+        Rect* placements,
+        size_t& usedWidth,
+        size_t& usedHeight)
+    {
+        skyline.clear();
+        skyline.push_back({ 0, 0, atlasWidth });
+
+        usedWidth = usedHeight = 0;
+
+        for (const auto& item : items)
+        {
+            if (item.w > atlasWidth)
+                return false;
+
+            // The lowest top edge wins, then the narrowest skyline segment to waste less space
+            size_t bestNode = SIZE_MAX;
+            size_t bestY = 0;
+            size_t bestTop = SIZE_MAX;
+            size_t bestWidth = SIZE_MAX;
+            for (size_t i = 0; i < skyline.size(); ++i)
+            {
+                const size_t x = skyline[i].x;
+                if (x + item.w > atlasWidth)
+                    break;
+
+                size_t y = 0;
+                size_t spanned = 0;
+                for (size_t j = i; spanned < item.w; ++j)
+                {
+                    assert(j < skyline.size());
+                    y = std::max(y, skyline[j].y);
+                    spanned += skyline[j].w;
+                }
+
+                const size_t top = y + item.h;
+                if (top < bestTop || (top == bestTop && skyline[i].w < bestWidth))
+                {
+                    bestNode = i;
+                    bestY = y;
+                    bestTop = top;
+                    bestWidth = skyline[i].w;
+                }
+            }
+
+            if (bestNode == SIZE_MAX)
+                return false;
+
+            const size_t x = skyline[bestNode].x;
+            placements[item.index] = Rect(x, bestY, item.w, item.h);
+
+            usedWidth = std::max(usedWidth, x + item.w);
+            usedHeight = std::max(usedHeight, bestTop);
+
+            // Raise the skyline over the placed item, trimming the segments it covers
+            skyline.insert(skyline.begin() + ptrdiff_t(bestNode), SkylineNode{ x, bestTop, item.w });
+
+            const size_t right = x + item.w;
+            size_t next = bestNode + 1;
+            while (next < skyline.size() && skyline[next].x < right)
+            {
+                const size_t end = skyline[next].x + skyline[next].w;
+                if (end <= right)
+                {
+                    skyline.erase(skyline.begin() + ptrdiff_t(next));
+                }
+                else
+                {
+                    skyline[next].w = end - right;
+                    skyline[next].x = right;
+                    break;
+                }
+            }
+
+            // Merge neighbors at the same height
+            for (size_t i = 0; i + 1 < skyline.size();)
+            {
+                if (skyline[i].y == skyline[i + 1].y)
+                {
+                    skyline[i].w += skyline[i + 1].w;
+                    skyline.erase(skyline.begin() + ptrdiff_t(i + 1));
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    HRESULT PackAtlas_(
+        const Image* images,
+        size_t nimages,
+        size_t maxWidth,
+        size_t maxHeight,
+        size_t padding,
+        ATLAS_FLAGS flags,
+        Rect* placements,
+        size_t& width,
+        size_t& height)
+    {
+        const bool pow2 = (flags & ATLAS_POW2) != 0;
+
+        std::vector<AtlasItem> items;
+        items.reserve(nimages);
+
+        size_t widest = 0;
+        uint64_t area = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const size_t w = images[index].width + padding * 2;
+            const size_t h = images[index].height + padding * 2;
+            if (w > maxWidth || h > maxHeight)
+                return E_NOT_SUFFICIENT_BUFFER;
+
+            items.push_back({ index, w, h });
+            widest = std::max(widest, w);
+            area += uint64_t(w) * uint64_t(h);
+        }
+
+        if (area > uint64_t(maxWidth) * uint64_t(maxHeight))
+            return E_NOT_SUFFICIENT_BUFFER;
+
+        // Tallest first, then widest; the index keeps the order independent of the sort implementation
+        std::sort(items.begin(), items.end(), [](const AtlasItem& a, const AtlasItem& b) noexcept
+            {
+                if (a.h != b.h)
+                    return a.h > b.h;
+                if (a.w != b.w)
+                    return a.w > b.w;
+                return a.index < b.index;
+            });
+
+        // Try widths from a square fit up to the limit; the squarest result wins, then the smallest
+        size_t trialWidth = std::max(widest, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(area)))));
+        if (pow2)
+        {
+            trialWidth = RoundUpPow2(trialWidth);
+        }
+
+        std::vector<SkylineNode> skyline;
+        std::vector<Rect> trial(nimages);
+
+        uint64_t bestArea = UINT64_MAX;
+        size_t bestMaxSide = SIZE_MAX;
+        for (;;)
+        {
+            trialWidth = std::min(trialWidth, maxWidth);
+
+            size_t usedWidth, usedHeight;
+            if (PackSkyline(items, trialWidth, skyline, trial.data(), usedWidth, usedHeight))
+            {
+                if (pow2)
+                {
+                    usedWidth = RoundUpPow2(usedWidth);
+                    usedHeight = RoundUpPow2(usedHeight);
+                }
+
+                const uint64_t usedArea = uint64_t(usedWidth) * uint64_t(usedHeight);
+                const size_t maxSide = std::max(usedWidth, usedHeight);
+                if (usedWidth <= maxWidth && usedHeight <= maxHeight
+                    && (maxSide < bestMaxSide || (maxSide == bestMaxSide && usedArea < bestArea)))
+                {
+                    bestArea = usedArea;
+                    bestMaxSide = maxSide;
+                    width = usedWidth;
+                    height = usedHeight;
+                    std::copy(trial.cbegin(), trial.cend(), placements);
+                }
+            }
+
+            if (trialWidth >= maxWidth)
+                break;
+
+            trialWidth = (pow2) ? (trialWidth * 2)
+                : std::max(trialWidth + 1, static_cast<size_t>(static_cast<float>(trialWidth) * ATLAS_WIDTH_STEP));
+        }
+
+        if (bestMaxSide == SIZE_MAX)
+            return E_NOT_SUFFICIENT_BUFFER;
+
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            Rect& rct = placements[index];
+            rct.x += padding;
+            rct.y += padding;
+            rct.w = images[index].width;
+            rct.h = images[index].height;
+        }
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Fills the padding around a placed image by repeating its edge pixels
+    //-------------------------------------------------------------------------------------
+    void ExtrudeEdges(const Image& atlas, const Rect& rct, size_t padding, size_t bpp) noexcept
+    {
+        uint8_t* pixels = atlas.pixels;
+        const size_t rowPitch = atlas.rowPitch;
+
+        const size_t left = rct.x - padding;
+        const size_t rowBytes = (rct.w + padding * 2) * bpp;
+
+        for (size_t y = rct.y; y < rct.y + rct.h; ++y)
+        {
+            uint8_t* row = pixels + y * rowPitch;
+            const uint8_t* first = row + rct.x * bpp;
+            const uint8_t* last = row + (rct.x + rct.w - 1) * bpp;
+            for (size_t j = 0; j < padding; ++j)
+            {
+                memcpy(row + (left + j) * bpp, first, bpp);
+                memcpy(row + (rct.x + rct.w + j) * bpp, last, bpp);
+            }
+        }
+
+        const uint8_t* top = pixels + rct.y * rowPitch + left * bpp;
+        const uint8_t* bottom = pixels + (rct.y + rct.h - 1) * rowPitch + left * bpp;
+        for (size_t j = 0; j < padding; ++j)
+        {
+            memcpy(pixels + (rct.y - padding + j) * rowPitch + left * bpp, top, rowBytes);
+            memcpy(pixels + (rct.y + rct.h + j) * rowPitch + left * bpp, bottom, rowBytes);
+        }
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Computes the placement of each image in an atlas
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::PackAtlas(
+    const Image* images,
+    size_t nimages,
+    size_t maxWidth,
+    size_t maxHeight,
+    size_t padding,
+    ATLAS_FLAGS flags,
+    Rect* placements,
+    size_t& width,
+    size_t& height) noexcept
+{
+    width = height = 0;
+
+    if (!images || !nimages || !placements || !maxWidth || !maxHeight)
+        return E_INVALIDARG;
+
+    if (maxWidth > INT32_MAX || maxHeight > INT32_MAX || padding > INT16_MAX)
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        if (!images[index].width || !images[index].height)
+            return E_INVALIDARG;
+
+        if (images[index].width > INT32_MAX || images[index].height > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+    }
+
+    try
+    {
+        return PackAtlas_(images, nimages, maxWidth, maxHeight, padding, flags, placements, width, height);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Packs images into a single atlas image
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::CreateAtlas(
+    const Image* images,
+    size_t nimages,
+    DXGI_FORMAT format,
+    size_t maxWidth,
+    size_t maxHeight,
+    size_t padding,
+    ATLAS_FLAGS flags,
+    TEX_FILTER_FLAGS filter,
+    Rect* placements,
+    ScratchImage& atlas) noexcept
+{
+    if (!images || !nimages || !placements)
+        return E_INVALIDARG;
+
+    if (!IsValid(format))
+        return E_INVALIDARG;
+
+    if (IsCompressed(format) || IsPlanar(format) || IsPalettized(format) || IsPacked(format) || IsTypeless(format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    const size_t bpp = BitsPerPixel(format);
+    if (bpp < 8 || (bpp % 8) != 0)
+        return HRESULT_E_NOT_SUPPORTED;
+
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        if (!images[index].pixels)
+            return E_POINTER;
+
+        if (IsCompressed(images[index].format))
+            return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    size_t width, height;
+    HRESULT hr = PackAtlas(images, nimages, maxWidth, maxHeight, padding, flags, placements, width, height);
+    if (FAILED(hr))
+        return hr;
+
+    if (nimages > INT32_MAX)
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+    // Unused space stays zero, as Initialize2D clears the allocation
+    hr = atlas.Initialize2D(format, width, height, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    const Image* dest = atlas.GetImage(0, 0, 0);
+    assert(dest != nullptr);
+
+    // Placements don't overlap, padding included, so every image is copied independently
+    std::atomic<HRESULT> result(S_OK);
+
+#ifdef _OPENMP
+    const WorkerThreads workers;
+
+    #pragma omp parallel if (nimages > 1) num_threads(workers.Count())
+#endif
+    {
+    #ifdef _OPENMP
+        const WorkerAffinity affinity(workers);
+
+        #pragma omp for schedule(dynamic)
+    #endif
+        for (int index = 0; index < static_cast<int>(nimages); ++index)
+        {
+            if (FAILED(result.load(std::memory_order_relaxed)))
+                continue;
+
+            const Image& img = images[index];
+            const Rect& rct = placements[index];
+
+            const HRESULT hrCopy = CopyRectangle(img, Rect(0, 0, img.width, img.height), *dest, filter, rct.x, rct.y);
+            if (FAILED(hrCopy))
+            {
+                HRESULT expected = S_OK;
+                result.compare_exchange_strong(expected, hrCopy);
+                continue;
+            }
+
+            if (padding > 0)
+            {
+                ExtrudeEdges(*dest, rct, padding, bpp / 8);
+            }
+        }
+    }
+
+    hr = result.load();
+    if (FAILED(hr))
+    {
+        atlas.Release();
+        return hr;
+    }
+
+    return S_OK;
+}
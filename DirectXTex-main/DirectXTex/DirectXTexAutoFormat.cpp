@@ -0,0 +1,284 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexAutoFormat.cpp
+//
+// DirectX Texture Library - Selects the most compact format for an image
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+    // Half of one 8-bit step, so 8-bit content is classified exactly
+    constexpr float AUTO_TOLERANCE = 0.5f / 255.f;
+
+    constexpr size_t MAX_CANDIDATES = 3;
+
+    //-------------------------------------------------------------------------------------
+    // Largest difference between red and the green or blue channel of any pixel
+    //-------------------------------------------------------------------------------------
+    HRESULT MaxChromaDifference(
+        const Image* images,
+        size_t nimages,
+        const TexMetadata& metadata,
+        float& result) noexcept
+    {
+        XMVECTOR maxDiff = g_XMZero;
+
+        const HRESULT hr = EvaluateImage(images, nimages, metadata,
+            [&](const XMVECTOR* pixels, size_t width, size_t y)
+            {
+                UNREFERENCED_PARAMETER(y);
+
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const XMVECTOR v = pixels[x];
+                    const XMVECTOR diff = XMVectorAbs(XMVectorSubtract(v, XMVectorSplatX(v)));
+                    maxDiff = XMVectorMax(maxDiff, diff);
+                }
+            });
+        if (FAILED(hr))
+            return hr;
+
+        result = std::max(XMVectorGetY(maxDiff), XMVectorGetZ(maxDiff));
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Trial encodes every image and returns the lowest PSNR against the source
+    //-------------------------------------------------------------------------------------
+    HRESULT MeasureCandidate(
+        const Image* images,
+        size_t nimages,
+        const TexMetadata& metadata,
+        DXGI_FORMAT format,
+        bool grayscale,
+        AUTO_FORMAT_FLAGS flags,
+        float& psnr) noexcept
+    {
+        psnr = std::numeric_limits<float>::infinity();
+
+        if (format == metadata.format)
+            return S_OK;
+
+        ScratchImage trial;
+        HRESULT hr;
+        if (IsCompressed(format))
+        {
+            TEX_COMPRESS_FLAGS cflags = TEX_COMPRESS_PARALLEL;
+            if ((format == DXGI_FORMAT_BC7_UNORM || format == DXGI_FORMAT_BC7_UNORM_SRGB) && !(flags & AUTO_FORMAT_BC7_FULL))
+            {
+                cflags |= TEX_COMPRESS_BC7_QUICK;
+            }
+
+            hr = Compress(images, nimages, metadata, format, cflags, TEX_THRESHOLD_DEFAULT, trial);
+        }
+        else
+        {
+            hr = Convert(images, nimages, metadata, format, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, trial);
+        }
+
+        if (FAILED(hr))
+            return hr;
+
+        if (trial.GetImageCount() != nimages)
+            return E_UNEXPECTED;
+
+        const Image* dest = trial.GetImages();
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            float mse = 0.f;
+            float mseV[4] = {};
+            hr = ComputeMSE(images[index], dest[index], mse, mseV);
+            if (FAILED(hr))
+                return hr;
+
+            if (grayscale)
+            {
+                // Only red is stored; green and blue are read back by replicating it
+                mseV[1] = mseV[2] = mseV[0];
+            }
+
+            // ComputeMSE sums the channels; every candidate is judged on the RGBA average instead
+            // so the PSNR budget means the same thing whatever the channel count
+            mse = (mseV[0] + mseV[1] + mseV[2] + mseV[3]) * 0.25f;
+
+            if (mse > 0.f)
+            {
+                psnr = std::min(psnr, -10.f * log10f(mse));
+            }
+        }
+
+        return S_OK;
+    }
+
+    HRESULT SelectCompactFormat_(
+        const Image* images,
+        size_t nimages,
+        const TexMetadata& metadata,
+        float minPSNR,
+        AUTO_FORMAT_FLAGS flags,
+        AutoFormatResult& result) noexcept
+    {
+        // Histogram bins are centered on the 8-bit values
+        ImageStatistics stats;
+        HRESULT hr = EvaluateImageStatistics(images, nimages, metadata, stats, -AUTO_TOLERANCE, 1.f + AUTO_TOLERANCE);
+        if (FAILED(hr))
+            return hr;
+
+        // Candidates are all UNORM, so HDR, signed, and non-finite content is left to the caller
+        const float minimum[4] = { stats.minimum.x, stats.minimum.y, stats.minimum.z, stats.minimum.w };
+        const float maximum[4] = { stats.maximum.x, stats.maximum.y, stats.maximum.z, stats.maximum.w };
+        for (size_t c = 0; c < 4; ++c)
+        {
+            if (stats.nanCount[c] || stats.infiniteCount[c] || minimum[c] < 0.f || maximum[c] > 1.f)
+                return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        result.alphaOpaque = stats.constantChannel[3] && (stats.minimum.w >= 1.f);
+
+        result.alphaBinary = true;
+        for (size_t bin = 1; bin < ImageStatistics::HISTOGRAM_BINS - 1; ++bin)
+        {
+            if (stats.histogram[3][bin])
+            {
+                result.alphaBinary = false;
+                break;
+            }
+        }
+
+        // BC4, BC5, R8, and R8G8 have no sRGB variants, so sRGB content keeps all three color channels
+        const bool srgb = IsSRGB(metadata.format);
+
+        const bool blueZero = stats.constantChannel[2] && (stats.maximum.z == 0.f);
+        const bool greenZero = stats.constantChannel[1] && (stats.maximum.y == 0.f);
+
+        if (!srgb && result.alphaOpaque)
+        {
+            float chroma = 0.f;
+            hr = MaxChromaDifference(images, nimages, metadata, chroma);
+            if (FAILED(hr))
+                return hr;
+
+            result.grayscale = (chroma <= AUTO_TOLERANCE);
+        }
+
+        DXGI_FORMAT candidates[MAX_CANDIDATES] = {};
+        size_t ncandidates = 0;
+        if (!srgb && result.alphaOpaque && (result.grayscale || (greenZero && blueZero)))
+        {
+            result.channels = 1;
+            candidates[ncandidates++] = DXGI_FORMAT_BC4_UNORM;
+            candidates[ncandidates++] = DXGI_FORMAT_R8_UNORM;
+        }
+        else if (!srgb && result.alphaOpaque && blueZero)
+        {
+            result.channels = 2;
+            candidates[ncandidates++] = DXGI_FORMAT_BC5_UNORM;
+            candidates[ncandidates++] = DXGI_FORMAT_R8G8_UNORM;
+        }
+        else
+        {
+            result.channels = (result.alphaOpaque) ? 3u : 4u;
+            if (result.alphaOpaque || result.alphaBinary)
+            {
+                candidates[ncandidates++] = DXGI_FORMAT_BC1_UNORM;
+            }
+            candidates[ncandidates++] = DXGI_FORMAT_BC7_UNORM;
+            candidates[ncandidates++] = DXGI_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        for (size_t j = 0; j < ncandidates; ++j)
+        {
+            const DXGI_FORMAT format = (srgb) ? MakeSRGB(candidates[j]) : candidates[j];
+            const bool last = (j + 1 == ncandidates);
+
+            if (IsCompressed(format) && (flags & AUTO_FORMAT_UNCOMPRESSED))
+                continue;
+
+            float psnr = 0.f;
+            hr = MeasureCandidate(images, nimages, metadata, format, result.grayscale, flags, psnr);
+            if (FAILED(hr))
+                return hr;
+
+            // The uncompressed candidate is the fallback, whatever its error
+            if (psnr >= minPSNR || last)
+            {
+                result.format = format;
+                result.psnr = psnr;
+                return S_OK;
+            }
+        }
+
+        return E_UNEXPECTED;
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Picks the smallest format that keeps every image within the error budget
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SelectCompactFormat(
+    const Image& srcImage,
+    float minPSNR,
+    AUTO_FORMAT_FLAGS flags,
+    AutoFormatResult& result) noexcept
+{
+    TexMetadata mdata = {};
+    mdata.width = srcImage.width;
+    mdata.height = srcImage.height;
+    mdata.depth = mdata.arraySize = mdata.mipLevels = 1;
+    mdata.format = srcImage.format;
+    mdata.dimension = TEX_DIMENSION_TEXTURE2D;
+
+    return SelectCompactFormat(&srcImage, 1, mdata, minPSNR, flags, result);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SelectCompactFormat(
+    const Image* srcImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    float minPSNR,
+    AUTO_FORMAT_FLAGS flags,
+    AutoFormatResult& result) noexcept
+{
+    memset(&result, 0, sizeof(AutoFormatResult));
+
+    if (!srcImages || !nimages || std::isnan(minPSNR))
+        return E_INVALIDARG;
+
+    if (!IsValid(metadata.format))
+        return E_INVALIDARG;
+
+    if (IsPlanar(metadata.format) || IsPalettized(metadata.format) || IsTypeless(metadata.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (!IsCompressed(metadata.format))
+        return SelectCompactFormat_(srcImages, nimages, metadata, minPSNR, flags, result);
+
+    // Trial compression needs uncompressed source data
+    ScratchImage temp;
+    HRESULT hr = Decompress(srcImages, nimages, metadata, DXGI_FORMAT_UNKNOWN, temp);
+    if (FAILED(hr))
+        return hr;
+
+    if (temp.GetImageCount() != nimages)
+        return E_UNEXPECTED;
+
+    return SelectCompactFormat_(temp.GetImages(), nimages, temp.GetMetadata(), minPSNR, flags, result);
+}
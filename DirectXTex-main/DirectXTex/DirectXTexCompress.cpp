@@ -68,13 +68,21 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    inline size_t CountBlocks(const Image& image) noexcept
+    {
+        return std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+    }
+
+
     //-------------------------------------------------------------------------------------
     HRESULT CompressBC(
         const Image& image,
         const Image& result,
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
-        float threshold) noexcept
+        float threshold,
+        ProgressTracker& progress) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -109,6 +117,7 @@ namespace
         const uint8_t *pSrc = image.pixels;
         const uint8_t *pEnd = image.pixels + image.slicePitch;
         const size_t rowPitch = image.rowPitch;
+        const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
         for (size_t h = 0; h < image.height; h += 4)
         {
             const uint8_t *sptr = pSrc;
@@ -190,6 +199,9 @@ namespace
 
             pSrc += rowPitch * 4;
             pDest += result.rowPitch;
+
+            if (!progress.Advance(nbWidth))
+                return E_ABORT;
         }
 
         return S_OK;
@@ -203,7 +215,8 @@ namespace
         const Image& result,
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
-        float threshold) noexcept
+        float threshold,
+        ProgressTracker& progress) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -238,93 +251,111 @@ namespace
         const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
 
         bool fail = false;
+        std::atomic<bool> cancelled(false);
+
+        const WorkerThreads workers;
 
-    #pragma omp parallel for
-        for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+    #pragma omp parallel num_threads(workers.Count())
         {
-            const int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
+            const WorkerAffinity affinity(workers);
+
+        #pragma omp for
+            for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+            {
+                // OpenMP loops can't break, so remaining blocks are skipped once cancelled
+                if (cancelled.load(std::memory_order_relaxed))
+                    continue;
 
-            int y = nb / nbWidth;
-            const int x = (nb - (y*nbWidth)) * 4;
-            y *= 4;
+                const int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
 
-            assert((x >= 0) && (x < int(image.width)));
-            assert((y >= 0) && (y < int(image.height)));
+                int y = nb / nbWidth;
+                const int x = (nb - (y*nbWidth)) * 4;
+                y *= 4;
 
-            const size_t rowPitch = image.rowPitch;
-            const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
+                assert((x >= 0) && (x < int(image.width)));
+                assert((y >= 0) && (y < int(image.height)));
 
-            uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
+                const size_t rowPitch = image.rowPitch;
+                const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
 
-            const size_t ph = std::min<size_t>(4, image.height - size_t(y));
-            const size_t pw = std::min<size_t>(4, image.width - size_t(x));
-            assert(pw > 0 && ph > 0);
+                uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
 
-            const ptrdiff_t bytesLeft = pEnd - pSrc;
-            assert(bytesLeft > 0);
-            size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
+                const size_t ph = std::min<size_t>(4, image.height - size_t(y));
+                const size_t pw = std::min<size_t>(4, image.width - size_t(x));
+                assert(pw > 0 && ph > 0);
 
-            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-            if (!LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
-                fail = true;
+                const ptrdiff_t bytesLeft = pEnd - pSrc;
+                assert(bytesLeft > 0);
+                size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
 
-            if (ph > 1)
-            {
-                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
-                if (!LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
+                XM_ALIGNED_DATA(16) XMVECTOR temp[16];
+                if (!LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
                     fail = true;
 
-                if (ph > 2)
+                if (ph > 1)
                 {
-                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
-                    if (!LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
+                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
+                    if (!LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
                         fail = true;
 
-                    if (ph > 3)
+                    if (ph > 2)
                     {
-                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
-                        if (!LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
+                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
+                        if (!LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
                             fail = true;
+
+                        if (ph > 3)
+                        {
+                            bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
+                            if (!LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
+                                fail = true;
+                        }
                     }
                 }
-            }
-
-            if (pw != 4 || ph != 4)
-            {
-                // Replicate pixels for partial block
-                static const size_t uSrc[] = { 0, 0, 0, 1 };
 
-                if (pw < 4)
+                if (pw != 4 || ph != 4)
                 {
-                    for (size_t t = 0; t < ph && t < 4; ++t)
+                    // Replicate pixels for partial block
+                    static const size_t uSrc[] = { 0, 0, 0, 1 };
+
+                    if (pw < 4)
                     {
-                        for (size_t s = pw; s < 4; ++s)
+                        for (size_t t = 0; t < ph && t < 4; ++t)
                         {
-                            temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
+                            for (size_t s = pw; s < 4; ++s)
+                            {
+                                temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
+                            }
                         }
                     }
-                }
 
-                if (ph < 4)
-                {
-                    for (size_t t = ph; t < 4; ++t)
+                    if (ph < 4)
                     {
-                        for (size_t s = 0; s < 4; ++s)
+                        for (size_t t = ph; t < 4; ++t)
                         {
-                            temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
+                            for (size_t s = 0; s < 4; ++s)
+                            {
+                                temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
+                            }
                         }
                     }
                 }
-            }
 
-            ConvertScanline(temp, 16, result.format, format, cflags | srgb);
+                ConvertScanline(temp, 16, result.format, format, cflags | srgb);
+
+                if (pfEncode)
+                    pfEncode(pDest, temp, bcflags);
+                else
+                    D3DXEncodeBC1(pDest, temp, threshold, bcflags);
 
-            if (pfEncode)
-                pfEncode(pDest, temp, bcflags);
-            else
-                D3DXEncodeBC1(pDest, temp, threshold, bcflags);
+                if (!progress.Advance(1))
+                    cancelled.store(true, std::memory_order_relaxed);
+            }
         }
 
+        if (cancelled)
+            return E_ABORT;
+
         return (fail) ? E_FAIL : S_OK;
     }
 #endif // _OPENMP
@@ -490,6 +521,156 @@ namespace
 
         return S_OK;
     }
+
+    //-------------------------------------------------------------------------------------
+    // Opacity checks read the block encodings directly; alpha is only decoded where the
+    // encoding alone can't tell, using the same arithmetic as the decoders
+    //-------------------------------------------------------------------------------------
+
+    // Block rows per parallel work item
+    constexpr size_t OPAQUE_BAND_BLOCK_ROWS = 16;
+
+    // Smaller images are not worth starting worker threads for
+    constexpr size_t OPAQUE_PARALLEL_MIN_BLOCKS = 4096;
+
+    // Decoded alpha below this is not opaque
+    constexpr float OPAQUE_THRESHOLD = 0.99f;
+
+    using OpaqueBlockFunc = bool(*)(const uint8_t* pBC, uint32_t texels);
+
+    // One bit per texel (in block order) for the part of a block inside the image
+    uint32_t TexelMask(size_t pw, size_t ph) noexcept
+    {
+        const uint32_t row = (1u << pw) - 1u;
+        uint32_t mask = 0;
+        for (size_t y = 0; y < ph; ++y)
+        {
+            mask |= row << (y * 4);
+        }
+        return mask;
+    }
+
+    // Moves texel bit i to bit i * stride
+    uint64_t SpreadTexelMask(uint32_t texels, unsigned stride) noexcept
+    {
+        uint64_t mask = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            if (texels & (1u << i))
+                mask |= uint64_t(1) << (i * stride);
+        }
+        return mask;
+    }
+
+    bool IsOpaqueBC1(const uint8_t* pBC, uint32_t texels) noexcept
+    {
+        // Only index 3 in the three-color mode (color0 <= color1) is transparent
+        uint16_t color0, color1;
+        memcpy(&color0, pBC, sizeof(color0));
+        memcpy(&color1, pBC + 2, sizeof(color1));
+        if (color0 > color1)
+            return true;
+
+        uint32_t bits;
+        memcpy(&bits, pBC + 4, sizeof(bits));
+
+        const uint32_t transparent = bits & (bits >> 1) & 0x55555555u;
+        if (texels == 0xFFFF)
+            return !transparent;
+
+        return !(transparent & static_cast<uint32_t>(SpreadTexelMask(texels, 2)));
+    }
+
+    bool IsOpaqueBC2(const uint8_t* pBC, uint32_t texels) noexcept
+    {
+        // Explicit 4-bit alpha is only opaque at 15
+        uint64_t bits;
+        memcpy(&bits, pBC, sizeof(bits));
+
+        const uint64_t used = (texels == 0xFFFF) ? UINT64_MAX : SpreadTexelMask(texels, 4) * 0xF;
+        return !(~bits & used);
+    }
+
+    bool IsOpaqueBC3(const uint8_t* pBC, uint32_t texels) noexcept
+    {
+        const uint8_t alpha0 = pBC[0];
+        const uint8_t alpha1 = pBC[1];
+
+        // Palette as computed by D3DXDecodeBC3
+        float fAlpha[8];
+        fAlpha[0] = static_cast<float>(alpha0) * (1.0f / 255.0f);
+        fAlpha[1] = static_cast<float>(alpha1) * (1.0f / 255.0f);
+
+        if (alpha0 > alpha1)
+        {
+            for (size_t i = 1; i < 7; ++i)
+                fAlpha[i + 1] = (fAlpha[0] * float(7u - i) + fAlpha[1] * float(i)) * (1.0f / 7.0f);
+        }
+        else
+        {
+            for (size_t i = 1; i < 5; ++i)
+                fAlpha[i + 1] = (fAlpha[0] * float(5u - i) + fAlpha[1] * float(i)) * (1.0f / 5.0f);
+
+            fAlpha[6] = 0.0f;
+            fAlpha[7] = 1.0f;
+        }
+
+        uint32_t opaqueIndices = 0;
+        for (size_t i = 0; i < 8; ++i)
+        {
+            if (fAlpha[i] >= OPAQUE_THRESHOLD)
+                opaqueIndices |= 1u << i;
+        }
+
+        if (opaqueIndices == 0xFF)
+            return true;
+
+        uint64_t bits = 0;
+        memcpy(&bits, pBC + 2, 6);
+
+        for (size_t i = 0; i < 16; ++i, bits >>= 3)
+        {
+            if ((texels & (1u << i)) && !(opaqueIndices & (1u << (bits & 0x7))))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool IsOpaqueBC7(const uint8_t* pBC, uint32_t texels) noexcept
+    {
+        // The mode is the position of the lowest set bit; modes 0-3 have no alpha
+        const uint8_t first = pBC[0];
+        if (first & 0x0F)
+            return true;
+
+        if (!first)
+        {
+            // Reserved mode 8 decodes as transparent black
+            return false;
+        }
+
+        if ((first & 0x7F) == 0x40)
+        {
+            // Mode 6 with both 7-bit alpha endpoints and p-bits set interpolates to 255 everywhere
+            uint64_t lo, hi;
+            memcpy(&lo, pBC, sizeof(lo));
+            memcpy(&hi, pBC + 8, sizeof(hi));
+            if ((lo >> 49) == 0x7FFF && (hi & 0x1))
+                return true;
+        }
+
+        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
+        D3DXDecodeBC7(temp, pBC);
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            if ((texels & (1u << i)) && XMVectorGetW(temp[i]) < OPAQUE_THRESHOLD)
+                return false;
+        }
+
+        return true;
+    }
 }
 
 //-------------------------------------------------------------------------------------
@@ -498,83 +679,78 @@ bool DirectX::Internal::IsAlphaAllOpaqueBC(_In_ const Image& cImage) noexcept
     if (!cImage.pixels)
         return false;
 
-    // Promote "typeless" BC formats
-    DXGI_FORMAT cformat;
-    switch (cImage.format)
-    {
-    case DXGI_FORMAT_BC1_TYPELESS:  cformat = DXGI_FORMAT_BC1_UNORM; break;
-    case DXGI_FORMAT_BC2_TYPELESS:  cformat = DXGI_FORMAT_BC2_UNORM; break;
-    case DXGI_FORMAT_BC3_TYPELESS:  cformat = DXGI_FORMAT_BC3_UNORM; break;
-    case DXGI_FORMAT_BC7_TYPELESS:  cformat = DXGI_FORMAT_BC7_UNORM; break;
-    default:                        cformat = cImage.format;         break;
-    }
-
-    // Determine BC format decoder
-    BC_DECODE pfDecode;
+    OpaqueBlockFunc pfCheck;
     size_t sbpp;
-    switch (cformat)
+    switch (cImage.format)
     {
+    case DXGI_FORMAT_BC1_TYPELESS:
     case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:    pfDecode = D3DXDecodeBC1;   sbpp = 8;   break;
+    case DXGI_FORMAT_BC1_UNORM_SRGB:    pfCheck = IsOpaqueBC1;  sbpp = 8;   break;
+    case DXGI_FORMAT_BC2_TYPELESS:
     case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:    pfDecode = D3DXDecodeBC2;   sbpp = 16;  break;
+    case DXGI_FORMAT_BC2_UNORM_SRGB:    pfCheck = IsOpaqueBC2;  sbpp = 16;  break;
+    case DXGI_FORMAT_BC3_TYPELESS:
     case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:    pfDecode = D3DXDecodeBC3;   sbpp = 16;  break;
+    case DXGI_FORMAT_BC3_UNORM_SRGB:    pfCheck = IsOpaqueBC3;  sbpp = 16;  break;
+    case DXGI_FORMAT_BC7_TYPELESS:
     case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:    pfDecode = D3DXDecodeBC7;   sbpp = 16;  break;
+    case DXGI_FORMAT_BC7_UNORM_SRGB:    pfCheck = IsOpaqueBC7;  sbpp = 16;  break;
     default:
         // BC4, BC5, and BC6 don't have alpha channels
         return false;
     }
 
-    // Scan blocks for non-opaque alpha
-    static const XMVECTORF32 threshold = { { { 0.99f, 0.99f, 0.99f, 0.99f } } };
+    const size_t nbWidth = std::max<size_t>(1, (cImage.width + 3) / 4);
+    const size_t nbHeight = std::max<size_t>(1, (cImage.height + 3) / 4);
+    if (nbWidth * sbpp > cImage.rowPitch)
+        return false;
+
+    const size_t nbands = (nbHeight + OPAQUE_BAND_BLOCK_ROWS - 1) / OPAQUE_BAND_BLOCK_ROWS;
+    if (nbands > INT32_MAX)
+        return false;
+
+    // Edge blocks only test the texels inside the image
+    const uint32_t rightMask = TexelMask(std::min<size_t>(4, cImage.width - (nbWidth - 1) * 4), 4);
+    const uint32_t bottomShift = 4 * (4 - std::min<size_t>(4, cImage.height - (nbHeight - 1) * 4));
 
-    XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-    const uint8_t* pPixels = cImage.pixels;
-    for (size_t h = 0; h < cImage.height; h += 4)
+    // Cleared by the first transparent block; the other workers stop at their next block row
+    std::atomic<bool> opaque(true);
+
+#ifdef _OPENMP
+    const WorkerThreads workers;
+
+    #pragma omp parallel if (nbands > 1 && nbWidth * nbHeight >= OPAQUE_PARALLEL_MIN_BLOCKS) num_threads(workers.Count())
+#endif
     {
-        const uint8_t* ptr = pPixels;
-        const size_t ph = std::min<size_t>(4, cImage.height - h);
-        size_t w = 0;
-        for (size_t count = 0; (count < cImage.rowPitch) && (w < cImage.width); count += sbpp, w += 4)
-        {
-            pfDecode(temp, ptr);
+    #ifdef _OPENMP
+        const WorkerAffinity affinity(workers);
 
-            const size_t pw = std::min<size_t>(4, cImage.width - w);
-            assert(pw > 0 && ph > 0);
+        #pragma omp for
+    #endif
+        for (int band = 0; band < static_cast<int>(nbands); ++band)
+        {
+            const size_t by0 = size_t(band) * OPAQUE_BAND_BLOCK_ROWS;
+            const size_t by1 = std::min(by0 + OPAQUE_BAND_BLOCK_ROWS, nbHeight);
 
-            if (pw == 4 && ph == 4)
+            for (size_t by = by0; by < by1 && opaque.load(std::memory_order_relaxed); ++by)
             {
-                // Full blocks
-                for (size_t j = 0; j < 16; ++j)
-                {
-                    const XMVECTOR alpha = XMVectorSplatW(temp[j]);
-                    if (XMVector4Less(alpha, threshold))
-                        return false;
-                }
-            }
-            else
-            {
-                // Handle partial blocks
-                for (size_t y = 0; y < ph; ++y)
+                const uint8_t* pBlock = cImage.pixels + by * cImage.rowPitch;
+                const uint32_t rowMask = (by + 1 == nbHeight) ? (0xFFFFu >> bottomShift) : 0xFFFFu;
+
+                for (size_t bx = 0; bx < nbWidth; ++bx, pBlock += sbpp)
                 {
-                    for (size_t x = 0; x < pw; ++x)
+                    const uint32_t texels = (bx + 1 == nbWidth) ? (rowMask & rightMask) : rowMask;
+                    if (!pfCheck(pBlock, texels))
                     {
-                        const XMVECTOR alpha = XMVectorSplatW(temp[y * 4 + x]);
-                        if (XMVector4Less(alpha, threshold))
-                            return false;
+                        opaque.store(false, std::memory_order_relaxed);
+                        break;
                     }
                 }
             }
-
-            ptr += sbpp;
         }
-
-        pPixels += cImage.rowPitch;
     }
 
-    return true;
+    return opaque.load();
 }
 
 
@@ -591,8 +767,11 @@ HRESULT DirectX::Compress(
     DXGI_FORMAT format,
     TEX_COMPRESS_FLAGS compress,
     float threshold,
-    ScratchImage& image) noexcept
+    ScratchImage& image,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_COMPRESS, srcImage, format);
+
     if (IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
 
@@ -613,17 +792,18 @@ HRESULT DirectX::Compress(
     }
 
     // Compress single image
+    ProgressTracker tracker(progress, CountBlocks(srcImage));
     if (compress & TEX_COMPRESS_PARALLEL)
     {
     #ifndef _OPENMP
         return E_NOTIMPL;
     #else
-        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold, tracker);
     #endif // _OPENMP
     }
     else
     {
-        hr = CompressBC(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+        hr = CompressBC(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold, tracker);
     }
 
     if (FAILED(hr))
@@ -640,8 +820,11 @@ HRESULT DirectX::Compress(
     DXGI_FORMAT format,
     TEX_COMPRESS_FLAGS compress,
     float threshold,
-    ScratchImage& cImages) noexcept
+    ScratchImage& cImages,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_COMPRESS, srcImages, nimages, metadata, format);
+
     if (!srcImages || !nimages)
         return E_INVALIDARG;
 
@@ -673,6 +856,14 @@ HRESULT DirectX::Compress(
         return E_POINTER;
     }
 
+    size_t totalBlocks = 0;
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        totalBlocks += CountBlocks(srcImages[index]);
+    }
+
+    ProgressTracker tracker(progress, totalBlocks);
+
     for (size_t index = 0; index < nimages; ++index)
     {
         assert(dest[index].format == format);
@@ -692,7 +883,7 @@ HRESULT DirectX::Compress(
         #else
             if (compress & TEX_COMPRESS_PARALLEL)
             {
-                hr = CompressBC_Parallel(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+                hr = CompressBC_Parallel(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold, tracker);
                 if (FAILED(hr))
                 {
                     cImages.Release();
@@ -703,7 +894,7 @@ HRESULT DirectX::Compress(
         }
         else
         {
-            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold, tracker);
             if (FAILED(hr))
             {
                 cImages.Release();
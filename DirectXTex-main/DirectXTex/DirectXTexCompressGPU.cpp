@@ -220,6 +220,8 @@ HRESULT DirectX::Compress(
     float alphaWeight,
     ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_COMPRESS, srcImage, format);
+
     if (!pDevice || IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
 
@@ -270,6 +272,8 @@ HRESULT DirectX::Compress(
     float alphaWeight,
     ScratchImage& cImages) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_COMPRESS, srcImages, nimages, metadata, format);
+
     if (!pDevice || !srcImages || !nimages)
         return E_INVALIDARG;
 
@@ -507,38 +507,14 @@ void DirectX::Internal::SwizzleScanline(
         if (inSize >= 4 && outSize >= 4)
         {
             // Swap Red (R) and Blue (B) channels (used to convert from DXGI 1.1 BGR formats to DXGI 1.0 RGB)
-            if (pDestination == pSource)
+            ChannelRemap remap = { 1, 4, 4, { 2, 1, 0, 3 }, {} };
+            if (tflags & TEXP_SCANLINE_SETALPHA)
             {
-                auto dPtr = static_cast<uint32_t*>(pDestination);
-                for (size_t count = 0; count < (outSize - 3); count += 4)
-                {
-                    const uint32_t t = *dPtr;
-
-                    uint32_t t1 = (t & 0x00ff0000) >> 16;
-                    uint32_t t2 = (t & 0x000000ff) << 16;
-                    uint32_t t3 = (t & 0x0000ff00);
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : (t & 0xFF000000);
-
-                    *(dPtr++) = t1 | t2 | t3 | ta;
-                }
+                remap.source[3] = TEXP_REMAP_CONSTANT;
+                remap.constant[3] = 0xff;
             }
-            else
-            {
-                const uint32_t * __restrict sPtr = static_cast<const uint32_t*>(pSource);
-                uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
-                const size_t size = std::min<size_t>(outSize, inSize);
-                for (size_t count = 0; count < (size - 3); count += 4)
-                {
-                    const uint32_t t = *(sPtr++);
-
-                    uint32_t t1 = (t & 0x00ff0000) >> 16;
-                    uint32_t t2 = (t & 0x000000ff) << 16;
-                    uint32_t t3 = (t & 0x0000ff00);
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : (t & 0xFF000000);
 
-                    *(dPtr++) = t1 | t2 | t3 | ta;
-                }
-            }
+            RemapScanline(pDestination, pSource, std::min<size_t>(outSize, inSize) / 4, remap);
             return;
         }
         break;
@@ -597,6 +573,94 @@ void DirectX::Internal::SwizzleScanline(
 }
 
 
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // SSE2 kernels for ExpandScanline, 8 pixels per step. Channels are widened in 16-bit
+    // lanes, where replicating the top bits is a multiply and shift. Each returns the
+    // number of pixels done and the scalar loop finishes the row.
+    //-------------------------------------------------------------------------------------
+
+    // Interleaves 16-bit channel lanes holding 0..255 into 8 R8G8B8A8 pixels
+    inline void StoreRGBA8(uint32_t* pDest, __m128i r, __m128i g, __m128i b, __m128i a) noexcept
+    {
+        const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+
+    // (v * 33) >> 2 == (v << 3) | (v >> 2) for a 5-bit v
+    inline __m128i Widen5(__m128i v) noexcept
+    {
+        return _mm_srli_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(33)), 2);
+    }
+
+    size_t Expand565(uint32_t* pDest, const uint16_t* pSource, size_t count) noexcept
+    {
+        const __m128i mask5 = _mm_set1_epi16(0x1f);
+        const __m128i mask6 = _mm_set1_epi16(0x3f);
+        const __m128i scale6 = _mm_set1_epi16(65);  // (v * 65) >> 4 == (v << 2) | (v >> 4)
+        const __m128i alpha = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            const __m128i r = Widen5(_mm_srli_epi16(t, 11));
+            const __m128i g = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(t, 5), mask6), scale6), 4);
+            const __m128i b = Widen5(_mm_and_si128(t, mask5));
+            StoreRGBA8(pDest + i, r, g, b, alpha);
+        }
+        return i;
+    }
+
+    size_t Expand5551(uint32_t* pDest, const uint16_t* pSource, size_t count, bool setAlpha) noexcept
+    {
+        const __m128i mask5 = _mm_set1_epi16(0x1f);
+        const __m128i mask8 = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            const __m128i r = Widen5(_mm_and_si128(_mm_srli_epi16(t, 10), mask5));
+            const __m128i g = Widen5(_mm_and_si128(_mm_srli_epi16(t, 5), mask5));
+            const __m128i b = Widen5(_mm_and_si128(t, mask5));
+            const __m128i a = (setAlpha) ? mask8 : _mm_and_si128(_mm_srai_epi16(t, 15), mask8);
+            StoreRGBA8(pDest + i, r, g, b, a);
+        }
+        return i;
+    }
+
+    // Handles both nibble orders; the shifts give each channel's position in the source
+    size_t Expand4444(
+        uint32_t* pDest, const uint16_t* pSource, size_t count,
+        int shiftR, int shiftG, int shiftB, int shiftA, bool setAlpha) noexcept
+    {
+        const __m128i mask4 = _mm_set1_epi16(0xf);
+        const __m128i scale4 = _mm_set1_epi16(17);  // v * 17 == (v << 4) | v
+        const __m128i countR = _mm_cvtsi32_si128(shiftR);
+        const __m128i countG = _mm_cvtsi32_si128(shiftG);
+        const __m128i countB = _mm_cvtsi32_si128(shiftB);
+        const __m128i countA = _mm_cvtsi32_si128(shiftA);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            const __m128i r = _mm_mullo_epi16(_mm_and_si128(_mm_srl_epi16(t, countR), mask4), scale4);
+            const __m128i g = _mm_mullo_epi16(_mm_and_si128(_mm_srl_epi16(t, countG), mask4), scale4);
+            const __m128i b = _mm_mullo_epi16(_mm_and_si128(_mm_srl_epi16(t, countB), mask4), scale4);
+            const __m128i a = (setAlpha) ? _mm_set1_epi16(0xff) : _mm_mullo_epi16(_mm_and_si128(_mm_srl_epi16(t, countA), mask4), scale4);
+            StoreRGBA8(pDest + i, r, g, b, a);
+        }
+        return i;
+    }
+}
+#endif
+
 //-------------------------------------------------------------------------------------
 // Converts an image row with optional clearing of alpha value to 1.0
 // Returns true if supported, false if expansion case not supported
@@ -628,12 +692,20 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            size_t done = 0;
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint32_t));
+            done = Expand565(dPtr, sPtr, count);
+            sPtr += done;
+            dPtr += done;
+        #endif
+
+            for (size_t ocount = done * 4, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
             {
                 const uint16_t t = *(sPtr++);
 
                 uint32_t t1 = uint32_t(((t & 0xf800) >> 8) | ((t & 0xe000) >> 13));
-                uint32_t t2 = uint32_t(((t & 0x07e0) << 5) | ((t & 0x0600) >> 5));
+                uint32_t t2 = uint32_t(((t & 0x07e0) << 5) | ((t & 0x0600) >> 1));
                 uint32_t t3 = uint32_t(((t & 0x001f) << 19) | ((t & 0x001c) << 14));
 
                 *(dPtr++) = t1 | t2 | t3 | 0xff000000;
@@ -652,7 +724,15 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            size_t done = 0;
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint32_t));
+            done = Expand5551(dPtr, sPtr, count, (tflags & TEXP_SCANLINE_SETALPHA) != 0);
+            sPtr += done;
+            dPtr += done;
+        #endif
+
+            for (size_t ocount = done * 4, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
             {
                 const uint16_t t = *(sPtr++);
 
@@ -677,7 +757,15 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            size_t done = 0;
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint32_t));
+            done = Expand4444(dPtr, sPtr, count, 8, 4, 0, 12, (tflags & TEXP_SCANLINE_SETALPHA) != 0);
+            sPtr += done;
+            dPtr += done;
+        #endif
+
+            for (size_t ocount = done * 4, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
             {
                 const uint16_t t = *(sPtr++);
 
@@ -702,7 +790,15 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            size_t done = 0;
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint32_t));
+            done = Expand4444(dPtr, sPtr, count, 12, 8, 4, 0, (tflags & TEXP_SCANLINE_SETALPHA) != 0);
+            sPtr += done;
+            dPtr += done;
+        #endif
+
+            for (size_t ocount = done * 4, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
             {
                 const uint16_t t = *(sPtr++);
 
@@ -723,49 +819,66 @@ bool DirectX::Internal::ExpandScanline(
 }
 
 
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // Row loaders for formats that map directly onto a DirectXMath load. LoadScanline uses
+    // them for those cases and GetLoadScanline hands them out so a caller can skip the
+    // format switch on every row.
+    //-------------------------------------------------------------------------------------
+    template<typename T, XMVECTOR(XM_CALLCONV *Load)(const T*)>
+    bool __cdecl LoadTyped(
+        XMVECTOR* pDestination, size_t count,
+        const void* pSource, size_t size, DXGI_FORMAT) noexcept
+    {
+        XMVECTOR* __restrict dPtr = pDestination;
+        if (!dPtr || size < sizeof(T))
+            return false;
+
+        const XMVECTOR* ePtr = pDestination + count;
+        const T * __restrict sPtr = static_cast<const T*>(pSource);
+        for (size_t icount = 0; icount < (size - sizeof(T) + 1); icount += sizeof(T))
+        {
+            if (dPtr >= ePtr) break;
+            *(dPtr++) = Load(sPtr++);
+        }
+        return true;
+    }
+
+    // Formats with only RGB or RG channels; the rest default to 0 with alpha 1
+    template<typename T, XMVECTOR(XM_CALLCONV *Load)(const T*), size_t Channels>
+    bool __cdecl LoadTypedPartial(
+        XMVECTOR* pDestination, size_t count,
+        const void* pSource, size_t size, DXGI_FORMAT) noexcept
+    {
+        XMVECTOR* __restrict dPtr = pDestination;
+        if (!dPtr || size < sizeof(T))
+            return false;
+
+        const XMVECTOR select = (Channels > 2) ? g_XMSelect1110 : g_XMSelect1100;
+        const XMVECTOR* ePtr = pDestination + count;
+        const T * __restrict sPtr = static_cast<const T*>(pSource);
+        for (size_t icount = 0; icount < (size - sizeof(T) + 1); icount += sizeof(T))
+        {
+            const XMVECTOR v = Load(sPtr++);
+            if (dPtr >= ePtr) break;
+            *(dPtr++) = XMVectorSelect(g_XMIdentityR3, v, select);
+        }
+        return true;
+    }
+}
+
 //-------------------------------------------------------------------------------------
 // Loads an image row into standard RGBA XMVECTOR (aligned) array
 //-------------------------------------------------------------------------------------
 #define LOAD_SCANLINE( type, func )\
-        if (size >= sizeof(type))\
-        {\
-            const type * __restrict sPtr = reinterpret_cast<const type*>(pSource);\
-            for(size_t icount = 0; icount < (size - sizeof(type) + 1); icount += sizeof(type))\
-            {\
-                if (dPtr >= ePtr) break;\
-                *(dPtr++) = func(sPtr++);\
-            }\
-            return true;\
-        }\
-        return false;
+        return LoadTyped<type, func>(pDestination, count, pSource, size, format);
 
-#define LOAD_SCANLINE3( type, func, defvec )\
-        if (size >= sizeof(type))\
-        {\
-            const type * __restrict sPtr = reinterpret_cast<const type*>(pSource);\
-            for(size_t icount = 0; icount < (size - sizeof(type) + 1); icount += sizeof(type))\
-            {\
-                const XMVECTOR v = func(sPtr++);\
-                if (dPtr >= ePtr) break;\
-                *(dPtr++) = XMVectorSelect(defvec, v, g_XMSelect1110);\
-            }\
-            return true;\
-        }\
-        return false;
+#define LOAD_SCANLINE3( type, func )\
+        return LoadTypedPartial<type, func, 3>(pDestination, count, pSource, size, format);
 
-#define LOAD_SCANLINE2( type, func, defvec )\
-        if (size >= sizeof(type))\
-        {\
-            const type * __restrict sPtr = reinterpret_cast<const type*>(pSource);\
-            for(size_t icount = 0; icount < (size - sizeof(type) + 1); icount += sizeof(type))\
-            {\
-                const XMVECTOR v = func(sPtr++);\
-                if (dPtr >= ePtr) break;\
-                *(dPtr++) = XMVectorSelect(defvec, v, g_XMSelect1100);\
-            }\
-            return true;\
-        }\
-        return false;
+#define LOAD_SCANLINE2( type, func )\
+        return LoadTypedPartial<type, func, 2>(pDestination, count, pSource, size, format);
 
 #pragma warning(suppress: 6101)
 _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
@@ -801,13 +914,13 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         LOAD_SCANLINE(XMINT4, XMLoadSInt4)
 
     case DXGI_FORMAT_R32G32B32_FLOAT:
-        LOAD_SCANLINE3(XMFLOAT3, XMLoadFloat3, g_XMIdentityR3)
+        LOAD_SCANLINE3(XMFLOAT3, XMLoadFloat3)
 
     case DXGI_FORMAT_R32G32B32_UINT:
-        LOAD_SCANLINE3(XMUINT3, XMLoadUInt3, g_XMIdentityR3)
+        LOAD_SCANLINE3(XMUINT3, XMLoadUInt3)
 
     case DXGI_FORMAT_R32G32B32_SINT:
-        LOAD_SCANLINE3(XMINT3, XMLoadSInt3, g_XMIdentityR3)
+        LOAD_SCANLINE3(XMINT3, XMLoadSInt3)
 
     case DXGI_FORMAT_R16G16B16A16_FLOAT:
         LOAD_SCANLINE(XMHALF4, XMLoadHalf4)
@@ -825,13 +938,13 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         LOAD_SCANLINE(XMSHORT4, XMLoadShort4)
 
     case DXGI_FORMAT_R32G32_FLOAT:
-        LOAD_SCANLINE2(XMFLOAT2, XMLoadFloat2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMFLOAT2, XMLoadFloat2)
 
     case DXGI_FORMAT_R32G32_UINT:
-        LOAD_SCANLINE2(XMUINT2, XMLoadUInt2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMUINT2, XMLoadUInt2)
 
     case DXGI_FORMAT_R32G32_SINT:
-        LOAD_SCANLINE2(XMINT2, XMLoadSInt2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMINT2, XMLoadSInt2)
 
     case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
             {
@@ -896,7 +1009,7 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         LOAD_SCANLINE(XMUDEC4, XMLoadUDec4)
 
     case DXGI_FORMAT_R11G11B10_FLOAT:
-        LOAD_SCANLINE3(XMFLOAT3PK, XMLoadFloat3PK, g_XMIdentityR3)
+        LOAD_SCANLINE3(XMFLOAT3PK, XMLoadFloat3PK)
 
     case DXGI_FORMAT_R8G8B8A8_UNORM:
     case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
@@ -912,19 +1025,19 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         LOAD_SCANLINE(XMBYTE4, XMLoadByte4)
 
     case DXGI_FORMAT_R16G16_FLOAT:
-        LOAD_SCANLINE2(XMHALF2, XMLoadHalf2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMHALF2, XMLoadHalf2)
 
     case DXGI_FORMAT_R16G16_UNORM:
-        LOAD_SCANLINE2(XMUSHORTN2, XMLoadUShortN2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMUSHORTN2, XMLoadUShortN2)
 
     case DXGI_FORMAT_R16G16_UINT:
-        LOAD_SCANLINE2(XMUSHORT2, XMLoadUShort2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMUSHORT2, XMLoadUShort2)
 
     case DXGI_FORMAT_R16G16_SNORM:
-        LOAD_SCANLINE2(XMSHORTN2, XMLoadShortN2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMSHORTN2, XMLoadShortN2)
 
     case DXGI_FORMAT_R16G16_SINT:
-        LOAD_SCANLINE2(XMSHORT2, XMLoadShort2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMSHORT2, XMLoadShort2)
 
     case DXGI_FORMAT_D32_FLOAT:
     case DXGI_FORMAT_R32_FLOAT:
@@ -1018,16 +1131,16 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         return false;
 
     case DXGI_FORMAT_R8G8_UNORM:
-        LOAD_SCANLINE2(XMUBYTEN2, XMLoadUByteN2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMUBYTEN2, XMLoadUByteN2)
 
     case DXGI_FORMAT_R8G8_UINT:
-        LOAD_SCANLINE2(XMUBYTE2, XMLoadUByte2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMUBYTE2, XMLoadUByte2)
 
     case DXGI_FORMAT_R8G8_SNORM:
-        LOAD_SCANLINE2(XMBYTEN2, XMLoadByteN2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMBYTEN2, XMLoadByteN2)
 
     case DXGI_FORMAT_R8G8_SINT:
-        LOAD_SCANLINE2(XMBYTE2, XMLoadByte2, g_XMIdentityR3)
+        LOAD_SCANLINE2(XMBYTE2, XMLoadByte2)
 
     case DXGI_FORMAT_R16_FLOAT:
         if (size >= sizeof(HALF))
@@ -1179,7 +1292,7 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         return false;
 
     case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-        LOAD_SCANLINE3(XMFLOAT3SE, XMLoadFloat3SE, g_XMIdentityR3)
+        LOAD_SCANLINE3(XMFLOAT3SE, XMLoadFloat3SE)
 
     case DXGI_FORMAT_R8G8_B8G8_UNORM:
         if (size >= sizeof(XMUBYTEN4))
@@ -1615,21 +1728,145 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
 #undef LOAD_SCANLINE2
 
 
+//-------------------------------------------------------------------------------------
+// Picks the row loader for a format once, so per-row loops can call it directly.
+// Formats without a direct DirectXMath load get LoadScanline itself.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+LoadScanlineFunc DirectX::Internal::GetLoadScanline(DXGI_FORMAT format) noexcept
+{
+    switch (static_cast<int>(format))
+    {
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+        return LoadTyped<XMUINT4, XMLoadUInt4>;
+
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return LoadTyped<XMINT4, XMLoadSInt4>;
+
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+        return LoadTypedPartial<XMFLOAT3, XMLoadFloat3, 3>;
+
+    case DXGI_FORMAT_R32G32B32_UINT:
+        return LoadTypedPartial<XMUINT3, XMLoadUInt3, 3>;
+
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return LoadTypedPartial<XMINT3, XMLoadSInt3, 3>;
+
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        return LoadTyped<XMHALF4, XMLoadHalf4>;
+
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+        return LoadTyped<XMUSHORTN4, XMLoadUShortN4>;
+
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+        return LoadTyped<XMUSHORT4, XMLoadUShort4>;
+
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+        return LoadTyped<XMSHORTN4, XMLoadShortN4>;
+
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+        return LoadTyped<XMSHORT4, XMLoadShort4>;
+
+    case DXGI_FORMAT_R32G32_FLOAT:
+        return LoadTypedPartial<XMFLOAT2, XMLoadFloat2, 2>;
+
+    case DXGI_FORMAT_R32G32_UINT:
+        return LoadTypedPartial<XMUINT2, XMLoadUInt2, 2>;
+
+    case DXGI_FORMAT_R32G32_SINT:
+        return LoadTypedPartial<XMINT2, XMLoadSInt2, 2>;
+
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+        return LoadTyped<XMUDECN4, XMLoadUDecN4>;
+
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+        return LoadTyped<XMUDECN4, XMLoadUDecN4_XR>;
+
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+        return LoadTyped<XMUDEC4, XMLoadUDec4>;
+
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+        return LoadTypedPartial<XMFLOAT3PK, XMLoadFloat3PK, 3>;
+
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        return LoadTyped<XMUBYTEN4, XMLoadUByteN4>;
+
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+        return LoadTyped<XMUBYTE4, XMLoadUByte4>;
+
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+        return LoadTyped<XMBYTEN4, XMLoadByteN4>;
+
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+        return LoadTyped<XMBYTE4, XMLoadByte4>;
+
+    case DXGI_FORMAT_R16G16_FLOAT:
+        return LoadTypedPartial<XMHALF2, XMLoadHalf2, 2>;
+
+    case DXGI_FORMAT_R16G16_UNORM:
+        return LoadTypedPartial<XMUSHORTN2, XMLoadUShortN2, 2>;
+
+    case DXGI_FORMAT_R16G16_UINT:
+        return LoadTypedPartial<XMUSHORT2, XMLoadUShort2, 2>;
+
+    case DXGI_FORMAT_R16G16_SNORM:
+        return LoadTypedPartial<XMSHORTN2, XMLoadShortN2, 2>;
+
+    case DXGI_FORMAT_R16G16_SINT:
+        return LoadTypedPartial<XMSHORT2, XMLoadShort2, 2>;
+
+    case DXGI_FORMAT_R8G8_UNORM:
+        return LoadTypedPartial<XMUBYTEN2, XMLoadUByteN2, 2>;
+
+    case DXGI_FORMAT_R8G8_UINT:
+        return LoadTypedPartial<XMUBYTE2, XMLoadUByte2, 2>;
+
+    case DXGI_FORMAT_R8G8_SNORM:
+        return LoadTypedPartial<XMBYTEN2, XMLoadByteN2, 2>;
+
+    case DXGI_FORMAT_R8G8_SINT:
+        return LoadTypedPartial<XMBYTE2, XMLoadByte2, 2>;
+
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        return LoadTypedPartial<XMFLOAT3SE, XMLoadFloat3SE, 3>;
+
+    default:
+        return LoadScanline;
+    }
+}
+
+
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // Row storer for formats that map directly onto a DirectXMath store
+    //-------------------------------------------------------------------------------------
+    template<typename T, void(XM_CALLCONV *Store)(T*, FXMVECTOR)>
+    bool __cdecl StoreTyped(
+        void* pDestination, size_t size, DXGI_FORMAT,
+        const XMVECTOR* pSource, size_t count, float) noexcept
+    {
+        const XMVECTOR* __restrict sPtr = pSource;
+        if (!pDestination || !sPtr || !count || size < sizeof(T))
+            return false;
+
+        const XMVECTOR* ePtr = sPtr + count;
+        T * __restrict dPtr = static_cast<T*>(pDestination);
+        for (size_t icount = 0; icount < (size - sizeof(T) + 1); icount += sizeof(T))
+        {
+            if (sPtr >= ePtr) break;
+            Store(dPtr++, *sPtr++);
+        }
+        return true;
+    }
+}
+
 //-------------------------------------------------------------------------------------
 // Stores an image row from standard RGBA XMVECTOR (aligned) array
 //-------------------------------------------------------------------------------------
 #define STORE_SCANLINE( type, func )\
-        if (size >= sizeof(type))\
-        {\
-            type * __restrict dPtr = reinterpret_cast<type*>(pDestination);\
-            for(size_t icount = 0; icount < (size - sizeof(type) + 1); icount += sizeof(type))\
-            {\
-                if (sPtr >= ePtr) break;\
-                func(dPtr++, *sPtr++);\
-            }\
-            return true; \
-        }\
-        return false;
+        return StoreTyped<type, func>(pDestination, size, format, pSource, count, threshold);
 
 _Use_decl_annotations_
 bool DirectX::Internal::StoreScanline(
@@ -2521,6 +2758,108 @@ bool DirectX::Internal::StoreScanline(
 #undef STORE_SCANLINE
 
 
+//-------------------------------------------------------------------------------------
+// Picks the row storer for a format once, so per-row loops can call it directly.
+// Formats without a direct DirectXMath store get StoreScanline itself.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+StoreScanlineFunc DirectX::Internal::GetStoreScanline(DXGI_FORMAT format) noexcept
+{
+    switch (static_cast<int>(format))
+    {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        return StoreTyped<XMFLOAT4, XMStoreFloat4>;
+
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+        return StoreTyped<XMUINT4, XMStoreUInt4>;
+
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return StoreTyped<XMINT4, XMStoreSInt4>;
+
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+        return StoreTyped<XMFLOAT3, XMStoreFloat3>;
+
+    case DXGI_FORMAT_R32G32B32_UINT:
+        return StoreTyped<XMUINT3, XMStoreUInt3>;
+
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return StoreTyped<XMINT3, XMStoreSInt3>;
+
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+        return StoreTyped<XMUSHORTN4, XMStoreUShortN4>;
+
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+        return StoreTyped<XMUSHORT4, XMStoreUShort4>;
+
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+        return StoreTyped<XMSHORTN4, XMStoreShortN4>;
+
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+        return StoreTyped<XMSHORT4, XMStoreShort4>;
+
+    case DXGI_FORMAT_R32G32_FLOAT:
+        return StoreTyped<XMFLOAT2, XMStoreFloat2>;
+
+    case DXGI_FORMAT_R32G32_UINT:
+        return StoreTyped<XMUINT2, XMStoreUInt2>;
+
+    case DXGI_FORMAT_R32G32_SINT:
+        return StoreTyped<XMINT2, XMStoreSInt2>;
+
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+        return StoreTyped<XMUDECN4, XMStoreUDecN4>;
+
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+        return StoreTyped<XMUDECN4, XMStoreUDecN4_XR>;
+
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+        return StoreTyped<XMUDEC4, XMStoreUDec4>;
+
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+        return StoreTyped<XMFLOAT3PK, XMStoreFloat3PK>;
+
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+        return StoreTyped<XMUBYTE4, XMStoreUByte4>;
+
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+        return StoreTyped<XMBYTEN4, XMStoreByteN4>;
+
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+        return StoreTyped<XMBYTE4, XMStoreByte4>;
+
+    case DXGI_FORMAT_R16G16_UNORM:
+        return StoreTyped<XMUSHORTN2, XMStoreUShortN2>;
+
+    case DXGI_FORMAT_R16G16_UINT:
+        return StoreTyped<XMUSHORT2, XMStoreUShort2>;
+
+    case DXGI_FORMAT_R16G16_SNORM:
+        return StoreTyped<XMSHORTN2, XMStoreShortN2>;
+
+    case DXGI_FORMAT_R16G16_SINT:
+        return StoreTyped<XMSHORT2, XMStoreShort2>;
+
+    case DXGI_FORMAT_R8G8_UNORM:
+        return StoreTyped<XMUBYTEN2, XMStoreUByteN2>;
+
+    case DXGI_FORMAT_R8G8_UINT:
+        return StoreTyped<XMUBYTE2, XMStoreUByte2>;
+
+    case DXGI_FORMAT_R8G8_SNORM:
+        return StoreTyped<XMBYTEN2, XMStoreByteN2>;
+
+    case DXGI_FORMAT_R8G8_SINT:
+        return StoreTyped<XMBYTE2, XMStoreByte2>;
+
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        return StoreTyped<XMFLOAT3SE, StoreFloat3SE>;
+
+    default:
+        return StoreScanline;
+    }
+}
+
+
 //-------------------------------------------------------------------------------------
 // Convert DXGI image to/from GUID_WICPixelFormat128bppRGBAFloat (no range conversions)
 //-------------------------------------------------------------------------------------
@@ -2548,10 +2887,12 @@ HRESULT DirectX::Internal::ConvertToR32G32B32A32(const Image& srcImage, ScratchI
         return E_POINTER;
     }
 
+    const LoadScanlineFunc pfnLoad = GetLoadScanline(srcImage.format);
+
     const uint8_t *pSrc = srcImage.pixels;
     for (size_t h = 0; h < srcImage.height; ++h)
     {
-        if (!LoadScanline(reinterpret_cast<XMVECTOR*>(pDest), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
+        if (!pfnLoad(reinterpret_cast<XMVECTOR*>(pDest), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
         {
             image.Release();
             return E_FAIL;
@@ -2575,12 +2916,14 @@ HRESULT DirectX::Internal::ConvertFromR32G32B32A32(const Image& srcImage, const
     if (srcImage.width != destImage.width || srcImage.height != destImage.height)
         return E_FAIL;
 
+    const StoreScanlineFunc pfnStore = GetStoreScanline(destImage.format);
+
     const uint8_t *pSrc = srcImage.pixels;
     uint8_t* pDest = destImage.pixels;
 
     for (size_t h = 0; h < srcImage.height; ++h)
     {
-        if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, reinterpret_cast<const XMVECTOR*>(pSrc), srcImage.width))
+        if (!pfnStore(pDest, destImage.rowPitch, destImage.format, reinterpret_cast<const XMVECTOR*>(pSrc), srcImage.width, 0))
             return E_FAIL;
 
         pSrc += srcImage.rowPitch;
@@ -2654,6 +2997,8 @@ HRESULT DirectX::Internal::ConvertFromR32G32B32A32(
         return E_POINTER;
     }
 
+    const StoreScanlineFunc pfnStore = GetStoreScanline(format);
+
     for (size_t index = 0; index < nimages; ++index)
     {
         const Image& src = srcImages[index];
@@ -2678,7 +3023,7 @@ HRESULT DirectX::Internal::ConvertFromR32G32B32A32(
 
         for (size_t h = 0; h < src.height; ++h)
         {
-            if (!StoreScanline(pDest, dst.rowPitch, format, reinterpret_cast<const XMVECTOR*>(pSrc), src.width))
+            if (!pfnStore(pDest, dst.rowPitch, format, reinterpret_cast<const XMVECTOR*>(pSrc), src.width, 0))
             {
                 result.Release();
                 return E_FAIL;
@@ -2727,10 +3072,12 @@ HRESULT DirectX::Internal::ConvertToR16G16B16A16(const Image& srcImage, ScratchI
         return E_POINTER;
     }
 
+    const LoadScanlineFunc pfnLoad = GetLoadScanline(srcImage.format);
+
     const uint8_t *pSrc = srcImage.pixels;
     for (size_t h = 0; h < srcImage.height; ++h)
     {
-        if (!LoadScanline(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
+        if (!pfnLoad(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
         {
             image.Release();
             return E_FAIL;
@@ -2763,6 +3110,8 @@ HRESULT DirectX::Internal::ConvertFromR16G16B16A16(const Image& srcImage, const
     if (!scanline)
         return E_OUTOFMEMORY;
 
+    const StoreScanlineFunc pfnStore = GetStoreScanline(destImage.format);
+
     const uint8_t *pSrc = srcImage.pixels;
     uint8_t* pDest = destImage.pixels;
 
@@ -2773,7 +3122,7 @@ HRESULT DirectX::Internal::ConvertFromR16G16B16A16(const Image& srcImage, const
             reinterpret_cast<const HALF*>(pSrc), sizeof(HALF),
             srcImage.width * 4);
 
-        if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline.get(), srcImage.width))
+        if (!pfnStore(pDest, destImage.rowPitch, destImage.format, scanline.get(), srcImage.width, 0))
             return E_FAIL;
 
         pSrc += srcImage.rowPitch;
@@ -4790,6 +5139,112 @@ namespace
     #endif // WIN32
     }
 
+    //-------------------------------------------------------------------------------------
+    // Conversions between formats of the same numeric type and channel size that only move
+    // whole channels (RGBA <-> BGRA, RGB(A) -> R/RG with TEX_FILTER_RGB_COPY_*, R -> RG/RGBA)
+    // are done on the integer data. The channel choices mirror ConvertScanline.
+    //-------------------------------------------------------------------------------------
+    bool SetupConvertRemap(
+        _In_ DXGI_FORMAT inFormat,
+        _In_ DXGI_FORMAT outFormat,
+        _In_ TEX_FILTER_FLAGS filter,
+        _Out_ ChannelRemap& remap) noexcept
+    {
+        if (filter & (TEX_FILTER_DITHER | TEX_FILTER_DITHER_DIFFUSION | TEX_FILTER_SRGB_IN | TEX_FILTER_SRGB_OUT))
+            return false;
+
+        if (IsSRGB(inFormat) || IsSRGB(outFormat))
+            return false;
+
+        const uint32_t inFlags = GetConvertFlags(inFormat);
+        const uint32_t outFlags = GetConvertFlags(outFormat);
+
+        uint32_t channels[4] = { TEX_SWIZZLE_RED, TEX_SWIZZLE_GREEN, TEX_SWIZZLE_BLUE, TEX_SWIZZLE_ALPHA };
+
+        if ((inFlags & CONVF_RGB_MASK) == CONVF_R)
+        {
+            // R format -> RG or RGB format replicates red
+            if (outFlags & CONVF_G)
+            {
+                channels[1] = TEX_SWIZZLE_RED;
+            }
+            if (outFlags & CONVF_B)
+            {
+                channels[2] = TEX_SWIZZLE_RED;
+            }
+        }
+        else if ((inFlags & CONVF_RGB_MASK) == (CONVF_R | CONVF_G | CONVF_B))
+        {
+            const auto copy = static_cast<int>(filter & (TEX_FILTER_RGB_COPY_RED | TEX_FILTER_RGB_COPY_GREEN | TEX_FILTER_RGB_COPY_BLUE | TEX_FILTER_RGB_COPY_ALPHA));
+
+            if ((outFlags & CONVF_RGB_MASK) == CONVF_R)
+            {
+                switch (copy)
+                {
+                case TEX_FILTER_RGB_COPY_RED:
+                    break;
+
+                case TEX_FILTER_RGB_COPY_GREEN:
+                    channels[0] = TEX_SWIZZLE_GREEN;
+                    break;
+
+                case TEX_FILTER_RGB_COPY_BLUE:
+                    channels[0] = TEX_SWIZZLE_BLUE;
+                    break;
+
+                case TEX_FILTER_RGB_COPY_ALPHA:
+                    channels[0] = TEX_SWIZZLE_ALPHA;
+                    break;
+
+                default:
+                    // UNORM sources are reduced to luminance
+                    if (inFlags & CONVF_UNORM)
+                        return false;
+                    break;
+                }
+            }
+            else if ((outFlags & CONVF_RGB_MASK) == (CONVF_R | CONVF_G))
+            {
+                if ((filter & TEX_FILTER_RGB_COPY_ALPHA) && (inFlags & CONVF_A))
+                {
+                    switch (copy)
+                    {
+                    case (static_cast<int>(TEX_FILTER_RGB_COPY_GREEN) | static_cast<int>(TEX_FILTER_RGB_COPY_ALPHA)):
+                        channels[0] = TEX_SWIZZLE_GREEN;
+                        break;
+
+                    case (static_cast<int>(TEX_FILTER_RGB_COPY_BLUE) | static_cast<int>(TEX_FILTER_RGB_COPY_ALPHA)):
+                        channels[0] = TEX_SWIZZLE_BLUE;
+                        break;
+
+                    default:
+                        break;
+                    }
+                    channels[1] = TEX_SWIZZLE_ALPHA;
+                }
+                else
+                {
+                    switch (copy & ~static_cast<int>(TEX_FILTER_RGB_COPY_ALPHA))
+                    {
+                    case (static_cast<int>(TEX_FILTER_RGB_COPY_RED) | static_cast<int>(TEX_FILTER_RGB_COPY_BLUE)):
+                        channels[1] = TEX_SWIZZLE_BLUE;
+                        break;
+
+                    case (static_cast<int>(TEX_FILTER_RGB_COPY_GREEN) | static_cast<int>(TEX_FILTER_RGB_COPY_BLUE)):
+                        channels[0] = TEX_SWIZZLE_GREEN;
+                        channels[1] = TEX_SWIZZLE_BLUE;
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+            }
+        }
+
+        return SetupChannelRemap(inFormat, outFormat, channels, remap);
+    }
+
     //-------------------------------------------------------------------------------------
     // Convert the source image (not using WIC)
     //-------------------------------------------------------------------------------------
@@ -4798,7 +5253,8 @@ namespace
         _In_ TEX_FILTER_FLAGS filter,
         _In_ const Image& destImage,
         _In_ float threshold,
-        size_t z) noexcept
+        size_t z,
+        ProgressTracker& progress) noexcept
     {
         assert(srcImage.width == destImage.width);
         assert(srcImage.height == destImage.height);
@@ -4810,6 +5266,25 @@ namespace
 
         size_t width = srcImage.width;
 
+        ChannelRemap remap;
+        if (SetupConvertRemap(srcImage.format, destImage.format, filter, remap))
+        {
+            for (size_t h = 0; h < srcImage.height; ++h)
+            {
+                RemapScanline(pDest, pSrc, width, remap);
+
+                pSrc += srcImage.rowPitch;
+                pDest += destImage.rowPitch;
+
+                if (!progress.Advance(1))
+                    return E_ABORT;
+            }
+
+            return S_OK;
+        }
+
+        const LoadScanlineFunc pfnLoad = GetLoadScanline(srcImage.format);
+
         if (filter & TEX_FILTER_DITHER_DIFFUSION)
         {
             // Error diffusion dithering (aka Floyd-Steinberg dithering)
@@ -4822,7 +5297,7 @@ namespace
 
             for (size_t h = 0; h < srcImage.height; ++h)
             {
-                if (!LoadScanline(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
+                if (!pfnLoad(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
                     return E_FAIL;
 
                 ConvertScanline(scanline.get(), width, destImage.format, srcImage.format, filter);
@@ -4832,6 +5307,9 @@ namespace
 
                 pSrc += srcImage.rowPitch;
                 pDest += destImage.rowPitch;
+
+                if (!progress.Advance(1))
+                    return E_ABORT;
             }
         }
         else
@@ -4845,7 +5323,7 @@ namespace
                 // Ordered dithering
                 for (size_t h = 0; h < srcImage.height; ++h)
                 {
-                    if (!LoadScanline(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
+                    if (!pfnLoad(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
                         return E_FAIL;
 
                     ConvertScanline(scanline.get(), width, destImage.format, srcImage.format, filter);
@@ -4855,23 +5333,31 @@ namespace
 
                     pSrc += srcImage.rowPitch;
                     pDest += destImage.rowPitch;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
             else
             {
                 // No dithering
+                const StoreScanlineFunc pfnStore = GetStoreScanline(destImage.format);
+
                 for (size_t h = 0; h < srcImage.height; ++h)
                 {
-                    if (!LoadScanline(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
+                    if (!pfnLoad(scanline.get(), width, pSrc, srcImage.rowPitch, srcImage.format))
                         return E_FAIL;
 
                     ConvertScanline(scanline.get(), width, destImage.format, srcImage.format, filter);
 
-                    if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline.get(), width, threshold))
+                    if (!pfnStore(pDest, destImage.rowPitch, destImage.format, scanline.get(), width, threshold))
                         return E_FAIL;
 
                     pSrc += srcImage.rowPitch;
                     pDest += destImage.rowPitch;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
         }
@@ -5060,8 +5546,11 @@ HRESULT DirectX::Convert(
     DXGI_FORMAT format,
     TEX_FILTER_FLAGS filter,
     float threshold,
-    ScratchImage& image) noexcept
+    ScratchImage& image,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_CONVERT, srcImage, format);
+
     if ((srcImage.format == format) || !IsValid(format))
         return E_INVALIDARG;
 
@@ -5088,14 +5577,18 @@ HRESULT DirectX::Convert(
         return E_POINTER;
     }
 
+    ProgressTracker tracker(progress, srcImage.height);
+
     WICPixelFormatGUID pfGUID, targetGUID;
     if (UseWICConversion(filter, srcImage.format, format, pfGUID, targetGUID))
     {
         hr = ConvertUsingWIC(srcImage, pfGUID, targetGUID, filter, threshold, *rimage);
+        if (SUCCEEDED(hr) && !tracker.Advance(srcImage.height))
+            hr = E_ABORT;
     }
     else
     {
-        hr = ConvertCustom(srcImage, filter, *rimage, threshold, 0);
+        hr = ConvertCustom(srcImage, filter, *rimage, threshold, 0, tracker);
     }
 
     if (FAILED(hr))
@@ -5119,8 +5612,11 @@ HRESULT DirectX::Convert(
     DXGI_FORMAT format,
     TEX_FILTER_FLAGS filter,
     float threshold,
-    ScratchImage& result) noexcept
+    ScratchImage& result,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_CONVERT, srcImages, nimages, metadata, format);
+
     if (!srcImages || !nimages || (metadata.format == format) || !IsValid(format))
         return E_INVALIDARG;
 
@@ -5155,6 +5651,14 @@ HRESULT DirectX::Convert(
     WICPixelFormatGUID pfGUID, targetGUID;
     const bool usewic = !metadata.IsPMAlpha() && UseWICConversion(filter, metadata.format, format, pfGUID, targetGUID);
 
+    size_t totalRows = 0;
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        totalRows += srcImages[index].height;
+    }
+
+    ProgressTracker tracker(progress, totalRows);
+
     switch (metadata.dimension)
     {
     case TEX_DIMENSION_TEXTURE1D:
@@ -5186,10 +5690,12 @@ HRESULT DirectX::Convert(
             if (usewic)
             {
                 hr = ConvertUsingWIC(src, pfGUID, targetGUID, filter, threshold, dst);
+                if (SUCCEEDED(hr) && !tracker.Advance(src.height))
+                    hr = E_ABORT;
             }
             else
             {
-                hr = ConvertCustom(src, filter, dst, threshold, 0);
+                hr = ConvertCustom(src, filter, dst, threshold, 0, tracker);
             }
 
             if (FAILED(hr))
@@ -5239,10 +5745,12 @@ HRESULT DirectX::Convert(
                     if (usewic)
                     {
                         hr = ConvertUsingWIC(src, pfGUID, targetGUID, filter, threshold, dst);
+                        if (SUCCEEDED(hr) && !tracker.Advance(src.height))
+                            hr = E_ABORT;
                     }
                     else
                     {
-                        hr = ConvertCustom(src, filter, dst, threshold, slice);
+                        hr = ConvertCustom(src, filter, dst, threshold, slice, tracker);
                     }
 
                     if (FAILED(hr))
@@ -928,6 +928,140 @@ namespace
         return lformat;
     }
 
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    //-------------------------------------------------------------------------------------
+    // SSE2 kernels for LegacyExpandScanline, working on 16-bit channel lanes. Each returns
+    // the number of pixels done and the scalar loop finishes the row. Palettized formats
+    // need a gather, so they stay scalar.
+    //-------------------------------------------------------------------------------------
+
+    // Interleaves 16-bit channel lanes holding 0..255 into 8 R8G8B8A8 pixels
+    inline void StoreRGBA8(uint32_t* pDest, __m128i r, __m128i g, __m128i b, __m128i a) noexcept
+    {
+        const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+
+    // Widens the 3:3:2 color in the low byte of each lane and stores 8 pixels
+    inline void StoreRGB332(uint32_t* pDest, __m128i t, __m128i a) noexcept
+    {
+        const __m128i mask3 = _mm_set1_epi16(0x7);
+        const __m128i scale3 = _mm_set1_epi16(73);  // (v * 73) >> 1 == (v << 5) | (v << 2) | (v >> 1)
+
+        const __m128i r = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(t, 5), mask3), scale3), 1);
+        const __m128i g = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(t, 2), mask3), scale3), 1);
+        const __m128i b = _mm_mullo_epi16(_mm_and_si128(t, _mm_set1_epi16(0x3)), _mm_set1_epi16(0x55));
+        StoreRGBA8(pDest, r, g, b, a);
+    }
+
+    size_t ExpandR3G3B2(uint32_t* pDest, const uint8_t* pSource, size_t count) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            StoreRGB332(pDest + i, _mm_unpacklo_epi8(t, zero), alpha);
+            StoreRGB332(pDest + i + 8, _mm_unpackhi_epi8(t, zero), alpha);
+        }
+        return i;
+    }
+
+    size_t ExpandA8R3G3B2(uint32_t* pDest, const uint16_t* pSource, size_t count, bool setAlpha) noexcept
+    {
+        const __m128i mask8 = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            StoreRGB332(pDest + i, t, (setAlpha) ? mask8 : _mm_srli_epi16(t, 8));
+        }
+        return i;
+    }
+
+    size_t ExpandA4L4(uint32_t* pDest, const uint8_t* pSource, size_t count, bool setAlpha) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask4 = _mm_set1_epi16(0xf);
+        const __m128i scale4 = _mm_set1_epi16(17);  // v * 17 == (v << 4) | v
+        const __m128i opaque = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            for (size_t half = 0; half < 2; ++half)
+            {
+                const __m128i v = (half) ? _mm_unpackhi_epi8(t, zero) : _mm_unpacklo_epi8(t, zero);
+                const __m128i l = _mm_mullo_epi16(_mm_and_si128(v, mask4), scale4);
+                const __m128i a = (setAlpha) ? opaque : _mm_mullo_epi16(_mm_srli_epi16(v, 4), scale4);
+                StoreRGBA8(pDest + i + half * 8, l, l, l, a);
+            }
+        }
+        return i;
+    }
+
+    size_t ExpandL8(uint32_t* pDest, const uint8_t* pSource, size_t count) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alpha = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            const __m128i lo = _mm_unpacklo_epi8(t, zero);
+            const __m128i hi = _mm_unpackhi_epi8(t, zero);
+            StoreRGBA8(pDest + i, lo, lo, lo, alpha);
+            StoreRGBA8(pDest + i + 8, hi, hi, hi, alpha);
+        }
+        return i;
+    }
+
+    size_t ExpandA8L8(uint32_t* pDest, const uint16_t* pSource, size_t count, bool setAlpha) noexcept
+    {
+        const __m128i mask8 = _mm_set1_epi16(0xff);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            const __m128i l = _mm_and_si128(t, mask8);
+            StoreRGBA8(pDest + i, l, l, l, (setAlpha) ? mask8 : _mm_srli_epi16(t, 8));
+        }
+        return i;
+    }
+
+    size_t ExpandL16(uint64_t* pDest, const uint16_t* pSource, size_t count) noexcept
+    {
+        const __m128i alpha = _mm_set1_epi16(-1);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+
+            // (l, l) and (l, 0xffff) pairs, then interleaved into (l, l, l, 0xffff)
+            const __m128i ll0 = _mm_unpacklo_epi16(t, t);
+            const __m128i la0 = _mm_unpacklo_epi16(t, alpha);
+            const __m128i ll1 = _mm_unpackhi_epi16(t, t);
+            const __m128i la1 = _mm_unpackhi_epi16(t, alpha);
+
+            auto dPtr = reinterpret_cast<__m128i*>(pDest + i);
+            _mm_storeu_si128(dPtr, _mm_unpacklo_epi32(ll0, la0));
+            _mm_storeu_si128(dPtr + 1, _mm_unpackhi_epi32(ll0, la0));
+            _mm_storeu_si128(dPtr + 2, _mm_unpacklo_epi32(ll1, la1));
+            _mm_storeu_si128(dPtr + 3, _mm_unpackhi_epi32(ll1, la1));
+        }
+        return i;
+    }
+#endif
+
     _Success_(return)
         bool LegacyExpandScanline(
             _Out_writes_bytes_(outSize) void* pDestination,
@@ -979,7 +1113,15 @@ namespace
                     const uint8_t* __restrict sPtr = static_cast<const uint8_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                    for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                    size_t done = 0;
+                #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                    const size_t count = std::min(inSize, outSize / sizeof(uint32_t));
+                    done = ExpandR3G3B2(dPtr, sPtr, count);
+                    sPtr += done;
+                    dPtr += done;
+                #endif
+
+                    for (size_t ocount = done * 4, icount = done; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
                     {
                         const uint8_t t = *(sPtr++);
 
@@ -1028,7 +1170,15 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                size_t done = 0;
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint32_t));
+                done = ExpandA8R3G3B2(dPtr, sPtr, count, (tflags & TEXP_SCANLINE_SETALPHA) != 0);
+                sPtr += done;
+                dPtr += done;
+            #endif
+
+                for (size_t ocount = done * 4, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
                 {
                     const uint16_t t = *(sPtr++);
 
@@ -1116,7 +1266,15 @@ namespace
                     const uint8_t * __restrict sPtr = static_cast<const uint8_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                    for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                    size_t done = 0;
+                #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                    const size_t count = std::min(inSize, outSize / sizeof(uint32_t));
+                    done = ExpandA4L4(dPtr, sPtr, count, (tflags & TEXP_SCANLINE_SETALPHA) != 0);
+                    sPtr += done;
+                    dPtr += done;
+                #endif
+
+                    for (size_t ocount = done * 4, icount = done; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
                     {
                         const uint8_t t = *(sPtr++);
 
@@ -1168,7 +1326,15 @@ namespace
                 const uint8_t * __restrict sPtr = static_cast<const uint8_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                size_t done = 0;
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                const size_t count = std::min(inSize, outSize / sizeof(uint32_t));
+                done = ExpandL8(dPtr, sPtr, count);
+                sPtr += done;
+                dPtr += done;
+            #endif
+
+                for (size_t ocount = done * 4, icount = done; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
                 {
                     uint32_t t1 = *(sPtr++);
                     uint32_t t2 = (t1 << 8);
@@ -1190,7 +1356,15 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint64_t * __restrict dPtr = static_cast<uint64_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 7))); icount += 2, ocount += 8)
+                size_t done = 0;
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint64_t));
+                done = ExpandL16(dPtr, sPtr, count);
+                sPtr += done;
+                dPtr += done;
+            #endif
+
+                for (size_t ocount = done * 8, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 7))); icount += 2, ocount += 8)
                 {
                     const uint16_t t = *(sPtr++);
 
@@ -1214,7 +1388,15 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                size_t done = 0;
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                const size_t count = std::min(inSize / sizeof(uint16_t), outSize / sizeof(uint32_t));
+                done = ExpandA8L8(dPtr, sPtr, count, (tflags & TEXP_SCANLINE_SETALPHA) != 0);
+                sPtr += done;
+                dPtr += done;
+            #endif
+
+                for (size_t ocount = done * 4, icount = done * 2; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
                 {
                     const uint16_t t = *(sPtr++);
 
@@ -1235,6 +1417,119 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // Converts or copies the rows of one non-compressed, non-planar image
+    //-------------------------------------------------------------------------------------
+
+    // Rows per parallel work item
+    constexpr size_t DDS_BAND_ROWS = 64;
+
+    // Expansion is cheap per pixel, so only large images are worth starting worker threads for
+    constexpr size_t DDS_PARALLEL_MIN_PIXELS = 256 * 1024;
+
+    _Success_(return)
+        bool ConvertScanline(
+            _Out_writes_bytes_(dpitch) void* pDest,
+            size_t dpitch,
+            _In_reads_bytes_(spitch) const void* pSrc,
+            size_t spitch,
+            _In_ DXGI_FORMAT format,
+            _In_ uint32_t convFlags,
+            _In_reads_opt_(256) const uint32_t* pal8,
+            _In_ uint32_t tflags) noexcept
+    {
+        if (convFlags & CONV_FLAGS_EXPAND)
+        {
+            if (convFlags & CONV_FLAGS_4444)
+            {
+                return ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
+                    pSrc, spitch,
+                    (convFlags & CONF_FLAGS_11ON12) ? WIN11_DXGI_FORMAT_A4B4G4R4_UNORM : DXGI_FORMAT_B4G4R4A4_UNORM,
+                    tflags);
+            }
+            else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551))
+            {
+                return ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
+                    pSrc, spitch,
+                    (convFlags & CONV_FLAGS_565) ? DXGI_FORMAT_B5G6R5_UNORM : DXGI_FORMAT_B5G5R5A1_UNORM,
+                    tflags);
+            }
+
+            const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
+            return LegacyExpandScanline(pDest, dpitch, format,
+                pSrc, spitch, lformat, pal8,
+                tflags);
+        }
+        else if (convFlags & CONV_FLAGS_SWIZZLE)
+        {
+            SwizzleScanline(pDest, dpitch, pSrc, spitch, format, tflags);
+        }
+        else
+        {
+            CopyScanline(pDest, dpitch, pSrc, spitch, format, tflags);
+        }
+
+        return true;
+    }
+
+    HRESULT ConvertImageRows(
+        _In_ const Image& srcImage,
+        _In_ const Image& destImage,
+        _In_ DXGI_FORMAT format,
+        _In_ uint32_t convFlags,
+        _In_reads_opt_(256) const uint32_t* pal8,
+        _In_ uint32_t tflags) noexcept
+    {
+        const size_t height = destImage.height;
+        const size_t nbands = (height + DDS_BAND_ROWS - 1) / DDS_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::atomic<bool> failed(false);
+
+    #ifdef _OPENMP
+        // Plain copies and swizzles are bound by memory bandwidth, so only expansion is threaded
+        const bool threaded = (convFlags & CONV_FLAGS_EXPAND) && nbands > 1
+            && destImage.width * height >= DDS_PARALLEL_MIN_PIXELS;
+
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (threaded) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                if (failed.load(std::memory_order_relaxed))
+                    continue;
+
+                const size_t y0 = size_t(band) * DDS_BAND_ROWS;
+                const size_t y1 = std::min(y0 + DDS_BAND_ROWS, height);
+
+                const uint8_t* pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+                uint8_t* pDest = destImage.pixels + destImage.rowPitch * y0;
+                for (size_t y = y0; y < y1; ++y)
+                {
+                    if (!ConvertScanline(pDest, destImage.rowPitch, pSrc, srcImage.rowPitch, format, convFlags, pal8, tflags))
+                    {
+                        failed = true;
+                        break;
+                    }
+
+                    pSrc += srcImage.rowPitch;
+                    pDest += destImage.rowPitch;
+                }
+            }
+        }
+
+        return (failed) ? E_FAIL : S_OK;
+    }
+
+
     //-------------------------------------------------------------------------------------
     // Converts or copies image data from pPixels into scratch image data
     //-------------------------------------------------------------------------------------
@@ -1372,49 +1667,9 @@ namespace
                         }
                         else
                         {
-                            for (size_t h = 0; h < images[index].height; ++h)
-                            {
-                                if (convFlags & CONV_FLAGS_EXPAND)
-                                {
-                                    if (convFlags & CONV_FLAGS_4444)
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONF_FLAGS_11ON12) ? WIN11_DXGI_FORMAT_A4B4G4R4_UNORM : DXGI_FORMAT_B4G4R4A4_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551))
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONV_FLAGS_565) ? DXGI_FORMAT_B5G6R5_UNORM : DXGI_FORMAT_B5G5R5A1_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else
-                                    {
-                                        const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                                        if (!LegacyExpandScanline(pDest, dpitch, metadata.format,
-                                            pSrc, spitch, lformat, pal8,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                }
-                                else if (convFlags & CONV_FLAGS_SWIZZLE)
-                                {
-                                    SwizzleScanline(pDest, dpitch, pSrc, spitch,
-                                        metadata.format, tflags);
-                                }
-                                else
-                                {
-                                    CopyScanline(pDest, dpitch, pSrc, spitch,
-                                        metadata.format, tflags);
-                                }
-
-                                pSrc += spitch;
-                                pDest += dpitch;
-                            }
+                            hr = ConvertImageRows(timages[index], images[index], metadata.format, convFlags, pal8, tflags);
+                            if (FAILED(hr))
+                                return hr;
                         }
                     }
                 }
@@ -1437,9 +1692,6 @@ namespace
                         if (images[index].height != timages[index].height)
                             return E_FAIL;
 
-                        size_t dpitch = images[index].rowPitch;
-                        const size_t spitch = timages[index].rowPitch;
-
                         const uint8_t *pSrc = timages[index].pixels;
                         if (!pSrc)
                             return E_POINTER;
@@ -1473,47 +1725,9 @@ namespace
                         }
                         else
                         {
-                            for (size_t h = 0; h < images[index].height; ++h)
-                            {
-                                if (convFlags & CONV_FLAGS_EXPAND)
-                                {
-                                    if (convFlags & CONV_FLAGS_4444)
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONF_FLAGS_11ON12) ? WIN11_DXGI_FORMAT_A4B4G4R4_UNORM : DXGI_FORMAT_B4G4R4A4_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551))
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONV_FLAGS_565) ? DXGI_FORMAT_B5G6R5_UNORM : DXGI_FORMAT_B5G5R5A1_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else
-                                    {
-                                        const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                                        if (!LegacyExpandScanline(pDest, dpitch, metadata.format,
-                                            pSrc, spitch, lformat, pal8,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                }
-                                else if (convFlags & CONV_FLAGS_SWIZZLE)
-                                {
-                                    SwizzleScanline(pDest, dpitch, pSrc, spitch, metadata.format, tflags);
-                                }
-                                else
-                                {
-                                    CopyScanline(pDest, dpitch, pSrc, spitch, metadata.format, tflags);
-                                }
-
-                                pSrc += spitch;
-                                pDest += dpitch;
-                            }
+                            hr = ConvertImageRows(timages[index], images[index], metadata.format, convFlags, pal8, tflags);
+                            if (FAILED(hr))
+                                return hr;
                         }
                     }
 
@@ -1574,6 +1788,138 @@ namespace
 
         return S_OK;
     }
+
+    //-------------------------------------------------------------------------------------
+    // Number of surfaces stored in the file; the image array is already in file order
+    // (array item then mip level, or mip level then slice for volumes)
+    //-------------------------------------------------------------------------------------
+    HRESULT CountDDSImages(const TexMetadata& metadata, size_t nimages, size_t& count) noexcept
+    {
+        count = 0;
+
+        switch (static_cast<DDS_RESOURCE_DIMENSION>(metadata.dimension))
+        {
+        case DDS_DIMENSION_TEXTURE1D:
+        case DDS_DIMENSION_TEXTURE2D:
+            {
+                const uint64_t total = uint64_t(metadata.arraySize) * uint64_t(metadata.mipLevels);
+                if (total > nimages)
+                    return E_FAIL;
+
+                count = static_cast<size_t>(total);
+            }
+            break;
+
+        case DDS_DIMENSION_TEXTURE3D:
+            {
+                if (metadata.arraySize != 1)
+                    return E_FAIL;
+
+                size_t d = metadata.depth;
+                for (size_t level = 0; level < metadata.mipLevels; ++level)
+                {
+                    count += d;
+                    if (count > nimages)
+                        return E_FAIL;
+
+                    if (d > 1)
+                        d >>= 1;
+                }
+            }
+            break;
+
+        default:
+            return E_FAIL;
+        }
+
+        return (count > 0) ? S_OK : E_FAIL;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Emits the DDS header followed by the surfaces as a series of chunks. Rows are passed
+    // through from the source image when the pitch allows, so no staging copy is made.
+    //-------------------------------------------------------------------------------------
+    template<typename TWrite>
+    HRESULT WriteDDSImages(
+        _In_reads_(nimages) const Image* images,
+        size_t nimages,
+        const TexMetadata& metadata,
+        DDS_FLAGS flags,
+        TWrite& write)
+    {
+        size_t count;
+        HRESULT hr = CountDDSImages(metadata, nimages, count);
+        if (FAILED(hr))
+            return hr;
+
+        uint8_t header[MAX_HEADER_SIZE] = {};
+        size_t headerSize;
+        hr = EncodeDDSHeader(metadata, flags, header, MAX_HEADER_SIZE, headerSize);
+        if (FAILED(hr))
+            return hr;
+
+        hr = write(header, headerSize);
+        if (FAILED(hr))
+            return hr;
+
+        std::unique_ptr<uint8_t[]> temp;
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            const Image& img = images[index];
+            if (!img.pixels)
+                return E_POINTER;
+
+            if (img.format != metadata.format)
+                return E_FAIL;
+
+            size_t ddsRowPitch, ddsSlicePitch;
+            hr = ComputePitch(metadata.format, img.width, img.height, ddsRowPitch, ddsSlicePitch, CP_FLAGS_NONE);
+            if (FAILED(hr))
+                return hr;
+
+            if ((img.rowPitch == ddsRowPitch) && (img.slicePitch == ddsSlicePitch))
+            {
+                hr = write(img.pixels, ddsSlicePitch);
+                if (FAILED(hr))
+                    return hr;
+
+                continue;
+            }
+
+            const size_t lines = ComputeScanlines(metadata.format, img.height);
+            const uint8_t* sPtr = img.pixels;
+
+            for (size_t j = 0; j < lines; ++j)
+            {
+                if (img.rowPitch >= ddsRowPitch)
+                {
+                    hr = write(sPtr, ddsRowPitch);
+                }
+                else
+                {
+                    // Short source rows are zero padded out to the DDS pitch
+                    if (!temp)
+                    {
+                        temp.reset(new (std::nothrow) uint8_t[ddsRowPitch]);
+                        if (!temp)
+                            return E_OUTOFMEMORY;
+                    }
+
+                    memcpy(temp.get(), sPtr, img.rowPitch);
+                    memset(temp.get() + img.rowPitch, 0, ddsRowPitch - img.rowPitch);
+                    hr = write(temp.get(), ddsRowPitch);
+                }
+
+                if (FAILED(hr))
+                    return hr;
+
+                sPtr += img.rowPitch;
+            }
+        }
+
+        return S_OK;
+    }
 }
 
 
@@ -1694,6 +2040,8 @@ HRESULT DirectX::LoadFromDDSMemory(
     TexMetadata* metadata,
     ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(image);
+
     if (!pSource || size == 0)
         return E_INVALIDARG;
 
@@ -1766,6 +2114,8 @@ HRESULT DirectX::LoadFromDDSFile(
     TexMetadata* metadata,
     ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -2010,28 +2360,32 @@ HRESULT DirectX::LoadFromDDSFile(
 
 
 //-------------------------------------------------------------------------------------
-// Save a DDS file to memory
+// Determine the size of a DDS file
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::SaveToDDSMemory(
+HRESULT DirectX::GetDDSSaveSize(
     const Image* images,
     size_t nimages,
     const TexMetadata& metadata,
     DDS_FLAGS flags,
-    Blob& blob) noexcept
+    size_t& required) noexcept
 {
+    required = 0;
+
     if (!images || (nimages == 0))
         return E_INVALIDARG;
 
-    // Determine memory required
-    size_t required = 0;
-    HRESULT hr = EncodeDDSHeader(metadata, flags, nullptr, 0, required);
+    size_t count;
+    HRESULT hr = CountDDSImages(metadata, nimages, count);
     if (FAILED(hr))
         return hr;
 
-    bool fastpath = true;
+    size_t total = 0;
+    hr = EncodeDDSHeader(metadata, flags, nullptr, 0, total);
+    if (FAILED(hr))
+        return hr;
 
-    for (size_t i = 0; i < nimages; ++i)
+    for (size_t i = 0; i < count; ++i)
     {
         if (!images[i].pixels)
             return E_POINTER;
@@ -2044,192 +2398,120 @@ HRESULT DirectX::SaveToDDSMemory(
         if (FAILED(hr))
             return hr;
 
-        assert(images[i].rowPitch > 0);
-        assert(images[i].slicePitch > 0);
-
-        if ((images[i].rowPitch != ddsRowPitch) || (images[i].slicePitch != ddsSlicePitch))
-        {
-            fastpath = false;
-        }
+        if (ddsSlicePitch > SIZE_MAX - total)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
 
-        required += ddsSlicePitch;
+        total += ddsSlicePitch;
     }
 
-    assert(required > 0);
+    required = total;
+    return S_OK;
+}
 
-    blob.Release();
 
-    hr = blob.Initialize(required);
-    if (FAILED(hr))
-        return hr;
+//-------------------------------------------------------------------------------------
+// Save a DDS file to memory
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveToDDSMemory(
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DDS_FLAGS flags,
+    void* pDestination,
+    size_t size,
+    size_t* written) noexcept
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, images, nimages, metadata);
+
+    if (written)
+        *written = 0;
 
-    auto pDestination = static_cast<uint8_t*>(blob.GetBufferPointer());
-    assert(pDestination);
+    if (!pDestination)
+        return E_INVALIDARG;
 
-    hr = EncodeDDSHeader(metadata, flags, pDestination, blob.GetBufferSize(), required);
+    size_t required;
+    HRESULT hr = GetDDSSaveSize(images, nimages, metadata, flags, required);
     if (FAILED(hr))
-    {
-        blob.Release();
         return hr;
-    }
 
-    size_t remaining = blob.GetBufferSize() - required;
-    pDestination += required;
-
-    if (!remaining)
-    {
-        blob.Release();
-        return E_FAIL;
-    }
+    if (size < required)
+        return E_NOT_SUFFICIENT_BUFFER;
 
-    switch (static_cast<DDS_RESOURCE_DIMENSION>(metadata.dimension))
-    {
-    case DDS_DIMENSION_TEXTURE1D:
-    case DDS_DIMENSION_TEXTURE2D:
+    auto dPtr = static_cast<uint8_t*>(pDestination);
+    size_t remaining = size;
+    auto write = [&](const void* pData, size_t bytes) noexcept -> HRESULT
         {
-            size_t index = 0;
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                for (size_t level = 0; level < metadata.mipLevels; ++level)
-                {
-                    if (index >= nimages)
-                    {
-                        blob.Release();
-                        return E_FAIL;
-                    }
-
-                    if (fastpath)
-                    {
-                        size_t pixsize = images[index].slicePitch;
-                        memcpy(pDestination, images[index].pixels, pixsize);
-
-                        pDestination += pixsize;
-                        remaining -= pixsize;
-                    }
-                    else
-                    {
-                        size_t ddsRowPitch, ddsSlicePitch;
-                        hr = ComputePitch(metadata.format, images[index].width, images[index].height, ddsRowPitch, ddsSlicePitch, CP_FLAGS_NONE);
-                        if (FAILED(hr))
-                        {
-                            blob.Release();
-                            return hr;
-                        }
-
-                        const size_t rowPitch = images[index].rowPitch;
-
-                        const uint8_t * __restrict sPtr = images[index].pixels;
-                        uint8_t * __restrict dPtr = pDestination;
-
-                        const size_t lines = ComputeScanlines(metadata.format, images[index].height);
-                        const size_t csize = std::min<size_t>(rowPitch, ddsRowPitch);
-                        size_t tremaining = remaining;
-                        for (size_t j = 0; j < lines; ++j)
-                        {
-                            if (tremaining < csize)
-                            {
-                                blob.Release();
-                                return E_FAIL;
-                            }
-
-                            memcpy(dPtr, sPtr, csize);
-
-                            sPtr += rowPitch;
-                            dPtr += ddsRowPitch;
-                            tremaining -= ddsRowPitch;
-                        }
-
-                        pDestination += ddsSlicePitch;
-                        remaining -= ddsSlicePitch;
-                    }
+            if (bytes > remaining)
+                return E_NOT_SUFFICIENT_BUFFER;
 
-                    ++index;
-                }
-            }
-        }
-        break;
+            memcpy(dPtr, pData, bytes);
+            dPtr += bytes;
+            remaining -= bytes;
+            return S_OK;
+        };
 
-    case DDS_DIMENSION_TEXTURE3D:
-        {
-            if (metadata.arraySize != 1)
-            {
-                blob.Release();
-                return E_FAIL;
-            }
+    hr = WriteDDSImages(images, nimages, metadata, flags, write);
+    if (FAILED(hr))
+        return hr;
 
-            size_t d = metadata.depth;
+    if (written)
+        *written = size - remaining;
 
-            size_t index = 0;
-            for (size_t level = 0; level < metadata.mipLevels; ++level)
-            {
-                for (size_t slice = 0; slice < d; ++slice)
-                {
-                    if (index >= nimages)
-                    {
-                        blob.Release();
-                        return E_FAIL;
-                    }
-
-                    if (fastpath)
-                    {
-                        size_t pixsize = images[index].slicePitch;
-                        memcpy(pDestination, images[index].pixels, pixsize);
+    return S_OK;
+}
 
-                        pDestination += pixsize;
-                        remaining -= pixsize;
-                    }
-                    else
-                    {
-                        size_t ddsRowPitch, ddsSlicePitch;
-                        hr = ComputePitch(metadata.format, images[index].width, images[index].height, ddsRowPitch, ddsSlicePitch, CP_FLAGS_NONE);
-                        if (FAILED(hr))
-                        {
-                            blob.Release();
-                            return hr;
-                        }
+_Use_decl_annotations_
+HRESULT DirectX::SaveToDDSMemory(
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DDS_FLAGS flags,
+    Blob& blob) noexcept
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, images, nimages, metadata);
 
-                        const size_t rowPitch = images[index].rowPitch;
+    size_t required;
+    HRESULT hr = GetDDSSaveSize(images, nimages, metadata, flags, required);
+    if (FAILED(hr))
+        return hr;
 
-                        const uint8_t * __restrict sPtr = images[index].pixels;
-                        uint8_t * __restrict dPtr = pDestination;
+    assert(required > 0);
 
-                        const size_t lines = ComputeScanlines(metadata.format, images[index].height);
-                        const size_t csize = std::min<size_t>(rowPitch, ddsRowPitch);
-                        size_t tremaining = remaining;
-                        for (size_t j = 0; j < lines; ++j)
-                        {
-                            if (tremaining < csize)
-                            {
-                                blob.Release();
-                                return E_FAIL;
-                            }
+    blob.Release();
 
-                            memcpy(dPtr, sPtr, csize);
+    hr = blob.Initialize(required);
+    if (FAILED(hr))
+        return hr;
 
-                            sPtr += rowPitch;
-                            dPtr += ddsRowPitch;
-                            tremaining -= ddsRowPitch;
-                        }
+    hr = SaveToDDSMemory(images, nimages, metadata, flags, blob.GetBufferPointer(), blob.GetBufferSize(), nullptr);
+    if (FAILED(hr))
+    {
+        blob.Release();
+        return hr;
+    }
 
-                        pDestination += ddsSlicePitch;
-                        remaining -= ddsSlicePitch;
-                    }
+    return S_OK;
+}
 
-                    ++index;
-                }
 
-                if (d > 1)
-                    d >>= 1;
-            }
-        }
-        break;
+//-------------------------------------------------------------------------------------
+// Save a DDS file through a writer callback
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveToDDSCallback(
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DDS_FLAGS flags,
+    WriteCallback writer)
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, images, nimages, metadata);
 
-    default:
-        blob.Release();
-        return E_FAIL;
-    }
+    if (!images || (nimages == 0) || !writer)
+        return E_INVALIDARG;
 
-    return S_OK;
+    return WriteDDSImages(images, nimages, metadata, flags, writer);
 }
 
 
@@ -2244,6 +2526,8 @@ HRESULT DirectX::SaveToDDSFile(
     DDS_FLAGS flags,
     const wchar_t* szFile) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, images, nimages, metadata);
+
     if (!szFile)
         return E_INVALIDARG;
 
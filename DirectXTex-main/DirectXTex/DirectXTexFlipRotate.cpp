@@ -13,134 +13,511 @@
 
 using namespace DirectX;
 using namespace DirectX::Internal;
-using Microsoft::WRL::ComPtr;
 
 namespace
 {
+    // Destination rows (or block rows) per parallel band
+    constexpr size_t FR_BAND_ROWS = 64;
+
+    // Square tile for rotations, so the source lines being gathered stay in cache
+    constexpr size_t FR_TILE = 32;
+
+    constexpr size_t FR_PARALLEL_MIN_PIXELS = 64 * 1024;
+
+    static_assert((FR_BAND_ROWS % FR_TILE) == 0, "Bands must hold whole tiles");
+
+    struct Pixel96 { uint32_t v[3]; };
+    struct Pixel128 { uint64_t v[2]; };
+
     //-------------------------------------------------------------------------------------
-    // Do flip/rotate operation using WIC
+    // Returns the source element for a destination element. Rotation is clockwise, and
+    // the flips are applied to the rotated result
     //-------------------------------------------------------------------------------------
-    HRESULT PerformFlipRotateUsingWIC(
-        const Image& srcImage,
+    void MapToSource(
+        int rotateMode,
         TEX_FR_FLAGS flags,
-        const WICPixelFormatGUID& pfGUID,
-        const Image& destImage) noexcept
+        ptrdiff_t width,
+        ptrdiff_t height,
+        ptrdiff_t x,
+        ptrdiff_t y,
+        ptrdiff_t& sx,
+        ptrdiff_t& sy) noexcept
     {
-        if (!srcImage.pixels || !destImage.pixels)
-            return E_POINTER;
+        const bool swap = (rotateMode == TEX_FR_ROTATE90) || (rotateMode == TEX_FR_ROTATE270);
+        const ptrdiff_t dwidth = (swap) ? height : width;
+        const ptrdiff_t dheight = (swap) ? width : height;
 
-        assert(srcImage.format == destImage.format);
+        if (flags & TEX_FR_FLIP_HORIZONTAL)
+            x = dwidth - 1 - x;
 
-        bool iswic2 = false;
-        auto pWIC = GetWICFactory(iswic2);
-        if (!pWIC)
-            return E_NOINTERFACE;
+        if (flags & TEX_FR_FLIP_VERTICAL)
+            y = dheight - 1 - y;
 
-        if (srcImage.rowPitch > UINT32_MAX || srcImage.slicePitch > UINT32_MAX
-            || destImage.rowPitch > UINT32_MAX || destImage.slicePitch > UINT32_MAX)
-            return HRESULT_E_ARITHMETIC_OVERFLOW;
+        switch (rotateMode)
+        {
+        case TEX_FR_ROTATE90:
+            sx = y;
+            sy = height - 1 - x;
+            break;
+
+        case TEX_FR_ROTATE180:
+            sx = width - 1 - x;
+            sy = height - 1 - y;
+            break;
+
+        case TEX_FR_ROTATE270:
+            sx = width - 1 - y;
+            sy = x;
+            break;
+
+        default:
+            sx = x;
+            sy = y;
+            break;
+        }
+    }
 
-        ComPtr<IWICBitmap> source;
-        HRESULT hr = pWIC->CreateBitmapFromMemory(static_cast<UINT>(srcImage.width), static_cast<UINT>(srcImage.height), pfGUID,
-            static_cast<UINT>(srcImage.rowPitch), static_cast<UINT>(srcImage.slicePitch),
-            srcImage.pixels, source.GetAddressOf());
-        if (FAILED(hr))
-            return hr;
+    //-------------------------------------------------------------------------------------
+    // The mapping is affine, so a destination element (x,y) is read from the source at
+    // origin + x * strideX + y * strideY bytes
+    //-------------------------------------------------------------------------------------
+    struct FRMapping
+    {
+        ptrdiff_t   origin;
+        ptrdiff_t   strideX;
+        ptrdiff_t   strideY;
+    };
 
-        ComPtr<IWICBitmapFlipRotator> FR;
-        hr = pWIC->CreateBitmapFlipRotator(FR.GetAddressOf());
-        if (FAILED(hr))
-            return hr;
+    FRMapping ComputeMapping(
+        int rotateMode,
+        TEX_FR_FLAGS flags,
+        size_t width,
+        size_t height,
+        size_t elementSize,
+        size_t rowPitch) noexcept
+    {
+        auto offset = [&](ptrdiff_t x, ptrdiff_t y) -> ptrdiff_t
+        {
+            ptrdiff_t sx, sy;
+            MapToSource(rotateMode, flags, ptrdiff_t(width), ptrdiff_t(height), x, y, sx, sy);
+            return sy * ptrdiff_t(rowPitch) + sx * ptrdiff_t(elementSize);
+        };
+
+        FRMapping m;
+        m.origin = offset(0, 0);
+        m.strideX = offset(1, 0) - m.origin;
+        m.strideY = offset(0, 1) - m.origin;
+        return m;
+    }
 
-        hr = FR->Initialize(source.Get(), static_cast<WICBitmapTransformOptions>(flags));
-        if (FAILED(hr))
-            return hr;
+    template<typename T>
+    inline void CopyElement(uint8_t* pDest, const uint8_t* pSrc) noexcept
+    {
+        memcpy(pDest, pSrc, sizeof(T));
+    }
 
-        WICPixelFormatGUID pfFR;
-        hr = FR->GetPixelFormat(&pfFR);
-        if (FAILED(hr))
-            return hr;
+    //-------------------------------------------------------------------------------------
+    // Reverses a row of elements (horizontal flip)
+    //-------------------------------------------------------------------------------------
+    template<typename T>
+    void ReverseRow(uint8_t* pDest, const uint8_t* pSrcLast, size_t width) noexcept
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            CopyElement<T>(pDest + x * sizeof(T), pSrcLast - ptrdiff_t(x * sizeof(T)));
+        }
+    }
 
-        if (memcmp(&pfFR, &pfGUID, sizeof(GUID)) != 0)
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    template<>
+    void ReverseRow<uint32_t>(uint8_t* pDest, const uint8_t* pSrcLast, size_t width) noexcept
+    {
+        size_t x = 0;
+        for (; x + 4 <= width; x += 4)
         {
-            // Flip/rotate should return the same format as the source...
-            return HRESULT_E_NOT_SUPPORTED;
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcLast - ptrdiff_t((x + 3) * sizeof(uint32_t))));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * sizeof(uint32_t)), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
         }
 
-        UINT nwidth, nheight;
-        hr = FR->GetSize(&nwidth, &nheight);
-        if (FAILED(hr))
-            return hr;
+        for (; x < width; ++x)
+        {
+            CopyElement<uint32_t>(pDest + x * sizeof(uint32_t), pSrcLast - ptrdiff_t(x * sizeof(uint32_t)));
+        }
+    }
 
-        if (destImage.width != nwidth || destImage.height != nheight)
-            return E_FAIL;
+    template<>
+    void ReverseRow<uint16_t>(uint8_t* pDest, const uint8_t* pSrcLast, size_t width) noexcept
+    {
+        size_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcLast - ptrdiff_t((x + 7) * sizeof(uint16_t))));
+            v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * sizeof(uint16_t)), v);
+        }
 
-        hr = FR->CopyPixels(nullptr, static_cast<UINT>(destImage.rowPitch), static_cast<UINT>(destImage.slicePitch), destImage.pixels);
-        if (FAILED(hr))
-            return hr;
+        for (; x < width; ++x)
+        {
+            CopyElement<uint16_t>(pDest + x * sizeof(uint16_t), pSrcLast - ptrdiff_t(x * sizeof(uint16_t)));
+        }
+    }
+#endif
 
-        return S_OK;
+    //-------------------------------------------------------------------------------------
+    // Gathers a tile for a rotation, one element at a time
+    //-------------------------------------------------------------------------------------
+    template<typename T>
+    void GatherTile(
+        uint8_t* pDest, size_t destPitch,
+        const uint8_t* pSrc, const FRMapping& m,
+        size_t x0, size_t x1, size_t y0, size_t y1) noexcept
+    {
+        for (size_t y = y0; y < y1; ++y)
+        {
+            uint8_t* dptr = pDest + y * destPitch;
+            const uint8_t* sptr = pSrc + m.origin + ptrdiff_t(y) * m.strideY;
+            for (size_t x = x0; x < x1; ++x)
+            {
+                CopyElement<T>(dptr + x * sizeof(T), sptr + ptrdiff_t(x) * m.strideX);
+            }
+        }
     }
 
+    template<typename T>
+    void RotateTile(
+        uint8_t* pDest, size_t destPitch,
+        const uint8_t* pSrc, const FRMapping& m,
+        size_t x0, size_t x1, size_t y0, size_t y1) noexcept
+    {
+        GatherTile<T>(pDest, destPitch, pSrc, m, x0, x1, y0, y1);
+    }
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    // 32-bit elements are transposed 4x4 at a time; each source row supplies one destination column
+    template<>
+    void RotateTile<uint32_t>(
+        uint8_t* pDest, size_t destPitch,
+        const uint8_t* pSrc, const FRMapping& m,
+        size_t x0, size_t x1, size_t y0, size_t y1) noexcept
+    {
+        const bool forward = (m.strideY == ptrdiff_t(sizeof(uint32_t)));
+        if (!forward && m.strideY != -ptrdiff_t(sizeof(uint32_t)))
+        {
+            GatherTile<uint32_t>(pDest, destPitch, pSrc, m, x0, x1, y0, y1);
+            return;
+        }
+
+        const size_t x4 = x0 + ((x1 - x0) & ~size_t(3));
+        const size_t y4 = y0 + ((y1 - y0) & ~size_t(3));
+
+        for (size_t y = y0; y < y4; y += 4)
+        {
+            // Lowest address of the four consecutive source elements for destination rows y..y+3
+            const ptrdiff_t rowOffset = m.origin + ptrdiff_t((forward) ? y : y + 3) * m.strideY;
+
+            for (size_t x = x0; x < x4; x += 4)
+            {
+                const uint8_t* sptr = pSrc + rowOffset + ptrdiff_t(x) * m.strideX;
+
+                __m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(sptr));
+                __m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(sptr + m.strideX));
+                __m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(sptr + 2 * m.strideX));
+                __m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(sptr + 3 * m.strideX));
+
+                if (!forward)
+                {
+                    r0 = XM_PERMUTE_PS(r0, _MM_SHUFFLE(0, 1, 2, 3));
+                    r1 = XM_PERMUTE_PS(r1, _MM_SHUFFLE(0, 1, 2, 3));
+                    r2 = XM_PERMUTE_PS(r2, _MM_SHUFFLE(0, 1, 2, 3));
+                    r3 = XM_PERMUTE_PS(r3, _MM_SHUFFLE(0, 1, 2, 3));
+                }
+
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                uint8_t* dptr = pDest + y * destPitch + x * sizeof(uint32_t);
+                _mm_storeu_ps(reinterpret_cast<float*>(dptr), r0);
+                _mm_storeu_ps(reinterpret_cast<float*>(dptr + destPitch), r1);
+                _mm_storeu_ps(reinterpret_cast<float*>(dptr + 2 * destPitch), r2);
+                _mm_storeu_ps(reinterpret_cast<float*>(dptr + 3 * destPitch), r3);
+            }
+        }
+
+        if (x4 < x1)
+        {
+            GatherTile<uint32_t>(pDest, destPitch, pSrc, m, x4, x1, y0, y4);
+        }
+
+        if (y4 < y1)
+        {
+            GatherTile<uint32_t>(pDest, destPitch, pSrc, m, x0, x1, y4, y1);
+        }
+    }
+#endif
 
     //-------------------------------------------------------------------------------------
-    // Do conversion, flip/rotate using WIC, conversion cycle
-    //
-    // For large images we have to use F16 instead of F32 to avoid exceeding the 32-bit
-    // memory limitations of WIC.
+    // Flip/rotate of an uncompressed image with T-sized pixels
     //-------------------------------------------------------------------------------------
-    HRESULT PerformFlipRotateViaF16(
+    template<typename T>
+    HRESULT FlipRotatePixels(
         const Image& srcImage,
+        int rotateMode,
         TEX_FR_FLAGS flags,
         const Image& destImage) noexcept
     {
-        if (!srcImage.pixels || !destImage.pixels)
-            return E_POINTER;
+        const FRMapping m = ComputeMapping(rotateMode, flags, srcImage.width, srcImage.height, sizeof(T), srcImage.rowPitch);
 
-        assert(srcImage.format != DXGI_FORMAT_R16G16B16A16_FLOAT);
-        assert(srcImage.format == destImage.format);
+        const size_t width = destImage.width;
+        const size_t height = destImage.height;
 
-        ScratchImage temp;
-        HRESULT hr = ConvertToR16G16B16A16(srcImage, temp);
-        if (FAILED(hr))
-            return hr;
+        const size_t nbands = (height + FR_BAND_ROWS - 1) / FR_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
 
-        const Image *tsrc = temp.GetImage(0, 0, 0);
-        if (!tsrc)
-            return E_POINTER;
+        const uint8_t* pSrc = srcImage.pixels;
+        uint8_t* pDest = destImage.pixels;
+        const size_t destPitch = destImage.rowPitch;
 
-        ScratchImage rtemp;
-        hr = rtemp.Initialize2D(DXGI_FORMAT_R16G16B16A16_FLOAT, destImage.width, destImage.height, 1, 1);
-        if (FAILED(hr))
-            return hr;
+    #ifdef _OPENMP
+        const WorkerThreads workers;
 
-        const Image *tdest = rtemp.GetImage(0, 0, 0);
-        if (!tdest)
-            return E_POINTER;
+        #pragma omp parallel if (nbands > 1 && width * height >= FR_PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
 
-        hr = PerformFlipRotateUsingWIC(*tsrc, flags, GUID_WICPixelFormat64bppRGBAHalf, *tdest);
-        if (FAILED(hr))
-            return hr;
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                const size_t y0 = size_t(band) * FR_BAND_ROWS;
+                const size_t y1 = std::min(y0 + FR_BAND_ROWS, height);
+
+                if (m.strideX == ptrdiff_t(sizeof(T)))
+                {
+                    // No horizontal change, so each row is a straight copy
+                    for (size_t y = y0; y < y1; ++y)
+                    {
+                        memcpy(pDest + y * destPitch, pSrc + m.origin + ptrdiff_t(y) * m.strideY, width * sizeof(T));
+                    }
+                }
+                else if (m.strideX == -ptrdiff_t(sizeof(T)))
+                {
+                    for (size_t y = y0; y < y1; ++y)
+                    {
+                        ReverseRow<T>(pDest + y * destPitch, pSrc + m.origin + ptrdiff_t(y) * m.strideY, width);
+                    }
+                }
+                else
+                {
+                    for (size_t ty = y0; ty < y1; ty += FR_TILE)
+                    {
+                        const size_t ty1 = std::min(ty + FR_TILE, y1);
+                        for (size_t tx = 0; tx < width; tx += FR_TILE)
+                        {
+                            RotateTile<T>(pDest, destPitch, pSrc, m, tx, std::min(tx + FR_TILE, width), ty, ty1);
+                        }
+                    }
+                }
+            }
+        }
 
-        temp.Release();
+        return S_OK;
+    }
 
-        hr = ConvertFromR16G16B16A16(*tdest, destImage);
-        if (FAILED(hr))
-            return hr;
+    //-------------------------------------------------------------------------------------
+    // BC blocks are moved whole and their 4x4 texel indices permuted, which is lossless.
+    // perm[i] is the source texel for destination texel i
+    //-------------------------------------------------------------------------------------
 
-        return S_OK;
+    // BC1 color block (also used by BC2 and BC3): 2-bit indices after the two endpoints
+    void RemapColorBlock(uint8_t* pDest, const uint8_t* pSrc, const uint8_t* perm) noexcept
+    {
+        uint32_t bits;
+        memcpy(&bits, pSrc + 4, sizeof(bits));
+
+        uint32_t result = 0;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            result |= ((bits >> (2 * perm[i])) & 0x3) << (2 * i);
+        }
+
+        memcpy(pDest, pSrc, 4);
+        memcpy(pDest + 4, &result, sizeof(result));
     }
 
-    HRESULT PerformFlipRotateViaF32(
+    // BC2 explicit alpha: 4 bits per texel
+    void RemapExplicitAlphaBlock(uint8_t* pDest, const uint8_t* pSrc, const uint8_t* perm) noexcept
+    {
+        uint64_t bits;
+        memcpy(&bits, pSrc, sizeof(bits));
+
+        uint64_t result = 0;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            result |= ((bits >> (4 * perm[i])) & 0xF) << (4 * i);
+        }
+
+        memcpy(pDest, &result, sizeof(result));
+    }
+
+    // BC3 alpha, BC4, and each half of BC5: 3-bit indices after the two endpoints
+    void RemapInterpolatedBlock(uint8_t* pDest, const uint8_t* pSrc, const uint8_t* perm) noexcept
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, pSrc + 2, 6);
+
+        uint64_t result = 0;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            result |= ((bits >> (3 * perm[i])) & 0x7) << (3 * i);
+        }
+
+        pDest[0] = pSrc[0];
+        pDest[1] = pSrc[1];
+        memcpy(pDest + 2, &result, 6);
+    }
+
+    HRESULT FlipRotateBC(
         const Image& srcImage,
+        int rotateMode,
         TEX_FR_FLAGS flags,
         const Image& destImage) noexcept
     {
-        if (!srcImage.pixels || !destImage.pixels)
-            return E_POINTER;
+        switch (srcImage.format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+            break;
+
+        default:
+            // BC6H and BC7 partition shapes are not closed under flips and rotations
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        // Texels only stay within their block if every edge block is complete, or there is just the one
+        if (((srcImage.width % 4) != 0 && srcImage.width > 4)
+            || ((srcImage.height % 4) != 0 && srcImage.height > 4))
+            return HRESULT_E_NOT_SUPPORTED;
+
+        // All blocks share one texel permutation, taken from the first destination block
+        uint8_t perm[16] = {};
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const ptrdiff_t x = ptrdiff_t(std::min(i & 3, destImage.width - 1));
+            const ptrdiff_t y = ptrdiff_t(std::min(i >> 2, destImage.height - 1));
+
+            ptrdiff_t sx, sy;
+            MapToSource(rotateMode, flags, ptrdiff_t(srcImage.width), ptrdiff_t(srcImage.height), x, y, sx, sy);
+            perm[i] = static_cast<uint8_t>((sy & 3) * 4 + (sx & 3));
+        }
 
+        const size_t blockSize = BitsPerPixel(srcImage.format) * 2;
+        const size_t srcBlocksX = std::max<size_t>(1, (srcImage.width + 3) / 4);
+        const size_t srcBlocksY = std::max<size_t>(1, (srcImage.height + 3) / 4);
+        const size_t destBlocksX = std::max<size_t>(1, (destImage.width + 3) / 4);
+        const size_t destBlocksY = std::max<size_t>(1, (destImage.height + 3) / 4);
+
+        const FRMapping m = ComputeMapping(rotateMode, flags, srcBlocksX, srcBlocksY, blockSize, srcImage.rowPitch);
+
+        const size_t nbands = (destBlocksY + FR_BAND_ROWS - 1) / FR_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        const uint8_t* pSrc = srcImage.pixels;
+        uint8_t* pDest = destImage.pixels;
+        const size_t destPitch = destImage.rowPitch;
+        const DXGI_FORMAT format = srcImage.format;
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (nbands > 1 && destImage.width * destImage.height >= FR_PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                const size_t by0 = size_t(band) * FR_BAND_ROWS;
+                const size_t by1 = std::min(by0 + FR_BAND_ROWS, destBlocksY);
+                for (size_t by = by0; by < by1; ++by)
+                {
+                    const ptrdiff_t rowOffset = m.origin + ptrdiff_t(by) * m.strideY;
+                    for (size_t bx = 0; bx < destBlocksX; ++bx)
+                    {
+                        uint8_t* dptr = pDest + by * destPitch + bx * blockSize;
+                        const uint8_t* sptr = pSrc + rowOffset + ptrdiff_t(bx) * m.strideX;
+
+                        switch (format)
+                        {
+                        case DXGI_FORMAT_BC1_TYPELESS:
+                        case DXGI_FORMAT_BC1_UNORM:
+                        case DXGI_FORMAT_BC1_UNORM_SRGB:
+                            RemapColorBlock(dptr, sptr, perm);
+                            break;
+
+                        case DXGI_FORMAT_BC2_TYPELESS:
+                        case DXGI_FORMAT_BC2_UNORM:
+                        case DXGI_FORMAT_BC2_UNORM_SRGB:
+                            RemapExplicitAlphaBlock(dptr, sptr, perm);
+                            RemapColorBlock(dptr + 8, sptr + 8, perm);
+                            break;
+
+                        case DXGI_FORMAT_BC3_TYPELESS:
+                        case DXGI_FORMAT_BC3_UNORM:
+                        case DXGI_FORMAT_BC3_UNORM_SRGB:
+                            RemapInterpolatedBlock(dptr, sptr, perm);
+                            RemapColorBlock(dptr + 8, sptr + 8, perm);
+                            break;
+
+                        case DXGI_FORMAT_BC5_TYPELESS:
+                        case DXGI_FORMAT_BC5_UNORM:
+                        case DXGI_FORMAT_BC5_SNORM:
+                            RemapInterpolatedBlock(dptr + 8, sptr + 8, perm);
+                            RemapInterpolatedBlock(dptr, sptr, perm);
+                            break;
+
+                        default:
+                            RemapInterpolatedBlock(dptr, sptr, perm);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Formats whose pixels share bits or bytes (e.g. YUY2, R1_UNORM) are expanded to float
+    //-------------------------------------------------------------------------------------
+    HRESULT FlipRotateViaF32(
+        const Image& srcImage,
+        int rotateMode,
+        TEX_FR_FLAGS flags,
+        const Image& destImage) noexcept
+    {
         assert(srcImage.format != DXGI_FORMAT_R32G32B32A32_FLOAT);
-        assert(srcImage.format == destImage.format);
 
         ScratchImage temp;
         HRESULT hr = ConvertToR32G32B32A32(srcImage, temp);
@@ -160,17 +537,44 @@ namespace
         if (!tdest)
             return E_POINTER;
 
-        hr = PerformFlipRotateUsingWIC(*tsrc, flags, GUID_WICPixelFormat128bppRGBAFloat, *tdest);
+        hr = FlipRotatePixels<Pixel128>(*tsrc, rotateMode, flags, *tdest);
         if (FAILED(hr))
             return hr;
 
         temp.Release();
 
-        hr = ConvertFromR32G32B32A32(*tdest, destImage);
-        if (FAILED(hr))
-            return hr;
+        return ConvertFromR32G32B32A32(*tdest, destImage);
+    }
 
-        return S_OK;
+    //-------------------------------------------------------------------------------------
+    HRESULT PerformFlipRotate(
+        const Image& srcImage,
+        int rotateMode,
+        TEX_FR_FLAGS flags,
+        const Image& destImage) noexcept
+    {
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        assert(srcImage.format == destImage.format);
+
+        if (IsCompressed(srcImage.format))
+            return FlipRotateBC(srcImage, rotateMode, flags, destImage);
+
+        const size_t bpp = BitsPerPixel(srcImage.format);
+        if (IsPacked(srcImage.format) || (bpp % 8) != 0)
+            return FlipRotateViaF32(srcImage, rotateMode, flags, destImage);
+
+        switch (bpp)
+        {
+        case 8:     return FlipRotatePixels<uint8_t>(srcImage, rotateMode, flags, destImage);
+        case 16:    return FlipRotatePixels<uint16_t>(srcImage, rotateMode, flags, destImage);
+        case 32:    return FlipRotatePixels<uint32_t>(srcImage, rotateMode, flags, destImage);
+        case 64:    return FlipRotatePixels<uint64_t>(srcImage, rotateMode, flags, destImage);
+        case 96:    return FlipRotatePixels<Pixel96>(srcImage, rotateMode, flags, destImage);
+        case 128:   return FlipRotatePixels<Pixel128>(srcImage, rotateMode, flags, destImage);
+        default:    return HRESULT_E_NOT_SUPPORTED;
+        }
     }
 }
 
@@ -197,18 +601,8 @@ HRESULT DirectX::FlipRotate(
     if ((srcImage.width > UINT32_MAX) || (srcImage.height > UINT32_MAX))
         return E_INVALIDARG;
 
-    if (IsCompressed(srcImage.format))
-    {
-        // We don't support flip/rotate operations on compressed images
+    if (IsPlanar(srcImage.format))
         return HRESULT_E_NOT_SUPPORTED;
-    }
-
-    static_assert(static_cast<int>(TEX_FR_ROTATE0) == static_cast<int>(WICBitmapTransformRotate0), "TEX_FR_ROTATE0 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_ROTATE90) == static_cast<int>(WICBitmapTransformRotate90), "TEX_FR_ROTATE90 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_ROTATE180) == static_cast<int>(WICBitmapTransformRotate180), "TEX_FR_ROTATE180 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_ROTATE270) == static_cast<int>(WICBitmapTransformRotate270), "TEX_FR_ROTATE270 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_FLIP_HORIZONTAL) == static_cast<int>(WICBitmapTransformFlipHorizontal), "TEX_FR_FLIP_HORIZONTAL no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_FLIP_VERTICAL) == static_cast<int>(WICBitmapTransformFlipVertical), "TEX_FR_FLIP_VERTICAL no longer matches WIC");
 
     // Only supports 90, 180, 270, or no rotation flags... not a combination of rotation flags
     const int rotateMode = static_cast<int>(flags & (TEX_FR_ROTATE0 | TEX_FR_ROTATE90 | TEX_FR_ROTATE180 | TEX_FR_ROTATE270));
@@ -245,27 +639,7 @@ HRESULT DirectX::FlipRotate(
         return E_POINTER;
     }
 
-    WICPixelFormatGUID pfGUID;
-    if (DXGIToWIC(srcImage.format, pfGUID))
-    {
-        // Case 1: Source format is supported by Windows Imaging Component
-        hr = PerformFlipRotateUsingWIC(srcImage, flags, pfGUID, *rimage);
-    }
-    else
-    {
-        // Case 2: Source format is not supported by WIC, so we have to convert, flip/rotate, and convert back
-        const uint64_t expandedSize = uint64_t(srcImage.width) * uint64_t(srcImage.height) * sizeof(float) * 4;
-        if (expandedSize > UINT32_MAX)
-        {
-            // Image is too large for float32, so have to use float16 instead
-            hr = PerformFlipRotateViaF16(srcImage, flags, *rimage);
-        }
-        else
-        {
-            hr = PerformFlipRotateViaF32(srcImage, flags, *rimage);
-        }
-    }
-
+    hr = PerformFlipRotate(srcImage, rotateMode, flags, *rimage);
     if (FAILED(hr))
     {
         image.Release();
@@ -290,18 +664,11 @@ HRESULT DirectX::FlipRotate(
     if (!srcImages || !nimages)
         return E_INVALIDARG;
 
-    if (IsCompressed(metadata.format))
-    {
-        // We don't support flip/rotate operations on compressed images
-        return HRESULT_E_NOT_SUPPORTED;
-    }
+    if (!flags)
+        return E_INVALIDARG;
 
-    static_assert(static_cast<int>(TEX_FR_ROTATE0) == static_cast<int>(WICBitmapTransformRotate0), "TEX_FR_ROTATE0 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_ROTATE90) == static_cast<int>(WICBitmapTransformRotate90), "TEX_FR_ROTATE90 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_ROTATE180) == static_cast<int>(WICBitmapTransformRotate180), "TEX_FR_ROTATE180 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_ROTATE270) == static_cast<int>(WICBitmapTransformRotate270), "TEX_FR_ROTATE270 no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_FLIP_HORIZONTAL) == static_cast<int>(WICBitmapTransformFlipHorizontal), "TEX_FR_FLIP_HORIZONTAL no longer matches WIC");
-    static_assert(static_cast<int>(TEX_FR_FLIP_VERTICAL) == static_cast<int>(WICBitmapTransformFlipVertical), "TEX_FR_FLIP_VERTICAL no longer matches WIC");
+    if (IsPlanar(metadata.format))
+        return HRESULT_E_NOT_SUPPORTED;
 
     // Only supports 90, 180, 270, or no rotation flags... not a combination of rotation flags
     const int rotateMode = static_cast<int>(flags & (TEX_FR_ROTATE0 | TEX_FR_ROTATE90 | TEX_FR_ROTATE180 | TEX_FR_ROTATE270));
@@ -345,9 +712,6 @@ HRESULT DirectX::FlipRotate(
         return E_POINTER;
     }
 
-    WICPixelFormatGUID pfGUID;
-    const bool wicpf = DXGIToWIC(metadata.format, pfGUID);
-
     for (size_t index = 0; index < nimages; ++index)
     {
         const Image& src = srcImages[index];
@@ -358,7 +722,10 @@ HRESULT DirectX::FlipRotate(
         }
 
         if ((src.width > UINT32_MAX) || (src.height > UINT32_MAX))
+        {
+            result.Release();
             return E_FAIL;
+        }
 
         const Image& dst = dest[index];
         assert(dst.format == metadata.format);
@@ -380,26 +747,7 @@ HRESULT DirectX::FlipRotate(
             }
         }
 
-        if (wicpf)
-        {
-            // Case 1: Source format is supported by Windows Imaging Component
-            hr = PerformFlipRotateUsingWIC(src, flags, pfGUID, dst);
-        }
-        else
-        {
-            // Case 2: Source format is not supported by WIC, so we have to convert, flip/rotate, and convert back
-            const uint64_t expandedSize = uint64_t(src.width) * uint64_t(src.height) * sizeof(float) * 4;
-            if (expandedSize > UINT32_MAX)
-            {
-                // Image is too large for float32, so have to use float16 instead
-                hr = PerformFlipRotateViaF16(src, flags, dst);
-            }
-            else
-            {
-                hr = PerformFlipRotateViaF32(src, flags, dst);
-            }
-        }
-
+        hr = PerformFlipRotate(src, rotateMode, flags, dst);
         if (FAILED(hr))
         {
             result.Release();
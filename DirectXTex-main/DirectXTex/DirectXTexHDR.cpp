@@ -10,6 +10,12 @@
 //-------------------------------------------------------------------------------------
 
 #include "DirectXTexP.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#pragma warning(disable : 4616 6993)
+#endif
+
 //
 // In theory HDR (RGBE) Radiance files can have any of the following data orientations
 //
@@ -33,6 +39,7 @@
 //#define WRITE_OLD_COLORS
 
 using namespace DirectX;
+using namespace DirectX::PackedVector;
 
 #ifndef _WIN32
 #include <cstdarg>
@@ -61,6 +68,11 @@ namespace
         "\n"\
         "-Y %u +X %u\n";
 
+    constexpr size_t HDR_PARALLEL_MIN_ROWS = 64;
+
+    // Scanlines encoded per batch when streaming to a callback or file
+    constexpr size_t HDR_WRITE_BATCH_ROWS = 256;
+
     inline size_t FindEOL(const char* str, size_t maxlen) noexcept
     {
         size_t pos = 0;
@@ -309,11 +321,62 @@ namespace
     //-------------------------------------------------------------------------------------
     inline void FloatToRGBE(_Out_writes_(width*4) uint8_t* pDestination, _In_reads_(width*fpp) const float* pSource, size_t width, _In_range_(3, 4) int fpp) noexcept
     {
-        auto ePtr = pSource + width * size_t(fpp);
+        size_t j = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // Four pixels at a time: frexpf(max) is taken directly from the float exponent bits, which
+        // makes the mantissa scale the exact power-of-two 2^(8-e) the scalar path computes.
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 minValue = _mm_set1_ps(1e-32f);
+        const __m128i scaleBias = _mm_set1_epi32(261);
+        const __m128i expBias = _mm_set1_epi32(2);
+        const __m128i byteMask = _mm_set1_epi32(0xFF);
+        const __m128i zeroi = _mm_setzero_si128();
+
+        // 3-component loads read one float past each group, so leave the last pixel to the scalar loop
+        const size_t vwidth = (fpp == 4 || !width) ? width : (width - 1);
+        for (; j + 4 <= vwidth; j += 4)
+        {
+            const float* sPtr = pSource + j * size_t(fpp);
+            __m128 r = _mm_loadu_ps(sPtr);
+            __m128 g = _mm_loadu_ps(sPtr + fpp);
+            __m128 b = _mm_loadu_ps(sPtr + 2 * fpp);
+            __m128 a = _mm_loadu_ps(sPtr + 3 * fpp);
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+
+            // Clamps negative (and NaN) values to zero
+            r = _mm_max_ps(r, zero);
+            g = _mm_max_ps(g, zero);
+            b = _mm_max_ps(b, zero);
+
+            const __m128 maxColor = _mm_max_ps(_mm_max_ps(r, g), b);
+            const __m128i valid = _mm_castps_si128(_mm_cmpgt_ps(maxColor, minValue));
+
+            const __m128i biased = _mm_srli_epi32(_mm_castps_si128(maxColor), 23);
+            const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(scaleBias, biased), 23));
+
+            const __m128i red = _mm_cvttps_epi32(_mm_mul_ps(r, scale));
+            const __m128i green = _mm_cvttps_epi32(_mm_mul_ps(g, scale));
+            const __m128i blue = _mm_cvttps_epi32(_mm_mul_ps(b, scale));
+
+            // Exponent is zero if all the mantissas truncated to zero
+            const __m128i black = _mm_cmpeq_epi32(_mm_or_si128(red, _mm_or_si128(green, blue)), zeroi);
+            const __m128i e = _mm_andnot_si128(black, _mm_and_si128(_mm_add_epi32(biased, expBias), byteMask));
+
+            __m128i rgbe = _mm_or_si128(red, _mm_slli_epi32(green, 8));
+            rgbe = _mm_or_si128(rgbe, _mm_slli_epi32(blue, 16));
+            rgbe = _mm_or_si128(rgbe, _mm_slli_epi32(e, 24));
+            rgbe = _mm_and_si128(rgbe, valid);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + j * 4), rgbe);
+        }
+    #endif
 
-        for (size_t j = 0; j < width; ++j)
+        pSource += j * size_t(fpp);
+        pDestination += j * 4;
+
+        for (; j < width; ++j)
         {
-            if (pSource + 2 >= ePtr) break;
             const float r = pSource[0] >= 0.f ? pSource[0] : 0.f;
             const float g = pSource[1] >= 0.f ? pSource[1] : 0.f;
             const float b = pSource[2] >= 0.f ? pSource[2] : 0.f;
@@ -351,41 +414,212 @@ namespace
     //-------------------------------------------------------------------------------------
     inline void HalfToRGBE(_Out_writes_(width * 4) uint8_t* pDestination, _In_reads_(width* fpp) const uint16_t* pSource, size_t width, _In_range_(3, 4) int fpp) noexcept
     {
-        auto ePtr = pSource + width * size_t(fpp);
+        // Expands to float in small batches (XMConvertHalfToFloatStream uses F16C when available)
+        constexpr size_t c_batch = 64;
+        XM_ALIGNED_DATA(16) float temp[c_batch * 4];
 
-        for (size_t j = 0; j < width; ++j)
+        for (size_t j = 0; j < width; j += c_batch)
         {
-            if (pSource + 2 >= ePtr) break;
-            float r = PackedVector::XMConvertHalfToFloat(pSource[0]); r = (r >= 0.f) ? r : 0.f;
-            float g = PackedVector::XMConvertHalfToFloat(pSource[1]); g = (g >= 0.f) ? g : 0.f;
-            float b = PackedVector::XMConvertHalfToFloat(pSource[2]); b = (b >= 0.f) ? b : 0.f;
-            pSource += fpp;
+            const size_t count = std::min<size_t>(c_batch, width - j);
+            XMConvertHalfToFloatStream(temp, sizeof(float), pSource + j * size_t(fpp), sizeof(HALF), count * size_t(fpp));
+            FloatToRGBE(pDestination + j * 4, temp, count, fpp);
+        }
+    }
 
-            const float max_xy = (r > g) ? r : g;
-            float max_xyz = (max_xy > b) ? max_xy : b;
+    //-------------------------------------------------------------------------------------
+    // RGBEToFloat
+    //-------------------------------------------------------------------------------------
+    void RGBEToFloat(_Out_writes_(width * 4) float* pDestination, _In_reads_(width * 4) const uint8_t* pSource, size_t width, float invExposure) noexcept
+    {
+        size_t j = 0;
 
-            if (max_xyz > 1e-32f)
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // 2^(e - 136) is applied as two normalized power-of-two factors so that results
+        // which end up denormalized round the same as ldexpf
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bias = _mm_set1_epi32(127 - 68);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 scale = _mm_set1_ps(invExposure);
+
+        for (; j + 4 <= width; j += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + j * 4));
+            const __m128i lo = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+            const __m128i pixels[4] =
             {
-                int e;
-                max_xyz = frexpf(max_xyz, &e) * 256.f / max_xyz;
-                e += 128;
+                _mm_unpacklo_epi16(lo, zero),
+                _mm_unpackhi_epi16(lo, zero),
+                _mm_unpacklo_epi16(hi, zero),
+                _mm_unpackhi_epi16(hi, zero)
+            };
 
-                const uint8_t red = uint8_t(r * max_xyz);
-                const uint8_t green = uint8_t(g * max_xyz);
-                const uint8_t blue = uint8_t(b * max_xyz);
+            for (size_t k = 0; k < 4; ++k)
+            {
+                const __m128i e = _mm_shuffle_epi32(pixels[k], _MM_SHUFFLE(3, 3, 3, 3));
+                const __m128i ea = _mm_srli_epi32(e, 1);
+                const __m128i eb = _mm_sub_epi32(e, ea);
+                const __m128 fa = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(ea, bias), 23));
+                const __m128 fb = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(eb, bias), 23));
 
-                pDestination[0] = red;
-                pDestination[1] = green;
-                pDestination[2] = blue;
-                pDestination[3] = (red || green || blue) ? uint8_t(e & 0xff) : 0u;
+                __m128 c = _mm_add_ps(_mm_cvtepi32_ps(pixels[k]), half);
+                c = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(c, fa), fb), scale);
+
+                _mm_storeu_ps(pDestination + (j + k) * 4, XMVectorSelect(g_XMIdentityR3, c, g_XMSelect1110));
             }
-            else
+        }
+    #endif
+
+        pSource += j * 4;
+        pDestination += j * 4;
+
+        for (; j < width; ++j)
+        {
+            auto const exponent = static_cast<int>(pSource[3]);
+            pDestination[0] = invExposure * ldexpf((float(pSource[0]) + 0.5f), exponent - (128 + 8));
+            pDestination[1] = invExposure * ldexpf((float(pSource[1]) + 0.5f), exponent - (128 + 8));
+            pDestination[2] = invExposure * ldexpf((float(pSource[2]) + 0.5f), exponent - (128 + 8));
+            pDestination[3] = 1.f;
+
+            pSource += 4;
+            pDestination += 4;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Decodes a scanline to RGBE, or when decode is false only validates it to find its size
+    //-------------------------------------------------------------------------------------
+    template<bool decode>
+    HRESULT DecodeScanline(
+        _Out_writes_opt_(width * 4) uint8_t* pDestination,
+        _In_reads_bytes_(size) const uint8_t* pSource, size_t size,
+        size_t width,
+        _Out_ size_t& bytesRead) noexcept
+    {
+        bytesRead = 0;
+
+        if (size < 4)
+            return E_FAIL;
+
+        const uint8_t* sPtr = pSource;
+        const uint8_t* ePtr = pSource + size;
+
+        uint8_t inColor[4];
+        memcpy(inColor, sPtr, 4);
+        sPtr += 4;
+
+        if (inColor[0] == 2 && inColor[1] == 2 && inColor[2] < 128)
+        {
+            // Adaptive Run Length Encoding (RLE)
+            if (size_t((size_t(inColor[2]) << 8) + inColor[3]) != width)
+                return E_FAIL;
+
+            for (size_t channel = 0; channel < 4; ++channel)
             {
-                pDestination[0] = pDestination[1] = pDestination[2] = pDestination[3] = 0;
+                uint8_t* dPtr = (decode) ? pDestination + channel : nullptr;
+                for (size_t pixelCount = 0; pixelCount < width;)
+                {
+                    if (ePtr - sPtr < 2)
+                        return E_FAIL;
+
+                    uint8_t runLen = *sPtr;
+                    if (runLen > 128)
+                    {
+                        runLen &= 127;
+                        if (pixelCount + runLen > width)
+                            return E_FAIL;
+
+                        if (decode)
+                        {
+                            const uint8_t val = sPtr[1];
+                            for (uint8_t j = 0; j < runLen; ++j)
+                            {
+                                *dPtr = val;
+                                dPtr += 4;
+                            }
+                        }
+                        pixelCount += runLen;
+                        sPtr += 2;
+                    }
+                    else if ((size_t(ePtr - sPtr) < size_t(runLen) + 1) || ((pixelCount + size_t(runLen)) > width))
+                    {
+                        return E_FAIL;
+                    }
+                    else
+                    {
+                        ++sPtr;
+                        if (decode)
+                        {
+                            for (uint8_t j = 0; j < runLen; ++j)
+                            {
+                                *dPtr = sPtr[j];
+                                dPtr += 4;
+                            }
+                        }
+                        pixelCount += runLen;
+                        sPtr += runLen;
+                    }
+                }
             }
+        }
+        else
+        {
+            uint8_t* dPtr = pDestination;
 
-            pDestination += 4;
+            uint8_t prevColor[4];
+            memcpy(prevColor, inColor, 4);
+
+            int bitShift = 0;
+            for (size_t pixelCount = 0; pixelCount < width;)
+            {
+                if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
+                {
+                    if (bitShift > 24)
+                        return E_FAIL;
+
+                    // "Standard" Run Length Encoding
+                    const size_t spanLen = size_t(inColor[3]) << bitShift;
+                    if (spanLen + pixelCount > width)
+                        return E_FAIL;
+
+                    if (decode)
+                    {
+                        for (size_t j = 0; j < spanLen; ++j)
+                        {
+                            memcpy(dPtr, prevColor, 4);
+                            dPtr += 4;
+                        }
+                    }
+                    pixelCount += spanLen;
+                    bitShift += 8;
+                }
+                else
+                {
+                    // Uncompressed
+                    memcpy(prevColor, inColor, 4);
+                    if (decode)
+                    {
+                        memcpy(dPtr, inColor, 4);
+                        dPtr += 4;
+                    }
+                    bitShift = 0;
+                    ++pixelCount;
+                }
+
+                if (pixelCount >= width)
+                    break;
+
+                if (ePtr - sPtr < 4)
+                    return E_FAIL;
+
+                memcpy(inColor, sPtr, 4);
+                sPtr += 4;
+            }
         }
+
+        bytesRead = size_t(sPtr - pSource);
+        return S_OK;
     }
 
     //-------------------------------------------------------------------------------------
@@ -571,6 +805,168 @@ namespace
         return encSize;
     #endif
     }
+
+    //-------------------------------------------------------------------------------------
+    // Validates an image for writing, and returns the file header and floats per pixel
+    //-------------------------------------------------------------------------------------
+    HRESULT EncodeHDRHeader(const Image& image, char (&header)[256], size_t& headerLen, int& fpp) noexcept
+    {
+        headerLen = 0;
+        fpp = 0;
+
+        if (!image.pixels)
+            return E_POINTER;
+
+        if (image.width > INT16_MAX || image.height > INT16_MAX)
+        {
+            // Images larger than this can't be RLE encoded. They are technically allowed as
+            // uncompresssed, but we just don't support them.
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        switch (image.format)
+        {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            fpp = 4;
+            break;
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+            fpp = 3;
+            break;
+
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        memset(header, 0, sizeof(header));
+        sprintf_s(header, g_Header, static_cast<unsigned int>(image.height), static_cast<unsigned int>(image.width));
+        headerLen = strlen(header);
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Encodes a range of scanlines in parallel into fixed rowPitch slots (EncodeRLE never
+    // produces more than that)
+    //-------------------------------------------------------------------------------------
+    HRESULT EncodeScanlines(
+        const Image& image,
+        int fpp,
+        size_t firstRow,
+        size_t rows,
+        _Out_writes_bytes_(rows * image.width * 4) uint8_t* slots,
+        _Out_writes_(rows) size_t* rowSizes) noexcept
+    {
+        const size_t rowPitch = image.width * 4;
+
+        std::atomic<bool> oom(false);
+
+    #ifdef _OPENMP
+        const Internal::WorkerThreads workers;
+
+        #pragma omp parallel if (rows >= HDR_PARALLEL_MIN_ROWS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const Internal::WorkerAffinity affinity(workers);
+        #endif
+
+            std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch]);
+            if (!temp)
+                oom = true;
+
+        #ifdef _OPENMP
+            #pragma omp for
+        #endif
+            for (int j = 0; j < static_cast<int>(rows); ++j)
+            {
+                if (!temp)
+                    continue;
+
+                auto rgbe = temp.get();
+
+                const uint8_t* sPtr = image.pixels + image.rowPitch * (firstRow + size_t(j));
+                if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+                {
+                    HalfToRGBE(rgbe, reinterpret_cast<const uint16_t*>(sPtr), image.width, fpp);
+                }
+                else
+                {
+                    FloatToRGBE(rgbe, reinterpret_cast<const float*>(sPtr), image.width, fpp);
+                }
+
+                uint8_t* slot = slots + rowPitch * size_t(j);
+            #ifdef DISABLE_COMPRESS
+                size_t encSize = 0;
+            #else
+                size_t encSize = EncodeRLE(slot, rgbe, rowPitch, image.width);
+            #endif
+                if (!encSize)
+                {
+                    memcpy(slot, rgbe, rowPitch);
+                    encSize = rowPitch;
+                }
+
+                rowSizes[j] = encSize;
+            }
+        }
+
+        return (oom) ? E_OUTOFMEMORY : S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Emits the header and then the scanlines, encoded in parallel a batch at a time and
+    // packed so each batch goes out as one chunk; only one batch is held in memory
+    //-------------------------------------------------------------------------------------
+    template<typename TWrite>
+    HRESULT WriteHDRImage(const Image& image, TWrite& write)
+    {
+        char header[256];
+        size_t headerLen;
+        int fpp;
+        HRESULT hr = EncodeHDRHeader(image, header, headerLen, fpp);
+        if (FAILED(hr))
+            return hr;
+
+        hr = write(header, headerLen);
+        if (FAILED(hr))
+            return hr;
+
+        const size_t rowPitch = image.width * 4;
+        const size_t batchRows = std::min(image.height, HDR_WRITE_BATCH_ROWS);
+
+        std::unique_ptr<uint8_t[]> slots(new (std::nothrow) uint8_t[batchRows * rowPitch]);
+        std::unique_ptr<size_t[]> rowSizes(new (std::nothrow) size_t[batchRows]);
+        if (!slots || !rowSizes)
+            return E_OUTOFMEMORY;
+
+        for (size_t firstRow = 0; firstRow < image.height; firstRow += batchRows)
+        {
+            const size_t rows = std::min(batchRows, image.height - firstRow);
+
+            hr = EncodeScanlines(image, fpp, firstRow, rows, slots.get(), rowSizes.get());
+            if (FAILED(hr))
+                return hr;
+
+            uint8_t* dPtr = slots.get();
+            const uint8_t* slot = slots.get();
+            for (size_t j = 0; j < rows; ++j)
+            {
+                if (dPtr != slot)
+                {
+                    memmove(dPtr, slot, rowSizes[j]);
+                }
+                dPtr += rowSizes[j];
+                slot += rowPitch;
+            }
+
+            hr = write(slots.get(), size_t(dPtr - slots.get()));
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
 }
 
 
@@ -680,6 +1076,8 @@ HRESULT DirectX::GetMetadataFromHDRFile(const wchar_t* szFile, TexMetadata& meta
 _Use_decl_annotations_
 HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata* metadata, ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(image);
+
     if (!pSource || size == 0)
         return E_INVALIDARG;
 
@@ -703,11 +1101,6 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
     if (FAILED(hr))
         return hr;
 
-    // Copy pixels
-    auto sourcePtr = static_cast<const uint8_t*>(pSource) + offset;
-
-    size_t pixelLen = remaining;
-
     const Image* img = image.GetImage(0, 0, 0);
     if (!img)
     {
@@ -715,173 +1108,81 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
         return E_POINTER;
     }
 
-    auto destPtr = img->pixels;
+    if (mdata.height > INT32_MAX)
+    {
+        image.Release();
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+    }
 
-#ifdef _DEBUG
-    memset(img->pixels, 0xFF, img->rowPitch * img->height);
-#endif
+    auto sourcePtr = static_cast<const uint8_t*>(pSource) + offset;
+
+    // Locate each scanline first so they can be decoded independently
+    std::unique_ptr<size_t[]> offsets(new (std::nothrow) size_t[mdata.height]);
+    if (!offsets)
+    {
+        image.Release();
+        return E_OUTOFMEMORY;
+    }
 
+    size_t pos = 0;
     for (size_t scan = 0; scan < mdata.height; ++scan)
     {
-        if (pixelLen < 4)
+        offsets[scan] = pos;
+
+        size_t bytesRead;
+        hr = DecodeScanline<false>(nullptr, sourcePtr + pos, remaining - pos, mdata.width, bytesRead);
+        if (FAILED(hr))
         {
             image.Release();
-            return E_FAIL;
+            return hr;
         }
 
-        uint8_t inColor[4];
-        memcpy(inColor, sourcePtr, 4);
-        sourcePtr += 4;
-        pixelLen -= 4;
+        pos += bytesRead;
+    }
 
-        auto scanLine = reinterpret_cast<float*>(destPtr);
+    // Decode and transform values
+    const float invExposure = 1.0f / exposure;
 
-        if (inColor[0] == 2 && inColor[1] == 2 && inColor[2] < 128)
-        {
-            // Adaptive Run Length Encoding (RLE)
-            if (size_t((size_t(inColor[2]) << 8) + inColor[3]) != mdata.width)
-            {
-                image.Release();
-                return E_FAIL;
-            }
+    std::atomic<bool> fail(false);
+    std::atomic<bool> oom(false);
 
-            for (int channel = 0; channel < 4; ++channel)
-            {
-                auto pixelLoc = scanLine + channel;
-                for (size_t pixelCount = 0; pixelCount < mdata.width;)
-                {
-                    if (pixelLen < 2)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
+#ifdef _OPENMP
+    const Internal::WorkerThreads workers;
 
-                    assert(sourcePtr < (reinterpret_cast<const uint8_t*>(pSource) + size));
+    #pragma omp parallel if (mdata.height >= HDR_PARALLEL_MIN_ROWS) num_threads(workers.Count())
+#endif
+    {
+    #ifdef _OPENMP
+        const Internal::WorkerAffinity affinity(workers);
+    #endif
 
-                    uint8_t runLen = *sourcePtr;
-                    if (runLen > 128)
-                    {
-                        runLen &= 127;
-                        if (pixelCount + runLen > mdata.width)
-                        {
-                            image.Release();
-                            return E_FAIL;
-                        }
+        std::unique_ptr<uint8_t[]> rgbe(new (std::nothrow) uint8_t[mdata.width * 4]);
+        if (!rgbe)
+            oom = true;
 
-                        auto val = static_cast<float>(sourcePtr[1]);
-                        for (uint8_t j = 0; j < runLen; ++j)
-                        {
-                            *pixelLoc = val;
-                            pixelLoc += 4;
-                        }
-                        pixelCount += runLen;
-                        sourcePtr += 2;
-                        pixelLen -= 2;
-                    }
-                    else if ((size < size_t(runLen) + 1) || ((pixelCount + size_t(runLen)) > mdata.width))
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-                    else
-                    {
-                        ++sourcePtr;
-                        for (uint8_t j = 0; j < runLen; ++j)
-                        {
-                            auto val = static_cast<float>(*sourcePtr++);
-                            *pixelLoc = val;
-                            pixelLoc += 4;
-                        }
-                        pixelCount += runLen;
-                        pixelLen -= size_t(runLen) + 1;
-                    }
-                }
-            }
-        }
-        else
+    #ifdef _OPENMP
+        #pragma omp for
+    #endif
+        for (int scan = 0; scan < static_cast<int>(mdata.height); ++scan)
         {
-            auto pixelLoc = scanLine;
-
-            float prevColor[4];
-            prevColor[0] = inColor[0];
-            prevColor[1] = inColor[1];
-            prevColor[2] = inColor[2];
-            prevColor[3] = inColor[3];
+            if (!rgbe)
+                continue;
 
-            int bitShift = 0;
-            for (size_t pixelCount = 0; pixelCount < mdata.width;)
+            size_t bytesRead;
+            if (FAILED(DecodeScanline<true>(rgbe.get(), sourcePtr + offsets[size_t(scan)], remaining - offsets[size_t(scan)], mdata.width, bytesRead)))
             {
-                if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
-                {
-                    if (bitShift > 24)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    // "Standard" Run Length Encoding
-                    const size_t spanLen = size_t(inColor[3]) << bitShift;
-                    if (spanLen + pixelCount > mdata.width)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    for (size_t j = 0; j < spanLen; ++j)
-                    {
-                        pixelLoc[0] = prevColor[0];
-                        pixelLoc[1] = prevColor[1];
-                        pixelLoc[2] = prevColor[2];
-                        pixelLoc[3] = prevColor[3];
-                        pixelLoc += 4;
-                    }
-                    pixelCount += spanLen;
-                    bitShift += 8;
-                }
-                else
-                {
-                    // Uncompressed
-                    pixelLoc[0] = prevColor[0] = inColor[0];
-                    pixelLoc[1] = prevColor[1] = inColor[1];
-                    pixelLoc[2] = prevColor[2] = inColor[2];
-                    pixelLoc[3] = prevColor[3] = inColor[3];
-                    bitShift = 0;
-                    ++pixelCount;
-                    pixelLoc += 4;
-                }
-
-                if (pixelCount >= mdata.width)
-                    break;
-
-                if (pixelLen < 4)
-                {
-                    image.Release();
-                    return E_FAIL;
-                }
-
-                memcpy(inColor, sourcePtr, 4);
-                sourcePtr += 4;
-                pixelLen -= 4;
+                fail = true;
+                continue;
             }
-        }
 
-        destPtr += img->rowPitch;
+            RGBEToFloat(reinterpret_cast<float*>(img->pixels + img->rowPitch * size_t(scan)), rgbe.get(), mdata.width, invExposure);
+        }
     }
 
-    // Transform values
+    if (oom || fail)
     {
-        auto fdata = reinterpret_cast<float*>(image.GetPixels());
-
-        for (size_t j = 0; j < image.GetPixelsSize(); j += 16)
-        {
-            auto const exponent = static_cast<int>(fdata[3]);
-            fdata[0] = 1.0f / exposure*ldexpf((fdata[0] + 0.5f), exponent - (128 + 8));
-            fdata[1] = 1.0f / exposure*ldexpf((fdata[1] + 0.5f), exponent - (128 + 8));
-            fdata[2] = 1.0f / exposure*ldexpf((fdata[2] + 0.5f), exponent - (128 + 8));
-            fdata[3] = 1.f;
-
-            fdata += 4;
-        }
+        image.Release();
+        return (oom) ? E_OUTOFMEMORY : E_FAIL;
     }
 
     if (metadata)
@@ -897,6 +1198,8 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
 _Use_decl_annotations_
 HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -982,104 +1285,107 @@ HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, S
 
 
 //-------------------------------------------------------------------------------------
-// Save a HDR file to memory
+// Determine the size of a HDR file
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::SaveToHDRMemory(const Image& image, Blob& blob) noexcept
+HRESULT DirectX::GetHDRSaveSize(const Image& image, size_t& required) noexcept
 {
-    if (!image.pixels)
-        return E_POINTER;
-
-    if (image.width > INT16_MAX || image.height > INT16_MAX)
-    {
-        // Images larger than this can't be RLE encoded. They are technically allowed as
-        // uncompresssed, but we just don't support them.
-        return HRESULT_E_NOT_SUPPORTED;
-    }
+    required = 0;
 
+    char header[256];
+    size_t headerLen;
     int fpp;
-    switch (image.format)
-    {
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-        fpp = 4;
-        break;
-    case DXGI_FORMAT_R32G32B32_FLOAT:
-        fpp = 3;
-        break;
+    HRESULT hr = EncodeHDRHeader(image, header, headerLen, fpp);
+    if (FAILED(hr))
+        return hr;
 
-    default:
-        return HRESULT_E_NOT_SUPPORTED;
-    }
+    // Worst case is every scanline stored uncompressed
+    required = headerLen + image.height * image.width * 4;
+    return S_OK;
+}
 
-    blob.Release();
 
-    char header[256] = {};
-    sprintf_s(header, g_Header, image.height, image.width);
+//-------------------------------------------------------------------------------------
+// Save a HDR file to memory
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveToHDRMemory(const Image& image, void* pDestination, size_t size, size_t* written) noexcept
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
 
-    auto headerLen = static_cast<DWORD>(strlen(header));
+    if (written)
+        *written = 0;
 
-    size_t rowPitch = image.width * 4;
-    const size_t slicePitch = image.height * rowPitch;
+    if (!pDestination)
+        return E_INVALIDARG;
 
-    HRESULT hr = blob.Initialize(headerLen + slicePitch);
+    char header[256];
+    size_t headerLen;
+    int fpp;
+    HRESULT hr = EncodeHDRHeader(image, header, headerLen, fpp);
     if (FAILED(hr))
         return hr;
 
+    const size_t rowPitch = image.width * 4;
+    if (size < headerLen + image.height * rowPitch)
+        return E_NOT_SUFFICIENT_BUFFER;
+
     // Copy header
-    auto dPtr = static_cast<uint8_t*>(blob.GetBufferPointer());
-    assert(dPtr != nullptr);
+    auto dPtr = static_cast<uint8_t*>(pDestination);
     memcpy(dPtr, header, headerLen);
     dPtr += headerLen;
 
-#ifdef DISABLE_COMPRESS
-    // Uncompressed write
-    auto sPtr = reinterpret_cast<const uint8_t*>(image.pixels);
-    for (size_t scan = 0; scan < image.height; ++scan)
-    {
-        FloatToRGBE(dPtr, reinterpret_cast<const float*>(sPtr), image.width, fpp);
-        dPtr += rowPitch;
-        sPtr += image.rowPitch;
-    }
-#else
-    std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch * 2]);
-    if (!temp)
-    {
-        blob.Release();
+    // Scanlines are encoded in place into their slots, and then packed together in order
+    std::unique_ptr<size_t[]> rowSizes(new (std::nothrow) size_t[image.height]);
+    if (!rowSizes)
         return E_OUTOFMEMORY;
-    }
 
-    auto rgbe = temp.get();
-    auto enc = temp.get() + rowPitch;
+    hr = EncodeScanlines(image, fpp, 0, image.height, dPtr, rowSizes.get());
+    if (FAILED(hr))
+        return hr;
 
-    const uint8_t* sPtr = image.pixels;
+    const uint8_t* slot = dPtr;
     for (size_t scan = 0; scan < image.height; ++scan)
     {
-        if (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT || image.format == DXGI_FORMAT_R32G32B32_FLOAT)
+        if (dPtr != slot)
         {
-            FloatToRGBE(rgbe, reinterpret_cast<const float*>(sPtr), image.width, fpp);
+            memmove(dPtr, slot, rowSizes[scan]);
         }
-        else if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
-        {
-            HalfToRGBE(rgbe, reinterpret_cast<const uint16_t*>(sPtr), image.width, fpp);
-        }
-        sPtr += image.rowPitch;
+        dPtr += rowSizes[scan];
+        slot += rowPitch;
+    }
 
-        size_t encSize = EncodeRLE(enc, rgbe, rowPitch, image.width);
-        if (encSize > 0)
-        {
-            memcpy(dPtr, enc, encSize);
-            dPtr += encSize;
-        }
-        else
-        {
-            memcpy(dPtr, rgbe, rowPitch);
-            dPtr += rowPitch;
-        }
+    if (written)
+        *written = size_t(dPtr - static_cast<uint8_t*>(pDestination));
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SaveToHDRMemory(const Image& image, Blob& blob) noexcept
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
+    size_t required;
+    HRESULT hr = GetHDRSaveSize(image, required);
+    if (FAILED(hr))
+        return hr;
+
+    blob.Release();
+
+    hr = blob.Initialize(required);
+    if (FAILED(hr))
+        return hr;
+
+    size_t written = 0;
+    hr = SaveToHDRMemory(image, blob.GetBufferPointer(), blob.GetBufferSize(), &written);
+    if (FAILED(hr))
+    {
+        blob.Release();
+        return hr;
     }
-#endif
 
-    hr = blob.Trim(size_t(dPtr - static_cast<uint8_t*>(blob.GetBufferPointer())));
+    hr = blob.Trim(written);
     if (FAILED(hr))
     {
         blob.Release();
@@ -1090,12 +1396,29 @@ HRESULT DirectX::SaveToHDRMemory(const Image& image, Blob& blob) noexcept
 }
 
 
+//-------------------------------------------------------------------------------------
+// Save a HDR file through a writer callback
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveToHDRCallback(const Image& image, WriteCallback writer)
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
+    if (!writer)
+        return E_INVALIDARG;
+
+    return WriteHDRImage(image, writer);
+}
+
+
 //-------------------------------------------------------------------------------------
 // Save a HDR file to disk
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
 HRESULT DirectX::SaveToHDRFile(const Image& image, const wchar_t* szFile) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -1109,22 +1432,18 @@ HRESULT DirectX::SaveToHDRFile(const Image& image, const wchar_t* szFile) noexce
         return HRESULT_E_NOT_SUPPORTED;
     }
 
-    int fpp;
     switch (image.format)
     {
     case DXGI_FORMAT_R32G32B32A32_FLOAT:
     case DXGI_FORMAT_R16G16B16A16_FLOAT:
-        fpp = 4;
-        break;
     case DXGI_FORMAT_R32G32B32_FLOAT:
-        fpp = 3;
         break;
 
     default:
         return HRESULT_E_NOT_SUPPORTED;
     }
 
-    // Create file and write header
+    // Create file
 #ifdef _WIN32
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
     ScopedHandle hFile(safe_handle(CreateFile2(szFile,
@@ -1139,158 +1458,36 @@ HRESULT DirectX::SaveToHDRFile(const Image& image, const wchar_t* szFile) noexce
     }
 
     auto_delete_file delonfail(hFile.get());
-#else // !WIN32
-    std::ofstream outFile(std::filesystem::path(szFile), std::ios::out | std::ios::binary | std::ios::trunc);
-    if (!outFile)
-        return E_FAIL;
-#endif
-
-    const uint64_t pitch = uint64_t(image.width) * 4u;
-    const uint64_t slicePitch = uint64_t(image.height) * pitch;
-
-    if (pitch > UINT32_MAX)
-        return HRESULT_E_ARITHMETIC_OVERFLOW;
-
-    size_t rowPitch = static_cast<size_t>(pitch);
-
-    if (slicePitch < 65535)
-    {
-        // For small images, it is better to create an in-memory file and write it out
-        Blob blob;
-
-        HRESULT hr = SaveToHDRMemory(image, blob);
-        if (FAILED(hr))
-            return hr;
-
-        // Write blob
-    #ifdef _WIN32
-        auto const bytesToWrite = static_cast<const DWORD>(blob.GetBufferSize());
-        DWORD bytesWritten;
-        if (!WriteFile(hFile.get(), blob.GetBufferPointer(), bytesToWrite, &bytesWritten, nullptr))
-        {
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
-
-        if (bytesWritten != bytesToWrite)
-        {
-            return E_FAIL;
-        }
-    #else
-        outFile.write(reinterpret_cast<char*>(blob.GetBufferPointer()),
-            static_cast<std::streamsize>(blob.GetBufferSize()));
 
-        if (!outFile)
-            return E_FAIL;
-    #endif
-    }
-    else
-    {
-        // Otherwise, write the image one scanline at a time...
-        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch * 2]);
-        if (!temp)
-            return E_OUTOFMEMORY;
-
-        auto rgbe = temp.get();
-
-        // Write header
-        char header[256] = {};
-        sprintf_s(header, g_Header, image.height, image.width);
-
-    #ifdef _WIN32
-        auto const headerLen = static_cast<DWORD>(strlen(header));
-
-        DWORD bytesWritten;
-        if (!WriteFile(hFile.get(), header, headerLen, &bytesWritten, nullptr))
+    auto write = [&](const void* pData, size_t bytes) noexcept -> HRESULT
         {
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
-
-        if (bytesWritten != headerLen)
-            return E_FAIL;
-    #else
-        outFile.write(reinterpret_cast<char*>(header), static_cast<std::streamsize>(strlen(header)));
-        if (!outFile)
-            return E_FAIL;
-    #endif
+            if (bytes > UINT32_MAX)
+                return HRESULT_E_ARITHMETIC_OVERFLOW;
 
-    #ifdef DISABLE_COMPRESS
-            // Uncompressed write
-        auto sPtr = reinterpret_cast<const uint8_t*>(image.pixels);
-        for (size_t scan = 0; scan < image.height; ++scan)
-        {
-            FloatToRGBE(rgbe, reinterpret_cast<const float*>(sPtr), image.width, fpp);
-            sPtr += image.rowPitch;
-
-        #ifdef _WIN32
-            if (!WriteFile(hFile.get(), rgbe, static_cast<DWORD>(rowPitch), &bytesWritten, nullptr))
+            DWORD bytesWritten;
+            if (!WriteFile(hFile.get(), pData, static_cast<DWORD>(bytes), &bytesWritten, nullptr))
             {
                 return HRESULT_FROM_WIN32(GetLastError());
             }
 
-            if (bytesWritten != rowPitch)
-                return E_FAIL;
-        #else
-            outFile.write(reinterpret_cast<char*>(rgbe), static_cast<std::streamsize>(rowPitch));
-            if (!outFile)
-                return E_FAIL;
-        #endif
-
-        }
-    #else
-        auto enc = temp.get() + rowPitch;
+            return (bytesWritten != bytes) ? E_FAIL : S_OK;
+        };
+#else // !WIN32
+    std::ofstream outFile(std::filesystem::path(szFile), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outFile)
+        return E_FAIL;
 
-        const uint8_t* sPtr = image.pixels;
-        for (size_t scan = 0; scan < image.height; ++scan)
+    auto write = [&](const void* pData, size_t bytes) noexcept -> HRESULT
         {
-            if (image.format == DXGI_FORMAT_R32G32B32A32_FLOAT || image.format == DXGI_FORMAT_R32G32B32_FLOAT)
-            {
-                FloatToRGBE(rgbe, reinterpret_cast<const float*>(sPtr), image.width, fpp);
-            }
-            else if (image.format == DXGI_FORMAT_R16G16B16A16_FLOAT)
-            {
-                HalfToRGBE(rgbe, reinterpret_cast<const uint16_t*>(sPtr), image.width, fpp);
-            }
-            sPtr += image.rowPitch;
-
-            const size_t encSize = EncodeRLE(enc, rgbe, rowPitch, image.width);
-            if (encSize > 0)
-            {
-                if (encSize > UINT32_MAX)
-                    return HRESULT_E_ARITHMETIC_OVERFLOW;
-
-            #ifdef _WIN32
-                if (!WriteFile(hFile.get(), enc, static_cast<DWORD>(encSize), &bytesWritten, nullptr))
-                {
-                    return HRESULT_FROM_WIN32(GetLastError());
-                }
-
-                if (bytesWritten != encSize)
-                    return E_FAIL;
-            #else
-                outFile.write(reinterpret_cast<char*>(enc), static_cast<std::streamsize>(encSize));
-                if (!outFile)
-                    return E_FAIL;
-            #endif
-            }
-            else
-            {
-            #ifdef _WIN32
-                if (!WriteFile(hFile.get(), rgbe, static_cast<DWORD>(rowPitch), &bytesWritten, nullptr))
-                {
-                    return HRESULT_FROM_WIN32(GetLastError());
-                }
+            outFile.write(static_cast<const char*>(pData), static_cast<std::streamsize>(bytes));
+            return (outFile) ? S_OK : E_FAIL;
+        };
+#endif
 
-                if (bytesWritten != rowPitch)
-                    return E_FAIL;
-            #else
-                outFile.write(reinterpret_cast<char*>(rgbe), static_cast<std::streamsize>(rowPitch));
-                if (!outFile)
-                    return E_FAIL;
-            #endif
-            }
-        }
-    #endif
-    }
+    // Scanlines are encoded in parallel a batch at a time and streamed to the file
+    const HRESULT hr = WriteHDRImage(image, write);
+    if (FAILED(hr))
+        return hr;
 
 #ifdef _WIN32
     delonfail.clear();
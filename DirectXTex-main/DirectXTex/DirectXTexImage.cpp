@@ -14,18 +14,212 @@
 using namespace DirectX;
 using namespace DirectX::Internal;
 
-#ifndef _WIN32
 namespace
 {
-    inline void * _aligned_malloc(size_t size, size_t alignment)
+    // Rows per parallel work item for the opacity scan
+    constexpr size_t OPAQUE_BAND_ROWS = 64;
+
+    // Smaller images are not worth starting worker threads for
+    constexpr size_t OPAQUE_PARALLEL_MIN_PIXELS = 64 * 1024;
+
+    // Loaded alpha below this is not opaque
+    const XMVECTORF32 g_OpaqueThreshold = { { { 0.997f, 0.997f, 0.997f, 0.997f } } };
+
+    // Smallest 16-bit UNORM alpha that loads at or above the threshold
+    constexpr uint16_t OPAQUE_MIN_ALPHA16 = 65339;
+
+    enum OPAQUE_SCAN
     {
-        size = (size + alignment - 1) & ~(alignment - 1);
-        return std::aligned_alloc(alignment, size);
+        OPAQUE_SCAN_LOAD,       // LoadScanline and compare
+        OPAQUE_SCAN_MASK32,     // 32-bit pixels with the alpha bits all set
+        OPAQUE_SCAN_ALPHA16,    // 64-bit pixels with 16-bit UNORM alpha
+    };
+
+    //-------------------------------------------------------------------------------------
+    // True if every 32-bit pixel of the row has all of the bits in mask set
+    //-------------------------------------------------------------------------------------
+    bool IsRowOpaque32(const uint8_t* pRow, size_t width, uint32_t mask) noexcept
+    {
+        size_t x = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+
+        for (; x + 16 <= width; x += 16)
+        {
+            auto p = reinterpret_cast<const __m128i*>(pRow + x * 4);
+            const __m128i v01 = _mm_and_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1));
+            const __m128i v23 = _mm_and_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3));
+            const __m128i v = _mm_and_si128(_mm_and_si128(v01, v23), vmask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, vmask)) != 0xFFFF)
+                return false;
+        }
+
+        for (; x + 4 <= width; x += 4)
+        {
+            const __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + x * 4)), vmask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, vmask)) != 0xFFFF)
+                return false;
+        }
+    #endif
+
+        for (; x < width; ++x)
+        {
+            uint32_t pixel;
+            memcpy(&pixel, pRow + x * 4, sizeof(pixel));
+            if ((pixel & mask) != mask)
+                return false;
+        }
+
+        return true;
     }
 
-#define _aligned_free free
+    //-------------------------------------------------------------------------------------
+    // True if every 64-bit pixel of the row has alpha of at least OPAQUE_MIN_ALPHA16
+    //-------------------------------------------------------------------------------------
+    bool IsRowOpaque16(const uint8_t* pRow, size_t width) noexcept
+    {
+        size_t x = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // SSE2 only has signed 16-bit compares, so both sides are biased; color lanes compare against the minimum
+        const __m128i bias = _mm_set1_epi16(INT16_MIN);
+        const auto minAlpha = static_cast<short>(OPAQUE_MIN_ALPHA16 ^ 0x8000u);
+        const __m128i vmin = _mm_setr_epi16(INT16_MIN, INT16_MIN, INT16_MIN, minAlpha, INT16_MIN, INT16_MIN, INT16_MIN, minAlpha);
+
+        for (; x + 8 <= width; x += 8)
+        {
+            auto p = reinterpret_cast<const __m128i*>(pRow + x * 8);
+            __m128i below = _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(p), bias), vmin);
+            below = _mm_or_si128(below, _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(p + 1), bias), vmin));
+            below = _mm_or_si128(below, _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(p + 2), bias), vmin));
+            below = _mm_or_si128(below, _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(p + 3), bias), vmin));
+            if (_mm_movemask_epi8(below))
+                return false;
+        }
+
+        for (; x + 2 <= width; x += 2)
+        {
+            const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + x * 8)), bias);
+            if (_mm_movemask_epi8(_mm_cmplt_epi16(v, vmin)))
+                return false;
+        }
+    #endif
+
+        for (; x < width; ++x)
+        {
+            uint16_t alpha;
+            memcpy(&alpha, pRow + x * 8 + 6, sizeof(alpha));
+            if (alpha < OPAQUE_MIN_ALPHA16)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool IsRowOpaqueLoad(XMVECTOR* scanline, const uint8_t* pRow, const Image& img) noexcept
+    {
+        if (!LoadScanline(scanline, img.width, pRow, img.rowPitch, img.format))
+            return false;
+
+        for (size_t x = 0; x < img.width; ++x)
+        {
+            const XMVECTOR alpha = XMVectorSplatW(scanline[x]);
+            if (XMVector4Less(alpha, g_OpaqueThreshold))
+                return false;
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Scans an uncompressed image, stopping at the first pixel that isn't opaque
+    //-------------------------------------------------------------------------------------
+    bool IsAlphaAllOpaqueImage(const Image& img) noexcept
+    {
+        if (!img.pixels)
+            return false;
+
+        OPAQUE_SCAN scan = OPAQUE_SCAN_LOAD;
+        uint32_t mask = 0;
+        switch (img.format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            scan = OPAQUE_SCAN_MASK32;
+            mask = 0xFF000000;
+            break;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            scan = OPAQUE_SCAN_MASK32;
+            mask = 0xC0000000;
+            break;
+
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+            scan = OPAQUE_SCAN_ALPHA16;
+            break;
+
+        default:
+            break;
+        }
+
+        const size_t nbands = (img.height + OPAQUE_BAND_ROWS - 1) / OPAQUE_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return false;
+
+        // Cleared by the first pixel that isn't opaque; the other workers stop at their next row
+        std::atomic<bool> opaque(true);
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (nbands > 1 && img.width * img.height >= OPAQUE_PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+        #endif
+
+            ScopedAlignedArrayXMVECTOR scanline;
+            if (scan == OPAQUE_SCAN_LOAD)
+            {
+                scanline = make_AlignedArrayXMVECTOR(img.width);
+                if (!scanline)
+                    opaque.store(false, std::memory_order_relaxed);
+            }
+
+        #ifdef _OPENMP
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                const size_t y0 = size_t(band) * OPAQUE_BAND_ROWS;
+                const size_t y1 = std::min(y0 + OPAQUE_BAND_ROWS, img.height);
+
+                for (size_t y = y0; y < y1 && opaque.load(std::memory_order_relaxed); ++y)
+                {
+                    const uint8_t* pRow = img.pixels + y * img.rowPitch;
+
+                    bool result;
+                    switch (scan)
+                    {
+                    case OPAQUE_SCAN_MASK32:    result = IsRowOpaque32(pRow, img.width, mask); break;
+                    case OPAQUE_SCAN_ALPHA16:   result = IsRowOpaque16(pRow, img.width); break;
+                    default:                    result = IsRowOpaqueLoad(scanline.get(), pRow, img); break;
+                    }
+
+                    if (!result)
+                        opaque.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        return opaque.load();
+    }
 }
-#endif
+
 
 //-------------------------------------------------------------------------------------
 // Determines number of image array entries and pixel size
@@ -277,65 +471,85 @@ ScratchImage& ScratchImage::operator= (ScratchImage&& moveFrom) noexcept
         m_metadata = moveFrom.m_metadata;
         m_image = moveFrom.m_image;
         m_memory = moveFrom.m_memory;
+        m_allocator = moveFrom.m_allocator;
+        m_memoryAllocator = moveFrom.m_memoryAllocator;
 
         moveFrom.m_nimages = 0;
         moveFrom.m_size = 0;
         moveFrom.m_image = nullptr;
         moveFrom.m_memory = nullptr;
+        moveFrom.m_memoryAllocator = nullptr;
     }
     return *this;
 }
 
 
-//-------------------------------------------------------------------------------------
-// Methods
-//-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexcept
+namespace
 {
-    if (!IsValid(mdata.format))
-        return E_INVALIDARG;
-
-    if (IsPalettized(mdata.format))
-        return HRESULT_E_NOT_SUPPORTED;
-
-    size_t mipLevels = mdata.mipLevels;
-
-    switch (mdata.dimension)
+    //-------------------------------------------------------------------------------------
+    // Validates metadata for ScratchImage::Initialize and computes the full mip count
+    //-------------------------------------------------------------------------------------
+    HRESULT ValidateMetadata(const TexMetadata& mdata, size_t& mipLevels) noexcept
     {
-    case TEX_DIMENSION_TEXTURE1D:
-        if (!mdata.width || mdata.height != 1 || mdata.depth != 1 || !mdata.arraySize)
+        if (!IsValid(mdata.format))
             return E_INVALIDARG;
 
-        if (!CalculateMipLevels(mdata.width, 1, mipLevels))
-            return E_INVALIDARG;
-        break;
+        if (IsPalettized(mdata.format))
+            return HRESULT_E_NOT_SUPPORTED;
 
-    case TEX_DIMENSION_TEXTURE2D:
-        if (!mdata.width || !mdata.height || mdata.depth != 1 || !mdata.arraySize)
-            return E_INVALIDARG;
+        mipLevels = mdata.mipLevels;
 
-        if (mdata.IsCubemap())
+        switch (mdata.dimension)
         {
-            if ((mdata.arraySize % 6) != 0)
+        case TEX_DIMENSION_TEXTURE1D:
+            if (!mdata.width || mdata.height != 1 || mdata.depth != 1 || !mdata.arraySize)
                 return E_INVALIDARG;
-        }
 
-        if (!CalculateMipLevels(mdata.width, mdata.height, mipLevels))
-            return E_INVALIDARG;
-        break;
+            if (!CalculateMipLevels(mdata.width, 1, mipLevels))
+                return E_INVALIDARG;
+            break;
 
-    case TEX_DIMENSION_TEXTURE3D:
-        if (!mdata.width || !mdata.height || !mdata.depth || mdata.arraySize != 1)
-            return E_INVALIDARG;
+        case TEX_DIMENSION_TEXTURE2D:
+            if (!mdata.width || !mdata.height || mdata.depth != 1 || !mdata.arraySize)
+                return E_INVALIDARG;
 
-        if (!CalculateMipLevels3D(mdata.width, mdata.height, mdata.depth, mipLevels))
-            return E_INVALIDARG;
-        break;
+            if (mdata.IsCubemap())
+            {
+                if ((mdata.arraySize % 6) != 0)
+                    return E_INVALIDARG;
+            }
 
-    default:
-        return HRESULT_E_NOT_SUPPORTED;
+            if (!CalculateMipLevels(mdata.width, mdata.height, mipLevels))
+                return E_INVALIDARG;
+            break;
+
+        case TEX_DIMENSION_TEXTURE3D:
+            if (!mdata.width || !mdata.height || !mdata.depth || mdata.arraySize != 1)
+                return E_INVALIDARG;
+
+            if (!CalculateMipLevels3D(mdata.width, mdata.height, mdata.depth, mipLevels))
+                return E_INVALIDARG;
+            break;
+
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        return S_OK;
     }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Methods
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexcept
+{
+    size_t mipLevels;
+    HRESULT hr = ValidateMetadata(mdata, mipLevels);
+    if (FAILED(hr))
+        return hr;
 
     Release();
 
@@ -350,7 +564,7 @@ HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexc
     m_metadata.dimension = mdata.dimension;
 
     size_t pixelSize, nimages;
-    HRESULT hr = DetermineImageArray(m_metadata, flags, nimages, pixelSize);
+    hr = DetermineImageArray(m_metadata, flags, nimages, pixelSize);
     if (FAILED(hr))
         return hr;
 
@@ -361,12 +575,14 @@ HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexc
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    IAllocator* allocator = (m_allocator) ? m_allocator : GetDefaultAllocator();
+    m_memory = static_cast<uint8_t*>(allocator->Allocate(pixelSize, 16));
     if (!m_memory)
     {
         Release();
         return E_OUTOFMEMORY;
     }
+    m_memoryAllocator = allocator;
     memset(m_memory, 0, pixelSize);
     m_size = pixelSize;
 
@@ -379,6 +595,122 @@ HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexc
     return S_OK;
 }
 
+_Use_decl_annotations_
+HRESULT ScratchImage::InitializeFromMemory(const TexMetadata& mdata, uint8_t* pixels, size_t size, CP_FLAGS flags, IAllocator* owner) noexcept
+{
+    if (!pixels || !size)
+        return E_INVALIDARG;
+
+    size_t mipLevels;
+    HRESULT hr = ValidateMetadata(mdata, mipLevels);
+    if (FAILED(hr))
+        return hr;
+
+    TexMetadata mdata2 = mdata;
+    mdata2.mipLevels = mipLevels;
+
+    size_t pixelSize, nimages;
+    hr = DetermineImageArray(mdata2, flags, nimages, pixelSize);
+    if (FAILED(hr))
+        return hr;
+
+    if (size < pixelSize)
+        return E_NOT_SUFFICIENT_BUFFER;
+
+    auto images = new (std::nothrow) Image[nimages];
+    if (!images)
+        return E_OUTOFMEMORY;
+
+    memset(images, 0, sizeof(Image) * nimages);
+
+    if (!SetupImageArray(pixels, size, mdata2, flags, images, nimages))
+    {
+        delete[] images;
+        return E_FAIL;
+    }
+
+    // Only release the current contents once the new layout is known to be good, since the
+    // caller may still own the buffer on failure
+    Release();
+
+    m_metadata = mdata2;
+    m_image = images;
+    m_nimages = nimages;
+    m_memory = pixels;
+    m_size = size;
+    m_memoryAllocator = owner;
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT ScratchImage::InitializeFromMemory(
+    const TexMetadata& mdata,
+    uint8_t* pixels,
+    size_t size,
+    size_t rowPitch,
+    size_t slicePitch,
+    CP_FLAGS flags,
+    IAllocator* owner) noexcept
+{
+    if (!pixels || !size)
+        return E_INVALIDARG;
+
+    size_t mipLevels;
+    HRESULT hr = ValidateMetadata(mdata, mipLevels);
+    if (FAILED(hr))
+        return hr;
+
+    if (mipLevels != 1)
+        return HRESULT_E_NOT_SUPPORTED;
+
+    size_t minRowPitch, minSlicePitch;
+    hr = ComputePitch(mdata.format, mdata.width, mdata.height, minRowPitch, minSlicePitch, flags);
+    if (FAILED(hr))
+        return hr;
+
+    if (rowPitch < minRowPitch)
+        return E_INVALIDARG;
+
+    // Every image reports the full pitches, so the buffer must cover all of them including the
+    // padding after the last row
+    const size_t scanlines = ComputeScanlines(mdata.format, mdata.height);
+    if (!scanlines || rowPitch > slicePitch / scanlines)
+        return E_INVALIDARG;
+
+    const size_t nimages = (mdata.dimension == TEX_DIMENSION_TEXTURE3D) ? mdata.depth : mdata.arraySize;
+    if (nimages > size / slicePitch)
+        return E_NOT_SUFFICIENT_BUFFER;
+
+    auto images = new (std::nothrow) Image[nimages];
+    if (!images)
+        return E_OUTOFMEMORY;
+
+    uint8_t* ptr = pixels;
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        images[index].width = mdata.width;
+        images[index].height = mdata.height;
+        images[index].format = mdata.format;
+        images[index].rowPitch = rowPitch;
+        images[index].slicePitch = slicePitch;
+        images[index].pixels = ptr;
+        ptr += slicePitch;
+    }
+
+    Release();
+
+    m_metadata = mdata;
+    m_metadata.mipLevels = 1;
+    m_image = images;
+    m_nimages = nimages;
+    m_memory = pixels;
+    m_size = size;
+    m_memoryAllocator = owner;
+
+    return S_OK;
+}
+
 _Use_decl_annotations_
 HRESULT ScratchImage::Initialize1D(DXGI_FORMAT fmt, size_t length, size_t arraySize, size_t mipLevels, CP_FLAGS flags) noexcept
 {
@@ -431,12 +763,14 @@ HRESULT ScratchImage::Initialize2D(DXGI_FORMAT fmt, size_t width, size_t height,
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    IAllocator* allocator = (m_allocator) ? m_allocator : GetDefaultAllocator();
+    m_memory = static_cast<uint8_t*>(allocator->Allocate(pixelSize, 16));
     if (!m_memory)
     {
         Release();
         return E_OUTOFMEMORY;
     }
+    m_memoryAllocator = allocator;
     memset(m_memory, 0, pixelSize);
     m_size = pixelSize;
 
@@ -487,12 +821,14 @@ HRESULT ScratchImage::Initialize3D(DXGI_FORMAT fmt, size_t width, size_t height,
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    IAllocator* allocator = (m_allocator) ? m_allocator : GetDefaultAllocator();
+    m_memory = static_cast<uint8_t*>(allocator->Allocate(pixelSize, 16));
     if (!m_memory)
     {
         Release();
         return E_OUTOFMEMORY;
     }
+    m_memoryAllocator = allocator;
     memset(m_memory, 0, pixelSize);
     m_size = pixelSize;
 
@@ -696,9 +1032,6 @@ HRESULT ScratchImage::Initialize3DFromImages(const Image* images, size_t depth,
 
 void ScratchImage::Release() noexcept
 {
-    m_nimages = 0;
-    m_size = 0;
-
     if (m_image)
     {
         delete[] m_image;
@@ -707,10 +1040,18 @@ void ScratchImage::Release() noexcept
 
     if (m_memory)
     {
-        _aligned_free(m_memory);
+        // Views created by InitializeFromMemory without an owner don't free the pixels
+        if (m_memoryAllocator)
+        {
+            m_memoryAllocator->Free(m_memory, m_size);
+        }
         m_memory = nullptr;
     }
 
+    m_memoryAllocator = nullptr;
+    m_nimages = 0;
+    m_size = 0;
+
     memset(&m_metadata, 0, sizeof(m_metadata));
 }
 
@@ -793,46 +1134,16 @@ bool ScratchImage::IsAlphaAllOpaque() const noexcept
     if (!HasAlpha(m_metadata.format))
         return true;
 
-    if (IsCompressed(m_metadata.format))
+    for (size_t index = 0; index < m_nimages; ++index)
     {
-        for (size_t index = 0; index < m_nimages; ++index)
+        if (IsCompressed(m_metadata.format))
         {
             if (!IsAlphaAllOpaqueBC(m_image[index]))
                 return false;
         }
-    }
-    else
-    {
-        auto scanline = make_AlignedArrayXMVECTOR(m_metadata.width);
-        if (!scanline)
-            return false;
-
-        static const XMVECTORF32 threshold = { { { 0.997f, 0.997f, 0.997f, 0.997f } } };
-
-        for (size_t index = 0; index < m_nimages; ++index)
+        else if (!IsAlphaAllOpaqueImage(m_image[index]))
         {
-        #pragma warning( suppress : 6011 )
-            const Image& img = m_image[index];
-
-            const uint8_t *pPixels = img.pixels;
-            assert(pPixels);
-
-            for (size_t h = 0; h < img.height; ++h)
-            {
-                if (!LoadScanline(scanline.get(), img.width, pPixels, img.rowPitch, img.format))
-                    return false;
-
-                const XMVECTOR* ptr = scanline.get();
-                for (size_t w = 0; w < img.width; ++w)
-                {
-                    const XMVECTOR alpha = XMVectorSplatW(*ptr);
-                    if (XMVector4Less(alpha, threshold))
-                        return false;
-                    ++ptr;
-                }
-
-                pPixels += img.rowPitch;
-            }
+            return false;
         }
     }
 
@@ -0,0 +1,356 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexMetadata.cpp
+//
+// DirectX Texture Library - Batch metadata scanner
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace DirectX;
+using namespace DirectX::Internal;
+
+namespace
+{
+    // DDS (including the DX10 extension) and TGA headers fit in a single page
+    constexpr size_t PROBE_READ_SIZE = 4096;
+
+    // Matches the amount GetMetadataFromHDRFile reads to find the end of the text header
+    constexpr size_t PROBE_READ_SIZE_HDR = 8192;
+
+    // Probing is latency bound, so use more threads than cores to keep requests in flight
+    constexpr size_t PROBE_THREADS_PER_CORE = 4;
+    constexpr size_t PROBE_MIN_THREADS = 8;
+    constexpr size_t PROBE_MAX_THREADS = 64;
+
+    enum PROBE_TYPE
+    {
+        PROBE_UNKNOWN = 0,
+        PROBE_DDS,
+        PROBE_TGA,
+        PROBE_HDR,
+    };
+
+    bool IsExtension(const wchar_t* ext, const wchar_t* match) noexcept
+    {
+        for (; *ext && *match; ++ext, ++match)
+        {
+            wchar_t c = *ext;
+            if (c >= L'A' && c <= L'Z')
+                c = static_cast<wchar_t>(c - L'A' + L'a');
+
+            if (c != *match)
+                return false;
+        }
+
+        return (*ext == 0 && *match == 0);
+    }
+
+    PROBE_TYPE GetProbeType(_In_z_ const wchar_t* szFile) noexcept
+    {
+        const wchar_t* ext = wcsrchr(szFile, L'.');
+        if (!ext || wcschr(ext, L'/') || wcschr(ext, L'\\'))
+            return PROBE_UNKNOWN;
+
+        if (IsExtension(ext, L".dds"))
+            return PROBE_DDS;
+        else if (IsExtension(ext, L".tga"))
+            return PROBE_TGA;
+        else if (IsExtension(ext, L".hdr"))
+            return PROBE_HDR;
+
+        return PROBE_UNKNOWN;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Read-only file handle supporting positioned reads
+    //-------------------------------------------------------------------------------------
+    class ProbeFile
+    {
+    public:
+        ProbeFile() noexcept :
+            m_size(0)
+        #ifndef _WIN32
+            , m_fd(-1)
+        #endif
+        {
+        }
+
+        ProbeFile(const ProbeFile&) = delete;
+        ProbeFile& operator=(const ProbeFile&) = delete;
+
+        ~ProbeFile()
+        {
+        #ifndef _WIN32
+            if (m_fd != -1)
+                close(m_fd);
+        #endif
+        }
+
+        HRESULT Open(_In_z_ const wchar_t* szFile) noexcept
+        {
+        #ifdef _WIN32
+        #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            m_hFile.reset(safe_handle(CreateFile2(szFile, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr)));
+        #else
+            m_hFile.reset(safe_handle(CreateFileW(szFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                FILE_FLAG_RANDOM_ACCESS, nullptr)));
+        #endif
+            if (!m_hFile)
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            FILE_STANDARD_INFO fileInfo;
+            if (!GetFileInformationByHandleEx(m_hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            m_size = static_cast<uint64_t>(fileInfo.EndOfFile.QuadPart);
+        #else // !WIN32
+            const std::filesystem::path path(szFile);
+            m_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (m_fd == -1)
+                return E_FAIL;
+
+            struct stat st = {};
+            if (fstat(m_fd, &st) != 0)
+                return E_FAIL;
+
+            m_size = static_cast<uint64_t>(st.st_size);
+        #endif
+
+            return S_OK;
+        }
+
+        bool ReadAt(uint64_t offset, _Out_writes_bytes_(bytes) void* buffer, size_t bytes) noexcept
+        {
+            if (offset > m_size || bytes > (m_size - offset))
+                return false;
+
+        #ifdef _WIN32
+            if (bytes > UINT32_MAX)
+                return false;
+
+            OVERLAPPED ov = {};
+            ov.Offset = static_cast<DWORD>(offset);
+            ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+            DWORD bytesRead = 0;
+            if (!ReadFile(m_hFile.get(), buffer, static_cast<DWORD>(bytes), &bytesRead, &ov))
+                return false;
+
+            return (bytesRead == bytes);
+        #else
+            auto ptr = static_cast<uint8_t*>(buffer);
+            while (bytes > 0)
+            {
+                const ssize_t result = pread(m_fd, ptr, bytes, static_cast<off_t>(offset));
+                if (result < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+
+                    return false;
+                }
+
+                if (result == 0)
+                    return false;
+
+                ptr += result;
+                offset += static_cast<uint64_t>(result);
+                bytes -= static_cast<size_t>(result);
+            }
+
+            return true;
+        #endif
+        }
+
+        static bool __cdecl ReadAtCallback(void* context, uint64_t offset, void* buffer, size_t bytes) noexcept
+        {
+            return static_cast<ProbeFile*>(context)->ReadAt(offset, buffer, bytes);
+        }
+
+        uint64_t GetSize() const noexcept { return m_size; }
+
+    private:
+        uint64_t        m_size;
+    #ifdef _WIN32
+        ScopedHandle    m_hFile;
+    #else
+        int             m_fd;
+    #endif
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Probe a single file
+    //-------------------------------------------------------------------------------------
+    HRESULT ProbeMetadata(
+        _In_z_ const wchar_t* szFile,
+        DDS_FLAGS ddsFlags,
+        TGA_FLAGS tgaFlags,
+        _Out_writes_bytes_(PROBE_READ_SIZE_HDR) uint8_t* buffer,
+        TexMetadata& metadata) noexcept
+    {
+        const PROBE_TYPE type = GetProbeType(szFile);
+        if (type == PROBE_UNKNOWN)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        ProbeFile file;
+        HRESULT hr = file.Open(szFile);
+        if (FAILED(hr))
+            return hr;
+
+        // File is too big for 32-bit allocation, so reject read (matches the GetMetadataFrom*File functions)
+        if (file.GetSize() > UINT32_MAX)
+            return HRESULT_E_FILE_TOO_LARGE;
+
+        if (!file.GetSize())
+            return E_FAIL;
+
+        const size_t readSize = (type == PROBE_HDR) ? PROBE_READ_SIZE_HDR : PROBE_READ_SIZE;
+        const size_t len = static_cast<size_t>(std::min<uint64_t>(file.GetSize(), readSize));
+        if (!file.ReadAt(0, buffer, len))
+            return E_FAIL;
+
+        switch (type)
+        {
+        case PROBE_DDS:
+            return GetMetadataFromDDSMemory(buffer, len, ddsFlags, metadata);
+
+        case PROBE_TGA:
+            return GetMetadataFromTGAReader(buffer, len, file.GetSize(), ProbeFile::ReadAtCallback, &file, tgaFlags, metadata);
+
+        case PROBE_HDR:
+            return GetMetadataFromHDRMemory(buffer, len, metadata);
+
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Worker loop; each thread pulls the next file index until the list is exhausted
+    //-------------------------------------------------------------------------------------
+    void ProbeWorker(
+        _In_reads_(nfiles) const wchar_t* const* szFiles,
+        size_t nfiles,
+        DDS_FLAGS ddsFlags,
+        TGA_FLAGS tgaFlags,
+        _Out_writes_all_(nfiles) TexMetadata* metadata,
+        _Out_writes_all_(nfiles) HRESULT* results,
+        std::atomic<size_t>& next) noexcept
+    {
+        std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[PROBE_READ_SIZE_HDR]);
+
+        for (;;)
+        {
+            const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= nfiles)
+                break;
+
+            memset(&metadata[index], 0, sizeof(TexMetadata));
+
+            if (!szFiles[index])
+            {
+                results[index] = E_INVALIDARG;
+            }
+            else if (!buffer)
+            {
+                results[index] = E_OUTOFMEMORY;
+            }
+            else
+            {
+                results[index] = ProbeMetadata(szFiles[index], ddsFlags, tgaFlags, buffer.get(), metadata[index]);
+            }
+        }
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Obtain metadata for a list of files
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GetMetadataFromFiles(
+    const wchar_t* const* szFiles,
+    size_t nfiles,
+    DDS_FLAGS ddsFlags,
+    TGA_FLAGS tgaFlags,
+    TexMetadata* metadata,
+    HRESULT* results,
+    size_t maxThreads) noexcept
+{
+    if (!szFiles || !metadata || !results)
+        return E_INVALIDARG;
+
+    if (!nfiles)
+        return S_OK;
+
+    // Probing is I/O bound, so the pool oversubscribes the policy's processors but never exceeds its thread cap
+    const WorkerThreads policy;
+    if (!maxThreads)
+    {
+        const size_t cores = static_cast<size_t>(std::max(policy.Count(), 1));
+        maxThreads = std::min<size_t>(std::max<size_t>(cores * PROBE_THREADS_PER_CORE, PROBE_MIN_THREADS), PROBE_MAX_THREADS);
+    }
+
+    if (policy.Limit())
+    {
+        maxThreads = std::min(maxThreads, policy.Limit());
+    }
+
+    const size_t nthreads = std::min<size_t>(maxThreads, nfiles);
+
+    std::atomic<size_t> next(0);
+
+    // The calling thread is one of the workers; if a thread can't be created the rest carry the load
+    std::vector<std::thread> workers;
+    try
+    {
+        workers.reserve(nthreads - 1);
+        for (size_t j = 1; j < nthreads; ++j)
+        {
+            workers.emplace_back([&]()
+                {
+                    const WorkerAffinity affinity(policy);
+                    ProbeWorker(szFiles, nfiles, ddsFlags, tgaFlags, metadata, results, next);
+                });
+        }
+    }
+    catch (...)
+    {
+    }
+
+    {
+        const WorkerAffinity affinity(policy);
+        ProbeWorker(szFiles, nfiles, ddsFlags, tgaFlags, metadata, results, next);
+    }
+
+    for (auto& it : workers)
+    {
+        it.join();
+    }
+
+    return S_OK;
+}
@@ -707,7 +707,8 @@ namespace
         _In_ size_t levels,
         _In_ const WICPixelFormatGUID& pfGUID,
         _In_ const ScratchImage& mipChain,
-        _In_ size_t item) noexcept
+        _In_ size_t item,
+        ProgressTracker& progress) noexcept
     {
         assert(levels > 1);
 
@@ -839,6 +840,9 @@ namespace
                         return hr;
                 }
             }
+
+            if (!progress.Advance(height))
+                return E_ABORT;
         }
 
         return S_OK;
@@ -846,6 +850,25 @@ namespace
 #endif // WIN32
 
 
+    //-------------------------------------------------------------------------------------
+    // Progress is reported in rows written to the generated levels (rows x slices for volumes)
+    size_t CountMipRows(size_t height, size_t depth, size_t levels) noexcept
+    {
+        size_t rows = 0;
+        for (size_t level = 1; level < levels; ++level)
+        {
+            if (height > 1)
+                height >>= 1;
+
+            if (depth > 1)
+                depth >>= 1;
+
+            rows += height * depth;
+        }
+        return rows;
+    }
+
+
     //-------------------------------------------------------------------------------------
     // Generate (1D/2D) mip-map helpers (custom filtering)
     //-------------------------------------------------------------------------------------
@@ -905,7 +928,8 @@ namespace
     }
 
     //--- 2D Point Filter ---
-    HRESULT Generate2DMipsPointFilter(size_t levels, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsPointFilter(size_t levels, const ScratchImage& mipChain, size_t item,
+        ProgressTracker& progress) noexcept
     {
         if (!mipChain.GetImages())
             return E_INVALIDARG;
@@ -975,6 +999,9 @@ namespace
                 pDest += dest->rowPitch;
 
                 sy += yinc;
+
+                if (!progress.Advance(1))
+                    return E_ABORT;
             }
 
             if (height > 1)
@@ -989,7 +1016,8 @@ namespace
 
 
     //--- 2D Box Filter ---
-    HRESULT Generate2DMipsBoxFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsBoxFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -1071,6 +1099,9 @@ namespace
                 if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                     return E_FAIL;
                 pDest += dest->rowPitch;
+
+                if (!progress.Advance(1))
+                    return E_ABORT;
             }
 
             if (height > 1)
@@ -1085,7 +1116,8 @@ namespace
 
 
     //--- 2D Linear Filter ---
-    HRESULT Generate2DMipsLinearFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsLinearFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -1185,6 +1217,9 @@ namespace
                 if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                     return E_FAIL;
                 pDest += dest->rowPitch;
+
+                if (!progress.Advance(1))
+                    return E_ABORT;
             }
 
             if (height > 1)
@@ -1202,7 +1237,8 @@ namespace
 #pragma clang diagnostic ignored "-Wextra-semi-stmt"
 #endif
 
-    HRESULT Generate2DMipsCubicFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsCubicFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -1376,6 +1412,9 @@ namespace
                 if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                     return E_FAIL;
                 pDest += dest->rowPitch;
+
+                if (!progress.Advance(1))
+                    return E_ABORT;
             }
 
             if (height > 1)
@@ -1390,7 +1429,8 @@ namespace
 
 
     //--- 2D Triangle Filter ---
-    HRESULT Generate2DMipsTriangleFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsTriangleFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -1586,6 +1626,9 @@ namespace
                         // Put row on freelist to reuse it's allocated scanline
                         rowAcc->next = rowFree;
                         rowFree = rowAcc;
+
+                        if (!progress.Advance(1))
+                            return E_ABORT;
                     }
                 }
 
@@ -1661,7 +1704,8 @@ namespace
 
 
     //--- 3D Point Filter ---
-    HRESULT Generate3DMipsPointFilter(size_t depth, size_t levels, const ScratchImage& mipChain) noexcept
+    HRESULT Generate3DMipsPointFilter(size_t depth, size_t levels, const ScratchImage& mipChain,
+        ProgressTracker& progress) noexcept
     {
         if (!depth || !mipChain.GetImages())
             return E_INVALIDARG;
@@ -1740,6 +1784,9 @@ namespace
                         pDest += dest->rowPitch;
 
                         sy += yinc;
+
+                        if (!progress.Advance(1))
+                            return E_ABORT;
                     }
 
                     sz += zinc;
@@ -1789,6 +1836,9 @@ namespace
                     pDest += dest->rowPitch;
 
                     sy += yinc;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
 
@@ -1807,7 +1857,8 @@ namespace
 
 
     //--- 3D Box Filter ---
-    HRESULT Generate3DMipsBoxFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    HRESULT Generate3DMipsBoxFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -1920,6 +1971,9 @@ namespace
                         if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                             return E_FAIL;
                         pDest += dest->rowPitch;
+
+                        if (!progress.Advance(1))
+                            return E_ABORT;
                     }
                 }
             }
@@ -1963,6 +2017,9 @@ namespace
                     if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                         return E_FAIL;
                     pDest += dest->rowPitch;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
 
@@ -1981,7 +2038,8 @@ namespace
 
 
     //--- 3D Linear Filter ---
-    HRESULT Generate3DMipsLinearFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    HRESULT Generate3DMipsLinearFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -2098,6 +2156,9 @@ namespace
                         if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                             return E_FAIL;
                         pDest += dest->rowPitch;
+
+                        if (!progress.Advance(1))
+                            return E_ABORT;
                     }
                 }
             }
@@ -2158,6 +2219,9 @@ namespace
                     if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                         return E_FAIL;
                     pDest += dest->rowPitch;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
 
@@ -2176,7 +2240,8 @@ namespace
 
 
     //--- 3D Cubic Filter ---
-    HRESULT Generate3DMipsCubicFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    HRESULT Generate3DMipsCubicFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -2410,6 +2475,9 @@ namespace
                         if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                             return E_FAIL;
                         pDest += dest->rowPitch;
+
+                        if (!progress.Advance(1))
+                            return E_ABORT;
                     }
                 }
             }
@@ -2539,6 +2607,9 @@ namespace
                     if (!StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
                         return E_FAIL;
                     pDest += dest->rowPitch;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
 
@@ -2557,7 +2628,8 @@ namespace
 
 
     //--- 3D Triangle Filter ---
-    HRESULT Generate3DMipsTriangleFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    HRESULT Generate3DMipsTriangleFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -2779,6 +2851,9 @@ namespace
                         // Put slice on freelist to reuse it's allocated scanline
                         sliceAcc->next = sliceFree;
                         sliceFree = sliceAcc;
+
+                        if (!progress.Advance(nheight))
+                            return E_ABORT;
                     }
                 }
 
@@ -2813,8 +2888,11 @@ HRESULT DirectX::GenerateMipMaps(
     TEX_FILTER_FLAGS filter,
     size_t levels,
     ScratchImage& mipChain,
-    bool allow1D) noexcept
+    bool allow1D,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_GENERATE_MIPMAPS, baseImage);
+
     if (!IsValid(baseImage.format))
         return E_INVALIDARG;
 
@@ -2834,6 +2912,8 @@ HRESULT DirectX::GenerateMipMaps(
 
     HRESULT hr = E_UNEXPECTED;
 
+    ProgressTracker tracker(progress, CountMipRows(baseImage.height, 1, levels));
+
     static_assert(TEX_FILTER_POINT == 0x100000, "TEX_FILTER_ flag values don't match TEX_FILTER_MODE_MASK");
 
 #ifdef _WIN32
@@ -2878,7 +2958,10 @@ HRESULT DirectX::GenerateMipMaps(
                     if (FAILED(hr))
                         return hr;
 
-                    return GenerateMipMapsUsingWIC(baseImage, filter, levels, pfGUID, mipChain, 0);
+                    hr = GenerateMipMapsUsingWIC(baseImage, filter, levels, pfGUID, mipChain, 0, tracker);
+                    if (FAILED(hr))
+                        mipChain.Release();
+                    return hr;
                 }
                 else
                 {
@@ -2900,7 +2983,7 @@ HRESULT DirectX::GenerateMipMaps(
                     if (FAILED(hr))
                         return hr;
 
-                    hr = GenerateMipMapsUsingWIC(*timg, filter, levels, GUID_WICPixelFormat128bppRGBAFloat, tMipChain, 0);
+                    hr = GenerateMipMapsUsingWIC(*timg, filter, levels, GUID_WICPixelFormat128bppRGBAFloat, tMipChain, 0, tracker);
                     if (FAILED(hr))
                         return hr;
 
@@ -2948,7 +3031,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsBoxFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsBoxFilter(levels, filter, mipChain, 0, tracker);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2958,7 +3041,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsPointFilter(levels, mipChain, 0);
+            hr = Generate2DMipsPointFilter(levels, mipChain, 0, tracker);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2968,7 +3051,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsLinearFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsLinearFilter(levels, filter, mipChain, 0, tracker);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2978,7 +3061,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsCubicFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsCubicFilter(levels, filter, mipChain, 0, tracker);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2988,7 +3071,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, 0, tracker);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -3006,8 +3089,11 @@ HRESULT DirectX::GenerateMipMaps(
     const TexMetadata& metadata,
     TEX_FILTER_FLAGS filter,
     size_t levels,
-    ScratchImage& mipChain)
+    ScratchImage& mipChain,
+    ProgressContext* progress)
 {
+    TEX_TRACE_ZONE(TRACE_OP_GENERATE_MIPMAPS, srcImages, nimages, metadata);
+
     if (!srcImages || !nimages || !IsValid(metadata.format))
         return E_INVALIDARG;
 
@@ -3049,6 +3135,8 @@ HRESULT DirectX::GenerateMipMaps(
     if (baseImages.empty())
         return hr;
 
+    ProgressTracker tracker(progress, CountMipRows(metadata.height, 1, levels) * metadata.arraySize);
+
     static_assert(TEX_FILTER_POINT == 0x100000, "TEX_FILTER_ flag values don't match TEX_FILTER_MODE_MASK");
 
 #ifdef _WIN32
@@ -3095,7 +3183,7 @@ HRESULT DirectX::GenerateMipMaps(
 
                     for (size_t item = 0; item < metadata.arraySize; ++item)
                     {
-                        hr = GenerateMipMapsUsingWIC(baseImages[item], filter, levels, pfGUID, mipChain, item);
+                        hr = GenerateMipMapsUsingWIC(baseImages[item], filter, levels, pfGUID, mipChain, item, tracker);
                         if (FAILED(hr))
                         {
                             mipChain.Release();
@@ -3129,7 +3217,7 @@ HRESULT DirectX::GenerateMipMaps(
                         if (!timg)
                             return E_POINTER;
 
-                        hr = GenerateMipMapsUsingWIC(*timg, filter, levels, GUID_WICPixelFormat128bppRGBAFloat, tMipChain, item);
+                        hr = GenerateMipMapsUsingWIC(*timg, filter, levels, GUID_WICPixelFormat128bppRGBAFloat, tMipChain, item, tracker);
                         if (FAILED(hr))
                             return hr;
                     }
@@ -3165,9 +3253,12 @@ HRESULT DirectX::GenerateMipMaps(
 
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
-                hr = Generate2DMipsBoxFilter(levels, filter, mipChain, item);
+                hr = Generate2DMipsBoxFilter(levels, filter, mipChain, item, tracker);
                 if (FAILED(hr))
+                {
                     mipChain.Release();
+                    return hr;
+                }
             }
             return hr;
 
@@ -3178,9 +3269,12 @@ HRESULT DirectX::GenerateMipMaps(
 
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
-                hr = Generate2DMipsPointFilter(levels, mipChain, item);
+                hr = Generate2DMipsPointFilter(levels, mipChain, item, tracker);
                 if (FAILED(hr))
+                {
                     mipChain.Release();
+                    return hr;
+                }
             }
             return hr;
 
@@ -3191,9 +3285,12 @@ HRESULT DirectX::GenerateMipMaps(
 
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
-                hr = Generate2DMipsLinearFilter(levels, filter, mipChain, item);
+                hr = Generate2DMipsLinearFilter(levels, filter, mipChain, item, tracker);
                 if (FAILED(hr))
+                {
                     mipChain.Release();
+                    return hr;
+                }
             }
             return hr;
 
@@ -3204,9 +3301,12 @@ HRESULT DirectX::GenerateMipMaps(
 
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
-                hr = Generate2DMipsCubicFilter(levels, filter, mipChain, item);
+                hr = Generate2DMipsCubicFilter(levels, filter, mipChain, item, tracker);
                 if (FAILED(hr))
+                {
                     mipChain.Release();
+                    return hr;
+                }
             }
             return hr;
 
@@ -3217,9 +3317,12 @@ HRESULT DirectX::GenerateMipMaps(
 
             for (size_t item = 0; item < metadata.arraySize; ++item)
             {
-                hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, item);
+                hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, item, tracker);
                 if (FAILED(hr))
+                {
                     mipChain.Release();
+                    return hr;
+                }
             }
             return hr;
 
@@ -3239,11 +3342,14 @@ HRESULT DirectX::GenerateMipMaps3D(
     size_t depth,
     TEX_FILTER_FLAGS filter,
     size_t levels,
-    ScratchImage& mipChain) noexcept
+    ScratchImage& mipChain,
+    ProgressContext* progress) noexcept
 {
     if (!baseImages || !depth)
         return E_INVALIDARG;
 
+    TEX_TRACE_ZONE(TRACE_OP_GENERATE_MIPMAPS, baseImages[0]);
+
     if (filter & TEX_FILTER_FORCE_WIC)
         return HRESULT_E_NOT_SUPPORTED;
 
@@ -3276,6 +3382,8 @@ HRESULT DirectX::GenerateMipMaps3D(
 
     HRESULT hr = E_UNEXPECTED;
 
+    ProgressTracker tracker(progress, CountMipRows(height, depth, levels));
+
     unsigned long filter_select = (filter & TEX_FILTER_MODE_MASK);
     if (!filter_select)
     {
@@ -3290,7 +3398,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsBoxFilter(depth, levels, filter, mipChain);
+        hr = Generate3DMipsBoxFilter(depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3300,7 +3408,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsPointFilter(depth, levels, mipChain);
+        hr = Generate3DMipsPointFilter(depth, levels, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3310,7 +3418,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsLinearFilter(depth, levels, filter, mipChain);
+        hr = Generate3DMipsLinearFilter(depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3320,7 +3428,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsCubicFilter(depth, levels, filter, mipChain);
+        hr = Generate3DMipsCubicFilter(depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3330,7 +3438,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsTriangleFilter(depth, levels, filter, mipChain);
+        hr = Generate3DMipsTriangleFilter(depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3347,8 +3455,11 @@ HRESULT DirectX::GenerateMipMaps3D(
     const TexMetadata& metadata,
     TEX_FILTER_FLAGS filter,
     size_t levels,
-    ScratchImage& mipChain)
+    ScratchImage& mipChain,
+    ProgressContext* progress)
 {
+    TEX_TRACE_ZONE(TRACE_OP_GENERATE_MIPMAPS, srcImages, nimages, metadata);
+
     if (!srcImages || !nimages || !IsValid(metadata.format))
         return E_INVALIDARG;
 
@@ -3390,6 +3501,8 @@ HRESULT DirectX::GenerateMipMaps3D(
 
     HRESULT hr = E_UNEXPECTED;
 
+    ProgressTracker tracker(progress, CountMipRows(metadata.height, metadata.depth, levels));
+
     static_assert(TEX_FILTER_POINT == 0x100000, "TEX_FILTER_ flag values don't match TEX_FILTER_MODE_MASK");
 
     unsigned long filter_select = (filter & TEX_FILTER_MODE_MASK);
@@ -3406,7 +3519,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsBoxFilter(metadata.depth, levels, filter, mipChain);
+        hr = Generate3DMipsBoxFilter(metadata.depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3416,7 +3529,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsPointFilter(metadata.depth, levels, mipChain);
+        hr = Generate3DMipsPointFilter(metadata.depth, levels, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3426,7 +3539,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsLinearFilter(metadata.depth, levels, filter, mipChain);
+        hr = Generate3DMipsLinearFilter(metadata.depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3436,7 +3549,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsCubicFilter(metadata.depth, levels, filter, mipChain);
+        hr = Generate3DMipsCubicFilter(metadata.depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -3446,7 +3559,7 @@ HRESULT DirectX::GenerateMipMaps3D(
         if (FAILED(hr))
             return hr;
 
-        hr = Generate3DMipsTriangleFilter(metadata.depth, levels, filter, mipChain);
+        hr = Generate3DMipsTriangleFilter(metadata.depth, levels, filter, mipChain, tracker);
         if (FAILED(hr))
             mipChain.Release();
         return hr;
@@ -11,6 +11,9 @@
 
 #include "DirectXTexP.h"
 
+#include <cfloat>
+#include <cmath>
+
 using namespace DirectX;
 using namespace DirectX::Internal;
 
@@ -23,6 +26,254 @@ namespace
 {
     const XMVECTORF32 g_Gamma22 = { { { 2.2f, 2.2f, 2.2f, 1.f } } };
 
+    // Rows summed per partial result; fixed so the reduction order never depends on the thread count
+    constexpr size_t MSE_BAND_ROWS = 64;
+
+    // Rows decoded per batch by EvaluateImage before the callback sees them
+    constexpr size_t EVALUATE_CHUNK_ROWS = 64;
+    constexpr size_t EVALUATE_CHUNK_BYTES = 16 * 1024 * 1024;
+
+    // Smaller images are not worth starting worker threads for
+    constexpr size_t PARALLEL_MIN_PIXELS = 64 * 1024;
+
+    //-------------------------------------------------------------------------------------
+    // Comparison flags implied from an image format
+    //-------------------------------------------------------------------------------------
+    CMSE_FLAGS GetImpliedFlags(DXGI_FORMAT format, CMSE_FLAGS srgb) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            return CMSE_IGNORE_ALPHA;
+
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return srgb | CMSE_IGNORE_ALPHA;
+
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return srgb;
+
+        default:
+            return CMSE_DEFAULT;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // 8-bit UNORM images with the same channel order can be compared exactly with integers
+    //-------------------------------------------------------------------------------------
+    bool IsIntegerMSE(DXGI_FORMAT format1, DXGI_FORMAT format2, CMSE_FLAGS flags) noexcept
+    {
+        if (flags & (CMSE_IMAGE1_SRGB | CMSE_IMAGE2_SRGB | CMSE_IMAGE1_X2_BIAS | CMSE_IMAGE2_X2_BIAS))
+            return false;
+
+        switch (format1)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            return (format2 == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            // The X8 alpha is always ignored by the implied flags
+            return (format2 == DXGI_FORMAT_B8G8R8A8_UNORM || format2 == DXGI_FORMAT_B8G8R8X8_UNORM);
+
+        default:
+            return false;
+        }
+    }
+
+    // Adds the squared difference of each byte channel for one row of 4-byte pixels
+    void SquaredErrorUNORM8(
+        _In_reads_bytes_(width * 4) const uint8_t* pSrc1,
+        _In_reads_bytes_(width * 4) const uint8_t* pSrc2,
+        size_t width,
+        _Inout_updates_all_(4) uint64_t* sums) noexcept
+    {
+        size_t i = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m128i zero = _mm_setzero_si128();
+        while (i + 4 <= width)
+        {
+            // Each 32-bit lane grows by at most 4 * 255^2 per step, so flush to 64-bit before it can wrap
+            const size_t steps = std::min<size_t>((width - i) / 4, 16384);
+
+            __m128i acc = zero;
+            for (size_t j = 0; j < steps; ++j, i += 4)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc1 + i * 4));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc2 + i * 4));
+
+                // |a - b| per byte, then squared in 16-bit lanes (255^2 still fits unsigned)
+                const __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+                const __m128i lo = _mm_unpacklo_epi8(diff, zero);
+                const __m128i hi = _mm_unpackhi_epi8(diff, zero);
+                const __m128i sqlo = _mm_mullo_epi16(lo, lo);
+                const __m128i sqhi = _mm_mullo_epi16(hi, hi);
+
+                acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(sqlo, zero));
+                acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(sqlo, zero));
+                acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(sqhi, zero));
+                acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(sqhi, zero));
+            }
+
+            XM_ALIGNED_DATA(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            sums[0] += lanes[0];
+            sums[1] += lanes[1];
+            sums[2] += lanes[2];
+            sums[3] += lanes[3];
+        }
+    #endif
+
+        for (; i < width; ++i)
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                const int d = int(pSrc1[i * 4 + c]) - int(pSrc2[i * 4 + c]);
+                sums[c] += uint64_t(d * d);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Sums the squared error for rows [y0, y1) in RGBA channel order
+    //-------------------------------------------------------------------------------------
+    void SumBandUNORM8(
+        const Image& image1,
+        const Image& image2,
+        size_t y0,
+        size_t y1,
+        CMSE_FLAGS flags,
+        _Out_writes_(4) double* sums) noexcept
+    {
+        uint64_t isums[4] = {};
+        for (size_t y = y0; y < y1; ++y)
+        {
+            SquaredErrorUNORM8(image1.pixels + y * image1.rowPitch, image2.pixels + y * image2.rowPitch, image1.width, isums);
+        }
+
+        if (image1.format != DXGI_FORMAT_R8G8B8A8_UNORM)
+        {
+            // BGRA byte order
+            std::swap(isums[0], isums[2]);
+        }
+
+        // Scale back to the [0,1] range used by the floating-point path
+        constexpr double scale = 1.0 / (255.0 * 255.0);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            sums[c] = double(isums[c]) * scale;
+        }
+
+        if (flags & CMSE_IGNORE_RED)
+            sums[0] = 0.0;
+        if (flags & CMSE_IGNORE_GREEN)
+            sums[1] = 0.0;
+        if (flags & CMSE_IGNORE_BLUE)
+            sums[2] = 0.0;
+        if (flags & CMSE_IGNORE_ALPHA)
+            sums[3] = 0.0;
+    }
+
+    bool SumBand(
+        const Image& image1,
+        const Image& image2,
+        size_t y0,
+        size_t y1,
+        CMSE_FLAGS flags,
+        _Inout_updates_(image1.width * 2) XMVECTOR* scanline,
+        _Out_writes_(4) double* sums) noexcept
+    {
+        static const XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+
+        const size_t width = image1.width;
+
+        // Hoist the per-pixel flag tests out of the inner loop
+        const XMVECTOR scale1 = (flags & CMSE_IMAGE1_X2_BIAS) ? two.v : g_XMOne.v;
+        const XMVECTOR bias1 = (flags & CMSE_IMAGE1_X2_BIAS) ? g_XMNegativeOne.v : g_XMZero.v;
+        const XMVECTOR scale2 = (flags & CMSE_IMAGE2_X2_BIAS) ? two.v : g_XMOne.v;
+        const XMVECTOR bias2 = (flags & CMSE_IMAGE2_X2_BIAS) ? g_XMNegativeOne.v : g_XMZero.v;
+
+        const XMVECTOR keep = XMVectorSelectControl(
+            (flags & CMSE_IGNORE_RED) ? 0u : 1u,
+            (flags & CMSE_IGNORE_GREEN) ? 0u : 1u,
+            (flags & CMSE_IGNORE_BLUE) ? 0u : 1u,
+            (flags & CMSE_IGNORE_ALPHA) ? 0u : 1u);
+
+        sums[0] = sums[1] = sums[2] = sums[3] = 0.0;
+
+        XMVECTOR* ptr1 = scanline;
+        XMVECTOR* ptr2 = scanline + width;
+
+        const LoadScanlineFunc pfnLoad1 = GetLoadScanline(image1.format);
+        const LoadScanlineFunc pfnLoad2 = GetLoadScanline(image2.format);
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            if (!pfnLoad1(ptr1, width, image1.pixels + y * image1.rowPitch, image1.rowPitch, image1.format))
+                return false;
+
+            if (!pfnLoad2(ptr2, width, image2.pixels + y * image2.rowPitch, image2.rowPitch, image2.format))
+                return false;
+
+            if (flags & CMSE_IMAGE1_SRGB)
+            {
+                for (size_t i = 0; i < width; ++i)
+                {
+                    ptr1[i] = XMVectorPow(ptr1[i], g_Gamma22);
+                }
+            }
+
+            if (flags & CMSE_IMAGE2_SRGB)
+            {
+                for (size_t i = 0; i < width; ++i)
+                {
+                    ptr2[i] = XMVectorPow(ptr2[i], g_Gamma22);
+                }
+            }
+
+            // sum[ (I1 - I2)^2 ], using two accumulators to keep the multiply-adds independent
+            XMVECTOR acc0 = g_XMZero;
+            XMVECTOR acc1 = g_XMZero;
+
+            size_t i = 0;
+            for (; i + 1 < width; i += 2)
+            {
+                const XMVECTOR v1a = XMVectorMultiplyAdd(ptr1[i], scale1, bias1);
+                const XMVECTOR v2a = XMVectorMultiplyAdd(ptr2[i], scale2, bias2);
+                const XMVECTOR va = XMVectorAndInt(XMVectorSubtract(v1a, v2a), keep);
+                acc0 = XMVectorMultiplyAdd(va, va, acc0);
+
+                const XMVECTOR v1b = XMVectorMultiplyAdd(ptr1[i + 1], scale1, bias1);
+                const XMVECTOR v2b = XMVectorMultiplyAdd(ptr2[i + 1], scale2, bias2);
+                const XMVECTOR vb = XMVectorAndInt(XMVectorSubtract(v1b, v2b), keep);
+                acc1 = XMVectorMultiplyAdd(vb, vb, acc1);
+            }
+
+            if (i < width)
+            {
+                const XMVECTOR v1 = XMVectorMultiplyAdd(ptr1[i], scale1, bias1);
+                const XMVECTOR v2 = XMVectorMultiplyAdd(ptr2[i], scale2, bias2);
+                const XMVECTOR v = XMVectorAndInt(XMVectorSubtract(v1, v2), keep);
+                acc0 = XMVectorMultiplyAdd(v, v, acc0);
+            }
+
+            // Rows are carried in double so long images don't lose precision
+            XMFLOAT4 row;
+            XMStoreFloat4(&row, XMVectorAdd(acc0, acc1));
+            sums[0] += double(row.x);
+            sums[1] += double(row.y);
+            sums[2] += double(row.z);
+            sums[3] += double(row.w);
+        }
+
+        return true;
+    }
+
     //-------------------------------------------------------------------------------------
     HRESULT ComputeMSE_(
         const Image& image1,
@@ -37,179 +288,1018 @@ namespace
         assert(image1.width == image2.width && image1.height == image2.height);
         assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
 
+        flags |= GetImpliedFlags(image1.format, CMSE_IMAGE1_SRGB) | GetImpliedFlags(image2.format, CMSE_IMAGE2_SRGB);
+
         const size_t width = image1.width;
+        const size_t height = image1.height;
+        const bool integer = IsIntegerMSE(image1.format, image2.format, flags);
 
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
-        if (!scanline)
+        const size_t nbands = (height + MSE_BAND_ROWS - 1) / MSE_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::unique_ptr<double[]> partials(new (std::nothrow) double[nbands * 4]);
+        if (!partials)
             return E_OUTOFMEMORY;
 
-        // Flags implied from image formats
-        switch (image1.format)
+        std::atomic<bool> fail(false);
+        std::atomic<bool> oom(false);
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (nbands > 1 && width * height >= PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
         {
-        case DXGI_FORMAT_B8G8R8X8_UNORM:
-            flags |= CMSE_IGNORE_ALPHA;
-            break;
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+        #endif
 
-        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            flags |= CMSE_IMAGE1_SRGB | CMSE_IGNORE_ALPHA;
-            break;
+            ScopedAlignedArrayXMVECTOR scanline;
+            if (!integer)
+            {
+                scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+                if (!scanline)
+                    oom = true;
+            }
 
-        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-        case DXGI_FORMAT_BC1_UNORM_SRGB:
-        case DXGI_FORMAT_BC2_UNORM_SRGB:
-        case DXGI_FORMAT_BC3_UNORM_SRGB:
-        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-        case DXGI_FORMAT_BC7_UNORM_SRGB:
-            flags |= CMSE_IMAGE1_SRGB;
-            break;
+        #ifdef _OPENMP
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                const size_t y0 = size_t(band) * MSE_BAND_ROWS;
+                const size_t y1 = std::min(y0 + MSE_BAND_ROWS, height);
+                double* sums = partials.get() + size_t(band) * 4;
 
-        default:
-            break;
+                if (integer)
+                {
+                    SumBandUNORM8(image1, image2, y0, y1, flags, sums);
+                }
+                else if (!scanline || !SumBand(image1, image2, y0, y1, flags, scanline.get(), sums))
+                {
+                    fail = true;
+                }
+            }
         }
 
-        switch (image2.format)
-        {
-        case DXGI_FORMAT_B8G8R8X8_UNORM:
-            flags |= CMSE_IGNORE_ALPHA;
-            break;
+        if (oom || fail)
+            return (oom) ? E_OUTOFMEMORY : E_FAIL;
 
-        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            flags |= CMSE_IMAGE2_SRGB | CMSE_IGNORE_ALPHA;
-            break;
+        // Bands are reduced in order, so the result is the same for any number of threads
+        double acc[4] = {};
+        for (size_t band = 0; band < nbands; ++band)
+        {
+            const double* sums = partials.get() + band * 4;
+            acc[0] += sums[0];
+            acc[1] += sums[1];
+            acc[2] += sums[2];
+            acc[3] += sums[3];
+        }
 
-        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-        case DXGI_FORMAT_BC1_UNORM_SRGB:
-        case DXGI_FORMAT_BC2_UNORM_SRGB:
-        case DXGI_FORMAT_BC3_UNORM_SRGB:
-        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-        case DXGI_FORMAT_BC7_UNORM_SRGB:
-            flags |= CMSE_IMAGE2_SRGB;
-            break;
+        // MSE = sum[ (I1 - I2)^2 ] / w*h
+        const double d = double(width) * double(height);
+        float _mseV[4];
+        for (size_t c = 0; c < 4; ++c)
+        {
+            _mseV[c] = float(acc[c] / d);
+        }
 
-        default:
-            break;
+        if (mseV)
+        {
+            memcpy(mseV, _mseV, sizeof(_mseV));
         }
 
-        const uint8_t *pSrc1 = image1.pixels;
-        const size_t rowPitch1 = image1.rowPitch;
+        mse = _mseV[0] + _mseV[1] + _mseV[2] + _mseV[3];
 
-        const uint8_t *pSrc2 = image2.pixels;
-        const size_t rowPitch2 = image2.rowPitch;
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Structural similarity (Wang, Bovik, Sheikh & Simoncelli 2004)
+    //-------------------------------------------------------------------------------------
 
-        XMVECTOR acc = g_XMZero;
-        static XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+    // 11-tap Gaussian window with sigma 1.5, normalized to sum to one
+    constexpr size_t SSIM_RADIUS = 5;
+    constexpr size_t SSIM_TAPS = SSIM_RADIUS * 2 + 1;
 
-        for (size_t h = 0; h < image1.height; ++h)
+    const XMVECTORF32 g_SSIMWindow[SSIM_RADIUS + 1] =
+    {
+        { { { 0.266011725f, 0.266011725f, 0.266011725f, 0.266011725f } } },
+        { { { 0.213005538f, 0.213005538f, 0.213005538f, 0.213005538f } } },
+        { { { 0.109360690f, 0.109360690f, 0.109360690f, 0.109360690f } } },
+        { { { 0.036000772f, 0.036000772f, 0.036000772f, 0.036000772f } } },
+        { { { 0.007598758f, 0.007598758f, 0.007598758f, 0.007598758f } } },
+        { { { 0.001028380f, 0.001028380f, 0.001028380f, 0.001028380f } } },
+    };
+
+    constexpr float SSIM_K1 = 0.01f;
+    constexpr float SSIM_K2 = 0.03f;
+
+    // Output rows per partial result; fixed so the reduction order never depends on the thread count
+    constexpr size_t SSIM_BAND_ROWS = 64;
+
+    // Per-scale exponents for MS-SSIM, finest scale first
+    constexpr size_t MSSSIM_SCALES = 5;
+    const float g_MSSSIMWeights[MSSSIM_SCALES] = { 0.0448f, 0.2856f, 0.3001f, 0.2363f, 0.1333f };
+
+    // Filtered quantities per pixel: mean of x, mean of y, mean of x^2, mean of y^2, and mean of xy
+    constexpr size_t SSIM_MOMENTS = 5;
+
+    struct SSIMInput
+    {
+        const Image*    image;
+        CMSE_FLAGS      srgb;
+        CMSE_FLAGS      bias;
+        CMSE_FLAGS      flags;
+        LoadScanlineFunc load;
+    };
+
+    bool LoadSSIMRow(const SSIMInput& input, size_t y, _Out_writes_(input.image->width) XMVECTOR* row) noexcept
+    {
+        const Image& image = *input.image;
+        if (!input.load(row, image.width, image.pixels + y * image.rowPitch, image.rowPitch, image.format))
+            return false;
+
+        if (input.flags & input.srgb)
         {
-            XMVECTOR* ptr1 = scanline.get();
-            if (!LoadScanline(ptr1, width, pSrc1, rowPitch1, image1.format))
-                return E_FAIL;
+            for (size_t x = 0; x < image.width; ++x)
+            {
+                row[x] = XMVectorPow(row[x], g_Gamma22);
+            }
+        }
 
-            XMVECTOR* ptr2 = scanline.get() + width;
-            if (!LoadScanline(ptr2, width, pSrc2, rowPitch2, image2.format))
-                return E_FAIL;
+        if (input.flags & input.bias)
+        {
+            for (size_t x = 0; x < image.width; ++x)
+            {
+                row[x] = XMVectorMultiplyAdd(row[x], g_XMTwo, g_XMNegativeOne);
+            }
+        }
+
+        return true;
+    }
 
-            for (size_t i = 0; i < width; ++i)
+    // Horizontal pass of the window over one row, with edge pixels clamped
+    void FilterSSIMRow(
+        _In_reads_(width) const XMVECTOR* src,
+        _Out_writes_(width) XMVECTOR* dest,
+        size_t width) noexcept
+    {
+        const ptrdiff_t last = ptrdiff_t(width) - 1;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            XMVECTOR acc = XMVectorMultiply(src[x], g_SSIMWindow[0]);
+
+            if (x >= SSIM_RADIUS && x + SSIM_RADIUS < width)
             {
-                XMVECTOR v1 = *(ptr1++);
-                if (flags & CMSE_IMAGE1_SRGB)
+                for (size_t k = 1; k <= SSIM_RADIUS; ++k)
                 {
-                    v1 = XMVectorPow(v1, g_Gamma22);
+                    acc = XMVectorMultiplyAdd(XMVectorAdd(src[x - k], src[x + k]), g_SSIMWindow[k], acc);
                 }
-                if (flags & CMSE_IMAGE1_X2_BIAS)
+            }
+            else
+            {
+                for (size_t k = 1; k <= SSIM_RADIUS; ++k)
+                {
+                    const ptrdiff_t left = std::max<ptrdiff_t>(ptrdiff_t(x) - ptrdiff_t(k), 0);
+                    const ptrdiff_t right = std::min<ptrdiff_t>(ptrdiff_t(x + k), last);
+                    acc = XMVectorMultiplyAdd(XMVectorAdd(src[left], src[right]), g_SSIMWindow[k], acc);
+                }
+            }
+
+            dest[x] = acc;
+        }
+    }
+
+    // Loads source row y and writes its horizontally filtered moments to dest
+    bool FilterSSIMMoments(
+        const SSIMInput& input1,
+        const SSIMInput& input2,
+        size_t y,
+        _Inout_updates_(width * SSIM_MOMENTS) XMVECTOR* temp,
+        _Out_writes_(width * SSIM_MOMENTS) XMVECTOR* dest,
+        size_t width) noexcept
+    {
+        XMVECTOR* a = temp;
+        XMVECTOR* b = temp + width;
+        if (!LoadSSIMRow(input1, y, a) || !LoadSSIMRow(input2, y, b))
+            return false;
+
+        XMVECTOR* aa = temp + width * 2;
+        XMVECTOR* bb = temp + width * 3;
+        XMVECTOR* ab = temp + width * 4;
+        for (size_t x = 0; x < width; ++x)
+        {
+            aa[x] = XMVectorMultiply(a[x], a[x]);
+            bb[x] = XMVectorMultiply(b[x], b[x]);
+            ab[x] = XMVectorMultiply(a[x], b[x]);
+        }
+
+        for (size_t m = 0; m < SSIM_MOMENTS; ++m)
+        {
+            FilterSSIMRow(temp + width * m, dest + width * m, width);
+        }
+
+        return true;
+    }
+
+    struct SSIMTiles
+    {
+        const Image*    image;
+        size_t          tileSize;
+        XMVECTOR        ignore;
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Sums SSIM and contrast-structure for output rows [y0, y1)
+    //-------------------------------------------------------------------------------------
+    bool XM_CALLCONV SumSSIMBand(
+        const SSIMInput& input1,
+        const SSIMInput& input2,
+        size_t y0,
+        size_t y1,
+        FXMVECTOR c1,
+        FXMVECTOR c2,
+        _In_opt_ const SSIMTiles* tiles,
+        _Inout_ XMVECTOR* workspace,
+        _Out_writes_(8) double* sums) noexcept
+    {
+        const size_t width = input1.image->width;
+        const size_t height = input1.image->height;
+        const size_t rowSize = width * SSIM_MOMENTS;
+
+        // Filtered rows are kept in a ring indexed by logical row, so each source row is filtered once per band
+        XMVECTOR* temp = workspace;
+        XMVECTOR* ring = temp + rowSize;
+        XMVECTOR* tileAcc = ring + rowSize * SSIM_TAPS;
+
+        auto slot = [&](ptrdiff_t row) noexcept -> XMVECTOR*
+            {
+                return ring + rowSize * (size_t(row + ptrdiff_t(SSIM_RADIUS)) % SSIM_TAPS);
+            };
+
+        auto filter = [&](ptrdiff_t row) noexcept -> bool
+            {
+                const ptrdiff_t y = std::min<ptrdiff_t>(std::max<ptrdiff_t>(row, 0), ptrdiff_t(height) - 1);
+                return FilterSSIMMoments(input1, input2, size_t(y), temp, slot(row), width);
+            };
+
+        for (ptrdiff_t row = ptrdiff_t(y0) - ptrdiff_t(SSIM_RADIUS); row < ptrdiff_t(y0 + SSIM_RADIUS); ++row)
+        {
+            if (!filter(row))
+                return false;
+        }
+
+        const size_t tilesAcross = (tiles) ? (width + tiles->tileSize - 1) / tiles->tileSize : 0;
+
+        for (size_t m = 0; m < 8; ++m)
+        {
+            sums[m] = 0.0;
+        }
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            if (!filter(ptrdiff_t(y + SSIM_RADIUS)))
+                return false;
+
+            const XMVECTOR* rows[SSIM_TAPS];
+            for (size_t k = 0; k < SSIM_TAPS; ++k)
+            {
+                rows[k] = slot(ptrdiff_t(y + k) - ptrdiff_t(SSIM_RADIUS));
+            }
+
+            if (tiles && !(y % tiles->tileSize))
+            {
+                for (size_t t = 0; t < tilesAcross; ++t)
                 {
-                    v1 = XMVectorMultiplyAdd(v1, two, g_XMNegativeOne);
+                    tileAcc[t] = g_XMZero;
                 }
+            }
+
+            XMVECTOR rowSSIM = g_XMZero;
+            XMVECTOR rowCS = g_XMZero;
 
-                XMVECTOR v2 = *(ptr2++);
-                if (flags & CMSE_IMAGE2_SRGB)
+            for (size_t x = 0; x < width; ++x)
+            {
+                // Vertical pass of the window for each moment
+                XMVECTOR moments[SSIM_MOMENTS];
+                for (size_t m = 0; m < SSIM_MOMENTS; ++m)
                 {
-                    v2 = XMVectorPow(v2, g_Gamma22);
+                    const size_t offset = width * m + x;
+                    XMVECTOR acc = XMVectorMultiply(rows[SSIM_RADIUS][offset], g_SSIMWindow[0]);
+                    for (size_t k = 1; k <= SSIM_RADIUS; ++k)
+                    {
+                        acc = XMVectorMultiplyAdd(
+                            XMVectorAdd(rows[SSIM_RADIUS - k][offset], rows[SSIM_RADIUS + k][offset]), g_SSIMWindow[k], acc);
+                    }
+                    moments[m] = acc;
                 }
-                if (flags & CMSE_IMAGE2_X2_BIAS)
+
+                const XMVECTOR mu1 = moments[0];
+                const XMVECTOR mu2 = moments[1];
+                const XMVECTOR mu11 = XMVectorMultiply(mu1, mu1);
+                const XMVECTOR mu22 = XMVectorMultiply(mu2, mu2);
+                const XMVECTOR mu12 = XMVectorMultiply(mu1, mu2);
+
+                const XMVECTOR sigma11 = XMVectorSubtract(moments[2], mu11);
+                const XMVECTOR sigma22 = XMVectorSubtract(moments[3], mu22);
+                const XMVECTOR sigma12 = XMVectorSubtract(moments[4], mu12);
+
+                // l = (2 mu1 mu2 + C1) / (mu1^2 + mu2^2 + C1), cs = (2 sigma12 + C2) / (sigma1^2 + sigma2^2 + C2)
+                const XMVECTOR l = XMVectorDivide(XMVectorMultiplyAdd(g_XMTwo, mu12, c1), XMVectorAdd(XMVectorAdd(mu11, mu22), c1));
+                const XMVECTOR cs = XMVectorDivide(XMVectorMultiplyAdd(g_XMTwo, sigma12, c2), XMVectorAdd(XMVectorAdd(sigma11, sigma22), c2));
+                const XMVECTOR ssim = XMVectorMultiply(l, cs);
+
+                rowSSIM = XMVectorAdd(rowSSIM, ssim);
+                rowCS = XMVectorAdd(rowCS, cs);
+
+                if (tiles)
                 {
-                    v2 = XMVectorMultiplyAdd(v2, two, g_XMNegativeOne);
+                    XMVECTOR& acc = tileAcc[x / tiles->tileSize];
+                    acc = XMVectorAdd(acc, ssim);
                 }
+            }
 
-                // sum[ (I1 - I2)^2 ]
-                XMVECTOR v = XMVectorSubtract(v1, v2);
-                if (flags & CMSE_IGNORE_RED)
+            // Rows are carried in double so large images don't lose precision
+            XMFLOAT4 s, c;
+            XMStoreFloat4(&s, rowSSIM);
+            XMStoreFloat4(&c, rowCS);
+            sums[0] += double(s.x);
+            sums[1] += double(s.y);
+            sums[2] += double(s.z);
+            sums[3] += double(s.w);
+            sums[4] += double(c.x);
+            sums[5] += double(c.y);
+            sums[6] += double(c.z);
+            sums[7] += double(c.w);
+
+            if (tiles && (!((y + 1) % tiles->tileSize) || (y + 1) == height))
+            {
+                const size_t ty = y / tiles->tileSize;
+                const size_t tileRows = y - ty * tiles->tileSize + 1;
+
+                auto dest = reinterpret_cast<XMFLOAT4*>(tiles->image->pixels + ty * tiles->image->rowPitch);
+                for (size_t t = 0; t < tilesAcross; ++t)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskX);
+                    const size_t tileColumns = std::min(tiles->tileSize, width - t * tiles->tileSize);
+                    const XMVECTOR mean = XMVectorScale(tileAcc[t], 1.f / float(tileColumns * tileRows));
+                    XMStoreFloat4(dest + t, XMVectorSelect(mean, g_XMOne, tiles->ignore));
                 }
-                if (flags & CMSE_IGNORE_GREEN)
+            }
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Mean SSIM and mean contrast-structure of one scale
+    //-------------------------------------------------------------------------------------
+    HRESULT XM_CALLCONV ComputeSSIMScale(
+        const SSIMInput& input1,
+        const SSIMInput& input2,
+        FXMVECTOR c1,
+        FXMVECTOR c2,
+        _In_opt_ const SSIMTiles* tiles,
+        XMVECTOR& ssim,
+        XMVECTOR& cs) noexcept
+    {
+        const size_t width = input1.image->width;
+        const size_t height = input1.image->height;
+
+        // Bands hold whole rows of tiles so each tile is finished by a single thread
+        size_t bandRows = SSIM_BAND_ROWS;
+        size_t tilesAcross = 0;
+        if (tiles)
+        {
+            bandRows = std::max<size_t>(1, SSIM_BAND_ROWS / tiles->tileSize) * tiles->tileSize;
+            tilesAcross = (width + tiles->tileSize - 1) / tiles->tileSize;
+        }
+
+        const size_t nbands = (height + bandRows - 1) / bandRows;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::unique_ptr<double[]> partials(new (std::nothrow) double[nbands * 8]);
+        if (!partials)
+            return E_OUTOFMEMORY;
+
+        const uint64_t workspaceSize = uint64_t(width) * SSIM_MOMENTS * (SSIM_TAPS + 1) + tilesAcross;
+
+        std::atomic<bool> fail(false);
+        std::atomic<bool> oom(false);
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (nbands > 1 && width * height >= PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+        #endif
+
+            auto workspace = make_AlignedArrayXMVECTOR(workspaceSize);
+            if (!workspace)
+                oom = true;
+
+        #ifdef _OPENMP
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                const size_t y0 = size_t(band) * bandRows;
+                const size_t y1 = std::min(y0 + bandRows, height);
+
+                if (!workspace
+                    || !SumSSIMBand(input1, input2, y0, y1, c1, c2, tiles, workspace.get(), partials.get() + size_t(band) * 8))
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskY);
+                    fail = true;
                 }
-                if (flags & CMSE_IGNORE_BLUE)
+            }
+        }
+
+        if (oom || fail)
+            return (oom) ? E_OUTOFMEMORY : E_FAIL;
+
+        // Bands are reduced in order, so the result is the same for any number of threads
+        double acc[8] = {};
+        for (size_t band = 0; band < nbands; ++band)
+        {
+            const double* sums = partials.get() + band * 8;
+            for (size_t m = 0; m < 8; ++m)
+            {
+                acc[m] += sums[m];
+            }
+        }
+
+        const double d = double(width) * double(height);
+        ssim = XMVectorSet(float(acc[0] / d), float(acc[1] / d), float(acc[2] / d), float(acc[3] / d));
+        cs = XMVectorSet(float(acc[4] / d), float(acc[5] / d), float(acc[6] / d), float(acc[7] / d));
+
+        return S_OK;
+    }
+
+    // 2x2 box filter between MS-SSIM scales; the result is already linear and unbiased
+    HRESULT DownsampleSSIM(const SSIMInput& input, ScratchImage& result) noexcept
+    {
+        const size_t width = input.image->width;
+        const size_t height = input.image->height;
+        const size_t dwidth = width / 2;
+        const size_t dheight = height / 2;
+
+        HRESULT hr = result.Initialize2D(DXGI_FORMAT_R32G32B32A32_FLOAT, dwidth, dheight, 1, 1);
+        if (FAILED(hr))
+            return hr;
+
+        const Image* dest = result.GetImage(0, 0, 0);
+        if (!dest)
+            return E_POINTER;
+
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* row0 = scanline.get();
+        XMVECTOR* row1 = scanline.get() + width;
+
+        for (size_t y = 0; y < dheight; ++y)
+        {
+            if (!LoadSSIMRow(input, y * 2, row0) || !LoadSSIMRow(input, y * 2 + 1, row1))
+                return E_FAIL;
+
+            auto pDest = reinterpret_cast<XMFLOAT4*>(dest->pixels + y * dest->rowPitch);
+            for (size_t x = 0; x < dwidth; ++x)
+            {
+                const XMVECTOR v = XMVectorAdd(XMVectorAdd(row0[x * 2], row0[x * 2 + 1]), XMVectorAdd(row1[x * 2], row1[x * 2 + 1]));
+                XMStoreFloat4(pDest + x, XMVectorScale(v, 0.25f));
+            }
+        }
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    HRESULT ComputeSSIM_(
+        const Image& image1,
+        const Image& image2,
+        float& ssim,
+        _Out_writes_opt_(4) float* ssimV,
+        CMSE_FLAGS flags,
+        CSSIM_FLAGS ssimFlags,
+        _In_opt_ ScratchImage* tileMap,
+        size_t tileSize) noexcept
+    {
+        if (!image1.pixels || !image2.pixels)
+            return E_POINTER;
+
+        assert(image1.width == image2.width && image1.height == image2.height);
+        assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
+
+        flags |= GetImpliedFlags(image1.format, CMSE_IMAGE1_SRGB) | GetImpliedFlags(image2.format, CMSE_IMAGE2_SRGB);
+
+        const XMVECTOR ignore = XMVectorSelectControl(
+            (flags & CMSE_IGNORE_RED) ? 1u : 0u,
+            (flags & CMSE_IGNORE_GREEN) ? 1u : 0u,
+            (flags & CMSE_IGNORE_BLUE) ? 1u : 0u,
+            (flags & CMSE_IGNORE_ALPHA) ? 1u : 0u);
+
+        size_t channels = 0;
+        for (const CMSE_FLAGS channel : { CMSE_IGNORE_RED, CMSE_IGNORE_GREEN, CMSE_IGNORE_BLUE, CMSE_IGNORE_ALPHA })
+        {
+            if (!(flags & channel))
+                ++channels;
+        }
+
+        if (!channels)
+            return E_INVALIDARG;
+
+        // Biased images span [-1,1], so the dynamic range is doubled
+        const float range = (flags & (CMSE_IMAGE1_X2_BIAS | CMSE_IMAGE2_X2_BIAS)) ? 2.f : 1.f;
+        const XMVECTOR c1 = XMVectorReplicate((SSIM_K1 * range) * (SSIM_K1 * range));
+        const XMVECTOR c2 = XMVectorReplicate((SSIM_K2 * range) * (SSIM_K2 * range));
+
+        SSIMTiles tiles = {};
+        if (tileMap)
+        {
+            const size_t tilesAcross = (image1.width + tileSize - 1) / tileSize;
+            const size_t tilesDown = (image1.height + tileSize - 1) / tileSize;
+
+            HRESULT hr = tileMap->Initialize2D(DXGI_FORMAT_R32G32B32A32_FLOAT, tilesAcross, tilesDown, 1, 1);
+            if (FAILED(hr))
+                return hr;
+
+            tiles.image = tileMap->GetImage(0, 0, 0);
+            tiles.tileSize = tileSize;
+            tiles.ignore = ignore;
+            if (!tiles.image)
+                return E_POINTER;
+        }
+
+        // Coarser scales are skipped once the image is smaller than the window
+        size_t scales = 1;
+        if (ssimFlags & CSSIM_MULTISCALE)
+        {
+            while (scales < MSSSIM_SCALES
+                && (image1.width >> scales) >= SSIM_TAPS
+                && (image1.height >> scales) >= SSIM_TAPS)
+            {
+                ++scales;
+            }
+        }
+
+        float totalWeight = 0.f;
+        for (size_t scale = 0; scale < scales; ++scale)
+        {
+            totalWeight += g_MSSSIMWeights[scale];
+        }
+
+        SSIMInput input1 = { &image1, CMSE_IMAGE1_SRGB, CMSE_IMAGE1_X2_BIAS, flags, GetLoadScanline(image1.format) };
+        SSIMInput input2 = { &image2, CMSE_IMAGE2_SRGB, CMSE_IMAGE2_X2_BIAS, flags, GetLoadScanline(image2.format) };
+
+        ScratchImage level1;
+        ScratchImage level2;
+
+        XMVECTOR result = g_XMOne;
+        for (size_t scale = 0; scale < scales; ++scale)
+        {
+            XMVECTOR ssimScale, csScale;
+            HRESULT hr = ComputeSSIMScale(input1, input2, c1, c2, (scale == 0 && tileMap) ? &tiles : nullptr, ssimScale, csScale);
+            if (FAILED(hr))
+            {
+                if (tileMap)
+                    tileMap->Release();
+                return hr;
+            }
+
+            if (scales == 1)
+            {
+                result = ssimScale;
+                break;
+            }
+
+            // MS-SSIM = ssim[M]^w[M] * prod( cs[j]^w[j] ), with negative terms clamped so fractional powers stay real
+            const XMVECTOR term = XMVectorMax((scale + 1 == scales) ? ssimScale : csScale, g_XMZero);
+            result = XMVectorMultiply(result, XMVectorPow(term, XMVectorReplicate(g_MSSSIMWeights[scale] / totalWeight)));
+
+            if (scale + 1 < scales)
+            {
+                ScratchImage next1;
+                ScratchImage next2;
+                hr = DownsampleSSIM(input1, next1);
+                if (SUCCEEDED(hr))
+                    hr = DownsampleSSIM(input2, next2);
+
+                if (FAILED(hr))
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskZ);
+                    if (tileMap)
+                        tileMap->Release();
+                    return hr;
                 }
-                if (flags & CMSE_IGNORE_ALPHA)
+
+                level1 = std::move(next1);
+                level2 = std::move(next2);
+
+                // Downsampled levels are already linear and unbiased
+                input1 = { level1.GetImage(0, 0, 0), CMSE_IMAGE1_SRGB, CMSE_IMAGE1_X2_BIAS, CMSE_DEFAULT, GetLoadScanline(level1.GetMetadata().format) };
+                input2 = { level2.GetImage(0, 0, 0), CMSE_IMAGE2_SRGB, CMSE_IMAGE2_X2_BIAS, CMSE_DEFAULT, GetLoadScanline(level2.GetMetadata().format) };
+            }
+        }
+
+        XMFLOAT4 _ssimV;
+        XMStoreFloat4(&_ssimV, XMVectorSelect(result, g_XMOne, ignore));
+
+        if (ssimV)
+        {
+            memcpy(ssimV, &_ssimV, sizeof(_ssimV));
+        }
+
+        // Overall result is the mean over the channels being compared
+        XMFLOAT4 kept;
+        XMStoreFloat4(&kept, XMVectorSelect(result, g_XMZero, ignore));
+        ssim = (kept.x + kept.y + kept.z + kept.w) / float(channels);
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    HRESULT EvaluateImage_(
+        const Image& image,
+        const std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>& pixelFunc)
+    {
+        if (!pixelFunc)
+            return E_INVALIDARG;
+
+        if (!image.pixels)
+            return E_POINTER;
+
+        assert(!IsCompressed(image.format));
+
+        const size_t width = image.width;
+        const size_t height = image.height;
+
+        const size_t chunkRows = std::max<size_t>(1,
+            std::min<size_t>(std::min(EVALUATE_CHUNK_ROWS, height), EVALUATE_CHUNK_BYTES / (sizeof(XMVECTOR) * std::max<size_t>(width, 1))));
+
+        auto scanlines = make_AlignedArrayXMVECTOR(uint64_t(width) * chunkRows);
+        if (!scanlines)
+            return E_OUTOFMEMORY;
+
+        const uint8_t *pSrc = image.pixels;
+        const size_t rowPitch = image.rowPitch;
+        const LoadScanlineFunc pfnLoad = GetLoadScanline(image.format);
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+    #endif
+
+        for (size_t y0 = 0; y0 < height; y0 += chunkRows)
+        {
+            const size_t rows = std::min(chunkRows, height - y0);
+
+            // Rows are decoded in parallel, but pixelFunc is still called on this thread one row at a time in order
+            std::atomic<bool> fail(false);
+
+        #ifdef _OPENMP
+            #pragma omp parallel if (rows > 1 && width * rows >= PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+        #endif
+            {
+            #ifdef _OPENMP
+                const WorkerAffinity affinity(workers);
+
+                #pragma omp for
+            #endif
+                for (int row = 0; row < static_cast<int>(rows); ++row)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskW);
+                    if (!pfnLoad(scanlines.get() + size_t(row) * width, width,
+                        pSrc + (y0 + size_t(row)) * rowPitch, rowPitch, image.format))
+                        fail = true;
                 }
+            }
 
-                acc = XMVectorMultiplyAdd(v, v, acc);
+            if (fail)
+                return E_FAIL;
+
+            for (size_t row = 0; row < rows; ++row)
+            {
+                pixelFunc(scanlines.get() + row * width, width, y0 + row);
             }
+        }
+
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Image statistics
+    //-------------------------------------------------------------------------------------
 
-            pSrc1 += rowPitch1;
-            pSrc2 += rowPitch2;
+    // Rows per partial result; fixed so the reduction order never depends on the thread count
+    constexpr size_t STATS_BAND_ROWS = 64;
+
+    // Pixels summed in float before being folded into the double-precision moments
+    constexpr size_t STATS_SPAN = 4096;
+
+    struct StatisticsPartial
+    {
+        double      count[4];
+        double      mean[4];
+        double      m2[4];
+        XMFLOAT4    minimum;
+        XMFLOAT4    maximum;
+        float       luminance;
+        size_t      nanCount[4];
+        size_t      infiniteCount[4];
+        size_t      denormalCount[4];
+        size_t      histogram[4][ImageStatistics::HISTOGRAM_BINS];
+
+        void Reset() noexcept
+        {
+            memset(this, 0, sizeof(StatisticsPartial));
+            minimum = XMFLOAT4(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+            maximum = XMFLOAT4(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+            luminance = -FLT_MAX;
         }
 
-        // MSE = sum[ (I1 - I2)^2 ] / w*h
-        const XMVECTOR d = XMVectorReplicate(float(image1.width * image1.height));
-        const XMVECTOR v = XMVectorDivide(acc, d);
-        if (mseV)
+        // Chan et al. pairwise update for the mean and the sum of squared deviations
+        void AddMoments(size_t c, double countB, double meanB, double m2B) noexcept
         {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(mseV), v);
-            mse = mseV[0] + mseV[1] + mseV[2] + mseV[3];
+            if (countB <= 0.0)
+                return;
+
+            const double total = count[c] + countB;
+            const double delta = meanB - mean[c];
+            mean[c] += delta * countB / total;
+            m2[c] += m2B + delta * delta * count[c] * countB / total;
+            count[c] = total;
         }
-        else
+
+        void Merge(const StatisticsPartial& other) noexcept
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                AddMoments(c, other.count[c], other.mean[c], other.m2[c]);
+                nanCount[c] += other.nanCount[c];
+                infiniteCount[c] += other.infiniteCount[c];
+                denormalCount[c] += other.denormalCount[c];
+
+                for (size_t bin = 0; bin < ImageStatistics::HISTOGRAM_BINS; ++bin)
+                {
+                    histogram[c][bin] += other.histogram[c][bin];
+                }
+            }
+
+            XMStoreFloat4(&minimum, XMVectorMin(XMLoadFloat4(&minimum), XMLoadFloat4(&other.minimum)));
+            XMStoreFloat4(&maximum, XMVectorMax(XMLoadFloat4(&maximum), XMLoadFloat4(&other.maximum)));
+            luminance = std::max(luminance, other.luminance);
+        }
+    };
+
+    // Adds up to STATS_SPAN decoded pixels to the partial result
+    void AccumulateStatistics(
+        _In_reads_(count) const XMVECTOR* pixels,
+        size_t count,
+        FXMVECTOR histogramMin,
+        FXMVECTOR histogramScale,
+        StatisticsPartial& partial) noexcept
+    {
+        static const XMVECTORF32 s_luminance = { { { 0.3f, 0.59f, 0.11f, 0.f } } };
+        static const XMVECTORF32 s_lastBin = { { {
+            float(ImageStatistics::HISTOGRAM_BINS - 1), float(ImageStatistics::HISTOGRAM_BINS - 1),
+            float(ImageStatistics::HISTOGRAM_BINS - 1), float(ImageStatistics::HISTOGRAM_BINS - 1) } } };
+
+        assert(count <= STATS_SPAN);
+
+        XMVECTOR minv = XMLoadFloat4(&partial.minimum);
+        XMVECTOR maxv = XMLoadFloat4(&partial.maximum);
+        XMVECTOR lum = XMVectorReplicate(partial.luminance);
+        XMVECTOR sum = g_XMZero;
+        XMVECTOR nans = g_XMZero;
+        XMVECTOR infinities = g_XMZero;
+        XMVECTOR denormals = g_XMZero;
+
+        // First pass: extremes, special values, histogram, and the sum of finite values
+        for (size_t i = 0; i < count; ++i)
+        {
+            const XMVECTOR v = pixels[i];
+
+            const XMVECTOR nan = XMVectorIsNaN(v);
+            const XMVECTOR inf = XMVectorIsInfinite(v);
+            const XMVECTOR special = XMVectorOrInt(nan, inf);
+
+            const XMVECTOR absv = XMVectorAbs(v);
+            const XMVECTOR denormal = XMVectorAndInt(XMVectorLess(absv, g_XMFltMin), XMVectorGreater(absv, g_XMZero));
+
+            nans = XMVectorAdd(nans, XMVectorAndInt(nan, g_XMOne));
+            infinities = XMVectorAdd(infinities, XMVectorAndInt(inf, g_XMOne));
+            denormals = XMVectorAdd(denormals, XMVectorAndInt(denormal, g_XMOne));
+
+            minv = XMVectorMin(minv, XMVectorSelect(v, g_XMFltMax, special));
+            maxv = XMVectorMax(maxv, XMVectorSelect(v, XMVectorNegate(g_XMFltMax), special));
+
+            const XMVECTOR finite = XMVectorSelect(v, g_XMZero, special);
+            sum = XMVectorAdd(sum, finite);
+            lum = XMVectorMax(lum, XMVector3Dot(finite, s_luminance));
+
+            XMVECTOR bins = XMVectorMultiply(XMVectorSubtract(finite, histogramMin), histogramScale);
+            bins = XMVectorClamp(bins, g_XMZero, s_lastBin);
+
+            XMUINT4 index;
+            XMStoreUInt4(&index, XMConvertVectorFloatToUInt(bins, 0));
+
+            XMUINT4 skip;
+            XMStoreUInt4(&skip, special);
+
+            if (!skip.x) ++partial.histogram[0][index.x];
+            if (!skip.y) ++partial.histogram[1][index.y];
+            if (!skip.z) ++partial.histogram[2][index.z];
+            if (!skip.w) ++partial.histogram[3][index.w];
+        }
+
+        XMFLOAT4 nanf, inff, denf, sumf;
+        XMStoreFloat4(&nanf, nans);
+        XMStoreFloat4(&inff, infinities);
+        XMStoreFloat4(&denf, denormals);
+        XMStoreFloat4(&sumf, sum);
+
+        const float nanc[4] = { nanf.x, nanf.y, nanf.z, nanf.w };
+        const float infc[4] = { inff.x, inff.y, inff.z, inff.w };
+        const float denc[4] = { denf.x, denf.y, denf.z, denf.w };
+        const float sums[4] = { sumf.x, sumf.y, sumf.z, sumf.w };
+
+        float finiteCount[4];
+        float mean[4];
+        for (size_t c = 0; c < 4; ++c)
+        {
+            partial.nanCount[c] += size_t(nanc[c]);
+            partial.infiniteCount[c] += size_t(infc[c]);
+            partial.denormalCount[c] += size_t(denc[c]);
+
+            finiteCount[c] = float(count) - nanc[c] - infc[c];
+            mean[c] = (finiteCount[c] > 0.f) ? sums[c] / finiteCount[c] : 0.f;
+        }
+
+        // Second pass over the same pixels for the squared deviations, which avoids cancellation
+        const XMVECTOR meanv = XMVectorSet(mean[0], mean[1], mean[2], mean[3]);
+        XMVECTOR m2 = g_XMZero;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const XMVECTOR v = pixels[i];
+            const XMVECTOR special = XMVectorOrInt(XMVectorIsNaN(v), XMVectorIsInfinite(v));
+            const XMVECTOR diff = XMVectorSelect(XMVectorSubtract(v, meanv), g_XMZero, special);
+            m2 = XMVectorMultiplyAdd(diff, diff, m2);
+        }
+
+        XMFLOAT4 m2f;
+        XMStoreFloat4(&m2f, m2);
+        const float m2c[4] = { m2f.x, m2f.y, m2f.z, m2f.w };
+
+        for (size_t c = 0; c < 4; ++c)
         {
-            XMFLOAT4 _mseV;
-            XMStoreFloat4(&_mseV, v);
-            mse = _mseV.x + _mseV.y + _mseV.z + _mseV.w;
+            partial.AddMoments(c, double(finiteCount[c]), double(mean[c]), double(m2c[c]));
         }
 
-        return S_OK;
+        XMStoreFloat4(&partial.minimum, minv);
+        XMStoreFloat4(&partial.maximum, maxv);
+        partial.luminance = XMVectorGetX(lum);
     }
 
     //-------------------------------------------------------------------------------------
-    HRESULT EvaluateImage_(
+    // Adds every pixel of the image to total, in row order
+    //-------------------------------------------------------------------------------------
+    HRESULT EvaluateStatistics_(
         const Image& image,
-        const std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>& pixelFunc)
+        float histogramMin,
+        float histogramMax,
+        StatisticsPartial& total) noexcept
     {
-        if (!pixelFunc)
-            return E_INVALIDARG;
-
         if (!image.pixels)
             return E_POINTER;
 
         assert(!IsCompressed(image.format));
 
         const size_t width = image.width;
+        const size_t height = image.height;
 
-        auto scanline = make_AlignedArrayXMVECTOR(width);
-        if (!scanline)
+        const size_t nbands = (height + STATS_BAND_ROWS - 1) / STATS_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::unique_ptr<StatisticsPartial[]> partials(new (std::nothrow) StatisticsPartial[nbands]);
+        if (!partials)
             return E_OUTOFMEMORY;
 
-        const uint8_t *pSrc = image.pixels;
-        const size_t rowPitch = image.rowPitch;
+        const XMVECTOR hmin = XMVectorReplicate(histogramMin);
+        const XMVECTOR hscale = XMVectorReplicate(float(ImageStatistics::HISTOGRAM_BINS) / (histogramMax - histogramMin));
+        const LoadScanlineFunc pfnLoad = GetLoadScanline(image.format);
+
+        std::atomic<bool> fail(false);
+        std::atomic<bool> oom(false);
 
-        for (size_t h = 0; h < image.height; ++h)
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (nbands > 1 && width * height >= PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
         {
-            if (!LoadScanline(scanline.get(), width, pSrc, rowPitch, image.format))
-                return E_FAIL;
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+        #endif
+
+            auto scanline = make_AlignedArrayXMVECTOR(width);
+            if (!scanline)
+                oom = true;
+
+        #ifdef _OPENMP
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                StatisticsPartial& partial = partials[size_t(band)];
+                partial.Reset();
+
+                if (!scanline)
+                {
+                    fail = true;
+                    continue;
+                }
+
+                const size_t y0 = size_t(band) * STATS_BAND_ROWS;
+                const size_t y1 = std::min(y0 + STATS_BAND_ROWS, height);
+                for (size_t y = y0; y < y1; ++y)
+                {
+                    if (!pfnLoad(scanline.get(), width, image.pixels + y * image.rowPitch, image.rowPitch, image.format))
+                    {
+                        fail = true;
+                        break;
+                    }
+
+                    for (size_t x = 0; x < width; x += STATS_SPAN)
+                    {
+                        AccumulateStatistics(scanline.get() + x, std::min(STATS_SPAN, width - x), hmin, hscale, partial);
+                    }
+                }
+            }
+        }
 
-            pixelFunc(scanline.get(), width, h);
+        if (oom || fail)
+            return (oom) ? E_OUTOFMEMORY : E_FAIL;
 
-            pSrc += rowPitch;
+        // Bands are merged in order, so the result is the same for any number of threads
+        for (size_t band = 0; band < nbands; ++band)
+        {
+            total.Merge(partials[band]);
         }
 
         return S_OK;
     }
 
+    void FinalizeStatistics(
+        const StatisticsPartial& total,
+        size_t pixelCount,
+        float histogramMin,
+        float histogramMax,
+        ImageStatistics& stats) noexcept
+    {
+        memset(&stats, 0, sizeof(ImageStatistics));
+
+        stats.pixelCount = pixelCount;
+        stats.histogramMin = histogramMin;
+        stats.histogramMax = histogramMax;
+        stats.luminance = (pixelCount > 0) ? total.luminance : 0.f;
+
+        const float minimum[4] = { total.minimum.x, total.minimum.y, total.minimum.z, total.minimum.w };
+        const float maximum[4] = { total.maximum.x, total.maximum.y, total.maximum.z, total.maximum.w };
+
+        float result[5][4] = {};
+        for (size_t c = 0; c < 4; ++c)
+        {
+            stats.nanCount[c] = total.nanCount[c];
+            stats.infiniteCount[c] = total.infiniteCount[c];
+            stats.denormalCount[c] = total.denormalCount[c];
+            memcpy(stats.histogram[c], total.histogram[c], sizeof(stats.histogram[c]));
+
+            if (total.count[c] > 0.0)
+            {
+                const double variance = total.m2[c] / total.count[c];
+                result[0][c] = minimum[c];
+                result[1][c] = maximum[c];
+                result[2][c] = float(total.mean[c]);
+                result[3][c] = float(variance);
+                result[4][c] = float(sqrt(variance));
+
+                stats.constantChannel[c] = (size_t(total.count[c]) == pixelCount) && (minimum[c] == maximum[c]);
+            }
+        }
+
+        stats.minimum = XMFLOAT4(result[0]);
+        stats.maximum = XMFLOAT4(result[1]);
+        stats.average = XMFLOAT4(result[2]);
+        stats.variance = XMFLOAT4(result[3]);
+        stats.standardDeviation = XMFLOAT4(result[4]);
+    }
+
 
     //-------------------------------------------------------------------------------------
     HRESULT TransformImage_(
@@ -241,9 +1331,12 @@ namespace
         uint8_t *pDest = destImage.pixels;
         const size_t dpitch = destImage.rowPitch;
 
+        const LoadScanlineFunc pfnLoad = GetLoadScanline(srcImage.format);
+        const StoreScanlineFunc pfnStore = GetStoreScanline(destImage.format);
+
         for (size_t h = 0; h < srcImage.height; ++h)
         {
-            if (!LoadScanline(sScanline, width, pSrc, spitch, srcImage.format))
+            if (!pfnLoad(sScanline, width, pSrc, spitch, srcImage.format))
                 return E_FAIL;
 
         #ifdef _DEBUG
@@ -252,7 +1345,7 @@ namespace
 
             pixelFunc(dScanline, sScanline, width, h);
 
-            if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, dScanline, width))
+            if (!pfnStore(pDest, destImage.rowPitch, destImage.format, dScanline, width, 0))
                 return E_FAIL;
 
             pSrc += spitch;
@@ -261,6 +1354,52 @@ namespace
 
         return S_OK;
     }
+
+    //-------------------------------------------------------------------------------------
+    // Copies whole 4x4 blocks between two images of the same BC format
+    //-------------------------------------------------------------------------------------
+    HRESULT CopyBlocks(
+        const Image& srcImage,
+        const Rect& srcRect,
+        const Image& dstImage,
+        size_t xOffset,
+        size_t yOffset) noexcept
+    {
+        assert(IsCompressed(srcImage.format) && srcImage.format == dstImage.format);
+
+        // Edges may only be partial blocks where they are the partial last block of both images
+        const bool alignedX = !(srcRect.x & 3) && !(xOffset & 3)
+            && (!(srcRect.w & 3) || (((srcRect.x + srcRect.w) == srcImage.width) && ((xOffset + srcRect.w) == dstImage.width)));
+        const bool alignedY = !(srcRect.y & 3) && !(yOffset & 3)
+            && (!(srcRect.h & 3) || (((srcRect.y + srcRect.h) == srcImage.height) && ((yOffset + srcRect.h) == dstImage.height)));
+        if (!alignedX || !alignedY)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        const size_t blockSize = BitsPerPixel(srcImage.format) * 2;
+        if (!blockSize)
+            return E_FAIL;
+
+        const uint8_t* pEndSrc = srcImage.pixels + srcImage.slicePitch;
+        const uint8_t* pEndDest = dstImage.pixels + dstImage.slicePitch;
+
+        const uint8_t* pSrc = srcImage.pixels + (srcRect.y >> 2) * srcImage.rowPitch + (srcRect.x >> 2) * blockSize;
+        uint8_t* pDest = dstImage.pixels + (yOffset >> 2) * dstImage.rowPitch + (xOffset >> 2) * blockSize;
+
+        const size_t copyW = ((srcRect.w + 3) >> 2) * blockSize;
+        const size_t rows = (srcRect.h + 3) >> 2;
+        for (size_t h = 0; h < rows; ++h)
+        {
+            if (((pSrc + copyW) > pEndSrc) || ((pDest + copyW) > pEndDest))
+                return E_FAIL;
+
+            memcpy(pDest, pSrc, copyW);
+
+            pSrc += srcImage.rowPitch;
+            pDest += dstImage.rowPitch;
+        }
+
+        return S_OK;
+    }
 };
 
 
@@ -283,11 +1422,6 @@ HRESULT DirectX::CopyRectangle(
     if (!srcImage.pixels || !dstImage.pixels)
         return E_POINTER;
 
-    if (IsCompressed(srcImage.format) || IsCompressed(dstImage.format)
-        || IsPlanar(srcImage.format) || IsPlanar(dstImage.format)
-        || IsPalettized(srcImage.format) || IsPalettized(dstImage.format))
-        return HRESULT_E_NOT_SUPPORTED;
-
     // Validate rectangle/offset
     if (!srcRect.w || !srcRect.h || ((srcRect.x + srcRect.w) > srcImage.width) || ((srcRect.y + srcRect.h) > srcImage.height))
     {
@@ -299,6 +1433,14 @@ HRESULT DirectX::CopyRectangle(
         return E_INVALIDARG;
     }
 
+    if (IsCompressed(srcImage.format) && srcImage.format == dstImage.format)
+        return CopyBlocks(srcImage, srcRect, dstImage, xOffset, yOffset);
+
+    if (IsCompressed(srcImage.format) || IsCompressed(dstImage.format)
+        || IsPlanar(srcImage.format) || IsPlanar(dstImage.format)
+        || IsPalettized(srcImage.format) || IsPalettized(dstImage.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
     // Compute source bytes-per-pixel
     size_t sbpp = BitsPerPixel(srcImage.format);
     if (!sbpp)
@@ -325,7 +1467,7 @@ HRESULT DirectX::CopyRectangle(
         const size_t copyW = srcRect.w * sbpp;
         for (size_t h = 0; h < srcRect.h; ++h)
         {
-            if (((pSrc + copyW) > pEndSrc) || (pDest > pEndDest))
+            if (((pSrc + copyW) > pEndSrc) || ((pDest + copyW) > pEndDest))
                 return E_FAIL;
 
             memcpy(pDest, pSrc, copyW);
@@ -360,17 +1502,20 @@ HRESULT DirectX::CopyRectangle(
     const size_t copyS = srcRect.w * sbpp;
     const size_t copyD = srcRect.w * dbpp;
 
+    const LoadScanlineFunc pfnLoad = GetLoadScanline(srcImage.format);
+    const StoreScanlineFunc pfnStore = GetStoreScanline(dstImage.format);
+
     for (size_t h = 0; h < srcRect.h; ++h)
     {
         if (((pSrc + copyS) > pEndSrc) || ((pDest + copyD) > pEndDest))
             return E_FAIL;
 
-        if (!LoadScanline(scanline.get(), srcRect.w, pSrc, copyS, srcImage.format))
+        if (!pfnLoad(scanline.get(), srcRect.w, pSrc, copyS, srcImage.format))
             return E_FAIL;
 
         ConvertScanline(scanline.get(), srcRect.w, dstImage.format, srcImage.format, filter);
 
-        if (!StoreScanline(pDest, copyD, dstImage.format, scanline.get(), srcRect.w))
+        if (!pfnStore(pDest, copyD, dstImage.format, scanline.get(), srcRect.w, 0))
             return E_FAIL;
 
         pSrc += srcImage.rowPitch;
@@ -468,6 +1613,68 @@ HRESULT DirectX::ComputeMSE(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Computes the Structural Similarity (SSIM) or multi-scale SSIM between two images
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ComputeSSIM(
+    const Image& image1,
+    const Image& image2,
+    float& ssim,
+    float* ssimV,
+    CMSE_FLAGS flags,
+    CSSIM_FLAGS ssimFlags,
+    ScratchImage* tileMap,
+    size_t tileSize) noexcept
+{
+    if (!image1.pixels || !image2.pixels)
+        return E_POINTER;
+
+    if (image1.width != image2.width || image1.height != image2.height)
+        return E_INVALIDARG;
+
+    if (!IsValid(image1.format) || !IsValid(image2.format))
+        return E_INVALIDARG;
+
+    if (tileMap && !tileSize)
+        return E_INVALIDARG;
+
+    if (IsPlanar(image1.format) || IsPlanar(image2.format)
+        || IsPalettized(image1.format) || IsPalettized(image2.format)
+        || IsTypeless(image1.format) || IsTypeless(image2.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    // Compressed images are expanded to RGBA32F
+    ScratchImage temp1;
+    const Image* img1 = &image1;
+    if (IsCompressed(image1.format))
+    {
+        HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, temp1);
+        if (FAILED(hr))
+            return hr;
+
+        img1 = temp1.GetImage(0, 0, 0);
+        if (!img1)
+            return E_POINTER;
+    }
+
+    ScratchImage temp2;
+    const Image* img2 = &image2;
+    if (IsCompressed(image2.format))
+    {
+        HRESULT hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, temp2);
+        if (FAILED(hr))
+            return hr;
+
+        img2 = temp2.GetImage(0, 0, 0);
+        if (!img2)
+            return E_POINTER;
+    }
+
+    return ComputeSSIM_(*img1, *img2, ssim, ssimV, flags, ssimFlags, tileMap, tileSize);
+}
+
+
 //-------------------------------------------------------------------------------------
 // Evaluates a user-supplied function for all the pixels in the image
 //-------------------------------------------------------------------------------------
@@ -599,6 +1806,170 @@ HRESULT DirectX::EvaluateImage(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Collects per-channel statistics for all the pixels in the image in a single pass
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::EvaluateImageStatistics(
+    const Image& image,
+    ImageStatistics& stats,
+    float histogramMin,
+    float histogramMax) noexcept
+{
+    memset(&stats, 0, sizeof(ImageStatistics));
+
+    if (!std::isfinite(histogramMin) || !std::isfinite(histogramMax) || histogramMax <= histogramMin)
+        return E_INVALIDARG;
+
+    if (image.width > UINT32_MAX
+        || image.height > UINT32_MAX)
+        return E_INVALIDARG;
+
+    if (!IsValid(image.format))
+        return E_INVALIDARG;
+
+    if (IsPlanar(image.format) || IsPalettized(image.format) || IsTypeless(image.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    StatisticsPartial total;
+    total.Reset();
+
+    if (IsCompressed(image.format))
+    {
+        ScratchImage temp;
+        HRESULT hr = Decompress(image, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+        if (FAILED(hr))
+            return hr;
+
+        const Image* img = temp.GetImage(0, 0, 0);
+        if (!img)
+            return E_POINTER;
+
+        hr = EvaluateStatistics_(*img, histogramMin, histogramMax, total);
+        if (FAILED(hr))
+            return hr;
+    }
+    else
+    {
+        const HRESULT hr = EvaluateStatistics_(image, histogramMin, histogramMax, total);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    FinalizeStatistics(total, image.width * image.height, histogramMin, histogramMax, stats);
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::EvaluateImageStatistics(
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    ImageStatistics& stats,
+    float histogramMin,
+    float histogramMax) noexcept
+{
+    memset(&stats, 0, sizeof(ImageStatistics));
+
+    if (!images || !nimages)
+        return E_INVALIDARG;
+
+    if (!std::isfinite(histogramMin) || !std::isfinite(histogramMax) || histogramMax <= histogramMin)
+        return E_INVALIDARG;
+
+    if (!IsValid(metadata.format))
+        return E_INVALIDARG;
+
+    if (IsPlanar(metadata.format) || IsPalettized(metadata.format) || IsTypeless(metadata.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (metadata.width > UINT32_MAX
+        || metadata.height > UINT32_MAX)
+        return E_INVALIDARG;
+
+    if (metadata.IsVolumemap() && metadata.depth > UINT16_MAX)
+        return E_INVALIDARG;
+
+    ScratchImage temp;
+    DXGI_FORMAT format = metadata.format;
+    if (IsCompressed(format))
+    {
+        HRESULT hr = Decompress(images, nimages, metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+        if (FAILED(hr))
+            return hr;
+
+        if (nimages != temp.GetImageCount())
+            return E_UNEXPECTED;
+
+        images = temp.GetImages();
+        format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    }
+
+    StatisticsPartial total;
+    total.Reset();
+    size_t pixelCount = 0;
+
+    switch (metadata.dimension)
+    {
+    case TEX_DIMENSION_TEXTURE1D:
+    case TEX_DIMENSION_TEXTURE2D:
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const Image& img = images[index];
+            if (img.format != format)
+                return E_FAIL;
+
+            if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
+                return E_FAIL;
+
+            HRESULT hr = EvaluateStatistics_(img, histogramMin, histogramMax, total);
+            if (FAILED(hr))
+                return hr;
+
+            pixelCount += img.width * img.height;
+        }
+        break;
+
+    case TEX_DIMENSION_TEXTURE3D:
+        {
+            size_t index = 0;
+            size_t d = metadata.depth;
+            for (size_t level = 0; level < metadata.mipLevels; ++level)
+            {
+                for (size_t slice = 0; slice < d; ++slice, ++index)
+                {
+                    if (index >= nimages)
+                        return E_FAIL;
+
+                    const Image& img = images[index];
+                    if (img.format != format)
+                        return E_FAIL;
+
+                    if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
+                        return E_FAIL;
+
+                    HRESULT hr = EvaluateStatistics_(img, histogramMin, histogramMax, total);
+                    if (FAILED(hr))
+                        return hr;
+
+                    pixelCount += img.width * img.height;
+                }
+
+                if (d > 1)
+                    d >>= 1;
+            }
+        }
+        break;
+
+    default:
+        return E_FAIL;
+    }
+
+    FinalizeStatistics(total, pixelCount, histogramMin, histogramMax, stats);
+    return S_OK;
+}
+
+
 //-------------------------------------------------------------------------------------
 // Use a user-supplied function to compute a new image from an input image
 //-------------------------------------------------------------------------------------
@@ -74,6 +74,243 @@ namespace
         }
     }
 
+    // Rows per parallel work item
+    constexpr size_t NMAP_BAND_ROWS = 64;
+
+    // Smaller images are not worth starting worker threads for
+    constexpr size_t NMAP_PARALLEL_MIN_PIXELS = 64 * 1024;
+
+    // Source row for y, which may be one row outside the image
+    inline size_t SourceRow(ptrdiff_t y, size_t height, CNMAP_FLAGS flags) noexcept
+    {
+        if (y < 0)
+        {
+            // Mirror clamps to the first row, wrap reads the last
+            return (flags & CNMAP_MIRROR_V) ? 0 : height - 1;
+        }
+        else if (static_cast<size_t>(y) >= height)
+        {
+            return (flags & CNMAP_MIRROR_V) ? height - 1 : 0;
+        }
+
+        return static_cast<size_t>(y);
+    }
+
+    // Scalar normal for one pixel, used for the tail of each row
+    XMVECTOR ComputeNormal(
+        _In_reads_(3) const float* val0,
+        _In_reads_(3) const float* val1,
+        _In_reads_(3) const float* val2,
+        CNMAP_FLAGS flags,
+        float amplitude,
+        bool unorm) noexcept
+    {
+        // Compute normal via central differencing
+        float totDelta = (val0[0] - val0[2]) + (val1[0] - val1[2]) + (val2[0] - val2[2]);
+        const float deltaZX = totDelta * amplitude / 6.f;
+
+        totDelta = (val0[0] - val2[0]) + (val0[1] - val2[1]) + (val0[2] - val2[2]);
+        const float deltaZY = totDelta * amplitude / 6.f;
+
+        const XMVECTOR vx = XMVectorSetZ(g_XMNegIdentityR0, deltaZX);   // (-1.0f, 0.0f, deltaZX)
+        const XMVECTOR vy = XMVectorSetZ(g_XMNegIdentityR1, deltaZY);   // (0.0f, -1.0f, deltaZY)
+
+        const XMVECTOR normal = XMVector3Normalize(XMVector3Cross(vx, vy));
+
+        // Compute alpha (1.0 or an occlusion term)
+        float alpha = 1.f;
+
+        if (flags & CNMAP_COMPUTE_OCCLUSION)
+        {
+            float delta = 0.f;
+            const float c = val1[1];
+
+            float t = val0[0] - c;  if (t > 0.f) delta += t;
+            t = val0[1] - c;    if (t > 0.f) delta += t;
+            t = val0[2] - c;    if (t > 0.f) delta += t;
+            t = val1[0] - c;    if (t > 0.f) delta += t;
+            // Skip current pixel
+            t = val1[2] - c;    if (t > 0.f) delta += t;
+            t = val2[0] - c;    if (t > 0.f) delta += t;
+            t = val2[1] - c;    if (t > 0.f) delta += t;
+            t = val2[2] - c;    if (t > 0.f) delta += t;
+
+            // Average delta (divide by 8, scale by amplitude factor)
+            delta *= 0.125f * amplitude;
+            if (delta > 0.f)
+            {
+                // If < 0, then no occlusion
+                const float r = sqrtf(1.f + delta*delta);
+                alpha = (r - delta) / r;
+            }
+        }
+
+        // Encode based on target format
+        if (unorm)
+        {
+            // 0.5f*normal + 0.5f -or- invert sign case: -0.5f*normal + 0.5f
+            const XMVECTOR n1 = XMVectorMultiplyAdd((flags & CNMAP_INVERT_SIGN) ? g_XMNegativeOneHalf : g_XMOneHalf, normal, g_XMOneHalf);
+            return XMVectorSetW(n1, alpha);
+        }
+        else if (flags & CNMAP_INVERT_SIGN)
+        {
+            return XMVectorSetW(XMVectorNegate(normal), alpha);
+        }
+
+        return XMVectorSetW(normal, alpha);
+    }
+
+    //---------------------------------------------------------------------------------
+    // Generates one row of normals from three evaluated height rows (each width + 2
+    // wide). Four pixels are computed at a time with each vector holding one component
+    // of the four normals, then transposed back to one pixel per vector.
+    void ComputeNormalRow(
+        _In_reads_(width + 2) const float* val0,
+        _In_reads_(width + 2) const float* val1,
+        _In_reads_(width + 2) const float* val2,
+        _Out_writes_(width) XMVECTOR* pDest,
+        size_t width,
+        CNMAP_FLAGS flags,
+        float amplitude,
+        bool unorm) noexcept
+    {
+        const XMVECTOR scale = XMVectorReplicate(amplitude);
+        const XMVECTOR occlusionScale = XMVectorReplicate(0.125f * amplitude);
+        const XMVECTOR six = XMVectorReplicate(6.f);
+        const XMVECTOR encodeScale = (!unorm) ? g_XMOne.v
+            : (flags & CNMAP_INVERT_SIGN) ? g_XMNegativeOneHalf.v : g_XMOneHalf.v;
+        const XMVECTOR encodeBias = (unorm) ? g_XMOneHalf.v : g_XMZero.v;
+        const bool negate = !unorm && (flags & CNMAP_INVERT_SIGN);
+
+        size_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            // a, b, c are the left, center, and right neighbors of each pixel
+            const XMVECTOR a0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val0 + x));
+            const XMVECTOR b0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val0 + x + 1));
+            const XMVECTOR c0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val0 + x + 2));
+            const XMVECTOR a1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val1 + x));
+            const XMVECTOR b1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val1 + x + 1));
+            const XMVECTOR c1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val1 + x + 2));
+            const XMVECTOR a2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val2 + x));
+            const XMVECTOR b2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val2 + x + 1));
+            const XMVECTOR c2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val2 + x + 2));
+
+            // Central differencing, summed in the same order as the scalar path
+            XMVECTOR dzx = XMVectorAdd(XMVectorAdd(XMVectorSubtract(a0, c0), XMVectorSubtract(a1, c1)), XMVectorSubtract(a2, c2));
+            dzx = XMVectorDivide(XMVectorMultiply(dzx, scale), six);
+
+            XMVECTOR dzy = XMVectorAdd(XMVectorAdd(XMVectorSubtract(a0, a2), XMVectorSubtract(b0, b2)), XMVectorSubtract(c0, c2));
+            dzy = XMVectorDivide(XMVectorMultiply(dzy, scale), six);
+
+            // cross((-1, 0, dzx), (0, -1, dzy)) is (dzx, dzy, 1), which is never zero length
+            const XMVECTOR length = XMVectorSqrt(XMVectorAdd(XMVectorAdd(XMVectorMultiply(dzx, dzx), XMVectorMultiply(dzy, dzy)), g_XMOne));
+            XMVECTOR nx = XMVectorDivide(dzx, length);
+            XMVECTOR ny = XMVectorDivide(dzy, length);
+            XMVECTOR nz = XMVectorDivide(g_XMOne, length);
+
+            XMVECTOR alpha = g_XMOne;
+            if (flags & CNMAP_COMPUTE_OCCLUSION)
+            {
+                // Sum of the positive differences to the eight neighbors
+                XMVECTOR delta = XMVectorMax(XMVectorSubtract(a0, b1), g_XMZero);
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(b0, b1), g_XMZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(c0, b1), g_XMZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(a1, b1), g_XMZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(c1, b1), g_XMZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(a2, b1), g_XMZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(b2, b1), g_XMZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(c2, b1), g_XMZero));
+                delta = XMVectorMultiply(delta, occlusionScale);
+
+                const XMVECTOR r = XMVectorSqrt(XMVectorAdd(g_XMOne, XMVectorMultiply(delta, delta)));
+                const XMVECTOR occlusion = XMVectorDivide(XMVectorSubtract(r, delta), r);
+                alpha = XMVectorSelect(alpha, occlusion, XMVectorGreater(delta, g_XMZero));
+            }
+
+            // Encode based on target format
+            if (negate)
+            {
+                nx = XMVectorNegate(nx);
+                ny = XMVectorNegate(ny);
+                nz = XMVectorNegate(nz);
+            }
+            else
+            {
+                nx = XMVectorMultiplyAdd(encodeScale, nx, encodeBias);
+                ny = XMVectorMultiplyAdd(encodeScale, ny, encodeBias);
+                nz = XMVectorMultiplyAdd(encodeScale, nz, encodeBias);
+            }
+
+            const XMMATRIX pixels = XMMatrixTranspose(XMMATRIX(nx, ny, nz, alpha));
+            pDest[x] = pixels.r[0];
+            pDest[x + 1] = pixels.r[1];
+            pDest[x + 2] = pixels.r[2];
+            pDest[x + 3] = pixels.r[3];
+        }
+
+        for (; x < width; ++x)
+        {
+            pDest[x] = ComputeNormal(val0 + x, val1 + x, val2 + x, flags, amplitude, unorm);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    // Generates rows y0 up to y1 of the normal map. Each band evaluates its own
+    // rows plus one above and one below, so bands are independent of each other.
+    HRESULT ComputeNMapBand(
+        const Image& srcImage,
+        CNMAP_FLAGS flags,
+        float amplitude,
+        DXGI_FORMAT format,
+        bool unorm,
+        const Image& normalMap,
+        size_t y0,
+        size_t y1) noexcept
+    {
+        const size_t width = srcImage.width;
+        const size_t height = srcImage.height;
+        const size_t rows = y1 - y0 + 2;
+        const size_t stride = width + 2;
+
+        // Allocate temporary space (2 scanlines and the evaluated rows of the band)
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        auto buffer = make_AlignedArrayFloat(uint64_t(stride) * rows);
+        if (!buffer)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* row = scanline.get();
+        XMVECTOR* target = row + width;
+
+        const size_t rowPitch = srcImage.rowPitch;
+        for (size_t j = 0; j < rows; ++j)
+        {
+            const size_t sy = SourceRow(static_cast<ptrdiff_t>(y0 + j) - 1, height, flags);
+            if (!LoadScanline(row, width, srcImage.pixels + rowPitch * sy, rowPitch, srcImage.format))
+                return E_FAIL;
+
+            EvaluateRow(row, buffer.get() + stride * j, width, flags);
+        }
+
+        uint8_t* pDest = normalMap.pixels + normalMap.rowPitch * y0;
+        for (size_t y = y0; y < y1; ++y)
+        {
+            const float* val0 = buffer.get() + stride * (y - y0);
+
+            ComputeNormalRow(val0, val0 + stride, val0 + stride * 2, target, width, flags, amplitude, unorm);
+
+            if (!StoreScanline(pDest, normalMap.rowPitch, format, target, width))
+                return E_FAIL;
+
+            pDest += normalMap.rowPitch;
+        }
+
+        return S_OK;
+    }
+
     HRESULT ComputeNMap(_In_ const Image& srcImage, _In_ CNMAP_FLAGS flags, _In_ float amplitude,
         _In_ DXGI_FORMAT format, _In_ const Image& normalMap) noexcept
     {
@@ -92,153 +329,189 @@ namespace
         if (width != normalMap.width || height != normalMap.height)
             return E_FAIL;
 
-        // Allocate temporary space (4 scanlines and 3 evaluated rows)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 4);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        const bool unorm = (convFlags & CONVF_UNORM) != 0;
 
-        auto buffer = make_AlignedArrayFloat((uint64_t(width) + 2) * 3);
-        if (!buffer)
-            return E_OUTOFMEMORY;
+        const size_t nbands = (height + NMAP_BAND_ROWS - 1) / NMAP_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
 
-        uint8_t* pDest = normalMap.pixels;
-        if (!pDest)
-            return E_POINTER;
+        std::atomic<HRESULT> result(S_OK);
 
-        XMVECTOR* row0 = scanline.get();
-        XMVECTOR* row1 = row0 + width;
-        XMVECTOR* row2 = row1 + width;
-        XMVECTOR* target = row2 + width;
+    #ifdef _OPENMP
+        const WorkerThreads workers;
 
-        float* val0 = buffer.get();
-        float* val1 = val0 + width + 2;
-        float* val2 = val1 + width + 2;
+        #pragma omp parallel if (nbands > 1 && width * height >= NMAP_PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
 
-        const size_t rowPitch = srcImage.rowPitch;
-        const uint8_t* pSrc = srcImage.pixels;
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                if (FAILED(result.load(std::memory_order_relaxed)))
+                    continue;
 
-        // Read first scanline row into 'row1'
-        if (!LoadScanline(row1, width, pSrc, rowPitch, srcImage.format))
-            return E_FAIL;
+                const size_t y0 = size_t(band) * NMAP_BAND_ROWS;
+                const size_t y1 = std::min(y0 + NMAP_BAND_ROWS, height);
 
-        // Setup 'row0'
-        if (flags & CNMAP_MIRROR_V)
-        {
-            // Mirror first row
-            memcpy(row0, row1, rowPitch);
-        }
-        else
-        {
-            // Read last row (Wrap V)
-            if (!LoadScanline(row0, width, pSrc + (rowPitch * (height - 1)), rowPitch, srcImage.format))
-                return E_FAIL;
+                const HRESULT hr = ComputeNMapBand(srcImage, flags, amplitude, format, unorm, normalMap, y0, y1);
+                if (FAILED(hr))
+                {
+                    HRESULT expected = S_OK;
+                    result.compare_exchange_strong(expected, hr);
+                }
+            }
         }
 
-        // Evaluate the initial rows
-        EvaluateRow(row0, val0, width, flags);
-        EvaluateRow(row1, val1, width, flags);
+        return result.load();
+    }
 
-        pSrc += rowPitch;
+    //---------------------------------------------------------------------------------
+    // Builds each mip level from the one above with a 2x2 box filter. The averaged
+    // vectors are renormalized so lower levels stay unit length rather than shrinking
+    // wherever the normals diverge; alpha (occlusion) is averaged as is. Formats with
+    // no blue channel have z rebuilt from x and y for each texel before averaging.
+    HRESULT GenerateNormalMipRows(
+        const Image& srcImage,
+        const Image& destImage,
+        CNMAP_FLAGS flags,
+        bool unorm,
+        bool hasBlue,
+        size_t y0,
+        size_t y1) noexcept
+    {
+        const size_t srcWidth = srcImage.width;
+        const size_t width = destImage.width;
 
-        for (size_t y = 0; y < height; ++y)
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcWidth) * 2 + width);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        XMVECTOR* urow0 = scanline.get();
+        XMVECTOR* urow1 = urow0 + srcWidth;
+        XMVECTOR* target = urow1 + srcWidth;
+
+        // Flat normal in the encoded sign, for blocks whose normals cancel out
+        const XMVECTOR flat = (flags & CNMAP_INVERT_SIGN) ? g_XMNegIdentityR2.v : g_XMIdentityR2.v;
+        const XMVECTOR quarter = XMVectorReplicate(0.25f);
+        const float zSign = (flags & CNMAP_INVERT_SIGN) ? -1.f : 1.f;
+
+        auto decode = [&](FXMVECTOR value) noexcept -> XMVECTOR
         {
-            // Load next scanline of source image
-            if (y < (height - 1))
-            {
-                if (!LoadScanline(row2, width, pSrc, rowPitch, srcImage.format))
-                    return E_FAIL;
-            }
-            else
+            const XMVECTOR d = (unorm) ? XMVectorMultiplyAdd(value, g_XMTwo, g_XMNegativeOne) : value;
+            const float z = sqrtf(std::max(0.f, 1.f - XMVectorGetX(XMVector2Dot(d, d))));
+            return XMVectorSetZ(d, z * zSign);
+        };
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            const size_t sy0 = y * 2;
+            const size_t sy1 = std::min(sy0 + 1, srcImage.height - 1);
+
+            if (!LoadScanline(urow0, srcWidth, srcImage.pixels + srcImage.rowPitch * sy0, srcImage.rowPitch, srcImage.format)
+                || !LoadScanline(urow1, srcWidth, srcImage.pixels + srcImage.rowPitch * sy1, srcImage.rowPitch, srcImage.format))
+                return E_FAIL;
+
+            for (size_t x = 0; x < width; ++x)
             {
-                if (flags & CNMAP_MIRROR_V)
+                const size_t sx0 = x * 2;
+                const size_t sx1 = std::min(sx0 + 1, srcWidth - 1);
+
+                XMVECTOR v = XMVectorAdd(XMVectorAdd(urow0[sx0], urow0[sx1]), XMVectorAdd(urow1[sx0], urow1[sx1]));
+                v = XMVectorMultiply(v, quarter);
+
+                // Decode from 0..1 (the sign inversion is kept through the round trip)
+                XMVECTOR d;
+                if (hasBlue)
                 {
-                    // Use last row of source image
-                    if (!LoadScanline(row2, width, srcImage.pixels + (rowPitch * (height - 1)), rowPitch, srcImage.format))
-                        return E_FAIL;
+                    d = (unorm) ? XMVectorMultiplyAdd(v, g_XMTwo, g_XMNegativeOne) : v;
                 }
                 else
                 {
-                    // Use first row of source image (Wrap V)
-                    if (!LoadScanline(row2, width, srcImage.pixels, rowPitch, srcImage.format))
-                        return E_FAIL;
+                    d = XMVectorAdd(XMVectorAdd(decode(urow0[sx0]), decode(urow0[sx1])),
+                        XMVectorAdd(decode(urow1[sx0]), decode(urow1[sx1])));
+                    d = XMVectorMultiply(d, quarter);
                 }
+
+                const XMVECTOR lengthSq = XMVector3LengthSq(d);
+                XMVECTOR n = (XMVectorGetX(lengthSq) > 1e-12f) ? XMVectorDivide(d, XMVectorSqrt(lengthSq)) : flat;
+
+                if (unorm)
+                {
+                    n = XMVectorMultiplyAdd(n, g_XMOneHalf, g_XMOneHalf);
+                }
+
+                // Alpha is a plain average
+                target[x] = XMVectorSelect(v, n, g_XMSelect1110);
             }
 
-            // Evaluate row
-            EvaluateRow(row2, val2, width, flags);
+            if (!StoreScanline(destImage.pixels + destImage.rowPitch * y, destImage.rowPitch, destImage.format, target, width))
+                return E_FAIL;
+        }
 
-            // Generate target scanline
-            XMVECTOR *dptr = target;
-            for (size_t x = 0; x < width; ++x)
-            {
-                // Compute normal via central differencing
-                float totDelta = (val0[x] - val0[x + 2]) + (val1[x] - val1[x + 2]) + (val2[x] - val2[x + 2]);
-                const float deltaZX = totDelta * amplitude / 6.f;
+        return S_OK;
+    }
 
-                totDelta = (val0[x] - val2[x]) + (val0[x + 1] - val2[x + 1]) + (val0[x + 2] - val2[x + 2]);
-                const float deltaZY = totDelta * amplitude / 6.f;
+    HRESULT GenerateNormalMips(
+        _In_reads_(levels) const Image* images,
+        size_t levels,
+        CNMAP_FLAGS flags) noexcept
+    {
+        assert(images && levels > 0);
 
-                const XMVECTOR vx = XMVectorSetZ(g_XMNegIdentityR0, deltaZX);   // (-1.0f, 0.0f, deltaZX)
-                const XMVECTOR vy = XMVectorSetZ(g_XMNegIdentityR1, deltaZY);   // (0.0f, -1.0f, deltaZY)
+        const uint32_t convFlags = GetConvertFlags(images[0].format);
+        if (!convFlags)
+            return E_FAIL;
 
-                const XMVECTOR normal = XMVector3Normalize(XMVector3Cross(vx, vy));
+        const bool unorm = (convFlags & CONVF_UNORM) != 0;
+        const bool hasBlue = (convFlags & CONVF_B) != 0;
 
-                // Compute alpha (1.0 or an occlusion term)
-                float alpha = 1.f;
+        for (size_t level = 1; level < levels; ++level)
+        {
+            const Image& src = images[level - 1];
+            const Image& dest = images[level];
+            if (!src.pixels || !dest.pixels)
+                return E_POINTER;
 
-                if (flags & CNMAP_COMPUTE_OCCLUSION)
+            const size_t nbands = (dest.height + NMAP_BAND_ROWS - 1) / NMAP_BAND_ROWS;
+            if (nbands > INT32_MAX)
+                return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+            std::atomic<HRESULT> result(S_OK);
+
+        #ifdef _OPENMP
+            const WorkerThreads workers;
+
+            #pragma omp parallel if (nbands > 1 && dest.width * dest.height >= NMAP_PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+        #endif
+            {
+            #ifdef _OPENMP
+                const WorkerAffinity affinity(workers);
+
+                #pragma omp for
+            #endif
+                for (int band = 0; band < static_cast<int>(nbands); ++band)
                 {
-                    float delta = 0.f;
-                    const float c = val1[x + 1];
-
-                    float t = val0[x] - c;  if (t > 0.f) delta += t;
-                    t = val0[x + 1] - c;    if (t > 0.f) delta += t;
-                    t = val0[x + 2] - c;    if (t > 0.f) delta += t;
-                    t = val1[x] - c;    if (t > 0.f) delta += t;
-                    // Skip current pixel
-                    t = val1[x + 2] - c;    if (t > 0.f) delta += t;
-                    t = val2[x] - c;    if (t > 0.f) delta += t;
-                    t = val2[x + 1] - c;    if (t > 0.f) delta += t;
-                    t = val2[x + 2] - c;    if (t > 0.f) delta += t;
-
-                    // Average delta (divide by 8, scale by amplitude factor)
-                    delta *= 0.125f * amplitude;
-                    if (delta > 0.f)
+                    if (FAILED(result.load(std::memory_order_relaxed)))
+                        continue;
+
+                    const size_t y0 = size_t(band) * NMAP_BAND_ROWS;
+                    const size_t y1 = std::min(y0 + NMAP_BAND_ROWS, dest.height);
+
+                    const HRESULT hr = GenerateNormalMipRows(src, dest, flags, unorm, hasBlue, y0, y1);
+                    if (FAILED(hr))
                     {
-                        // If < 0, then no occlusion
-                        const float r = sqrtf(1.f + delta*delta);
-                        alpha = (r - delta) / r;
+                        HRESULT expected = S_OK;
+                        result.compare_exchange_strong(expected, hr);
                     }
                 }
-
-                // Encode based on target format
-                if (convFlags & CONVF_UNORM)
-                {
-                    // 0.5f*normal + 0.5f -or- invert sign case: -0.5f*normal + 0.5f
-                    const XMVECTOR n1 = XMVectorMultiplyAdd((flags & CNMAP_INVERT_SIGN) ? g_XMNegativeOneHalf : g_XMOneHalf, normal, g_XMOneHalf);
-                    *dptr++ = XMVectorSetW(n1, alpha);
-                }
-                else if (flags & CNMAP_INVERT_SIGN)
-                {
-                    *dptr++ = XMVectorSetW(XMVectorNegate(normal), alpha);
-                }
-                else
-                {
-                    *dptr++ = XMVectorSetW(normal, alpha);
-                }
             }
 
-            if (!StoreScanline(pDest, normalMap.rowPitch, format, target, width))
-                return E_FAIL;
-
-            // Cycle buffers
-            float* temp = val0;
-            val0 = val1;
-            val1 = val2;
-            val2 = temp;
-
-            pSrc += rowPitch;
-            pDest += normalMap.rowPitch;
+            const HRESULT hr = result.load();
+            if (FAILED(hr))
+                return hr;
         }
 
         return S_OK;
@@ -288,7 +561,8 @@ HRESULT DirectX::ComputeNormalMap(
     // Setup target image
     normalMap.Release();
 
-    HRESULT hr = normalMap.Initialize2D(format, srcImage.width, srcImage.height, 1, 1);
+    const size_t mipLevels = (flags & CNMAP_GENERATE_MIPS) ? 0u : 1u;
+    HRESULT hr = normalMap.Initialize2D(format, srcImage.width, srcImage.height, 1, mipLevels);
     if (FAILED(hr))
         return hr;
 
@@ -306,6 +580,16 @@ HRESULT DirectX::ComputeNormalMap(
         return hr;
     }
 
+    if (normalMap.GetImageCount() > 1)
+    {
+        hr = GenerateNormalMips(normalMap.GetImages(), normalMap.GetImageCount(), flags);
+        if (FAILED(hr))
+        {
+            normalMap.Release();
+            return hr;
+        }
+    }
+
     return S_OK;
 }
 
@@ -343,15 +627,32 @@ HRESULT DirectX::ComputeNormalMap(
         return E_INVALIDARG;
     }
 
+    const bool generateMips = (flags & CNMAP_GENERATE_MIPS) != 0;
+    if (generateMips)
+    {
+        // The chain is built from the top level, so the source must not have one already
+        if (metadata.dimension == TEX_DIMENSION_TEXTURE3D)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        if (metadata.mipLevels != 1)
+            return E_INVALIDARG;
+    }
+
     normalMaps.Release();
 
     TexMetadata mdata2 = metadata;
     mdata2.format = format;
+    if (generateMips)
+    {
+        mdata2.mipLevels = 0;
+    }
+
     HRESULT hr = normalMaps.Initialize(mdata2);
     if (FAILED(hr))
         return hr;
 
-    if (nimages != normalMaps.GetImageCount())
+    const size_t levels = normalMaps.GetMetadata().mipLevels;
+    if (nimages * levels != normalMaps.GetImageCount())
     {
         normalMaps.Release();
         return E_FAIL;
@@ -366,7 +667,9 @@ HRESULT DirectX::ComputeNormalMap(
 
     for (size_t index = 0; index < nimages; ++index)
     {
-        assert(dest[index].format == format);
+        // With generated mips, each source image is the top of a chain of 'levels' images
+        const Image& target = dest[index * levels];
+        assert(target.format == format);
 
         const Image& src = srcImages[index];
         if (IsCompressed(src.format) || IsTypeless(src.format))
@@ -375,18 +678,28 @@ HRESULT DirectX::ComputeNormalMap(
             return HRESULT_E_NOT_SUPPORTED;
         }
 
-        if (src.width != dest[index].width || src.height != dest[index].height)
+        if (src.width != target.width || src.height != target.height)
         {
             normalMaps.Release();
             return E_FAIL;
         }
 
-        hr = ComputeNMap(src, flags, amplitude, format, dest[index]);
+        hr = ComputeNMap(src, flags, amplitude, format, target);
         if (FAILED(hr))
         {
             normalMaps.Release();
             return hr;
         }
+
+        if (levels > 1)
+        {
+            hr = GenerateNormalMips(&target, levels, flags);
+            if (FAILED(hr))
+            {
+                normalMaps.Release();
+                return hr;
+            }
+        }
     }
 
     return S_OK;
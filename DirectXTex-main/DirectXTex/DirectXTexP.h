@@ -130,6 +130,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <ctime>
@@ -216,6 +217,11 @@ using WICPixelFormatGUID = GUID;
 #define E_NOT_SUFFICIENT_BUFFER static_cast<HRESULT>(0x8007007AL)
 #endif
 
+// Returned when a ProgressContext cancels an operation
+#ifndef E_ABORT
+#define E_ABORT static_cast<HRESULT>(0x80004004L)
+#endif
+
 //-------------------------------------------------------------------------------------
 namespace DirectX
 {
@@ -375,6 +381,25 @@ namespace DirectX
             _In_reads_bytes_(inSize) const void* pSource, _In_ size_t inSize,
             _In_ DXGI_FORMAT format, _In_ uint32_t tflags) noexcept;
 
+        constexpr uint32_t TEXP_REMAP_CONSTANT = 0xff;
+
+        struct ChannelRemap
+        {
+            size_t      elementSize;    // Bytes per channel (1 or 2)
+            size_t      srcChannels;    // Channels per source pixel (1, 2, or 4)
+            size_t      destChannels;   // Channels per destination pixel (1, 2, or 4)
+            uint32_t    source[4];      // Source slot for each destination slot, or TEXP_REMAP_CONSTANT
+            uint32_t    constant[4];    // Value stored in TEXP_REMAP_CONSTANT slots
+        };
+
+        _Success_(return) bool __cdecl SetupChannelRemap(
+            _In_ DXGI_FORMAT inFormat, _In_ DXGI_FORMAT outFormat,
+            _In_reads_(4) const uint32_t* channels, _Out_ ChannelRemap& remap) noexcept;
+
+        void __cdecl RemapScanline(
+            _Out_ void* pDestination, _In_ const void* pSource, _In_ size_t count,
+            _In_ const ChannelRemap& remap) noexcept;
+
         _Success_(return) bool __cdecl ExpandScanline(
             _Out_writes_bytes_(outSize) void* pDestination, _In_ size_t outSize,
             _In_ DXGI_FORMAT outFormat,
@@ -406,6 +431,14 @@ namespace DirectX
             _In_ float threshold, size_t y, size_t z,
             _Inout_updates_all_opt_(count + 2) XMVECTOR* pDiffusionErrors) noexcept;
 
+        // Resolves the scanline kernel for a format once, so per-row loops skip the format switch.
+        // Formats without a dedicated kernel resolve to LoadScanline / StoreScanline.
+        using LoadScanlineFunc = bool (__cdecl *)(XMVECTOR*, size_t, const void*, size_t, DXGI_FORMAT);
+        using StoreScanlineFunc = bool (__cdecl *)(void*, size_t, DXGI_FORMAT, const XMVECTOR*, size_t, float);
+
+        LoadScanlineFunc __cdecl GetLoadScanline(_In_ DXGI_FORMAT format) noexcept;
+        StoreScanlineFunc __cdecl GetStoreScanline(_In_ DXGI_FORMAT format) noexcept;
+
         HRESULT __cdecl ConvertToR32G32B32A32(_In_ const Image& srcImage, _Inout_ ScratchImage& image) noexcept;
 
         HRESULT __cdecl ConvertFromR32G32B32A32(_In_ const Image& srcImage, _In_ const Image& destImage) noexcept;
@@ -430,6 +463,16 @@ namespace DirectX
         bool __cdecl CalculateMipLevels3D(_In_ size_t width, _In_ size_t height, _In_ size_t depth,
             _Inout_ size_t& mipLevels) noexcept;
 
+        //---------------------------------------------------------------------------------
+        // Metadata probing from positioned reads (used by GetMetadataFromFiles)
+        using ReadAtFunc = bool(__cdecl*)(_In_opt_ void* context, _In_ uint64_t offset,
+            _Out_writes_bytes_(bytes) void* buffer, _In_ size_t bytes) noexcept;
+
+        HRESULT __cdecl GetMetadataFromTGAReader(
+            _In_reads_bytes_(headerSize) const void* pHeader, _In_ size_t headerSize, _In_ uint64_t fileSize,
+            _In_ ReadAtFunc readAt, _In_opt_ void* context,
+            _In_ TGA_FLAGS flags, _Out_ TexMetadata& metadata) noexcept;
+
     #ifdef _WIN32
         HRESULT __cdecl ResizeSeparateColorAndAlpha(_In_ IWICImagingFactory* pWIC,
             _In_ bool iswic2,
@@ -438,5 +481,99 @@ namespace DirectX
             _Inout_ const Image* img) noexcept;
     #endif
 
+        //---------------------------------------------------------------------------------
+        // Progress reporting for a single call of a public function
+        class ProgressTracker
+        {
+        public:
+            ProgressTracker(_In_opt_ ProgressContext* context, _In_ size_t total) noexcept;
+
+            ProgressTracker(const ProgressTracker&) = delete;
+            ProgressTracker& operator=(const ProgressTracker&) = delete;
+
+            bool __cdecl Advance(_In_ size_t units) noexcept;
+                // Returns false once the operation should stop; safe to call from worker threads
+
+            bool IsCancelled() const noexcept { return m_context && m_context->IsCancelled(); }
+
+        private:
+            ProgressContext*    m_context;
+            size_t              m_total;
+            size_t              m_interval;
+            std::atomic<size_t> m_completed;
+            std::atomic<size_t> m_nextReport;
+        };
+
+        //---------------------------------------------------------------------------------
+        // Worker threads for OpenMP regions, following the ThreadPolicy of the calling thread
+        struct ResolvedThreadPolicy;
+
+        class WorkerThreads
+        {
+        public:
+            WorkerThreads() noexcept;
+
+            int __cdecl Count() const noexcept;
+                // Use as the num_threads clause of the parallel region
+
+            size_t __cdecl Limit() const noexcept;
+                // The policy's thread cap, or 0 if none; for I/O-bound pools that oversubscribe Count()
+
+        private:
+            std::shared_ptr<const ResolvedThreadPolicy> m_policy;
+
+            friend class WorkerAffinity;
+        };
+
+        class WorkerAffinity
+        {
+        public:
+            // Restricts the calling worker to the policy's processors until destroyed
+            explicit WorkerAffinity(_In_ const WorkerThreads& workers) noexcept;
+            ~WorkerAffinity();
+
+            WorkerAffinity(const WorkerAffinity&) = delete;
+            WorkerAffinity& operator=(const WorkerAffinity&) = delete;
+
+        private:
+            bool        m_applied;
+            uint64_t    m_saved[16];
+        };
+
+        //---------------------------------------------------------------------------------
+        // Instrumentation (see TEX_TRACE_ZONE)
+    #ifdef DIRECTX_TEX_INSTRUMENTATION
+        class TraceZone
+        {
+        public:
+            TraceZone(_In_z_ const char* name, _In_ TRACE_OPERATION operation, _In_ const Image& image,
+                _In_ DXGI_FORMAT targetFormat = DXGI_FORMAT_UNKNOWN) noexcept;
+            TraceZone(_In_z_ const char* name, _In_ TRACE_OPERATION operation,
+                _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+                _In_ DXGI_FORMAT targetFormat = DXGI_FORMAT_UNKNOWN) noexcept;
+            TraceZone(_In_z_ const char* name, _In_ const ScratchImage& result) noexcept;
+                // For load functions; the decoded format and dimensions are reported when the zone ends
+            ~TraceZone();
+
+            TraceZone(const TraceZone&) = delete;
+            TraceZone& operator=(const TraceZone&) = delete;
+
+        private:
+            ITraceSink*         m_sink;
+            const ScratchImage* m_result;
+            TraceEvent          m_event;
+
+            void Begin() noexcept;
+        };
+    #endif
+
     } // namespace Internal
 } // namespace DirectX
+
+// Reports the enclosing public function to the trace sink when built with DIRECTX_TEX_INSTRUMENTATION;
+// a zone nested in one for the same operation on the same thread is not reported
+#ifdef DIRECTX_TEX_INSTRUMENTATION
+#define TEX_TRACE_ZONE(...) const DirectX::Internal::TraceZone texTraceZone(__func__, __VA_ARGS__)
+#else
+#define TEX_TRACE_ZONE(...) ((void)0)
+#endif
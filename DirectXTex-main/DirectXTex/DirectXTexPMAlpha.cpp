@@ -27,7 +27,7 @@ namespace
 
     //---------------------------------------------------------------------------------
     // NonPremultiplied alpha -> Premultiplied alpha
-    HRESULT PremultiplyAlpha_(const Image& srcImage, const Image& destImage) noexcept
+    HRESULT PremultiplyAlpha_(const Image& srcImage, const Image& destImage, size_t y0, size_t y1) noexcept
     {
         assert(srcImage.width == destImage.width);
         assert(srcImage.height == destImage.height);
@@ -36,12 +36,10 @@ namespace
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
+        const uint8_t *pSrc = srcImage.pixels + y0 * srcImage.rowPitch;
+        uint8_t *pDest = destImage.pixels + y0 * destImage.rowPitch;
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
             if (!LoadScanline(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
                 return E_FAIL;
@@ -65,7 +63,7 @@ namespace
         return S_OK;
     }
 
-    HRESULT PremultiplyAlphaLinear(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage) noexcept
+    HRESULT PremultiplyAlphaLinear(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage, size_t y0, size_t y1) noexcept
     {
         assert(srcImage.width == destImage.width);
         assert(srcImage.height == destImage.height);
@@ -79,14 +77,12 @@ namespace
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
+        const uint8_t *pSrc = srcImage.pixels + y0 * srcImage.rowPitch;
+        uint8_t *pDest = destImage.pixels + y0 * destImage.rowPitch;
 
         const TEX_FILTER_FLAGS filter = GetSRGBFlags(flags);
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
             if (!LoadScanlineLinear(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format, filter))
                 return E_FAIL;
@@ -112,7 +108,7 @@ namespace
 
     //---------------------------------------------------------------------------------
     // Premultiplied alpha -> NonPremultiplied alpha (a.k.a. Straight alpha)
-    HRESULT DemultiplyAlpha(const Image& srcImage, const Image& destImage) noexcept
+    HRESULT DemultiplyAlpha(const Image& srcImage, const Image& destImage, size_t y0, size_t y1) noexcept
     {
         assert(srcImage.width == destImage.width);
         assert(srcImage.height == destImage.height);
@@ -121,12 +117,10 @@ namespace
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
+        const uint8_t *pSrc = srcImage.pixels + y0 * srcImage.rowPitch;
+        uint8_t *pDest = destImage.pixels + y0 * destImage.rowPitch;
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
             if (!LoadScanline(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
                 return E_FAIL;
@@ -153,7 +147,7 @@ namespace
         return S_OK;
     }
 
-    HRESULT DemultiplyAlphaLinear(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage) noexcept
+    HRESULT DemultiplyAlphaLinear(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage, size_t y0, size_t y1) noexcept
     {
         assert(srcImage.width == destImage.width);
         assert(srcImage.height == destImage.height);
@@ -167,14 +161,12 @@ namespace
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
+        const uint8_t *pSrc = srcImage.pixels + y0 * srcImage.rowPitch;
+        uint8_t *pDest = destImage.pixels + y0 * destImage.rowPitch;
 
         const TEX_FILTER_FLAGS filter = GetSRGBFlags(flags);
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
             if (!LoadScanlineLinear(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format, filter))
                 return E_FAIL;
@@ -200,6 +192,402 @@ namespace
 
         return S_OK;
     }
+
+    //---------------------------------------------------------------------------------
+    // Integer kernels for 8-bit RGBA/BGRA (the color channels are treated alike, and
+    // alpha is always the top byte)
+
+    // Rows per parallel work item
+    constexpr size_t PMALPHA_BAND_ROWS = 64;
+
+    // Smaller images are not worth starting worker threads for
+    constexpr size_t PMALPHA_PARALLEL_MIN_PIXELS = 64 * 1024;
+
+    bool Is8BitRGBA(DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    // round(c * a / 255), which the float path also produces as c * a / 255 is never exactly halfway
+    inline uint32_t MultiplyUNorm8(uint32_t c, uint32_t a) noexcept
+    {
+        const uint32_t t = c * a + 128;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    void PremultiplyAlpha8(const Image& srcImage, const Image& destImage, size_t y0, size_t y1) noexcept
+    {
+        const size_t width = srcImage.width;
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            const uint8_t* pSrc = srcImage.pixels + y * srcImage.rowPitch;
+            uint8_t* pDest = destImage.pixels + y * destImage.rowPitch;
+
+            size_t x = 0;
+
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            // Alpha is multiplied by 255 so it comes back unchanged
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+            const __m128i alpha255 = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+            const __m128i bias = _mm_set1_epi16(128);
+
+            for (; x + 4 <= width; x += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + x * 4));
+
+                __m128i lo = _mm_unpacklo_epi8(v, zero);
+                __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+                __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                alo = _mm_or_si128(_mm_and_si128(alo, colorMask), alpha255);
+                ahi = _mm_or_si128(_mm_and_si128(ahi, colorMask), alpha255);
+
+                lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), bias);
+                hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), bias);
+                lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+                hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_packus_epi16(lo, hi));
+            }
+        #endif
+
+            for (; x < width; ++x)
+            {
+                const uint8_t* sptr = pSrc + x * 4;
+                uint8_t* dptr = pDest + x * 4;
+                const uint32_t a = sptr[3];
+                dptr[0] = static_cast<uint8_t>(MultiplyUNorm8(sptr[0], a));
+                dptr[1] = static_cast<uint8_t>(MultiplyUNorm8(sptr[1], a));
+                dptr[2] = static_cast<uint8_t>(MultiplyUNorm8(sptr[2], a));
+                dptr[3] = static_cast<uint8_t>(a);
+            }
+        }
+    }
+
+    // ceil(255 * 65536 / a); (c * r + 32768) >> 16 is then c * 255 / a rounded to nearest, halves up,
+    // for every c <= a (verified exhaustively) and never overflows 32 bits
+    struct ReciprocalTable
+    {
+        uint32_t r[256];
+
+        ReciprocalTable() noexcept : r{}
+        {
+            for (uint32_t a = 1; a < 256; ++a)
+            {
+                r[a] = (255u * 65536u + a - 1) / a;
+            }
+        }
+    };
+
+    void DemultiplyAlpha8(const Image& srcImage, const Image& destImage, size_t y0, size_t y1) noexcept
+    {
+        static const ReciprocalTable s_recip;
+
+        const size_t width = srcImage.width;
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            const uint8_t* pSrc = srcImage.pixels + y * srcImage.rowPitch;
+            uint8_t* pDest = destImage.pixels + y * destImage.rowPitch;
+
+            size_t x = 0;
+
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            // The reciprocal is split into 16-bit halves so the 32-bit product fits SSE2 16-bit
+            // multiplies: (c * r + 32768) >> 16 == c * rh + mulhi(c, rl) + (mullo(c, rl) >> 15).
+            // Alpha, and texels with zero alpha, are copied from the source afterwards.
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i alphaMask = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+            auto splat = [](uint32_t r0, uint32_t r1) noexcept
+                {
+                    return _mm_unpacklo_epi64(_mm_set1_epi16(static_cast<short>(r0)), _mm_set1_epi16(static_cast<short>(r1)));
+                };
+
+            for (; x + 4 <= width; x += 4)
+            {
+                const uint8_t* sptr = pSrc + x * 4;
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sptr));
+
+                const uint32_t r0 = s_recip.r[sptr[3]];
+                const uint32_t r1 = s_recip.r[sptr[7]];
+                const uint32_t r2 = s_recip.r[sptr[11]];
+                const uint32_t r3 = s_recip.r[sptr[15]];
+
+                const __m128i srcLo = _mm_unpacklo_epi8(v, zero);
+                const __m128i srcHi = _mm_unpackhi_epi8(v, zero);
+
+                const __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                const __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+                // Colors brighter than alpha aren't valid premultiplied data, and saturate
+                const __m128i clo = _mm_min_epi16(srcLo, alo);
+                const __m128i chi = _mm_min_epi16(srcHi, ahi);
+
+                const __m128i rlLo = splat(r0 & 0xffff, r1 & 0xffff);
+                const __m128i rlHi = splat(r2 & 0xffff, r3 & 0xffff);
+
+                __m128i lo = _mm_add_epi16(_mm_mullo_epi16(clo, splat(r0 >> 16, r1 >> 16)), _mm_mulhi_epu16(clo, rlLo));
+                __m128i hi = _mm_add_epi16(_mm_mullo_epi16(chi, splat(r2 >> 16, r3 >> 16)), _mm_mulhi_epu16(chi, rlHi));
+                lo = _mm_add_epi16(lo, _mm_srli_epi16(_mm_mullo_epi16(clo, rlLo), 15));
+                hi = _mm_add_epi16(hi, _mm_srli_epi16(_mm_mullo_epi16(chi, rlHi), 15));
+
+                const __m128i keepLo = _mm_or_si128(alphaMask, _mm_cmpeq_epi16(alo, zero));
+                const __m128i keepHi = _mm_or_si128(alphaMask, _mm_cmpeq_epi16(ahi, zero));
+                lo = _mm_or_si128(_mm_and_si128(keepLo, srcLo), _mm_andnot_si128(keepLo, lo));
+                hi = _mm_or_si128(_mm_and_si128(keepHi, srcHi), _mm_andnot_si128(keepHi, hi));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_packus_epi16(lo, hi));
+            }
+        #endif
+
+            for (; x < width; ++x)
+            {
+                const uint8_t* sptr = pSrc + x * 4;
+                uint8_t* dptr = pDest + x * 4;
+                const uint32_t a = sptr[3];
+                if (!a)
+                {
+                    // Matches the float path, which leaves zero-alpha texels alone
+                    memcpy(dptr, sptr, 4);
+                    continue;
+                }
+
+                // Colors brighter than alpha aren't valid premultiplied data, and saturate
+                const uint32_t r = s_recip.r[a];
+                dptr[0] = static_cast<uint8_t>((std::min<uint32_t>(sptr[0], a) * r + 32768u) >> 16);
+                dptr[1] = static_cast<uint8_t>((std::min<uint32_t>(sptr[1], a) * r + 32768u) >> 16);
+                dptr[2] = static_cast<uint8_t>((std::min<uint32_t>(sptr[2], a) * r + 32768u) >> 16);
+                dptr[3] = static_cast<uint8_t>(a);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    // sRGB conversions go through a 256x256 table per mode indexed by [alpha][color],
+    // filled by running the float path over every combination so results match it exactly
+    std::unique_ptr<uint8_t[]> BuildAlphaTable(bool reverse, TEX_PMALPHA_FLAGS srgb) noexcept
+    {
+        constexpr size_t pitch = 256 * 4;
+
+        std::unique_ptr<uint8_t[]> src(new (std::nothrow) uint8_t[pitch * 256]);
+        std::unique_ptr<uint8_t[]> dest(new (std::nothrow) uint8_t[pitch * 256]);
+        std::unique_ptr<uint8_t[]> table(new (std::nothrow) uint8_t[256 * 256]);
+        if (!src || !dest || !table)
+            return nullptr;
+
+        for (size_t a = 0; a < 256; ++a)
+        {
+            uint8_t* ptr = src.get() + a * pitch;
+            for (size_t c = 0; c < 256; ++c, ptr += 4)
+            {
+                ptr[0] = ptr[1] = ptr[2] = static_cast<uint8_t>(c);
+                ptr[3] = static_cast<uint8_t>(a);
+            }
+        }
+
+        Image srcImage = {};
+        srcImage.width = srcImage.height = 256;
+        srcImage.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        srcImage.rowPitch = pitch;
+        srcImage.slicePitch = pitch * 256;
+        srcImage.pixels = src.get();
+
+        Image destImage = srcImage;
+        destImage.pixels = dest.get();
+
+        const HRESULT hr = (reverse)
+            ? DemultiplyAlphaLinear(srcImage, srgb, destImage, 0, 256)
+            : PremultiplyAlphaLinear(srcImage, srgb, destImage, 0, 256);
+        if (FAILED(hr))
+            return nullptr;
+
+        for (size_t a = 0; a < 256; ++a)
+        {
+            const uint8_t* ptr = dest.get() + a * pitch;
+            for (size_t c = 0; c < 256; ++c, ptr += 4)
+            {
+                table[a * 256 + c] = ptr[0];
+            }
+        }
+
+        return table;
+    }
+
+    // Tables are built on first use; returns nullptr if one couldn't be allocated
+    const uint8_t* GetAlphaTable(bool reverse, bool srgbIn, bool srgbOut) noexcept
+    {
+        assert(srgbIn || srgbOut);
+
+        if (reverse)
+        {
+            if (srgbIn && srgbOut)
+            {
+                static const std::unique_ptr<uint8_t[]> s_table = BuildAlphaTable(true, TEX_PMALPHA_SRGB);
+                return s_table.get();
+            }
+            else if (srgbIn)
+            {
+                static const std::unique_ptr<uint8_t[]> s_table = BuildAlphaTable(true, TEX_PMALPHA_SRGB_IN);
+                return s_table.get();
+            }
+            else
+            {
+                static const std::unique_ptr<uint8_t[]> s_table = BuildAlphaTable(true, TEX_PMALPHA_SRGB_OUT);
+                return s_table.get();
+            }
+        }
+        else
+        {
+            if (srgbIn && srgbOut)
+            {
+                static const std::unique_ptr<uint8_t[]> s_table = BuildAlphaTable(false, TEX_PMALPHA_SRGB);
+                return s_table.get();
+            }
+            else if (srgbIn)
+            {
+                static const std::unique_ptr<uint8_t[]> s_table = BuildAlphaTable(false, TEX_PMALPHA_SRGB_IN);
+                return s_table.get();
+            }
+            else
+            {
+                static const std::unique_ptr<uint8_t[]> s_table = BuildAlphaTable(false, TEX_PMALPHA_SRGB_OUT);
+                return s_table.get();
+            }
+        }
+    }
+
+    // Kept scalar: each color is a lookup into the 64 KB table, and SSE2 has no gather
+    void ApplyAlphaTable8(const Image& srcImage, const Image& destImage, const uint8_t* table, size_t y0, size_t y1) noexcept
+    {
+        const size_t width = srcImage.width;
+
+        for (size_t y = y0; y < y1; ++y)
+        {
+            const uint8_t* sptr = srcImage.pixels + y * srcImage.rowPitch;
+            uint8_t* dptr = destImage.pixels + y * destImage.rowPitch;
+
+            for (size_t x = 0; x < width; ++x, sptr += 4, dptr += 4)
+            {
+                const uint8_t a = sptr[3];
+                const uint8_t* row = table + size_t(a) * 256;
+                dptr[0] = row[sptr[0]];
+                dptr[1] = row[sptr[1]];
+                dptr[2] = row[sptr[2]];
+                dptr[3] = a;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    // Picks a kernel for the image and runs it over bands of rows
+    HRESULT PremultiplyAlphaImage(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage) noexcept
+    {
+        assert(srcImage.width == destImage.width);
+        assert(srcImage.height == destImage.height);
+        assert(srcImage.format == destImage.format);
+
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        const bool reverse = (flags & TEX_PMALPHA_REVERSE) != 0;
+        const bool ignoreSRGB = (flags & TEX_PMALPHA_IGNORE_SRGB) != 0;
+
+        enum { KERNEL_FLOAT, KERNEL_INTEGER, KERNEL_TABLE } kernel = KERNEL_FLOAT;
+        const uint8_t* table = nullptr;
+        if (Is8BitRGBA(srcImage.format))
+        {
+            const bool srgbFormat = IsSRGB(srcImage.format);
+            const bool srgbIn = !ignoreSRGB && (srgbFormat || (flags & TEX_PMALPHA_SRGB_IN));
+            const bool srgbOut = !ignoreSRGB && (srgbFormat || (flags & TEX_PMALPHA_SRGB_OUT));
+            if (!srgbIn && !srgbOut)
+            {
+                kernel = KERNEL_INTEGER;
+            }
+            else
+            {
+                table = GetAlphaTable(reverse, srgbIn, srgbOut);
+                if (table)
+                {
+                    kernel = KERNEL_TABLE;
+                }
+            }
+        }
+
+        const size_t nbands = (srcImage.height + PMALPHA_BAND_ROWS - 1) / PMALPHA_BAND_ROWS;
+        if (nbands > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::atomic<HRESULT> result(S_OK);
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+        #pragma omp parallel if (nbands > 1 && srcImage.width * srcImage.height >= PMALPHA_PARALLEL_MIN_PIXELS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+
+            #pragma omp for
+        #endif
+            for (int band = 0; band < static_cast<int>(nbands); ++band)
+            {
+                if (FAILED(result.load(std::memory_order_relaxed)))
+                    continue;
+
+                const size_t y0 = size_t(band) * PMALPHA_BAND_ROWS;
+                const size_t y1 = std::min(y0 + PMALPHA_BAND_ROWS, srcImage.height);
+
+                HRESULT hr = S_OK;
+                switch (kernel)
+                {
+                case KERNEL_INTEGER:
+                    if (reverse)
+                        DemultiplyAlpha8(srcImage, destImage, y0, y1);
+                    else
+                        PremultiplyAlpha8(srcImage, destImage, y0, y1);
+                    break;
+
+                case KERNEL_TABLE:
+                    ApplyAlphaTable8(srcImage, destImage, table, y0, y1);
+                    break;
+
+                default:
+                    if (reverse)
+                    {
+                        hr = (ignoreSRGB) ? DemultiplyAlpha(srcImage, destImage, y0, y1) : DemultiplyAlphaLinear(srcImage, flags, destImage, y0, y1);
+                    }
+                    else
+                    {
+                        hr = (ignoreSRGB) ? PremultiplyAlpha_(srcImage, destImage, y0, y1) : PremultiplyAlphaLinear(srcImage, flags, destImage, y0, y1);
+                    }
+                    break;
+                }
+
+                if (FAILED(hr))
+                {
+                    HRESULT expected = S_OK;
+                    result.compare_exchange_strong(expected, hr);
+                }
+            }
+        }
+
+        return result.load();
+    }
 }
 
 
@@ -240,14 +628,7 @@ HRESULT DirectX::PremultiplyAlpha(
         return E_POINTER;
     }
 
-    if (flags & TEX_PMALPHA_REVERSE)
-    {
-        hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? DemultiplyAlpha(srcImage, *rimage) : DemultiplyAlphaLinear(srcImage, flags, *rimage);
-    }
-    else
-    {
-        hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? PremultiplyAlpha_(srcImage, *rimage) : PremultiplyAlphaLinear(srcImage, flags, *rimage);
-    }
+    hr = PremultiplyAlphaImage(srcImage, flags, *rimage);
     if (FAILED(hr))
     {
         image.Release();
@@ -325,14 +706,7 @@ HRESULT DirectX::PremultiplyAlpha(
             return E_FAIL;
         }
 
-        if (flags & TEX_PMALPHA_REVERSE)
-        {
-            hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? DemultiplyAlpha(src, dst) : DemultiplyAlphaLinear(src, flags, dst);
-        }
-        else
-        {
-            hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? PremultiplyAlpha_(src, dst) : PremultiplyAlphaLinear(src, flags, dst);
-        }
+        hr = PremultiplyAlphaImage(src, flags, dst);
         if (FAILED(hr))
         {
             result.Release();
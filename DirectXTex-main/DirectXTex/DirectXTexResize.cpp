@@ -252,7 +252,7 @@ namespace
     //-------------------------------------------------------------------------------------
 
     //--- Point Filter ---
-    HRESULT ResizePointFilter(const Image& srcImage, const Image& destImage) noexcept
+    HRESULT ResizePointFilter(const Image& srcImage, const Image& destImage, ProgressTracker& progress) noexcept
     {
         assert(srcImage.pixels && destImage.pixels);
         assert(srcImage.format == destImage.format);
@@ -302,6 +302,9 @@ namespace
             pDest += destImage.rowPitch;
 
             sy += yinc;
+
+            if (!progress.Advance(1))
+                return E_ABORT;
         }
 
         return S_OK;
@@ -309,7 +312,8 @@ namespace
 
 
     //--- Box Filter ---
-    HRESULT ResizeBoxFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    HRESULT ResizeBoxFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -365,6 +369,9 @@ namespace
             if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
                 return E_FAIL;
             pDest += destImage.rowPitch;
+
+            if (!progress.Advance(1))
+                return E_ABORT;
         }
 
         return S_OK;
@@ -372,7 +379,8 @@ namespace
 
 
     //--- Linear Filter ---
-    HRESULT ResizeLinearFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    HRESULT ResizeLinearFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -452,6 +460,9 @@ namespace
             if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
                 return E_FAIL;
             pDest += destImage.rowPitch;
+
+            if (!progress.Advance(1))
+                return E_ABORT;
         }
 
         return S_OK;
@@ -463,7 +474,8 @@ namespace
 #pragma clang diagnostic ignored "-Wextra-semi-stmt"
 #endif
 
-    HRESULT ResizeCubicFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    HRESULT ResizeCubicFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -617,6 +629,9 @@ namespace
             if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
                 return E_FAIL;
             pDest += destImage.rowPitch;
+
+            if (!progress.Advance(1))
+                return E_ABORT;
         }
 
         return S_OK;
@@ -624,7 +639,8 @@ namespace
 
 
     //--- Triangle Filter ---
-    HRESULT ResizeTriangleFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    HRESULT ResizeTriangleFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        ProgressTracker& progress) noexcept
     {
         using namespace DirectX::Filters;
 
@@ -793,6 +809,9 @@ namespace
                     // Put row on freelist to reuse it's allocated scanline
                     rowAcc->next = rowFree;
                     rowFree = rowAcc;
+
+                    if (!progress.Advance(1))
+                        return E_ABORT;
                 }
             }
 
@@ -804,7 +823,8 @@ namespace
 
 
     //--- Custom filter resize ---
-    HRESULT PerformResizeUsingCustomFilters(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    HRESULT PerformResizeUsingCustomFilters(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage,
+        ProgressTracker& progress) noexcept
     {
         if (!srcImage.pixels || !destImage.pixels)
             return E_POINTER;
@@ -822,19 +842,19 @@ namespace
         switch (filter_select)
         {
         case TEX_FILTER_POINT:
-            return ResizePointFilter(srcImage, destImage);
+            return ResizePointFilter(srcImage, destImage, progress);
 
         case TEX_FILTER_BOX:
-            return ResizeBoxFilter(srcImage, filter, destImage);
+            return ResizeBoxFilter(srcImage, filter, destImage, progress);
 
         case TEX_FILTER_LINEAR:
-            return ResizeLinearFilter(srcImage, filter, destImage);
+            return ResizeLinearFilter(srcImage, filter, destImage, progress);
 
         case TEX_FILTER_CUBIC:
-            return ResizeCubicFilter(srcImage, filter, destImage);
+            return ResizeCubicFilter(srcImage, filter, destImage, progress);
 
         case TEX_FILTER_TRIANGLE:
-            return ResizeTriangleFilter(srcImage, filter, destImage);
+            return ResizeTriangleFilter(srcImage, filter, destImage, progress);
 
         default:
             return HRESULT_E_NOT_SUPPORTED;
@@ -856,8 +876,11 @@ HRESULT DirectX::Resize(
     size_t width,
     size_t height,
     TEX_FILTER_FLAGS filter,
-    ScratchImage& image) noexcept
+    ScratchImage& image,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_RESIZE, srcImage);
+
     if (width == 0 || height == 0)
         return E_INVALIDARG;
 
@@ -905,6 +928,8 @@ HRESULT DirectX::Resize(
     if (!rimage)
         return E_POINTER;
 
+    ProgressTracker tracker(progress, height);
+
 #ifdef _WIN32
     if (usewic)
     {
@@ -918,12 +943,15 @@ HRESULT DirectX::Resize(
             // Case 2: Source format is not supported by WIC, so we have to convert, resize, and convert back
             hr = PerformResizeViaF32(srcImage, filter, *rimage);
         }
+
+        if (SUCCEEDED(hr) && !tracker.Advance(height))
+            hr = E_ABORT;
     }
     else
     #endif
     {
         // Case 3: not using WIC resizing
-        hr = PerformResizeUsingCustomFilters(srcImage, filter, *rimage);
+        hr = PerformResizeUsingCustomFilters(srcImage, filter, *rimage, tracker);
     }
 
     if (FAILED(hr))
@@ -947,8 +975,11 @@ HRESULT DirectX::Resize(
     size_t width,
     size_t height,
     TEX_FILTER_FLAGS filter,
-    ScratchImage& result) noexcept
+    ScratchImage& result,
+    ProgressContext* progress) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_RESIZE, srcImages, nimages, metadata);
+
     if (!srcImages || !nimages || width == 0 || height == 0)
         return E_INVALIDARG;
 
@@ -984,6 +1015,8 @@ HRESULT DirectX::Resize(
     }
 #endif
 
+    ProgressTracker tracker(progress, height * ((metadata.dimension == TEX_DIMENSION_TEXTURE3D) ? metadata.depth : metadata.arraySize));
+
     switch (metadata.dimension)
     {
     case TEX_DIMENSION_TEXTURE1D:
@@ -1032,12 +1065,15 @@ HRESULT DirectX::Resize(
                     // Case 2: Source format is not supported by WIC, so we have to convert, resize, and convert back
                     hr = PerformResizeViaF32(*srcimg, filter, *destimg);
                 }
+
+                if (SUCCEEDED(hr) && !tracker.Advance(height))
+                    hr = E_ABORT;
             }
             else
             #endif
             {
                 // Case 3: not using WIC resizing
-                hr = PerformResizeUsingCustomFilters(*srcimg, filter, *destimg);
+                hr = PerformResizeUsingCustomFilters(*srcimg, filter, *destimg, tracker);
             }
 
             if (FAILED(hr))
@@ -1093,12 +1129,15 @@ HRESULT DirectX::Resize(
                     // Case 2: Source format is not supported by WIC, so we have to convert, resize, and convert back
                     hr = PerformResizeViaF32(*srcimg, filter, *destimg);
                 }
+
+                if (SUCCEEDED(hr) && !tracker.Advance(height))
+                    hr = E_ABORT;
             }
             else
             #endif
             {
                 // Case 3: not using WIC resizing
-                hr = PerformResizeUsingCustomFilters(*srcimg, filter, *destimg);
+                hr = PerformResizeUsingCustomFilters(*srcimg, filter, *destimg, tracker);
             }
 
             if (FAILED(hr))
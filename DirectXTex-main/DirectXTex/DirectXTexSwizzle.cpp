@@ -0,0 +1,540 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexSwizzle.cpp
+//
+// DirectX Texture Library - Channel permute, replicate, and constant fill
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <type_traits>
+
+using namespace DirectX;
+using namespace DirectX::Internal;
+
+namespace
+{
+    constexpr uint8_t CHANNEL_ABSENT = 0xff;
+
+    //-------------------------------------------------------------------------------------
+    // Formats whose channels are whole bytes or words and round-trip exactly through the
+    // float path, so moving the bits is the same as loading and storing them. SNORM and
+    // SINT are left out since the float path writes the most negative values, -128 and
+    // -32768, back as -127 and -32767.
+    //-------------------------------------------------------------------------------------
+    struct ChannelLayout
+    {
+        DXGI_FORMAT format;
+        uint32_t    type;           // CONVF_UNORM, CONVF_UINT, or CONVF_FLOAT
+        uint8_t     elementSize;    // bytes per channel
+        uint8_t     channels;       // channels stored per pixel
+        uint8_t     position[4];    // where R, G, B, and A are stored in the pixel
+        uint16_t    one;            // encoding of 1.0 (or the integer 1)
+    };
+
+    constexpr ChannelLayout g_ChannelLayouts[] =
+    {
+        { DXGI_FORMAT_R8G8B8A8_UNORM,       CONVF_UNORM, 1, 4, { 0, 1, 2, 3 }, 0xff },
+        { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,  CONVF_UNORM, 1, 4, { 0, 1, 2, 3 }, 0xff },
+        { DXGI_FORMAT_R8G8B8A8_UINT,        CONVF_UINT,  1, 4, { 0, 1, 2, 3 }, 1 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,       CONVF_UNORM, 1, 4, { 2, 1, 0, 3 }, 0xff },
+        { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,  CONVF_UNORM, 1, 4, { 2, 1, 0, 3 }, 0xff },
+        { DXGI_FORMAT_R8G8_UNORM,           CONVF_UNORM, 1, 2, { 0, 1, CHANNEL_ABSENT, CHANNEL_ABSENT }, 0xff },
+        { DXGI_FORMAT_R8G8_UINT,            CONVF_UINT,  1, 2, { 0, 1, CHANNEL_ABSENT, CHANNEL_ABSENT }, 1 },
+        { DXGI_FORMAT_R8_UNORM,             CONVF_UNORM, 1, 1, { 0, CHANNEL_ABSENT, CHANNEL_ABSENT, CHANNEL_ABSENT }, 0xff },
+        { DXGI_FORMAT_R8_UINT,              CONVF_UINT,  1, 1, { 0, CHANNEL_ABSENT, CHANNEL_ABSENT, CHANNEL_ABSENT }, 1 },
+        { DXGI_FORMAT_R16G16B16A16_FLOAT,   CONVF_FLOAT, 2, 4, { 0, 1, 2, 3 }, 0x3c00 },
+        { DXGI_FORMAT_R16G16B16A16_UNORM,   CONVF_UNORM, 2, 4, { 0, 1, 2, 3 }, 0xffff },
+        { DXGI_FORMAT_R16G16B16A16_UINT,    CONVF_UINT,  2, 4, { 0, 1, 2, 3 }, 1 },
+        { DXGI_FORMAT_R16G16_FLOAT,         CONVF_FLOAT, 2, 2, { 0, 1, CHANNEL_ABSENT, CHANNEL_ABSENT }, 0x3c00 },
+        { DXGI_FORMAT_R16G16_UNORM,         CONVF_UNORM, 2, 2, { 0, 1, CHANNEL_ABSENT, CHANNEL_ABSENT }, 0xffff },
+        { DXGI_FORMAT_R16G16_UINT,          CONVF_UINT,  2, 2, { 0, 1, CHANNEL_ABSENT, CHANNEL_ABSENT }, 1 },
+        { DXGI_FORMAT_R16_FLOAT,            CONVF_FLOAT, 2, 1, { 0, CHANNEL_ABSENT, CHANNEL_ABSENT, CHANNEL_ABSENT }, 0x3c00 },
+        { DXGI_FORMAT_R16_UNORM,            CONVF_UNORM, 2, 1, { 0, CHANNEL_ABSENT, CHANNEL_ABSENT, CHANNEL_ABSENT }, 0xffff },
+        { DXGI_FORMAT_R16_UINT,             CONVF_UINT,  2, 1, { 0, CHANNEL_ABSENT, CHANNEL_ABSENT, CHANNEL_ABSENT }, 1 },
+    };
+
+    const ChannelLayout* FindChannelLayout(DXGI_FORMAT format) noexcept
+    {
+        for (const auto& layout : g_ChannelLayouts)
+        {
+            if (layout.format == format)
+                return &layout;
+        }
+        return nullptr;
+    }
+
+    template<size_t N> using Channels = std::integral_constant<size_t, N>;
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    //-------------------------------------------------------------------------------------
+    // SSE2 kernels, 4 pixels per step. Each pixel is widened to its own 32-bit lane (8-bit
+    // channels) or 64-bit lane (16-bit channels), every destination channel is a shift,
+    // mask, and shift of that lane, and the lanes are packed down to the destination size.
+    // Constant channels use a shift past the lane width, which reads as zero.
+    //-------------------------------------------------------------------------------------
+
+    // 4 pixels of 8-bit channels into 32-bit lanes
+    inline __m128i Load8(const uint8_t* pSource, Channels<1>) noexcept
+    {
+        uint32_t t;
+        memcpy(&t, pSource, sizeof(t));
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(t)), zero), zero);
+    }
+
+    inline __m128i Load8(const uint8_t* pSource, Channels<2>) noexcept
+    {
+        return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource)), _mm_setzero_si128());
+    }
+
+    inline __m128i Load8(const uint8_t* pSource, Channels<4>) noexcept
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+    }
+
+    inline void Store8(uint8_t* pDest, __m128i v, Channels<1>) noexcept
+    {
+        // Lanes hold 0..255, so both packs are exact
+        v = _mm_packs_epi32(v, v);
+        const auto t = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(v, v)));
+        memcpy(pDest, &t, sizeof(t));
+    }
+
+    inline void Store8(uint8_t* pDest, __m128i v, Channels<2>) noexcept
+    {
+        // Sign-extend the low word so the signed pack keeps all 16 bits
+        v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pDest), _mm_packs_epi32(v, v));
+    }
+
+    inline void Store8(uint8_t* pDest, __m128i v, Channels<4>) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), v);
+    }
+
+    template<size_t SrcN, size_t DestN>
+    size_t RemapVector(uint8_t* pDest, const uint8_t* pSource, size_t count, const ChannelRemap& remap,
+        Channels<SrcN>, Channels<DestN>) noexcept
+    {
+        const __m128i mask = _mm_set1_epi32(0xff);
+        __m128i shiftIn[DestN];
+        __m128i shiftOut[DestN];
+        __m128i fill = _mm_setzero_si128();
+        for (size_t c = 0; c < DestN; ++c)
+        {
+            const bool copy = (remap.source[c] < SrcN);
+            shiftIn[c] = _mm_cvtsi32_si128(copy ? static_cast<int>(remap.source[c] * 8) : 32);
+            shiftOut[c] = _mm_cvtsi32_si128(static_cast<int>(c * 8));
+            if (!copy)
+            {
+                fill = _mm_or_si128(fill, _mm_set1_epi32(static_cast<int>((remap.constant[c] & 0xff) << (c * 8))));
+            }
+        }
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i v = Load8(pSource + i * SrcN, Channels<SrcN>());
+            __m128i r = fill;
+            for (size_t c = 0; c < DestN; ++c)
+            {
+                r = _mm_or_si128(r, _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(v, shiftIn[c]), mask), shiftOut[c]));
+            }
+            Store8(pDest + i * DestN, r, Channels<DestN>());
+        }
+        return i;
+    }
+
+    // 4 pixels of 16-bit channels into 64-bit lanes, pixels 0-1 in lo and 2-3 in hi
+    inline void Load16(const uint16_t* pSource, __m128i& lo, __m128i& hi, Channels<1>) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i v = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource)), zero);
+        lo = _mm_unpacklo_epi32(v, zero);
+        hi = _mm_unpackhi_epi32(v, zero);
+    }
+
+    inline void Load16(const uint16_t* pSource, __m128i& lo, __m128i& hi, Channels<2>) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+        lo = _mm_unpacklo_epi32(v, zero);
+        hi = _mm_unpackhi_epi32(v, zero);
+    }
+
+    inline void Load16(const uint16_t* pSource, __m128i& lo, __m128i& hi, Channels<4>) noexcept
+    {
+        lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+        hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 8));
+    }
+
+    // Gathers the low dword of each 64-bit lane into 4 32-bit lanes
+    inline __m128i Narrow16(__m128i lo, __m128i hi) noexcept
+    {
+        return _mm_unpacklo_epi64(
+            _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)),
+            _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    inline void Store16(uint16_t* pDest, __m128i lo, __m128i hi, Channels<1>) noexcept
+    {
+        __m128i v = Narrow16(lo, hi);
+        v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pDest), _mm_packs_epi32(v, v));
+    }
+
+    inline void Store16(uint16_t* pDest, __m128i lo, __m128i hi, Channels<2>) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), Narrow16(lo, hi));
+    }
+
+    inline void Store16(uint16_t* pDest, __m128i lo, __m128i hi, Channels<4>) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 8), hi);
+    }
+
+    template<size_t SrcN, size_t DestN>
+    size_t RemapVector(uint16_t* pDest, const uint16_t* pSource, size_t count, const ChannelRemap& remap,
+        Channels<SrcN>, Channels<DestN>) noexcept
+    {
+        const __m128i mask = _mm_set_epi32(0, 0xffff, 0, 0xffff);
+        __m128i shiftIn[DestN];
+        __m128i shiftOut[DestN];
+        uint64_t constant = 0;
+        for (size_t c = 0; c < DestN; ++c)
+        {
+            const bool copy = (remap.source[c] < SrcN);
+            shiftIn[c] = _mm_cvtsi32_si128(copy ? static_cast<int>(remap.source[c] * 16) : 64);
+            shiftOut[c] = _mm_cvtsi32_si128(static_cast<int>(c * 16));
+            if (!copy)
+            {
+                constant |= uint64_t(remap.constant[c] & 0xffff) << (c * 16);
+            }
+        }
+
+        const auto clo = static_cast<int>(constant & 0xffffffff);
+        const auto chi = static_cast<int>(constant >> 32);
+        const __m128i fill = _mm_set_epi32(chi, clo, chi, clo);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i lo, hi;
+            Load16(pSource + i * SrcN, lo, hi, Channels<SrcN>());
+            __m128i rlo = fill;
+            __m128i rhi = fill;
+            for (size_t c = 0; c < DestN; ++c)
+            {
+                rlo = _mm_or_si128(rlo, _mm_sll_epi64(_mm_and_si128(_mm_srl_epi64(lo, shiftIn[c]), mask), shiftOut[c]));
+                rhi = _mm_or_si128(rhi, _mm_sll_epi64(_mm_and_si128(_mm_srl_epi64(hi, shiftIn[c]), mask), shiftOut[c]));
+            }
+            Store16(pDest + i * DestN, rlo, rhi, Channels<DestN>());
+        }
+        return i;
+    }
+#else
+    template<typename T, size_t SrcN, size_t DestN>
+    size_t RemapVector(T*, const T*, size_t, const ChannelRemap&, Channels<SrcN>, Channels<DestN>) noexcept
+    {
+        return 0;
+    }
+#endif
+
+    //-------------------------------------------------------------------------------------
+    // One instantiation per element type and channel counts; the vector kernel takes the
+    // bulk of the row and the scalar loop finishes it. Each source pixel is read in full
+    // before its destination pixel is written, so this also works in place when the
+    // destination pixel is no larger than the source pixel.
+    //-------------------------------------------------------------------------------------
+    template<typename T, size_t SrcN, size_t DestN>
+    void RemapPixels(void* pDestination, const void* pSource, size_t count, const ChannelRemap& remap) noexcept
+    {
+        auto dPtr = static_cast<T*>(pDestination);
+        auto sPtr = static_cast<const T*>(pSource);
+
+        for (size_t i = RemapVector(dPtr, sPtr, count, remap, Channels<SrcN>(), Channels<DestN>()); i < count; ++i)
+        {
+            T s[SrcN];
+            for (size_t c = 0; c < SrcN; ++c)
+            {
+                s[c] = sPtr[i * SrcN + c];
+            }
+
+            for (size_t c = 0; c < DestN; ++c)
+            {
+                dPtr[i * DestN + c] = (remap.source[c] < SrcN) ? s[remap.source[c]] : static_cast<T>(remap.constant[c]);
+            }
+        }
+    }
+
+    using RemapFunc = void(*)(void*, const void*, size_t, const ChannelRemap&);
+
+    // Channel counts of 1, 2, and 4 map to 0, 1, and 2
+    inline size_t ChannelIndex(size_t channels) noexcept
+    {
+        return (channels >= 4) ? 2u : (channels - 1);
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Remaps every image of a chain with the integer path
+    //-------------------------------------------------------------------------------------
+    HRESULT SwizzleImages(
+        const Image* srcImages,
+        size_t nimages,
+        const ChannelRemap& remap,
+        const Image* destImages) noexcept
+    {
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const Image& src = srcImages[index];
+            const Image& dst = destImages[index];
+
+            if (src.format != dst.format || src.width != dst.width || src.height != dst.height)
+                return E_FAIL;
+
+            const uint8_t* pSrc = src.pixels;
+            uint8_t* pDest = dst.pixels;
+            if (!pSrc || !pDest)
+                return E_POINTER;
+
+            for (size_t h = 0; h < src.height; ++h)
+            {
+                RemapScanline(pDest, pSrc, src.width, remap);
+
+                pSrc += src.rowPitch;
+                pDest += dst.rowPitch;
+            }
+        }
+
+        return S_OK;
+    }
+}
+
+
+//=====================================================================================
+// Internal helpers
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Builds the remap from inFormat to outFormat, where channels[] gives the source RGBA
+// channel (or TEX_SWIZZLE_ZERO/ONE) for each destination RGBA channel. Source channels
+// the format does not store read as 0 (alpha as 1) like LoadScanline. Fails if either
+// format is unsupported or they differ in numeric type or channel size.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool DirectX::Internal::SetupChannelRemap(
+    DXGI_FORMAT inFormat,
+    DXGI_FORMAT outFormat,
+    const uint32_t* channels,
+    ChannelRemap& remap) noexcept
+{
+    memset(&remap, 0, sizeof(ChannelRemap));
+
+    if (!channels)
+        return false;
+
+    const ChannelLayout* in = FindChannelLayout(inFormat);
+    const ChannelLayout* out = FindChannelLayout(outFormat);
+    if (!in || !out)
+        return false;
+
+    if (in->type != out->type || in->elementSize != out->elementSize)
+        return false;
+
+    remap.elementSize = in->elementSize;
+    remap.srcChannels = in->channels;
+    remap.destChannels = out->channels;
+
+    for (size_t c = 0; c < 4; ++c)
+    {
+        const uint8_t slot = out->position[c];
+        if (slot == CHANNEL_ABSENT)
+            continue;
+
+        uint32_t select = channels[c];
+        if (select < 4 && in->position[select] == CHANNEL_ABSENT)
+        {
+            select = (select == 3) ? TEX_SWIZZLE_ONE : TEX_SWIZZLE_ZERO;
+        }
+
+        switch (select)
+        {
+        case TEX_SWIZZLE_RED:
+        case TEX_SWIZZLE_GREEN:
+        case TEX_SWIZZLE_BLUE:
+        case TEX_SWIZZLE_ALPHA:
+            remap.source[slot] = in->position[select];
+            break;
+
+        case TEX_SWIZZLE_ZERO:
+            remap.source[slot] = TEXP_REMAP_CONSTANT;
+            remap.constant[slot] = 0;
+            break;
+
+        case TEX_SWIZZLE_ONE:
+            remap.source[slot] = TEXP_REMAP_CONSTANT;
+            remap.constant[slot] = out->one;
+            break;
+
+        default:
+            memset(&remap, 0, sizeof(ChannelRemap));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Applies a channel remap to a row of count pixels
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::Internal::RemapScanline(
+    void* pDestination,
+    const void* pSource,
+    size_t count,
+    const ChannelRemap& remap) noexcept
+{
+    assert(pDestination && pSource);
+    assert(remap.elementSize == 1 || remap.elementSize == 2);
+    assert(remap.srcChannels == 1 || remap.srcChannels == 2 || remap.srcChannels == 4);
+    assert(remap.destChannels == 1 || remap.destChannels == 2 || remap.destChannels == 4);
+
+    static const RemapFunc s_remap8[3][3] =
+    {
+        { RemapPixels<uint8_t, 1, 1>, RemapPixels<uint8_t, 1, 2>, RemapPixels<uint8_t, 1, 4> },
+        { RemapPixels<uint8_t, 2, 1>, RemapPixels<uint8_t, 2, 2>, RemapPixels<uint8_t, 2, 4> },
+        { RemapPixels<uint8_t, 4, 1>, RemapPixels<uint8_t, 4, 2>, RemapPixels<uint8_t, 4, 4> },
+    };
+
+    static const RemapFunc s_remap16[3][3] =
+    {
+        { RemapPixels<uint16_t, 1, 1>, RemapPixels<uint16_t, 1, 2>, RemapPixels<uint16_t, 1, 4> },
+        { RemapPixels<uint16_t, 2, 1>, RemapPixels<uint16_t, 2, 2>, RemapPixels<uint16_t, 2, 4> },
+        { RemapPixels<uint16_t, 4, 1>, RemapPixels<uint16_t, 4, 2>, RemapPixels<uint16_t, 4, 4> },
+    };
+
+    if (!pDestination || !pSource || !count)
+        return;
+
+    const size_t src = ChannelIndex(remap.srcChannels);
+    const size_t dest = ChannelIndex(remap.destChannels);
+
+    if (remap.elementSize == 2)
+    {
+        s_remap16[src][dest](pDestination, pSource, count, remap);
+    }
+    else
+    {
+        s_remap8[src][dest](pDestination, pSource, count, remap);
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Permutes, replicates, or fills the channels of an image
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SwizzleChannels(
+    const Image& srcImage,
+    const uint32_t* channels,
+    ScratchImage& image) noexcept
+{
+    TexMetadata mdata = {};
+    mdata.width = srcImage.width;
+    mdata.height = srcImage.height;
+    mdata.depth = mdata.arraySize = mdata.mipLevels = 1;
+    mdata.format = srcImage.format;
+    mdata.dimension = TEX_DIMENSION_TEXTURE2D;
+
+    return SwizzleChannels(&srcImage, 1, mdata, channels, image);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SwizzleChannels(
+    const Image* srcImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    const uint32_t* channels,
+    ScratchImage& result) noexcept
+{
+    if (!srcImages || !nimages || !channels)
+        return E_INVALIDARG;
+
+    for (size_t c = 0; c < 4; ++c)
+    {
+        if (channels[c] > TEX_SWIZZLE_ONE)
+            return E_INVALIDARG;
+    }
+
+    if (IsPlanar(metadata.format) || IsPalettized(metadata.format) || IsCompressed(metadata.format) || IsTypeless(metadata.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    ChannelRemap remap;
+    if (SetupChannelRemap(metadata.format, metadata.format, channels, remap))
+    {
+        HRESULT hr = result.Initialize(metadata);
+        if (FAILED(hr))
+            return hr;
+
+        if (nimages != result.GetImageCount())
+        {
+            result.Release();
+            return E_FAIL;
+        }
+
+        const Image* dest = result.GetImages();
+        if (!dest)
+        {
+            result.Release();
+            return E_POINTER;
+        }
+
+        hr = SwizzleImages(srcImages, nimages, remap, dest);
+        if (FAILED(hr))
+        {
+            result.Release();
+            return hr;
+        }
+
+        return S_OK;
+    }
+
+    // Everything else goes through the float path
+    uint32_t select[4] = {};
+    uint32_t zero[4] = {};
+    uint32_t one[4] = {};
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        select[c] = (channels[c] < 4) ? channels[c] : c;
+        zero[c] = (channels[c] == TEX_SWIZZLE_ZERO) ? 1u : 0u;
+        one[c] = (channels[c] == TEX_SWIZZLE_ONE) ? 1u : 0u;
+    }
+
+    const XMVECTOR zc = XMVectorSelectControl(zero[0], zero[1], zero[2], zero[3]);
+    const XMVECTOR oc = XMVectorSelectControl(one[0], one[1], one[2], one[3]);
+
+    return TransformImage(srcImages, nimages, metadata,
+        [&, zc, oc](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t width, size_t y)
+        {
+            UNREFERENCED_PARAMETER(y);
+
+            for (size_t j = 0; j < width; ++j)
+            {
+                XMVECTOR pixel = XMVectorSwizzle(inPixels[j], select[0], select[1], select[2], select[3]);
+                pixel = XMVectorSelect(pixel, g_XMZero, zc);
+                outPixels[j] = XMVectorSelect(pixel, g_XMOne, oc);
+            }
+        }, result);
+}
@@ -11,13 +11,18 @@
 
 #include "DirectXTexP.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#pragma warning(disable : 4616 6993)
+#endif
+
 //
 // The implementation here has the following limitations:
 //      * Does not support files that contain color maps (these are rare in practice)
 //      * Interleaved files are not supported (deprecated aspect of TGA format)
 //      * Only supports 8-bit grayscale; 16-, 24-, and 32-bit truecolor images RLE or uncompressed
 //        plus 24-bit color-mapped uncompressed images
-//      * Always writes uncompressed files (i.e. can read RLE compression, but does not write it)
+//      * Writes uncompressed files by default, or RLE compressed files with TGA_FLAGS_RLE
 //
 
 using namespace DirectX;
@@ -1216,7 +1221,7 @@ namespace
     //-------------------------------------------------------------------------------------
     // Encodes TGA file header
     //-------------------------------------------------------------------------------------
-    HRESULT EncodeTGAHeader(_In_ const Image& image, _Out_ TGA_HEADER& header, _Inout_ uint32_t& convFlags) noexcept
+    HRESULT EncodeTGAHeader(_In_ const Image& image, TGA_FLAGS flags, _Out_ TGA_HEADER& header, _Inout_ uint32_t& convFlags) noexcept
     {
         memset(&header, 0, TGA_HEADER_LEN);
 
@@ -1271,6 +1276,12 @@ namespace
             return HRESULT_E_NOT_SUPPORTED;
         }
 
+        if (flags & TGA_FLAGS_RLE)
+        {
+            header.bImageType = (header.bImageType == TGA_BLACK_AND_WHITE) ? TGA_BLACK_AND_WHITE_RLE : TGA_TRUECOLOR_RLE;
+            convFlags |= CONV_FLAGS_RLE;
+        }
+
         return S_OK;
     }
 
@@ -1311,6 +1322,233 @@ namespace
         }
     }
 
+
+    //-------------------------------------------------------------------------------------
+    // RLE encoder helpers
+    //-------------------------------------------------------------------------------------
+    constexpr size_t TGA_RLE_MAX_PACKET = 128;
+
+    constexpr size_t TGA_RLE_PARALLEL_MIN_ROWS = 64;
+
+    // Returns the number of pixels (up to maxCount) which repeat the first pixel
+    template<size_t bpp>
+    size_t CountRepeatPixels(_In_reads_bytes_(maxCount * bpp) const uint8_t* pSource, size_t maxCount) noexcept
+    {
+        assert(pSource && maxCount > 0);
+
+        size_t count = 1;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        if (bpp == 1)
+        {
+            const __m128i first = _mm_set1_epi8(static_cast<char>(pSource[0]));
+            for (; count + 16 <= maxCount; count += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, first)) != 0xFFFF)
+                    break;
+            }
+        }
+        else if (bpp == 2)
+        {
+            uint16_t pixel;
+            memcpy(&pixel, pSource, sizeof(pixel));
+            const __m128i first = _mm_set1_epi16(static_cast<short>(pixel));
+            for (; count + 8 <= maxCount; count += 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count * 2));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(v, first)) != 0xFFFF)
+                    break;
+            }
+        }
+        else if (bpp == 4)
+        {
+            uint32_t pixel;
+            memcpy(&pixel, pSource, sizeof(pixel));
+            const __m128i first = _mm_set1_epi32(static_cast<int>(pixel));
+            for (; count + 4 <= maxCount; count += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count * 4));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, first)) != 0xFFFF)
+                    break;
+            }
+        }
+    #endif
+
+        // Handles the remainder and locates the exact mismatch within a failed vector
+        for (; count < maxCount; ++count)
+        {
+            if (memcmp(pSource, pSource + count * bpp, bpp) != 0)
+                break;
+        }
+
+        return count;
+    }
+
+    // Returns the number of pixels (up to maxCount) before the next pair of identical neighbors
+    template<size_t bpp>
+    size_t CountLiteralPixels(_In_reads_bytes_(maxCount * bpp) const uint8_t* pSource, size_t maxCount) noexcept
+    {
+        assert(pSource && maxCount > 0);
+
+        size_t count = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        if (bpp == 1)
+        {
+            for (; count + 17 <= maxCount; count += 16)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count + 1));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0)
+                    break;
+            }
+        }
+        else if (bpp == 2)
+        {
+            for (; count + 9 <= maxCount; count += 8)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count * 2));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count * 2 + 2));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, b)) != 0)
+                    break;
+            }
+        }
+        else if (bpp == 4)
+        {
+            for (; count + 5 <= maxCount; count += 4)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count * 4));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + count * 4 + 4));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0)
+                    break;
+            }
+        }
+    #endif
+
+        for (; count + 1 < maxCount; ++count)
+        {
+            if (memcmp(pSource + count * bpp, pSource + (count + 1) * bpp, bpp) == 0)
+                return count;
+        }
+
+        return maxCount;
+    }
+
+    // Encodes one scanline as RLE packets, returning the number of bytes written.
+    // The destination must hold at least width * (bpp + 1) bytes.
+    template<size_t bpp>
+    size_t EncodeRLEScanline(
+        _Out_writes_bytes_to_(width * (bpp + 1), return) uint8_t* pDestination,
+        _In_reads_bytes_(width * bpp) const uint8_t* pSource,
+        size_t width) noexcept
+    {
+        uint8_t* dPtr = pDestination;
+
+        size_t x = 0;
+        while (x < width)
+        {
+            const uint8_t* sPtr = pSource + x * bpp;
+            const size_t maxCount = std::min<size_t>(width - x, TGA_RLE_MAX_PACKET);
+
+            const size_t repeat = CountRepeatPixels<bpp>(sPtr, maxCount);
+            if (repeat > 1)
+            {
+                // Run-length packet
+                *(dPtr++) = static_cast<uint8_t>(0x80 | (repeat - 1));
+                memcpy(dPtr, sPtr, bpp);
+                dPtr += bpp;
+                x += repeat;
+            }
+            else
+            {
+                // Raw packet
+                const size_t literal = CountLiteralPixels<bpp>(sPtr, maxCount);
+                assert(literal > 0);
+                *(dPtr++) = static_cast<uint8_t>(literal - 1);
+                memcpy(dPtr, sPtr, literal * bpp);
+                dPtr += literal * bpp;
+                x += literal;
+            }
+        }
+
+        return static_cast<size_t>(dPtr - pDestination);
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Encodes the image as RLE packets one scanline per slot (TGA 2.0 requires packets
+    // do not cross scanlines, so rows are independent and encoded in parallel)
+    //-------------------------------------------------------------------------------------
+    HRESULT EncodeRLEPixels(
+        _In_ const Image& image,
+        uint32_t convFlags,
+        size_t rowPitch,
+        size_t bpp,
+        _Out_writes_bytes_(image.height * slotSize) uint8_t* pDestination,
+        size_t slotSize,
+        _Out_writes_(image.height) size_t* rowSizes) noexcept
+    {
+        assert(pDestination && rowSizes);
+        assert(slotSize >= image.width * (bpp + 1));
+
+        if (image.height > INT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::atomic<bool> fail(false);
+
+    #ifdef _OPENMP
+        const WorkerThreads workers;
+
+    #pragma omp parallel if (image.height >= TGA_RLE_PARALLEL_MIN_ROWS) num_threads(workers.Count())
+    #endif
+        {
+        #ifdef _OPENMP
+            const WorkerAffinity affinity(workers);
+        #endif
+
+            std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch]);
+            if (!temp)
+                fail.store(true, std::memory_order_relaxed);
+
+        #ifdef _OPENMP
+        #pragma omp for
+        #endif
+            for (int y = 0; y < static_cast<int>(image.height); ++y)
+            {
+                if (!temp)
+                    continue;
+
+                const uint8_t* pPixels = image.pixels + image.rowPitch * size_t(y);
+
+                if (convFlags & CONV_FLAGS_888)
+                {
+                    Copy24bppScanline(temp.get(), rowPitch, pPixels, image.rowPitch);
+                }
+                else if (convFlags & CONV_FLAGS_SWIZZLE)
+                {
+                    SwizzleScanline(temp.get(), rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+                }
+                else
+                {
+                    CopyScanline(temp.get(), rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+                }
+
+                uint8_t* dPtr = pDestination + slotSize * size_t(y);
+
+                switch (bpp)
+                {
+                case 1: rowSizes[y] = EncodeRLEScanline<1>(dPtr, temp.get(), image.width); break;
+                case 2: rowSizes[y] = EncodeRLEScanline<2>(dPtr, temp.get(), image.width); break;
+                case 3: rowSizes[y] = EncodeRLEScanline<3>(dPtr, temp.get(), image.width); break;
+                case 4: rowSizes[y] = EncodeRLEScanline<4>(dPtr, temp.get(), image.width); break;
+                default: rowSizes[y] = 0; fail.store(true, std::memory_order_relaxed); break;
+                }
+            }
+        }
+
+        return (fail.load(std::memory_order_relaxed)) ? E_FAIL : S_OK;
+    }
+
     //-------------------------------------------------------------------------------------
     // TGA 2.0 Extension helpers
     //-------------------------------------------------------------------------------------
@@ -1628,6 +1866,63 @@ HRESULT DirectX::GetMetadataFromTGAFile(const wchar_t* szFile, TGA_FLAGS flags,
 }
 
 
+//-------------------------------------------------------------------------------------
+// Obtain metadata from a TGA file using positioned reads (for the batch scanner)
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT Internal::GetMetadataFromTGAReader(
+    const void* pHeader,
+    size_t headerSize,
+    uint64_t fileSize,
+    ReadAtFunc readAt,
+    void* context,
+    TGA_FLAGS flags,
+    TexMetadata& metadata) noexcept
+{
+    if (!pHeader || !headerSize || !readAt)
+        return E_INVALIDARG;
+
+    // The whole file was read, so the footer is already in memory
+    if (headerSize >= fileSize)
+        return GetMetadataFromTGAMemory(pHeader, headerSize, flags, metadata);
+
+    size_t offset;
+    HRESULT hr = DecodeTGAHeader(pHeader, headerSize, flags, metadata, offset, nullptr);
+    if (FAILED(hr))
+        return hr;
+
+    // Optional TGA 2.0 footer & extension area
+    const TGA_EXTENSION* ext = nullptr;
+    TGA_EXTENSION extData = {};
+    if (fileSize >= sizeof(TGA_FOOTER))
+    {
+        TGA_FOOTER footer = {};
+        if (!readAt(context, fileSize - sizeof(TGA_FOOTER), &footer, sizeof(TGA_FOOTER)))
+            return E_FAIL;
+
+        if (memcmp(footer.Signature, g_Signature, sizeof(g_Signature)) == 0)
+        {
+            if (footer.dwExtensionOffset != 0
+                && ((uint64_t(footer.dwExtensionOffset) + sizeof(TGA_EXTENSION)) <= fileSize))
+            {
+                if (readAt(context, footer.dwExtensionOffset, &extData, sizeof(TGA_EXTENSION)))
+                {
+                    ext = &extData;
+                    metadata.SetAlphaMode(GetAlphaModeFromExtension(ext));
+                }
+            }
+        }
+    }
+
+    if (!(flags & TGA_FLAGS_IGNORE_SRGB))
+    {
+        metadata.format = GetSRGBFromExtension(ext, metadata.format, flags, nullptr);
+    }
+
+    return S_OK;
+}
+
+
 //-------------------------------------------------------------------------------------
 // Load a TGA file in memory
 //-------------------------------------------------------------------------------------
@@ -1639,6 +1934,8 @@ HRESULT DirectX::LoadFromTGAMemory(
     TexMetadata* metadata,
     ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(image);
+
     if (!pSource || size == 0)
         return E_INVALIDARG;
 
@@ -1744,6 +2041,8 @@ HRESULT DirectX::LoadFromTGAFile(
     TexMetadata* metadata,
     ScratchImage& image) noexcept
 {
+    TEX_TRACE_ZONE(image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -2230,15 +2529,17 @@ HRESULT DirectX::LoadFromTGAFile(
 
 
 //-------------------------------------------------------------------------------------
-// Save a TGA file to memory
+// Determine the size of a TGA file
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::SaveToTGAMemory(
+HRESULT DirectX::GetTGASaveSize(
     const Image& image,
     TGA_FLAGS flags,
-    Blob& blob,
+    size_t& required,
     const TexMetadata* metadata) noexcept
 {
+    required = 0;
+
     if ((flags & (TGA_FLAGS_FORCE_LINEAR | TGA_FLAGS_FORCE_SRGB)) != 0 && !metadata)
         return E_INVALIDARG;
 
@@ -2247,29 +2548,82 @@ HRESULT DirectX::SaveToTGAMemory(
 
     TGA_HEADER tga_header = {};
     uint32_t convFlags = 0;
-    HRESULT hr = EncodeTGAHeader(image, tga_header, convFlags);
+    HRESULT hr = EncodeTGAHeader(image, flags, tga_header, convFlags);
     if (FAILED(hr))
         return hr;
 
-    blob.Release();
-
-    // Determine memory required for image data
     size_t rowPitch, slicePitch;
     hr = ComputePitch(image.format, image.width, image.height, rowPitch, slicePitch,
         (convFlags & CONV_FLAGS_888) ? CP_FLAGS_24BPP : CP_FLAGS_NONE);
     if (FAILED(hr))
         return hr;
 
-    hr = blob.Initialize(TGA_HEADER_LEN
-        + slicePitch
+    // RLE output is encoded into worst-case sized slots per scanline, then joined
+    size_t pixelSize = slicePitch;
+    if (convFlags & CONV_FLAGS_RLE)
+    {
+        const size_t bpp = tga_header.bBitsPerPixel / 8u;
+        const uint64_t rleSize = uint64_t(image.width) * uint64_t(bpp + 1) * uint64_t(image.height);
+        if (rleSize > static_cast<uint64_t>(SIZE_MAX - TGA_HEADER_LEN - sizeof(TGA_EXTENSION) - sizeof(TGA_FOOTER)))
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        pixelSize = static_cast<size_t>(rleSize);
+    }
+
+    required = TGA_HEADER_LEN
+        + pixelSize
         + (metadata ? sizeof(TGA_EXTENSION) : 0)
-        + sizeof(TGA_FOOTER));
+        + sizeof(TGA_FOOTER);
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Save a TGA file to memory
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveToTGAMemory(
+    const Image& image,
+    TGA_FLAGS flags,
+    void* pDestination,
+    size_t size,
+    size_t* written,
+    const TexMetadata* metadata) noexcept
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
+    if (written)
+        *written = 0;
+
+    if (!pDestination)
+        return E_INVALIDARG;
+
+    size_t required;
+    HRESULT hr = GetTGASaveSize(image, flags, required, metadata);
+    if (FAILED(hr))
+        return hr;
+
+    if (size < required)
+        return E_NOT_SUFFICIENT_BUFFER;
+
+    TGA_HEADER tga_header = {};
+    uint32_t convFlags = 0;
+    hr = EncodeTGAHeader(image, flags, tga_header, convFlags);
+    if (FAILED(hr))
+        return hr;
+
+    size_t rowPitch, slicePitch;
+    hr = ComputePitch(image.format, image.width, image.height, rowPitch, slicePitch,
+        (convFlags & CONV_FLAGS_888) ? CP_FLAGS_24BPP : CP_FLAGS_NONE);
     if (FAILED(hr))
         return hr;
 
+    const size_t bpp = tga_header.bBitsPerPixel / 8u;
+    const size_t slotSize = image.width * (bpp + 1);
+
     // Copy header
-    auto destPtr = static_cast<uint8_t*>(blob.GetBufferPointer());
-    assert(destPtr  != nullptr);
+    auto destPtr = static_cast<uint8_t*>(pDestination);
 
     uint8_t* dPtr = destPtr;
     memcpy(dPtr, &tga_header, TGA_HEADER_LEN);
@@ -2278,47 +2632,244 @@ HRESULT DirectX::SaveToTGAMemory(
     const uint8_t* pPixels = image.pixels;
     assert(pPixels);
 
-    for (size_t y = 0; y < image.height; ++y)
+    if (convFlags & CONV_FLAGS_RLE)
     {
-        // Copy pixels
-        if (convFlags & CONV_FLAGS_888)
-        {
-            Copy24bppScanline(dPtr, rowPitch, pPixels, image.rowPitch);
-        }
-        else if (convFlags & CONV_FLAGS_SWIZZLE)
+        std::unique_ptr<size_t[]> rowSizes(new (std::nothrow) size_t[image.height]);
+        if (!rowSizes)
+            return E_OUTOFMEMORY;
+
+        hr = EncodeRLEPixels(image, convFlags, rowPitch, bpp, dPtr, slotSize, rowSizes.get());
+        if (FAILED(hr))
+            return hr;
+
+        // Join the encoded scanlines (each slot starts at or after the write position)
+        const uint8_t* pSlot = dPtr;
+        for (size_t y = 0; y < image.height; ++y)
         {
-            SwizzleScanline(dPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            if (dPtr != pSlot)
+            {
+                memmove(dPtr, pSlot, rowSizes[y]);
+            }
+
+            dPtr += rowSizes[y];
+            pSlot += slotSize;
         }
-        else
+    }
+    else
+    {
+        for (size_t y = 0; y < image.height; ++y)
         {
-            CopyScanline(dPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
-        }
+            // Copy pixels
+            if (convFlags & CONV_FLAGS_888)
+            {
+                Copy24bppScanline(dPtr, rowPitch, pPixels, image.rowPitch);
+            }
+            else if (convFlags & CONV_FLAGS_SWIZZLE)
+            {
+                SwizzleScanline(dPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            }
+            else
+            {
+                CopyScanline(dPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            }
 
-        dPtr += rowPitch;
-        pPixels += image.rowPitch;
+            dPtr += rowPitch;
+            pPixels += image.rowPitch;
+        }
     }
 
     uint32_t extOffset = 0;
     if (metadata)
     {
         // metadata is only used for writing the TGA 2.0 extension header
-        auto ext = reinterpret_cast<TGA_EXTENSION*>(dPtr);
-        SetExtension(ext, flags, *metadata);
+        TGA_EXTENSION ext;
+        SetExtension(&ext, flags, *metadata);
+        memcpy(dPtr, &ext, sizeof(TGA_EXTENSION));
 
         extOffset = static_cast<uint32_t>(dPtr - destPtr);
         dPtr += sizeof(TGA_EXTENSION);
     }
 
     // Copy TGA 2.0 footer
-    auto footer = reinterpret_cast<TGA_FOOTER*>(dPtr);
-    footer->dwDeveloperOffset = 0;
-    footer->dwExtensionOffset = extOffset;
-    memcpy(footer->Signature, g_Signature, sizeof(g_Signature));
+    TGA_FOOTER footer = {};
+    footer.dwExtensionOffset = extOffset;
+    memcpy(footer.Signature, g_Signature, sizeof(g_Signature));
+    memcpy(dPtr, &footer, sizeof(TGA_FOOTER));
+    dPtr += sizeof(TGA_FOOTER);
+
+    if (written)
+        *written = static_cast<size_t>(dPtr - destPtr);
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SaveToTGAMemory(
+    const Image& image,
+    TGA_FLAGS flags,
+    Blob& blob,
+    const TexMetadata* metadata) noexcept
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
+    size_t required;
+    HRESULT hr = GetTGASaveSize(image, flags, required, metadata);
+    if (FAILED(hr))
+        return hr;
+
+    blob.Release();
+
+    hr = blob.Initialize(required);
+    if (FAILED(hr))
+        return hr;
+
+    size_t written = 0;
+    hr = SaveToTGAMemory(image, flags, blob.GetBufferPointer(), blob.GetBufferSize(), &written, metadata);
+    if (FAILED(hr))
+    {
+        blob.Release();
+        return hr;
+    }
+
+    if (written < required)
+    {
+        hr = blob.Trim(written);
+        if (FAILED(hr))
+            return hr;
+    }
 
     return S_OK;
 }
 
 
+//-------------------------------------------------------------------------------------
+// Save a TGA file through a writer callback
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveToTGACallback(
+    const Image& image,
+    TGA_FLAGS flags,
+    WriteCallback writer,
+    const TexMetadata* metadata)
+{
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
+    if (!writer)
+        return E_INVALIDARG;
+
+    if ((flags & (TGA_FLAGS_FORCE_LINEAR | TGA_FLAGS_FORCE_SRGB)) != 0 && !metadata)
+        return E_INVALIDARG;
+
+    if (!image.pixels)
+        return E_POINTER;
+
+    TGA_HEADER tga_header = {};
+    uint32_t convFlags = 0;
+    HRESULT hr = EncodeTGAHeader(image, flags, tga_header, convFlags);
+    if (FAILED(hr))
+        return hr;
+
+    size_t rowPitch, slicePitch;
+    hr = ComputePitch(image.format, image.width, image.height, rowPitch, slicePitch,
+        (convFlags & CONV_FLAGS_888) ? CP_FLAGS_24BPP : CP_FLAGS_NONE);
+    if (FAILED(hr))
+        return hr;
+
+    // Track the file offset for the extension area
+    size_t offset = 0;
+    auto write = [&](const void* pData, size_t bytes) -> HRESULT
+        {
+            offset += bytes;
+            return writer(pData, bytes);
+        };
+
+    hr = write(&tga_header, TGA_HEADER_LEN);
+    if (FAILED(hr))
+        return hr;
+
+    if (convFlags & CONV_FLAGS_RLE)
+    {
+        // Scanlines are encoded in parallel into slots, and then each is emitted as its own chunk
+        const size_t bpp = tga_header.bBitsPerPixel / 8u;
+        const size_t slotSize = image.width * (bpp + 1);
+
+        const uint64_t rleSize = uint64_t(slotSize) * uint64_t(image.height);
+        if (rleSize > static_cast<uint64_t>(SIZE_MAX))
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        std::unique_ptr<uint8_t[]> slots(new (std::nothrow) uint8_t[static_cast<size_t>(rleSize)]);
+        std::unique_ptr<size_t[]> rowSizes(new (std::nothrow) size_t[image.height]);
+        if (!slots || !rowSizes)
+            return E_OUTOFMEMORY;
+
+        hr = EncodeRLEPixels(image, convFlags, rowPitch, bpp, slots.get(), slotSize, rowSizes.get());
+        if (FAILED(hr))
+            return hr;
+
+        const uint8_t* pSlot = slots.get();
+        for (size_t y = 0; y < image.height; ++y)
+        {
+            hr = write(pSlot, rowSizes[y]);
+            if (FAILED(hr))
+                return hr;
+
+            pSlot += slotSize;
+        }
+    }
+    else
+    {
+        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch]);
+        if (!temp)
+            return E_OUTOFMEMORY;
+
+        const uint8_t* pPixels = image.pixels;
+        for (size_t y = 0; y < image.height; ++y)
+        {
+            if (convFlags & CONV_FLAGS_888)
+            {
+                Copy24bppScanline(temp.get(), rowPitch, pPixels, image.rowPitch);
+            }
+            else if (convFlags & CONV_FLAGS_SWIZZLE)
+            {
+                SwizzleScanline(temp.get(), rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            }
+            else
+            {
+                CopyScanline(temp.get(), rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            }
+
+            hr = write(temp.get(), rowPitch);
+            if (FAILED(hr))
+                return hr;
+
+            pPixels += image.rowPitch;
+        }
+    }
+
+    uint32_t extOffset = 0;
+    if (metadata)
+    {
+        if (offset > UINT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        extOffset = static_cast<uint32_t>(offset);
+
+        TGA_EXTENSION ext;
+        SetExtension(&ext, flags, *metadata);
+
+        hr = write(&ext, sizeof(TGA_EXTENSION));
+        if (FAILED(hr))
+            return hr;
+    }
+
+    TGA_FOOTER footer = {};
+    footer.dwExtensionOffset = extOffset;
+    memcpy(footer.Signature, g_Signature, sizeof(g_Signature));
+
+    return write(&footer, sizeof(TGA_FOOTER));
+}
+
+
 //-------------------------------------------------------------------------------------
 // Save a TGA file to disk
 //-------------------------------------------------------------------------------------
@@ -2329,6 +2880,8 @@ HRESULT DirectX::SaveToTGAFile(
     const wchar_t* szFile,
     const TexMetadata* metadata) noexcept
 {
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -2340,7 +2893,7 @@ HRESULT DirectX::SaveToTGAFile(
 
     TGA_HEADER tga_header = {};
     uint32_t convFlags = 0;
-    HRESULT hr = EncodeTGAHeader(image, tga_header, convFlags);
+    HRESULT hr = EncodeTGAHeader(image, flags, tga_header, convFlags);
     if (FAILED(hr))
         return hr;
 
@@ -2372,9 +2925,10 @@ HRESULT DirectX::SaveToTGAFile(
     if (FAILED(hr))
         return hr;
 
-    if (slicePitch < 65535)
+    if (slicePitch < 65535 || (convFlags & CONV_FLAGS_RLE))
     {
         // For small images, it is better to create an in-memory file and write it out
+        // (RLE files are always encoded in memory since the scanlines are encoded in parallel)
         Blob blob;
 
         hr = SaveToTGAMemory(image, flags, blob, metadata);
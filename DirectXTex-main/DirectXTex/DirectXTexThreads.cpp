@@ -0,0 +1,351 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexThreads.cpp
+//
+// DirectX Texture Library - Worker thread budget and processor affinity
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(_WIN32) && (!defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP))
+#define USE_GROUP_AFFINITY
+#elif defined(__linux__)
+#define USE_SCHED_AFFINITY
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace DirectX;
+
+struct Internal::ResolvedThreadPolicy
+{
+    size_t          maxThreads;
+    size_t          processorCount;
+#if defined(USE_GROUP_AFFINITY)
+    GROUP_AFFINITY  affinity;
+#elif defined(USE_SCHED_AFFINITY)
+    cpu_set_t       affinity;
+#endif
+};
+
+namespace
+{
+    using Internal::ResolvedThreadPolicy;
+
+    std::mutex s_policyMutex;
+    std::shared_ptr<const ResolvedThreadPolicy> s_defaultPolicy;
+
+    thread_local std::shared_ptr<const ResolvedThreadPolicy> t_callingThreadPolicy;
+
+#if defined(USE_GROUP_AFFINITY)
+    static_assert(sizeof(GROUP_AFFINITY) <= sizeof(uint64_t) * 16, "WorkerAffinity storage too small");
+
+    // Maps a system-wide processor index to its group and the bit within that group
+    bool GetProcessorGroup(uint32_t index, WORD& group, DWORD& bit) noexcept
+    {
+        const WORD groups = GetActiveProcessorGroupCount();
+        for (WORD g = 0; g < groups; ++g)
+        {
+            const DWORD count = GetActiveProcessorCount(g);
+            if (index < count)
+            {
+                group = g;
+                bit = index;
+                return true;
+            }
+            index -= count;
+        }
+
+        return false;
+    }
+
+    HRESULT AddProcessor(ResolvedThreadPolicy& policy, uint32_t index) noexcept
+    {
+        WORD group = 0;
+        DWORD bit = 0;
+        if (!GetProcessorGroup(index, group, bit) || bit >= sizeof(KAFFINITY) * 8)
+            return E_INVALIDARG;
+
+        if (!policy.processorCount)
+        {
+            policy.affinity.Group = group;
+        }
+        else if (policy.affinity.Group != group)
+        {
+            // A thread can only have affinity with one processor group
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        const KAFFINITY mask = KAFFINITY(1) << bit;
+        if (!(policy.affinity.Mask & mask))
+        {
+            policy.affinity.Mask |= mask;
+            ++policy.processorCount;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT AddNumaNode(ResolvedThreadPolicy& policy, uint32_t node) noexcept
+    {
+        if (node > USHRT_MAX)
+            return E_INVALIDARG;
+
+        GROUP_AFFINITY nodeAffinity = {};
+        if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &nodeAffinity) || !nodeAffinity.Mask)
+            return E_INVALIDARG;
+
+        policy.affinity.Group = nodeAffinity.Group;
+        policy.affinity.Mask = nodeAffinity.Mask;
+        for (KAFFINITY mask = nodeAffinity.Mask; mask; mask &= mask - 1)
+        {
+            ++policy.processorCount;
+        }
+
+        return S_OK;
+    }
+
+#elif defined(USE_SCHED_AFFINITY)
+    static_assert(sizeof(cpu_set_t) <= sizeof(uint64_t) * 16, "WorkerAffinity storage too small");
+
+    HRESULT AddProcessor(ResolvedThreadPolicy& policy, uint32_t index) noexcept
+    {
+        if (index >= CPU_SETSIZE)
+            return E_INVALIDARG;
+
+        if (!CPU_ISSET(index, &policy.affinity))
+        {
+            CPU_SET(index, &policy.affinity);
+            ++policy.processorCount;
+        }
+
+        return S_OK;
+    }
+
+    // Node processors are listed as ranges such as "0-7,16-23"
+    HRESULT AddNumaNode(ResolvedThreadPolicy& policy, uint32_t node) noexcept
+    {
+        char path[64] = {};
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+        FILE* file = fopen(path, "r");
+        if (!file)
+            return E_INVALIDARG;
+
+        char list[4096] = {};
+        const bool read = (fgets(list, sizeof(list), file) != nullptr);
+        fclose(file);
+
+        if (!read)
+            return E_FAIL;
+
+        const char* ptr = list;
+        while (*ptr >= '0' && *ptr <= '9')
+        {
+            char* end = nullptr;
+            const unsigned long first = strtoul(ptr, &end, 10);
+            unsigned long last = first;
+            if (*end == '-')
+            {
+                last = strtoul(end + 1, &end, 10);
+            }
+
+            for (unsigned long index = first; index <= last && index < CPU_SETSIZE; ++index)
+            {
+                AddProcessor(policy, static_cast<uint32_t>(index));
+            }
+
+            ptr = (*end == ',') ? end + 1 : end;
+        }
+
+        return (policy.processorCount > 0) ? S_OK : E_INVALIDARG;
+    }
+
+#else
+    HRESULT AddProcessor(ResolvedThreadPolicy&, uint32_t) noexcept
+    {
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    HRESULT AddNumaNode(ResolvedThreadPolicy&, uint32_t) noexcept
+    {
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+#endif
+
+    HRESULT ResolvePolicy(const ThreadPolicy* policy, std::shared_ptr<const ResolvedThreadPolicy>& result) noexcept
+    {
+        result.reset();
+
+        if (!policy)
+            return S_OK;
+
+        if (policy->processorCount && !policy->processors)
+            return E_INVALIDARG;
+
+        if (policy->numaNode < -1)
+            return E_INVALIDARG;
+
+        std::shared_ptr<ResolvedThreadPolicy> resolved;
+        try
+        {
+            resolved = std::make_shared<ResolvedThreadPolicy>();
+        }
+        catch (const std::bad_alloc&)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        resolved->maxThreads = policy->maxThreads;
+
+        if (policy->processorCount)
+        {
+            for (size_t j = 0; j < policy->processorCount; ++j)
+            {
+                const HRESULT hr = AddProcessor(*resolved, policy->processors[j]);
+                if (FAILED(hr))
+                    return hr;
+            }
+        }
+        else if (policy->numaNode >= 0)
+        {
+            const HRESULT hr = AddNumaNode(*resolved, static_cast<uint32_t>(policy->numaNode));
+            if (FAILED(hr))
+                return hr;
+        }
+
+        result = std::move(resolved);
+        return S_OK;
+    }
+}
+
+
+//=====================================================================================
+// Thread policy
+//=====================================================================================
+
+_Use_decl_annotations_
+HRESULT DirectX::SetDefaultThreadPolicy(const ThreadPolicy* policy) noexcept
+{
+    std::shared_ptr<const ResolvedThreadPolicy> resolved;
+    const HRESULT hr = ResolvePolicy(policy, resolved);
+    if (FAILED(hr))
+        return hr;
+
+    std::lock_guard<std::mutex> lock(s_policyMutex);
+    s_defaultPolicy.swap(resolved);
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::SetCallingThreadPolicy(const ThreadPolicy* policy) noexcept
+{
+    std::shared_ptr<const ResolvedThreadPolicy> resolved;
+    const HRESULT hr = ResolvePolicy(policy, resolved);
+    if (FAILED(hr))
+        return hr;
+
+    t_callingThreadPolicy.swap(resolved);
+    return S_OK;
+}
+
+
+//=====================================================================================
+// WorkerThreads
+//=====================================================================================
+
+Internal::WorkerThreads::WorkerThreads() noexcept :
+    m_policy(t_callingThreadPolicy)
+{
+    if (!m_policy)
+    {
+        std::lock_guard<std::mutex> lock(s_policyMutex);
+        m_policy = s_defaultPolicy;
+    }
+}
+
+int Internal::WorkerThreads::Count() const noexcept
+{
+#ifdef _OPENMP
+    size_t count = static_cast<size_t>(std::max(omp_get_max_threads(), 1));
+#else
+    size_t count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+#endif
+
+    if (m_policy)
+    {
+        if (m_policy->processorCount)
+            count = std::min(count, m_policy->processorCount);
+
+        if (m_policy->maxThreads)
+            count = std::min(count, m_policy->maxThreads);
+    }
+
+    return static_cast<int>(std::min<size_t>(count, INT32_MAX));
+}
+
+size_t Internal::WorkerThreads::Limit() const noexcept
+{
+    return (m_policy) ? m_policy->maxThreads : 0;
+}
+
+
+//=====================================================================================
+// WorkerAffinity
+//=====================================================================================
+
+_Use_decl_annotations_
+Internal::WorkerAffinity::WorkerAffinity(const WorkerThreads& workers) noexcept :
+    m_applied(false),
+    m_saved{}
+{
+    const ResolvedThreadPolicy* policy = workers.m_policy.get();
+    if (!policy || !policy->processorCount)
+        return;
+
+#if defined(USE_GROUP_AFFINITY)
+    GROUP_AFFINITY previous = {};
+    if (SetThreadGroupAffinity(GetCurrentThread(), &policy->affinity, &previous))
+    {
+        memcpy(m_saved, &previous, sizeof(previous));
+        m_applied = true;
+    }
+#elif defined(USE_SCHED_AFFINITY)
+    cpu_set_t previous;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) == 0
+        && pthread_setaffinity_np(pthread_self(), sizeof(policy->affinity), &policy->affinity) == 0)
+    {
+        memcpy(m_saved, &previous, sizeof(previous));
+        m_applied = true;
+    }
+#endif
+}
+
+Internal::WorkerAffinity::~WorkerAffinity()
+{
+    if (!m_applied)
+        return;
+
+    // Worker threads are pooled by the OpenMP runtime, so restore them for later callers
+#if defined(USE_GROUP_AFFINITY)
+    GROUP_AFFINITY previous = {};
+    memcpy(&previous, m_saved, sizeof(previous));
+    SetThreadGroupAffinity(GetCurrentThread(), &previous, nullptr);
+#elif defined(USE_SCHED_AFFINITY)
+    cpu_set_t previous;
+    memcpy(&previous, m_saved, sizeof(previous));
+    pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#endif
+}
@@ -0,0 +1,435 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexTrace.cpp
+//
+// DirectX Texture Library - Instrumentation hooks and Chrome trace-event sink
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    std::atomic<ITraceSink*> s_traceSink(nullptr);
+
+    inline uint64_t GetThreadIdentifier() noexcept
+    {
+    #ifdef _WIN32
+        return GetCurrentThreadId();
+    #elif defined(__linux__)
+        return static_cast<uint64_t>(syscall(SYS_gettid));
+    #else
+        return std::hash<std::thread::id>()(std::this_thread::get_id());
+    #endif
+    }
+
+    inline uint64_t GetProcessIdentifier() noexcept
+    {
+    #ifdef _WIN32
+        return GetCurrentProcessId();
+    #else
+        return static_cast<uint64_t>(getpid());
+    #endif
+    }
+
+    const char* GetOperationName(TRACE_OPERATION operation) noexcept
+    {
+        switch (operation)
+        {
+        case TRACE_OP_COMPRESS:         return "compress";
+        case TRACE_OP_CONVERT:          return "convert";
+        case TRACE_OP_RESIZE:           return "resize";
+        case TRACE_OP_GENERATE_MIPMAPS: return "mipmaps";
+        case TRACE_OP_LOAD:             return "load";
+        case TRACE_OP_SAVE:             return "save";
+        default:                        return "unknown";
+        }
+    }
+
+    void AppendEscaped(std::string& out, const char* str)
+    {
+        for (; *str; ++str)
+        {
+            const auto ch = static_cast<unsigned char>(*str);
+            if (ch == '"' || ch == '\\')
+            {
+                out += '\\';
+                out += static_cast<char>(ch);
+            }
+            else if (ch < 0x20)
+            {
+                char buff[8] = {};
+                snprintf(buff, sizeof(buff), "\\u%04x", ch);
+                out += buff;
+            }
+            else
+            {
+                out += static_cast<char>(ch);
+            }
+        }
+    }
+}
+
+
+//=====================================================================================
+// Trace sink
+//=====================================================================================
+
+ITraceSink* DirectX::GetTraceSink() noexcept
+{
+    return s_traceSink.load(std::memory_order_acquire);
+}
+
+_Use_decl_annotations_
+void DirectX::SetTraceSink(ITraceSink* sink) noexcept
+{
+    s_traceSink.store(sink, std::memory_order_release);
+}
+
+
+//=====================================================================================
+// TraceZone - Reports one call of a public function
+//=====================================================================================
+
+#ifdef DIRECTX_TEX_INSTRUMENTATION
+
+namespace
+{
+    std::atomic<int64_t> s_activeZones(0);
+
+    // Operations with a zone open on this thread. Public functions call each other (the File
+    // and Blob overloads go through the Memory one, for example), so only the outermost zone
+    // of an operation is reported and its size isn't counted again by the inner calls.
+    thread_local uint32_t s_openOperations = 0;
+}
+
+_Use_decl_annotations_
+Internal::TraceZone::TraceZone(const char* name, TRACE_OPERATION operation, const Image& image, DXGI_FORMAT targetFormat) noexcept :
+    m_sink(GetTraceSink()),
+    m_result(nullptr),
+    m_event{}
+{
+    if (!m_sink)
+        return;
+
+    m_event.name = name;
+    m_event.operation = operation;
+    m_event.format = image.format;
+    m_event.targetFormat = targetFormat;
+    m_event.width = image.width;
+    m_event.height = image.height;
+    m_event.depth = 1;
+    m_event.arraySize = 1;
+    m_event.mipLevels = 1;
+    m_event.bytes = image.slicePitch;
+
+    Begin();
+}
+
+_Use_decl_annotations_
+Internal::TraceZone::TraceZone(
+    const char* name,
+    TRACE_OPERATION operation,
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DXGI_FORMAT targetFormat) noexcept :
+    m_sink(GetTraceSink()),
+    m_result(nullptr),
+    m_event{}
+{
+    if (!m_sink)
+        return;
+
+    m_event.name = name;
+    m_event.operation = operation;
+    m_event.format = metadata.format;
+    m_event.targetFormat = targetFormat;
+    m_event.width = metadata.width;
+    m_event.height = metadata.height;
+    m_event.depth = metadata.depth;
+    m_event.arraySize = metadata.arraySize;
+    m_event.mipLevels = metadata.mipLevels;
+
+    if (images)
+    {
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            m_event.bytes += images[index].slicePitch;
+        }
+    }
+
+    Begin();
+}
+
+_Use_decl_annotations_
+Internal::TraceZone::TraceZone(const char* name, const ScratchImage& result) noexcept :
+    m_sink(GetTraceSink()),
+    m_result(&result),
+    m_event{}
+{
+    if (!m_sink)
+        return;
+
+    m_event.name = name;
+    m_event.operation = TRACE_OP_LOAD;
+
+    Begin();
+}
+
+Internal::TraceZone::~TraceZone()
+{
+    if (!m_sink)
+        return;
+
+    s_openOperations &= ~(1u << m_event.operation);
+
+    if (m_result)
+    {
+        const TexMetadata& metadata = m_result->GetMetadata();
+        m_event.format = metadata.format;
+        m_event.width = metadata.width;
+        m_event.height = metadata.height;
+        m_event.depth = metadata.depth;
+        m_event.arraySize = metadata.arraySize;
+        m_event.mipLevels = metadata.mipLevels;
+        m_event.bytes = m_result->GetPixelsSize();
+    }
+
+    m_sink->EndZone(m_event);
+    m_sink->Counter("DirectXTex active operations", --s_activeZones);
+}
+
+void Internal::TraceZone::Begin() noexcept
+{
+    const uint32_t bit = 1u << m_event.operation;
+    if (s_openOperations & bit)
+    {
+        // Nested inside a zone for the same operation, so the destructor has nothing to do
+        m_sink = nullptr;
+        return;
+    }
+
+    s_openOperations |= bit;
+
+    m_event.threadId = GetThreadIdentifier();
+
+    m_sink->BeginZone(m_event);
+    m_sink->Counter("DirectXTex active operations", ++s_activeZones);
+}
+
+#endif // DIRECTX_TEX_INSTRUMENTATION
+
+
+//=====================================================================================
+// ChromeTraceSink - Records events for the Chrome trace-event JSON format
+//=====================================================================================
+
+struct ChromeTraceSink::Impl
+{
+    struct Record
+    {
+        char            phase;      // 'B', 'E', or 'C'
+        std::string     name;
+        double          timestamp;  // microseconds
+        TraceEvent      event;
+        int64_t         value;
+    };
+
+    mutable std::mutex                      mutex;
+    std::chrono::steady_clock::time_point   start;
+    std::vector<Record>                     records;
+
+    Impl() noexcept : start(std::chrono::steady_clock::now()) {}
+
+    void Add(char phase, const char* name, const TraceEvent* event, int64_t value) noexcept
+    {
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+        try
+        {
+            Record record = {};
+            record.phase = phase;
+            record.name = (name) ? name : "";
+            record.timestamp = elapsed.count();
+            if (event)
+            {
+                record.event = *event;
+                record.event.name = nullptr;
+            }
+            else
+            {
+                record.event.threadId = GetThreadIdentifier();
+            }
+            record.value = value;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            records.emplace_back(std::move(record));
+        }
+        catch (...)
+        {
+            // Out of memory: drop the event rather than fail the operation being traced
+        }
+    }
+};
+
+ChromeTraceSink::ChromeTraceSink() noexcept :
+    pImpl(new (std::nothrow) Impl)
+{
+}
+
+ChromeTraceSink::~ChromeTraceSink() = default;
+
+_Use_decl_annotations_
+void ChromeTraceSink::BeginZone(const TraceEvent& event) noexcept
+{
+    if (pImpl)
+        pImpl->Add('B', event.name, &event, 0);
+}
+
+_Use_decl_annotations_
+void ChromeTraceSink::EndZone(const TraceEvent& event) noexcept
+{
+    if (pImpl)
+        pImpl->Add('E', event.name, &event, 0);
+}
+
+_Use_decl_annotations_
+void ChromeTraceSink::Counter(const char* name, int64_t value) noexcept
+{
+    if (pImpl)
+        pImpl->Add('C', name, nullptr, value);
+}
+
+void ChromeTraceSink::Clear() noexcept
+{
+    if (!pImpl)
+        return;
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->records.clear();
+}
+
+_Use_decl_annotations_
+HRESULT ChromeTraceSink::SaveToFile(const wchar_t* szFile) const noexcept
+{
+    if (!szFile)
+        return E_INVALIDARG;
+
+    if (!pImpl)
+        return E_OUTOFMEMORY;
+
+    std::string json;
+    try
+    {
+        const uint64_t pid = GetProcessIdentifier();
+
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+
+        json.reserve(64 + pImpl->records.size() * 256);
+        json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        char buff[512] = {};
+        bool first = true;
+        for (const auto& record : pImpl->records)
+        {
+            json += (first) ? "\n{\"name\":\"" : ",\n{\"name\":\"";
+            first = false;
+
+            AppendEscaped(json, record.name.c_str());
+
+            snprintf(buff, sizeof(buff), "\",\"cat\":\"DirectXTex\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%llu,\"tid\":%llu,\"args\":{",
+                record.phase, record.timestamp,
+                static_cast<unsigned long long>(pid),
+                static_cast<unsigned long long>(record.event.threadId));
+            json += buff;
+
+            if (record.phase == 'C')
+            {
+                snprintf(buff, sizeof(buff), "\"value\":%lld}}", static_cast<long long>(record.value));
+            }
+            else
+            {
+                const TraceEvent& event = record.event;
+                snprintf(buff, sizeof(buff),
+                    "\"operation\":\"%s\",\"format\":%u,\"targetFormat\":%u,\"width\":%zu,\"height\":%zu,\"depth\":%zu,"
+                    "\"arraySize\":%zu,\"mipLevels\":%zu,\"bytes\":%llu}}",
+                    GetOperationName(event.operation),
+                    static_cast<unsigned int>(event.format), static_cast<unsigned int>(event.targetFormat),
+                    event.width, event.height, event.depth, event.arraySize, event.mipLevels,
+                    static_cast<unsigned long long>(event.bytes));
+            }
+            json += buff;
+        }
+
+        json += "\n]}\n";
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    // Create file
+#ifdef _WIN32
+    if (json.size() > UINT32_MAX)
+        return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(szFile,
+        GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(szFile,
+        GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)));
+#endif
+    if (!hFile)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    auto_delete_file delonfail(hFile.get());
+
+    auto const bytesToWrite = static_cast<const DWORD>(json.size());
+    DWORD bytesWritten;
+    if (!WriteFile(hFile.get(), json.data(), bytesToWrite, &bytesWritten, nullptr))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    if (bytesWritten != bytesToWrite)
+    {
+        return E_FAIL;
+    }
+
+    delonfail.clear();
+#else // !WIN32
+    std::ofstream outFile(std::filesystem::path(szFile), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outFile)
+        return E_FAIL;
+
+    outFile.write(json.data(), static_cast<std::streamsize>(json.size()));
+
+    if (!outFile)
+        return E_FAIL;
+#endif
+
+    return S_OK;
+}
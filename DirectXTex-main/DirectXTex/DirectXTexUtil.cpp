@@ -11,6 +11,8 @@
 
 #include "DirectXTexP.h"
 
+#include <mutex>
+
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
 static_assert(XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT == DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT, "Xbox mismatch detected");
 static_assert(XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT == DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT, "Xbox mismatch detected");
@@ -115,14 +117,6 @@ namespace
     #endif
     }
 
-#else // !WIN32
-    inline void * _aligned_malloc(size_t size, size_t alignment)
-    {
-        size = (size + alignment - 1) & ~(alignment - 1);
-        return std::aligned_alloc(alignment, size);
-    }
-
-#define _aligned_free free
 #endif
 }
 
@@ -342,59 +336,201 @@ void DirectX::SetWICFactory(_In_opt_ IWICImagingFactory* pWIC) noexcept
 // DXGI Format Utilities
 //=====================================================================================
 
-//-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-bool DirectX::IsPacked(DXGI_FORMAT fmt) noexcept
+namespace
 {
-    switch (static_cast<int>(fmt))
+    enum FORMAT_TRAITS_FLAGS : uint8_t
     {
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_YUY2: // 4:2:2 8-bit
-    case DXGI_FORMAT_Y210: // 4:2:2 10-bit
-    case DXGI_FORMAT_Y216: // 4:2:2 16-bit
-        return true;
+        FMTF_PACKED = 0x1,
+        FMTF_VIDEO = 0x2,
+        FMTF_PLANAR = 0x4,
+        FMTF_DEPTH_STENCIL = 0x8,
+        FMTF_BGR = 0x10,
+        FMTF_TYPELESS = 0x20,
+        FMTF_PARTIAL_TYPELESS = 0x40,
+        FMTF_ALPHA = 0x80,
+    };
 
-    default:
-        return false;
+    struct FormatTraits
+    {
+        uint8_t bitsPerPixel;
+        uint8_t bitsPerColor;   // Largest channel depth, 0 for palettized formats
+        uint8_t flags;          // FORMAT_TRAITS_FLAGS
+    };
+
+    // Indexed by DXGI_FORMAT value, so the format queries are a single table load
+    constexpr FormatTraits g_FormatTraits[] =
+    {
+        {   0,  0, 0 },                                                        // DXGI_FORMAT_UNKNOWN
+        { 128, 32, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_R32G32B32A32_TYPELESS
+        { 128, 32, FMTF_ALPHA },                                               // DXGI_FORMAT_R32G32B32A32_FLOAT
+        { 128, 32, FMTF_ALPHA },                                               // DXGI_FORMAT_R32G32B32A32_UINT
+        { 128, 32, FMTF_ALPHA },                                               // DXGI_FORMAT_R32G32B32A32_SINT
+        {  96, 32, FMTF_TYPELESS },                                            // DXGI_FORMAT_R32G32B32_TYPELESS
+        {  96, 32, 0 },                                                        // DXGI_FORMAT_R32G32B32_FLOAT
+        {  96, 32, 0 },                                                        // DXGI_FORMAT_R32G32B32_UINT
+        {  96, 32, 0 },                                                        // DXGI_FORMAT_R32G32B32_SINT
+        {  64, 16, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_R16G16B16A16_TYPELESS
+        {  64, 16, FMTF_ALPHA },                                               // DXGI_FORMAT_R16G16B16A16_FLOAT
+        {  64, 16, FMTF_ALPHA },                                               // DXGI_FORMAT_R16G16B16A16_UNORM
+        {  64, 16, FMTF_ALPHA },                                               // DXGI_FORMAT_R16G16B16A16_UINT
+        {  64, 16, FMTF_ALPHA },                                               // DXGI_FORMAT_R16G16B16A16_SNORM
+        {  64, 16, FMTF_ALPHA },                                               // DXGI_FORMAT_R16G16B16A16_SINT
+        {  64, 32, FMTF_TYPELESS },                                            // DXGI_FORMAT_R32G32_TYPELESS
+        {  64, 32, 0 },                                                        // DXGI_FORMAT_R32G32_FLOAT
+        {  64, 32, 0 },                                                        // DXGI_FORMAT_R32G32_UINT
+        {  64, 32, 0 },                                                        // DXGI_FORMAT_R32G32_SINT
+        {  64, 32, FMTF_DEPTH_STENCIL | FMTF_TYPELESS },                       // DXGI_FORMAT_R32G8X24_TYPELESS
+        {  64, 32, FMTF_DEPTH_STENCIL },                                       // DXGI_FORMAT_D32_FLOAT_S8X24_UINT
+        {  64, 32, FMTF_DEPTH_STENCIL | FMTF_PARTIAL_TYPELESS },               // DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS
+        {  64, 32, FMTF_DEPTH_STENCIL | FMTF_PARTIAL_TYPELESS },               // DXGI_FORMAT_X32_TYPELESS_G8X24_UINT
+        {  32, 10, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_R10G10B10A2_TYPELESS
+        {  32, 10, FMTF_ALPHA },                                               // DXGI_FORMAT_R10G10B10A2_UNORM
+        {  32, 10, FMTF_ALPHA },                                               // DXGI_FORMAT_R10G10B10A2_UINT
+        {  32, 11, 0 },                                                        // DXGI_FORMAT_R11G11B10_FLOAT
+        {  32,  8, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_R8G8B8A8_TYPELESS
+        {  32,  8, FMTF_ALPHA },                                               // DXGI_FORMAT_R8G8B8A8_UNORM
+        {  32,  8, FMTF_ALPHA },                                               // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+        {  32,  8, FMTF_ALPHA },                                               // DXGI_FORMAT_R8G8B8A8_UINT
+        {  32,  8, FMTF_ALPHA },                                               // DXGI_FORMAT_R8G8B8A8_SNORM
+        {  32,  8, FMTF_ALPHA },                                               // DXGI_FORMAT_R8G8B8A8_SINT
+        {  32, 16, FMTF_TYPELESS },                                            // DXGI_FORMAT_R16G16_TYPELESS
+        {  32, 16, 0 },                                                        // DXGI_FORMAT_R16G16_FLOAT
+        {  32, 16, 0 },                                                        // DXGI_FORMAT_R16G16_UNORM
+        {  32, 16, 0 },                                                        // DXGI_FORMAT_R16G16_UINT
+        {  32, 16, 0 },                                                        // DXGI_FORMAT_R16G16_SNORM
+        {  32, 16, 0 },                                                        // DXGI_FORMAT_R16G16_SINT
+        {  32, 32, FMTF_TYPELESS },                                            // DXGI_FORMAT_R32_TYPELESS
+        {  32, 32, FMTF_DEPTH_STENCIL },                                       // DXGI_FORMAT_D32_FLOAT
+        {  32, 32, 0 },                                                        // DXGI_FORMAT_R32_FLOAT
+        {  32, 32, 0 },                                                        // DXGI_FORMAT_R32_UINT
+        {  32, 32, 0 },                                                        // DXGI_FORMAT_R32_SINT
+        {  32, 24, FMTF_DEPTH_STENCIL | FMTF_TYPELESS },                       // DXGI_FORMAT_R24G8_TYPELESS
+        {  32, 24, FMTF_DEPTH_STENCIL },                                       // DXGI_FORMAT_D24_UNORM_S8_UINT
+        {  32, 24, FMTF_DEPTH_STENCIL | FMTF_PARTIAL_TYPELESS },               // DXGI_FORMAT_R24_UNORM_X8_TYPELESS
+        {  32, 24, FMTF_DEPTH_STENCIL | FMTF_PARTIAL_TYPELESS },               // DXGI_FORMAT_X24_TYPELESS_G8_UINT
+        {  16,  8, FMTF_TYPELESS },                                            // DXGI_FORMAT_R8G8_TYPELESS
+        {  16,  8, 0 },                                                        // DXGI_FORMAT_R8G8_UNORM
+        {  16,  8, 0 },                                                        // DXGI_FORMAT_R8G8_UINT
+        {  16,  8, 0 },                                                        // DXGI_FORMAT_R8G8_SNORM
+        {  16,  8, 0 },                                                        // DXGI_FORMAT_R8G8_SINT
+        {  16, 16, FMTF_TYPELESS },                                            // DXGI_FORMAT_R16_TYPELESS
+        {  16, 16, 0 },                                                        // DXGI_FORMAT_R16_FLOAT
+        {  16, 16, FMTF_DEPTH_STENCIL },                                       // DXGI_FORMAT_D16_UNORM
+        {  16, 16, 0 },                                                        // DXGI_FORMAT_R16_UNORM
+        {  16, 16, 0 },                                                        // DXGI_FORMAT_R16_UINT
+        {  16, 16, 0 },                                                        // DXGI_FORMAT_R16_SNORM
+        {  16, 16, 0 },                                                        // DXGI_FORMAT_R16_SINT
+        {   8,  8, FMTF_TYPELESS },                                            // DXGI_FORMAT_R8_TYPELESS
+        {   8,  8, 0 },                                                        // DXGI_FORMAT_R8_UNORM
+        {   8,  8, 0 },                                                        // DXGI_FORMAT_R8_UINT
+        {   8,  8, 0 },                                                        // DXGI_FORMAT_R8_SNORM
+        {   8,  8, 0 },                                                        // DXGI_FORMAT_R8_SINT
+        {   8,  8, FMTF_ALPHA },                                               // DXGI_FORMAT_A8_UNORM
+        {   1,  1, 0 },                                                        // DXGI_FORMAT_R1_UNORM
+        {  32, 14, 0 },                                                        // DXGI_FORMAT_R9G9B9E5_SHAREDEXP
+        {  32,  8, FMTF_PACKED },                                              // DXGI_FORMAT_R8G8_B8G8_UNORM
+        {  32,  8, FMTF_PACKED },                                              // DXGI_FORMAT_G8R8_G8B8_UNORM
+        {   4,  6, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_BC1_TYPELESS
+        {   4,  6, FMTF_ALPHA },                                               // DXGI_FORMAT_BC1_UNORM
+        {   4,  6, FMTF_ALPHA },                                               // DXGI_FORMAT_BC1_UNORM_SRGB
+        {   8,  6, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_BC2_TYPELESS
+        {   8,  6, FMTF_ALPHA },                                               // DXGI_FORMAT_BC2_UNORM
+        {   8,  6, FMTF_ALPHA },                                               // DXGI_FORMAT_BC2_UNORM_SRGB
+        {   8,  6, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_BC3_TYPELESS
+        {   8,  6, FMTF_ALPHA },                                               // DXGI_FORMAT_BC3_UNORM
+        {   8,  6, FMTF_ALPHA },                                               // DXGI_FORMAT_BC3_UNORM_SRGB
+        {   4,  8, FMTF_TYPELESS },                                            // DXGI_FORMAT_BC4_TYPELESS
+        {   4,  8, 0 },                                                        // DXGI_FORMAT_BC4_UNORM
+        {   4,  8, 0 },                                                        // DXGI_FORMAT_BC4_SNORM
+        {   8,  8, FMTF_TYPELESS },                                            // DXGI_FORMAT_BC5_TYPELESS
+        {   8,  8, 0 },                                                        // DXGI_FORMAT_BC5_UNORM
+        {   8,  8, 0 },                                                        // DXGI_FORMAT_BC5_SNORM
+        {  16,  6, FMTF_BGR },                                                 // DXGI_FORMAT_B5G6R5_UNORM
+        {  16,  5, FMTF_BGR | FMTF_ALPHA },                                    // DXGI_FORMAT_B5G5R5A1_UNORM
+        {  32,  8, FMTF_BGR | FMTF_ALPHA },                                    // DXGI_FORMAT_B8G8R8A8_UNORM
+        {  32,  8, FMTF_BGR },                                                 // DXGI_FORMAT_B8G8R8X8_UNORM
+        {  32, 10, FMTF_ALPHA },                                               // DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM
+        {  32,  8, FMTF_BGR | FMTF_ALPHA | FMTF_TYPELESS },                    // DXGI_FORMAT_B8G8R8A8_TYPELESS
+        {  32,  8, FMTF_BGR | FMTF_ALPHA },                                    // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+        {  32,  8, FMTF_BGR | FMTF_TYPELESS },                                 // DXGI_FORMAT_B8G8R8X8_TYPELESS
+        {  32,  8, FMTF_BGR },                                                 // DXGI_FORMAT_B8G8R8X8_UNORM_SRGB
+        {   8, 16, FMTF_TYPELESS },                                            // DXGI_FORMAT_BC6H_TYPELESS
+        {   8, 16, 0 },                                                        // DXGI_FORMAT_BC6H_UF16
+        {   8, 16, 0 },                                                        // DXGI_FORMAT_BC6H_SF16
+        {   8,  7, FMTF_ALPHA | FMTF_TYPELESS },                               // DXGI_FORMAT_BC7_TYPELESS
+        {   8,  7, FMTF_ALPHA },                                               // DXGI_FORMAT_BC7_UNORM
+        {   8,  7, FMTF_ALPHA },                                               // DXGI_FORMAT_BC7_UNORM_SRGB
+        {  32,  8, FMTF_VIDEO | FMTF_ALPHA },                                  // DXGI_FORMAT_AYUV
+        {  32, 10, FMTF_VIDEO | FMTF_ALPHA },                                  // DXGI_FORMAT_Y410
+        {  64, 16, FMTF_VIDEO | FMTF_ALPHA },                                  // DXGI_FORMAT_Y416
+        {  12,  8, FMTF_VIDEO | FMTF_PLANAR },                                 // DXGI_FORMAT_NV12
+        {  24, 10, FMTF_VIDEO | FMTF_PLANAR },                                 // DXGI_FORMAT_P010
+        {  24, 16, FMTF_VIDEO | FMTF_PLANAR },                                 // DXGI_FORMAT_P016
+        {  12,  8, FMTF_VIDEO | FMTF_PLANAR },                                 // DXGI_FORMAT_420_OPAQUE
+        {  32,  8, FMTF_PACKED | FMTF_VIDEO },                                 // DXGI_FORMAT_YUY2
+        {  64, 10, FMTF_PACKED | FMTF_VIDEO },                                 // DXGI_FORMAT_Y210
+        {  64, 16, FMTF_PACKED | FMTF_VIDEO },                                 // DXGI_FORMAT_Y216
+        {  12,  8, FMTF_VIDEO | FMTF_PLANAR },                                 // DXGI_FORMAT_NV11
+        {   8,  0, FMTF_VIDEO | FMTF_ALPHA },                                  // DXGI_FORMAT_AI44
+        {   8,  0, FMTF_VIDEO | FMTF_ALPHA },                                  // DXGI_FORMAT_IA44
+        {   8,  0, FMTF_VIDEO },                                               // DXGI_FORMAT_P8
+        {  16,  0, FMTF_VIDEO | FMTF_ALPHA },                                  // DXGI_FORMAT_A8P8
+        {  16,  4, FMTF_BGR | FMTF_ALPHA },                                    // DXGI_FORMAT_B4G4R4A4_UNORM
+        {  32, 10, FMTF_ALPHA },                                               // XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT
+        {  32, 10, FMTF_ALPHA },                                               // XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT
+        {  24, 16, FMTF_PLANAR | FMTF_DEPTH_STENCIL },                         // XBOX_DXGI_FORMAT_D16_UNORM_S8_UINT
+        {  24, 16, FMTF_PLANAR | FMTF_DEPTH_STENCIL | FMTF_PARTIAL_TYPELESS }, // XBOX_DXGI_FORMAT_R16_UNORM_X8_TYPELESS
+        {  24, 16, FMTF_PLANAR | FMTF_DEPTH_STENCIL | FMTF_PARTIAL_TYPELESS }, // XBOX_DXGI_FORMAT_X16_TYPELESS_G8_UINT
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(121)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(122)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(123)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(124)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(125)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(126)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(127)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(128)
+        {   0,  0, 0 },                                                        // DXGI_FORMAT(129)
+        {  16,  8, FMTF_VIDEO | FMTF_PLANAR },                                 // WIN10_DXGI_FORMAT_P208
+        {  16,  8, FMTF_VIDEO | FMTF_PLANAR },                                 // WIN10_DXGI_FORMAT_V208
+        {  24,  8, FMTF_VIDEO | FMTF_PLANAR },                                 // WIN10_DXGI_FORMAT_V408
+    };
+
+    static_assert(sizeof(g_FormatTraits) / sizeof(FormatTraits) == static_cast<size_t>(WIN10_DXGI_FORMAT_V408) + 1, "Format traits table size mismatch");
+
+    constexpr FormatTraits g_XboxR10G10B10SNormA2Traits = { 32, 10, FMTF_ALPHA };
+    constexpr FormatTraits g_XboxR4G4Traits = { 8, 4, 0 };
+    constexpr FormatTraits g_A4B4G4R4Traits = { 16, 4, FMTF_BGR | FMTF_ALPHA };
+    constexpr FormatTraits g_UnknownTraits = { 0, 0, 0 };
+
+    inline const FormatTraits& GetFormatTraits(DXGI_FORMAT fmt) noexcept
+    {
+        const auto index = static_cast<size_t>(fmt);
+        if (index < sizeof(g_FormatTraits) / sizeof(FormatTraits))
+            return g_FormatTraits[index];
+
+        switch (static_cast<int>(fmt))
+        {
+        case XBOX_DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM: return g_XboxR10G10B10SNormA2Traits;
+        case XBOX_DXGI_FORMAT_R4G4_UNORM:               return g_XboxR4G4Traits;
+        case WIN11_DXGI_FORMAT_A4B4G4R4_UNORM:          return g_A4B4G4R4Traits;
+        default:                                        return g_UnknownTraits;
+        }
     }
 }
 
-
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-bool DirectX::IsVideo(DXGI_FORMAT fmt) noexcept
+bool DirectX::IsPacked(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_AYUV:
-    case DXGI_FORMAT_Y410:
-    case DXGI_FORMAT_Y416:
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_P016:
-    case DXGI_FORMAT_YUY2:
-    case DXGI_FORMAT_Y210:
-    case DXGI_FORMAT_Y216:
-    case DXGI_FORMAT_NV11:
-        // These video formats can be used with the 3D pipeline through special view mappings
+    return (GetFormatTraits(fmt).flags & FMTF_PACKED) != 0;
+}
 
-    case DXGI_FORMAT_420_OPAQUE:
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_P8:
-    case DXGI_FORMAT_A8P8:
-        // These are limited use video formats not usable in any way by the 3D pipeline
 
-    case WIN10_DXGI_FORMAT_P208:
-    case WIN10_DXGI_FORMAT_V208:
-    case WIN10_DXGI_FORMAT_V408:
-        // These video formats are for JPEG Hardware decode (DXGI 1.4)
-        return true;
-
-    default:
-        return false;
-    }
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool DirectX::IsVideo(DXGI_FORMAT fmt) noexcept
+{
+    return (GetFormatTraits(fmt).flags & FMTF_VIDEO) != 0;
 }
 
 
@@ -402,28 +538,7 @@ bool DirectX::IsVideo(DXGI_FORMAT fmt) noexcept
 _Use_decl_annotations_
 bool DirectX::IsPlanar(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_NV12:      // 4:2:0 8-bit
-    case DXGI_FORMAT_P010:      // 4:2:0 10-bit
-    case DXGI_FORMAT_P016:      // 4:2:0 16-bit
-    case DXGI_FORMAT_420_OPAQUE:// 4:2:0 8-bit
-    case DXGI_FORMAT_NV11:      // 4:1:1 8-bit
-
-    case WIN10_DXGI_FORMAT_P208: // 4:2:2 8-bit
-    case WIN10_DXGI_FORMAT_V208: // 4:4:0 8-bit
-    case WIN10_DXGI_FORMAT_V408: // 4:4:4 8-bit
-        // These are JPEG Hardware decode formats (DXGI 1.4)
-
-    case XBOX_DXGI_FORMAT_D16_UNORM_S8_UINT:
-    case XBOX_DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-    case XBOX_DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-        // These are Xbox One platform specific types
-        return true;
-
-    default:
-        return false;
-    }
+    return (GetFormatTraits(fmt).flags & FMTF_PLANAR) != 0;
 }
 
 
@@ -431,26 +546,7 @@ bool DirectX::IsPlanar(DXGI_FORMAT fmt) noexcept
 _Use_decl_annotations_
 bool DirectX::IsDepthStencil(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-    case DXGI_FORMAT_D32_FLOAT:
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_D24_UNORM_S8_UINT:
-    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-    case DXGI_FORMAT_D16_UNORM:
-    case XBOX_DXGI_FORMAT_D16_UNORM_S8_UINT:
-    case XBOX_DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-    case XBOX_DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-        return true;
-
-    default:
-        return false;
-    }
+    return (GetFormatTraits(fmt).flags & FMTF_DEPTH_STENCIL) != 0;
 }
 
 
@@ -458,23 +554,7 @@ bool DirectX::IsDepthStencil(DXGI_FORMAT fmt) noexcept
 _Use_decl_annotations_
 bool DirectX::IsBGR(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_B5G6R5_UNORM:
-    case DXGI_FORMAT_B5G5R5A1_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_B8G8R8X8_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-    case DXGI_FORMAT_B4G4R4A4_UNORM:
-    case WIN11_DXGI_FORMAT_A4B4G4R4_UNORM:
-        return true;
-
-    default:
-        return false;
-    }
+    return (GetFormatTraits(fmt).flags & FMTF_BGR) != 0;
 }
 
 
@@ -482,43 +562,11 @@ bool DirectX::IsBGR(DXGI_FORMAT fmt) noexcept
 _Use_decl_annotations_
 bool DirectX::IsTypeless(DXGI_FORMAT fmt, bool partialTypeless) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32_TYPELESS:
-    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-    case DXGI_FORMAT_R32G32_TYPELESS:
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-    case DXGI_FORMAT_R16G16_TYPELESS:
-    case DXGI_FORMAT_R32_TYPELESS:
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_R8G8_TYPELESS:
-    case DXGI_FORMAT_R16_TYPELESS:
-    case DXGI_FORMAT_R8_TYPELESS:
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC7_TYPELESS:
+    const uint8_t flags = GetFormatTraits(fmt).flags;
+    if (flags & FMTF_TYPELESS)
         return true;
 
-    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-    case XBOX_DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-    case XBOX_DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-        return partialTypeless;
-
-    default:
-        return false;
-    }
+    return partialTypeless && (flags & FMTF_PARTIAL_TYPELESS) != 0;
 }
 
 
@@ -526,61 +574,7 @@ bool DirectX::IsTypeless(DXGI_FORMAT fmt, bool partialTypeless) noexcept
 _Use_decl_annotations_
 bool DirectX::HasAlpha(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R32G32B32A32_UINT:
-    case DXGI_FORMAT_R32G32B32A32_SINT:
-    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_UNORM:
-    case DXGI_FORMAT_R16G16B16A16_UINT:
-    case DXGI_FORMAT_R16G16B16A16_SNORM:
-    case DXGI_FORMAT_R16G16B16A16_SINT:
-    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-    case DXGI_FORMAT_R10G10B10A2_UNORM:
-    case DXGI_FORMAT_R10G10B10A2_UINT:
-    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R8G8B8A8_UINT:
-    case DXGI_FORMAT_R8G8B8A8_SNORM:
-    case DXGI_FORMAT_R8G8B8A8_SINT:
-    case DXGI_FORMAT_A8_UNORM:
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_B5G5R5A1_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-    case DXGI_FORMAT_AYUV:
-    case DXGI_FORMAT_Y410:
-    case DXGI_FORMAT_Y416:
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_A8P8:
-    case DXGI_FORMAT_B4G4R4A4_UNORM:
-    case XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
-    case XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
-    case XBOX_DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
-    case WIN11_DXGI_FORMAT_A4B4G4R4_UNORM:
-        return true;
-
-    default:
-        return false;
-    }
+    return (GetFormatTraits(fmt).flags & FMTF_ALPHA) != 0;
 }
 
 
@@ -590,157 +584,7 @@ bool DirectX::HasAlpha(DXGI_FORMAT fmt) noexcept
 _Use_decl_annotations_
 size_t DirectX::BitsPerPixel(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R32G32B32A32_UINT:
-    case DXGI_FORMAT_R32G32B32A32_SINT:
-        return 128;
-
-    case DXGI_FORMAT_R32G32B32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32_FLOAT:
-    case DXGI_FORMAT_R32G32B32_UINT:
-    case DXGI_FORMAT_R32G32B32_SINT:
-        return 96;
-
-    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_UNORM:
-    case DXGI_FORMAT_R16G16B16A16_UINT:
-    case DXGI_FORMAT_R16G16B16A16_SNORM:
-    case DXGI_FORMAT_R16G16B16A16_SINT:
-    case DXGI_FORMAT_R32G32_TYPELESS:
-    case DXGI_FORMAT_R32G32_FLOAT:
-    case DXGI_FORMAT_R32G32_UINT:
-    case DXGI_FORMAT_R32G32_SINT:
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-    case DXGI_FORMAT_Y416:
-    case DXGI_FORMAT_Y210:
-    case DXGI_FORMAT_Y216:
-        return 64;
-
-    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-    case DXGI_FORMAT_R10G10B10A2_UNORM:
-    case DXGI_FORMAT_R10G10B10A2_UINT:
-    case DXGI_FORMAT_R11G11B10_FLOAT:
-    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R8G8B8A8_UINT:
-    case DXGI_FORMAT_R8G8B8A8_SNORM:
-    case DXGI_FORMAT_R8G8B8A8_SINT:
-    case DXGI_FORMAT_R16G16_TYPELESS:
-    case DXGI_FORMAT_R16G16_FLOAT:
-    case DXGI_FORMAT_R16G16_UNORM:
-    case DXGI_FORMAT_R16G16_UINT:
-    case DXGI_FORMAT_R16G16_SNORM:
-    case DXGI_FORMAT_R16G16_SINT:
-    case DXGI_FORMAT_R32_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT:
-    case DXGI_FORMAT_R32_FLOAT:
-    case DXGI_FORMAT_R32_UINT:
-    case DXGI_FORMAT_R32_SINT:
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_D24_UNORM_S8_UINT:
-    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_B8G8R8X8_UNORM:
-    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-    case DXGI_FORMAT_AYUV:
-    case DXGI_FORMAT_Y410:
-    case DXGI_FORMAT_YUY2:
-    case XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
-    case XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
-    case XBOX_DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
-        return 32;
-
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_P016:
-    case XBOX_DXGI_FORMAT_D16_UNORM_S8_UINT:
-    case XBOX_DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-    case XBOX_DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-    case WIN10_DXGI_FORMAT_V408:
-        return 24;
-
-    case DXGI_FORMAT_R8G8_TYPELESS:
-    case DXGI_FORMAT_R8G8_UNORM:
-    case DXGI_FORMAT_R8G8_UINT:
-    case DXGI_FORMAT_R8G8_SNORM:
-    case DXGI_FORMAT_R8G8_SINT:
-    case DXGI_FORMAT_R16_TYPELESS:
-    case DXGI_FORMAT_R16_FLOAT:
-    case DXGI_FORMAT_D16_UNORM:
-    case DXGI_FORMAT_R16_UNORM:
-    case DXGI_FORMAT_R16_UINT:
-    case DXGI_FORMAT_R16_SNORM:
-    case DXGI_FORMAT_R16_SINT:
-    case DXGI_FORMAT_B5G6R5_UNORM:
-    case DXGI_FORMAT_B5G5R5A1_UNORM:
-    case DXGI_FORMAT_A8P8:
-    case DXGI_FORMAT_B4G4R4A4_UNORM:
-    case WIN10_DXGI_FORMAT_P208:
-    case WIN10_DXGI_FORMAT_V208:
-    case WIN11_DXGI_FORMAT_A4B4G4R4_UNORM:
-        return 16;
-
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_420_OPAQUE:
-    case DXGI_FORMAT_NV11:
-        return 12;
-
-    case DXGI_FORMAT_R8_TYPELESS:
-    case DXGI_FORMAT_R8_UNORM:
-    case DXGI_FORMAT_R8_UINT:
-    case DXGI_FORMAT_R8_SNORM:
-    case DXGI_FORMAT_R8_SINT:
-    case DXGI_FORMAT_A8_UNORM:
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_P8:
-    case XBOX_DXGI_FORMAT_R4G4_UNORM:
-        return 8;
-
-    case DXGI_FORMAT_R1_UNORM:
-        return 1;
-
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC4_UNORM:
-    case DXGI_FORMAT_BC4_SNORM:
-        return 4;
-
-    default:
-        return 0;
-    }
+    return GetFormatTraits(fmt).bitsPerPixel;
 }
 
 
@@ -751,163 +595,7 @@ size_t DirectX::BitsPerPixel(DXGI_FORMAT fmt) noexcept
 _Use_decl_annotations_
 size_t DirectX::BitsPerColor(DXGI_FORMAT fmt) noexcept
 {
-    switch (static_cast<int>(fmt))
-    {
-    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R32G32B32A32_UINT:
-    case DXGI_FORMAT_R32G32B32A32_SINT:
-    case DXGI_FORMAT_R32G32B32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32_FLOAT:
-    case DXGI_FORMAT_R32G32B32_UINT:
-    case DXGI_FORMAT_R32G32B32_SINT:
-    case DXGI_FORMAT_R32G32_TYPELESS:
-    case DXGI_FORMAT_R32G32_FLOAT:
-    case DXGI_FORMAT_R32G32_UINT:
-    case DXGI_FORMAT_R32G32_SINT:
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-    case DXGI_FORMAT_R32_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT:
-    case DXGI_FORMAT_R32_FLOAT:
-    case DXGI_FORMAT_R32_UINT:
-    case DXGI_FORMAT_R32_SINT:
-        return 32;
-
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_D24_UNORM_S8_UINT:
-    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-        return 24;
-
-    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_UNORM:
-    case DXGI_FORMAT_R16G16B16A16_UINT:
-    case DXGI_FORMAT_R16G16B16A16_SNORM:
-    case DXGI_FORMAT_R16G16B16A16_SINT:
-    case DXGI_FORMAT_R16G16_TYPELESS:
-    case DXGI_FORMAT_R16G16_FLOAT:
-    case DXGI_FORMAT_R16G16_UNORM:
-    case DXGI_FORMAT_R16G16_UINT:
-    case DXGI_FORMAT_R16G16_SNORM:
-    case DXGI_FORMAT_R16G16_SINT:
-    case DXGI_FORMAT_R16_TYPELESS:
-    case DXGI_FORMAT_R16_FLOAT:
-    case DXGI_FORMAT_D16_UNORM:
-    case DXGI_FORMAT_R16_UNORM:
-    case DXGI_FORMAT_R16_UINT:
-    case DXGI_FORMAT_R16_SNORM:
-    case DXGI_FORMAT_R16_SINT:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_Y416:
-    case DXGI_FORMAT_P016:
-    case DXGI_FORMAT_Y216:
-    case XBOX_DXGI_FORMAT_D16_UNORM_S8_UINT:
-    case XBOX_DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-    case XBOX_DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-        return 16;
-
-    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-        return 14;
-
-    case DXGI_FORMAT_R11G11B10_FLOAT:
-        return 11;
-
-    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-    case DXGI_FORMAT_R10G10B10A2_UNORM:
-    case DXGI_FORMAT_R10G10B10A2_UINT:
-    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-    case DXGI_FORMAT_Y410:
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_Y210:
-    case XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
-    case XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
-    case XBOX_DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
-        return 10;
-
-    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R8G8B8A8_UINT:
-    case DXGI_FORMAT_R8G8B8A8_SNORM:
-    case DXGI_FORMAT_R8G8B8A8_SINT:
-    case DXGI_FORMAT_R8G8_TYPELESS:
-    case DXGI_FORMAT_R8G8_UNORM:
-    case DXGI_FORMAT_R8G8_UINT:
-    case DXGI_FORMAT_R8G8_SNORM:
-    case DXGI_FORMAT_R8G8_SINT:
-    case DXGI_FORMAT_R8_TYPELESS:
-    case DXGI_FORMAT_R8_UNORM:
-    case DXGI_FORMAT_R8_UINT:
-    case DXGI_FORMAT_R8_SNORM:
-    case DXGI_FORMAT_R8_SINT:
-    case DXGI_FORMAT_A8_UNORM:
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC4_UNORM:
-    case DXGI_FORMAT_BC4_SNORM:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_B8G8R8X8_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-    case DXGI_FORMAT_AYUV:
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_420_OPAQUE:
-    case DXGI_FORMAT_YUY2:
-    case DXGI_FORMAT_NV11:
-    case WIN10_DXGI_FORMAT_P208:
-    case WIN10_DXGI_FORMAT_V208:
-    case WIN10_DXGI_FORMAT_V408:
-        return 8;
-
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-        return 7;
-
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_B5G6R5_UNORM:
-        return 6;
-
-    case DXGI_FORMAT_B5G5R5A1_UNORM:
-        return 5;
-
-    case DXGI_FORMAT_B4G4R4A4_UNORM:
-    case XBOX_DXGI_FORMAT_R4G4_UNORM:
-    case WIN11_DXGI_FORMAT_A4B4G4R4_UNORM:
-        return 4;
-
-    case DXGI_FORMAT_R1_UNORM:
-        return 1;
-
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_P8:
-    case DXGI_FORMAT_A8P8:
-        // Palettized formats return 0 for this function
-
-    default:
-        return 0;
-    }
+    return GetFormatTraits(fmt).bitsPerColor;
 }
 
 
@@ -1549,9 +1237,14 @@ Blob& Blob::operator= (Blob&& moveFrom) noexcept
 
         m_buffer = moveFrom.m_buffer;
         m_size = moveFrom.m_size;
+        m_capacity = moveFrom.m_capacity;
+        m_allocator = moveFrom.m_allocator;
+        m_bufferAllocator = moveFrom.m_bufferAllocator;
 
         moveFrom.m_buffer = nullptr;
         moveFrom.m_size = 0;
+        moveFrom.m_capacity = 0;
+        moveFrom.m_bufferAllocator = nullptr;
     }
     return *this;
 }
@@ -1560,11 +1253,14 @@ void Blob::Release() noexcept
 {
     if (m_buffer)
     {
-        _aligned_free(m_buffer);
+        assert(m_bufferAllocator != nullptr);
+        m_bufferAllocator->Free(m_buffer, m_capacity);
         m_buffer = nullptr;
     }
 
+    m_bufferAllocator = nullptr;
     m_size = 0;
+    m_capacity = 0;
 }
 
 _Use_decl_annotations_
@@ -1575,14 +1271,16 @@ HRESULT Blob::Initialize(size_t size) noexcept
 
     Release();
 
-    m_buffer = _aligned_malloc(size, 16);
+    IAllocator* allocator = (m_allocator) ? m_allocator : GetDefaultAllocator();
+    m_buffer = allocator->Allocate(size, 16);
     if (!m_buffer)
     {
         Release();
         return E_OUTOFMEMORY;
     }
 
-    m_size = size;
+    m_bufferAllocator = allocator;
+    m_size = m_capacity = size;
 
     return S_OK;
 }
@@ -1611,7 +1309,8 @@ HRESULT Blob::Resize(size_t size) noexcept
     if (!m_buffer || !m_size)
         return E_UNEXPECTED;
 
-    void *tbuffer = _aligned_malloc(size, 16);
+    IAllocator* allocator = (m_allocator) ? m_allocator : GetDefaultAllocator();
+    void *tbuffer = allocator->Allocate(size, 16);
     if (!tbuffer)
         return E_OUTOFMEMORY;
 
@@ -1620,7 +1319,134 @@ HRESULT Blob::Resize(size_t size) noexcept
     Release();
 
     m_buffer = tbuffer;
-    m_size = size;
+    m_bufferAllocator = allocator;
+    m_size = m_capacity = size;
 
     return S_OK;
 }
+
+
+//=====================================================================================
+// ProgressContext - Progress callback and cancellation for long-running operations
+//=====================================================================================
+
+struct ProgressContext::Impl
+{
+    std::atomic<bool>   cancelled;
+    std::mutex          mutex;
+    Callback            callback;
+
+    Impl() noexcept : cancelled(false) {}
+};
+
+ProgressContext::ProgressContext() noexcept :
+    pImpl(new (std::nothrow) Impl)
+{
+}
+
+_Use_decl_annotations_
+ProgressContext::ProgressContext(Callback callback) noexcept :
+    pImpl(new (std::nothrow) Impl)
+{
+    if (pImpl)
+    {
+        pImpl->callback = std::move(callback);
+    }
+}
+
+ProgressContext::~ProgressContext() = default;
+
+void ProgressContext::Cancel() noexcept
+{
+    if (pImpl)
+        pImpl->cancelled.store(true, std::memory_order_release);
+}
+
+bool ProgressContext::IsCancelled() const noexcept
+{
+    return pImpl && pImpl->cancelled.load(std::memory_order_acquire);
+}
+
+void ProgressContext::Reset() noexcept
+{
+    if (pImpl)
+        pImpl->cancelled.store(false, std::memory_order_release);
+}
+
+_Use_decl_annotations_
+bool ProgressContext::Report(size_t completed, size_t total) noexcept
+{
+    if (!pImpl)
+        return true;
+
+    if (pImpl->cancelled.load(std::memory_order_acquire))
+        return false;
+
+    if (!pImpl->callback)
+        return true;
+
+    // Intermediate reports are dropped rather than stall a worker behind a slow callback
+    std::unique_lock<std::mutex> lock(pImpl->mutex, std::defer_lock);
+    if (completed >= total)
+    {
+        lock.lock();
+    }
+    else if (!lock.try_lock())
+    {
+        return true;
+    }
+
+    bool proceed = false;
+    try
+    {
+        proceed = pImpl->callback(completed, total);
+    }
+    catch (...)
+    {
+        proceed = false;
+    }
+
+    if (!proceed)
+    {
+        Cancel();
+    }
+
+    return proceed && !IsCancelled();
+}
+
+
+//=====================================================================================
+// ProgressTracker
+//=====================================================================================
+
+_Use_decl_annotations_
+Internal::ProgressTracker::ProgressTracker(ProgressContext* context, size_t total) noexcept :
+    m_context(context),
+    m_total(std::max<size_t>(total, 1)),
+    m_interval(std::max<size_t>(m_total / 256, 1)),
+    m_completed(0),
+    m_nextReport(m_interval)
+{
+}
+
+_Use_decl_annotations_
+bool Internal::ProgressTracker::Advance(size_t units) noexcept
+{
+    if (!m_context)
+        return true;
+
+    const size_t completed = m_completed.fetch_add(units, std::memory_order_relaxed) + units;
+    if (completed >= m_total)
+    {
+        return m_context->Report(m_total, m_total);
+    }
+
+    size_t next = m_nextReport.load(std::memory_order_relaxed);
+    if (completed >= next
+        && m_nextReport.compare_exchange_strong(next, completed + m_interval, std::memory_order_relaxed))
+    {
+        return m_context->Report(completed, m_total);
+    }
+
+    return !m_context->IsCancelled();
+}
@@ -1314,6 +1314,8 @@ HRESULT DirectX::LoadFromWICMemory(
     ScratchImage& image,
     std::function<void(IWICMetadataQueryReader*)> getMQR)
 {
+    TEX_TRACE_ZONE(image);
+
     if (!pSource || size == 0)
         return E_INVALIDARG;
 
@@ -1388,6 +1390,8 @@ HRESULT DirectX::LoadFromWICFile(
     ScratchImage& image,
     std::function<void(IWICMetadataQueryReader*)> getMQR)
 {
+    TEX_TRACE_ZONE(image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -1450,6 +1454,8 @@ HRESULT DirectX::SaveToWICMemory(
     const GUID* targetFormat,
     std::function<void(IPropertyBag2*)> setCustomProps)
 {
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
     if (!image.pixels)
         return E_POINTER;
 
@@ -1497,6 +1503,8 @@ HRESULT DirectX::SaveToWICMemory(
     if (!images || nimages == 0)
         return E_INVALIDARG;
 
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, images[0]);
+
     HRESULT hr = blob.Initialize(65535u);
     if (FAILED(hr))
         return hr;
@@ -1545,6 +1553,8 @@ HRESULT DirectX::SaveToWICFile(
     const GUID* targetFormat,
     std::function<void(IPropertyBag2*)> setCustomProps)
 {
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, image);
+
     if (!szFile)
         return E_INVALIDARG;
 
@@ -1589,6 +1599,8 @@ HRESULT DirectX::SaveToWICFile(
     if (!szFile || !images || nimages == 0)
         return E_INVALIDARG;
 
+    TEX_TRACE_ZONE(TRACE_OP_SAVE, images[0]);
+
     bool iswic2 = false;
     auto pWIC = GetWICFactory(iswic2);
     if (!pWIC)
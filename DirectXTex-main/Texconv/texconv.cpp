@@ -9,6 +9,7 @@
 // http://go.microsoft.com/fwlink/?LinkId=248926
 //--------------------------------------------------------------------------------------
 
+#ifdef _WIN32
 #pragma warning(push)
 #pragma warning(disable : 4005)
 #define WIN32_LEAN_AND_MEAN
@@ -20,30 +21,45 @@
 #pragma warning(pop)
 
 #include <ShlObj.h>
+#endif
 
 #if __cplusplus < 201703L
 #error Requires C++17 (and /Zc:__cplusplus with MSVC)
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <cwchar>
 #include <cwctype>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iterator>
 #include <list>
 #include <locale>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <new>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <vector>
 
+#ifdef _WIN32
 #include <wrl\client.h>
 
 #include <d3d11.h>
@@ -51,6 +67,9 @@
 #include <dxgiformat.h>
 
 #include <wincodec.h>
+#else
+#include <unistd.h>
+#endif
 
 #pragma warning(disable : 4619 4616 26812)
 
@@ -68,7 +87,124 @@
 
 using namespace DirectX;
 using namespace DirectX::PackedVector;
+
+#ifdef _WIN32
 using Microsoft::WRL::ComPtr;
+#else
+#ifndef MAX_PATH
+#define MAX_PATH 260
+#endif
+#define _MAX_PATH MAX_PATH
+#define _MAX_FNAME 256
+#define _MAX_EXT 256
+
+#ifndef UNREFERENCED_PARAMETER
+#define UNREFERENCED_PARAMETER(P) (void)(P)
+#endif
+
+#ifndef _In_z_count_
+#define _In_z_count_(x)
+#endif
+
+#define _wcsicmp wcscasecmp
+#define swscanf_s swscanf
+
+namespace
+{
+    // This is adapter code. It is not a full implementation of the secure CRT!
+    inline int wcscpy_s(wchar_t* dest, size_t destSize, const wchar_t* src) noexcept
+    {
+        if (!dest || !destSize)
+            return EINVAL;
+
+        const size_t len = wcslen(src);
+        const size_t count = std::min(len, destSize - 1);
+        memcpy(dest, src, count * sizeof(wchar_t));
+        dest[count] = 0;
+        return (len < destSize) ? 0 : ERANGE;
+    }
+
+    template<size_t sizeOfBuffer>
+    inline int wcscpy_s(wchar_t(&dest)[sizeOfBuffer], const wchar_t* src) noexcept
+    {
+        return wcscpy_s(dest, sizeOfBuffer, src);
+    }
+
+    inline int wcscat_s(wchar_t* dest, size_t destSize, const wchar_t* src) noexcept
+    {
+        if (!dest || !destSize)
+            return EINVAL;
+
+        const size_t len = wcsnlen(dest, destSize);
+        if (len >= destSize)
+            return EINVAL;
+
+        return wcscpy_s(dest + len, destSize - len, src);
+    }
+
+    template<size_t sizeOfBuffer>
+    inline int wcscat_s(wchar_t(&dest)[sizeOfBuffer], const wchar_t* src) noexcept
+    {
+        return wcscat_s(dest, sizeOfBuffer, src);
+    }
+
+    template<size_t sizeOfBuffer>
+    inline int _wcslwr_s(wchar_t(&str)[sizeOfBuffer]) noexcept
+    {
+        for (size_t j = 0; j < sizeOfBuffer && str[j]; ++j)
+        {
+            str[j] = static_cast<wchar_t>(towlower(static_cast<wint_t>(str[j])));
+        }
+        return 0;
+    }
+
+    inline int memcpy_s(void* dest, size_t destSize, const void* src, size_t count) noexcept
+    {
+        if (count > destSize)
+            return ERANGE;
+
+        memcpy(dest, src, count);
+        return 0;
+    }
+
+    inline int _wsplitpath_s(const wchar_t* path,
+        wchar_t* drive, size_t driveSize,
+        wchar_t* dir, size_t dirSize,
+        wchar_t* fname, size_t fnameSize,
+        wchar_t* ext, size_t extSize) noexcept
+    {
+        const wchar_t* slash = wcsrchr(path, L'/');
+        const wchar_t* base = (slash) ? (slash + 1) : path;
+        const wchar_t* dot = wcsrchr(base, L'.');
+        if (!dot)
+            dot = base + wcslen(base);
+
+        if (drive && driveSize)
+            *drive = 0;
+
+        if (dir && dirSize)
+        {
+            const size_t count = std::min(static_cast<size_t>(base - path), dirSize - 1);
+            memcpy(dir, path, count * sizeof(wchar_t));
+            dir[count] = 0;
+        }
+
+        if (fname && fnameSize)
+        {
+            const size_t count = std::min(static_cast<size_t>(dot - base), fnameSize - 1);
+            memcpy(fname, base, count * sizeof(wchar_t));
+            fname[count] = 0;
+        }
+
+        if (ext && extSize)
+        {
+            wcscpy_s(ext, extSize, dot);
+        }
+
+        return 0;
+    }
+}
+#endif
 
 namespace
 {
@@ -97,6 +233,7 @@ namespace
         OPT_USE_DX10,
         OPT_USE_DX9,
         OPT_TGA20,
+        OPT_TGA_RLE,
         OPT_WIC_QUALITY,
         OPT_WIC_LOSSLESS,
         OPT_WIC_MULTIFRAME,
@@ -131,6 +268,9 @@ namespace
         OPT_PAPER_WHITE_NITS,
         OPT_BCNONMULT4FIX,
         OPT_SWIZZLE,
+        OPT_CACHE,
+        OPT_TIMING_JSON,
+        OPT_AUTO_PSNR,
         OPT_MAX
     };
 
@@ -186,6 +326,7 @@ namespace
         { L"dx10",          OPT_USE_DX10 },
         { L"dx9",           OPT_USE_DX9 },
         { L"tga20",         OPT_TGA20 },
+        { L"tgarle",        OPT_TGA_RLE },
         { L"wicq",          OPT_WIC_QUALITY },
         { L"wiclossless",   OPT_WIC_LOSSLESS },
         { L"wicmulti",      OPT_WIC_MULTIFRAME },
@@ -220,6 +361,9 @@ namespace
         { L"nits",          OPT_PAPER_WHITE_NITS },
         { L"fixbc4x4",      OPT_BCNONMULT4FIX },
         { L"swizzle",       OPT_SWIZZLE },
+        { L"cache",         OPT_CACHE },
+        { L"timing-json",   OPT_TIMING_JSON },
+        { L"autopsnr",      OPT_AUTO_PSNR },
         { nullptr,          0 }
     };
 
@@ -435,13 +579,16 @@ namespace
 
     const SValue<uint32_t> g_pSaveFileTypes[] =   // valid formats to write to
     {
+    #ifdef _WIN32
         { L"bmp",   WIC_CODEC_BMP  },
         { L"jpg",   WIC_CODEC_JPEG },
         { L"jpeg",  WIC_CODEC_JPEG },
         { L"png",   WIC_CODEC_PNG  },
+    #endif
         { L"dds",   CODEC_DDS      },
         { L"tga",   CODEC_TGA      },
         { L"hdr",   CODEC_HDR      },
+    #ifdef _WIN32
         { L"tif",   WIC_CODEC_TIFF },
         { L"tiff",  WIC_CODEC_TIFF },
         { L"wdp",   WIC_CODEC_WMP  },
@@ -449,11 +596,14 @@ namespace
         { L"jxr",   CODEC_JXR      },
         { L"ppm",   CODEC_PPM      },
         { L"pfm",   CODEC_PFM      },
+    #endif
     #ifdef USE_OPENEXR
         { L"exr",   CODEC_EXR      },
     #endif
+    #ifdef _WIN32
         { L"heic",  WIC_CODEC_HEIF },
         { L"heif",  WIC_CODEC_HEIF },
+    #endif
         { nullptr,  CODEC_DDS      }
     };
 
@@ -477,6 +627,7 @@ namespace
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
+#ifdef _WIN32
 HRESULT __cdecl LoadFromBMPEx(
     _In_z_ const wchar_t* szFile,
     _In_ WIC_FLAGS flags,
@@ -500,6 +651,7 @@ HRESULT __cdecl LoadFromPortablePixMapHDR(
 HRESULT __cdecl SaveToPortablePixMapHDR(
     _In_ const Image& image,
     _In_z_ const wchar_t* szFile) noexcept;
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -509,11 +661,13 @@ HRESULT __cdecl SaveToPortablePixMapHDR(
 
 namespace
 {
+#ifdef _WIN32
     inline HANDLE safe_handle(HANDLE h) noexcept { return (h == INVALID_HANDLE_VALUE) ? nullptr : h; }
 
     struct find_closer { void operator()(HANDLE h) noexcept { assert(h != INVALID_HANDLE_VALUE); if (h) FindClose(h); } };
 
     using ScopedFindHandle = std::unique_ptr<void, find_closer>;
+#endif
 
     constexpr static bool ispow2(size_t x)
     {
@@ -552,6 +706,7 @@ namespace
         return L"";
     }
 
+#ifdef _WIN32
     void SearchForFiles(const wchar_t* path, std::list<SConversion>& files, bool recursive, const wchar_t* folder)
     {
         // Process files
@@ -631,6 +786,101 @@ namespace
             }
         }
     }
+#else // !WIN32
+    bool MatchWildcard(const wchar_t* pattern, const wchar_t* name) noexcept
+    {
+        const wchar_t* star = nullptr;
+        const wchar_t* retry = nullptr;
+
+        while (*name)
+        {
+            if (*pattern == L'*')
+            {
+                star = pattern++;
+                retry = name;
+            }
+            else if (*pattern == L'?' || *pattern == *name)
+            {
+                ++pattern;
+                ++name;
+            }
+            else if (star)
+            {
+                pattern = star + 1;
+                name = ++retry;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (*pattern == L'*')
+            ++pattern;
+
+        return (*pattern == 0);
+    }
+
+    void SearchForFiles(const wchar_t* path, std::list<SConversion>& files, bool recursive, const wchar_t* folder)
+    {
+        const std::filesystem::path spec(path);
+        const std::wstring pattern = spec.filename().wstring();
+
+        std::filesystem::path dir = spec.parent_path();
+        if (dir.empty())
+            dir = L".";
+
+        // Directory order is unspecified, so sort to match the name order FindFirstFile gives on NTFS
+        std::list<std::wstring> matches;
+        std::list<std::wstring> subdirs;
+
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+        {
+            const std::wstring name = it->path().filename().wstring();
+            if (name.empty() || name[0] == L'.')
+                continue;
+
+            std::error_code tec;
+            if (it->is_directory(tec))
+            {
+                subdirs.push_back(name);
+            }
+            else if (it->is_regular_file(tec) && MatchWildcard(pattern.c_str(), name.c_str()))
+            {
+                matches.push_back(name);
+            }
+        }
+
+        // Process files
+        matches.sort();
+        for (const auto& name : matches)
+        {
+            SConversion conv = {};
+            wcscpy_s(conv.szSrc, (spec.parent_path() / name).wstring().c_str());
+            if (folder)
+            {
+                wcscpy_s(conv.szFolder, folder);
+            }
+            files.push_back(conv);
+        }
+
+        // Process directories
+        if (recursive)
+        {
+            subdirs.sort();
+            for (const auto& name : subdirs)
+            {
+                auto subfolder = (folder)
+                    ? (std::wstring(folder) + name + L'/')
+                    : (name + L'/');
+
+                const std::filesystem::path subdir = spec.parent_path() / name / pattern;
+                SearchForFiles(subdir.wstring().c_str(), files, recursive, subfolder.c_str());
+            }
+        }
+    }
+#endif
 
     void ProcessFileList(std::wifstream& inFile, std::list<SConversion>& files)
     {
@@ -660,7 +910,7 @@ namespace
                     if (wcspbrk(fname, L"?*") != nullptr)
                     {
                         std::list<SConversion> removeFiles;
-                        SearchForFiles(npath.c_str(), removeFiles, false, nullptr);
+                        SearchForFiles(npath.wstring().c_str(), removeFiles, false, nullptr);
 
                         for (auto& it : removeFiles)
                         {
@@ -670,7 +920,7 @@ namespace
                     }
                     else
                     {
-                        std::wstring name = npath.c_str();
+                        std::wstring name = npath.wstring();
                         std::transform(name.begin(), name.end(), name.begin(), towlower);
                         excludes.insert(name);
                     }
@@ -679,13 +929,13 @@ namespace
             else if (wcspbrk(fname, L"?*") != nullptr)
             {
                 std::filesystem::path path(fname);
-                SearchForFiles(path.make_preferred().c_str(), flist, false, nullptr);
+                SearchForFiles(path.make_preferred().wstring().c_str(), flist, false, nullptr);
             }
             else
             {
                 SConversion conv = {};
                 std::filesystem::path path(fname);
-                wcscpy_s(conv.szSrc, path.make_preferred().c_str());
+                wcscpy_s(conv.szSrc, path.make_preferred().wstring().c_str());
                 flist.push_back(conv);
             }
 
@@ -720,13 +970,79 @@ namespace
         }
     }
 
-    void PrintFormat(DXGI_FORMAT Format)
+    //--------------------------------------------------------------------------------------
+    // Per-file console output; when files are converted in parallel the text is buffered
+    // and written in one piece so the output of different files doesn't interleave
+    //--------------------------------------------------------------------------------------
+    std::mutex g_outputMutex;
+
+    class ConversionLog
+    {
+    public:
+        explicit ConversionLog(bool buffered) noexcept : m_buffered(buffered) {}
+
+        ConversionLog(const ConversionLog&) = delete;
+        ConversionLog& operator=(const ConversionLog&) = delete;
+
+        void Print(_In_z_ const wchar_t* format, ...)
+        {
+            va_list args;
+            va_start(args, format);
+
+            if (m_buffered)
+            {
+                wchar_t buffer[2048] = {};
+                if (vswprintf(buffer, std::size(buffer), format, args) < 0)
+                {
+                    // Output was truncated
+                    buffer[std::size(buffer) - 1] = 0;
+                }
+                m_text += buffer;
+            }
+            else
+            {
+                vwprintf(format, args);
+            }
+
+            va_end(args);
+        }
+
+        // Shows progress so far; buffered output waits for Commit
+        void Flush()
+        {
+            if (!m_buffered)
+                fflush(stdout);
+        }
+
+        void Commit()
+        {
+            if (!m_buffered || m_text.empty())
+                return;
+
+            std::lock_guard<std::mutex> lock(g_outputMutex);
+
+            static bool s_first = true;
+            if (!s_first)
+                wprintf(L"\n");
+            s_first = false;
+
+            wprintf(L"%ls", m_text.c_str());
+            fflush(stdout);
+            m_text.clear();
+        }
+
+    private:
+        bool            m_buffered;
+        std::wstring    m_text;
+    };
+
+    void PrintFormat(DXGI_FORMAT Format, ConversionLog& log)
     {
         for (auto pFormat = g_pFormats; pFormat->name; pFormat++)
         {
             if (static_cast<DXGI_FORMAT>(pFormat->value) == Format)
             {
-                wprintf(L"%ls", pFormat->name);
+                log.Print(L"%ls", pFormat->name);
                 return;
             }
         }
@@ -735,71 +1051,71 @@ namespace
         {
             if (static_cast<DXGI_FORMAT>(pFormat->value) == Format)
             {
-                wprintf(L"%ls", pFormat->name);
+                log.Print(L"%ls", pFormat->name);
                 return;
             }
         }
 
-        wprintf(L"*UNKNOWN*");
+        log.Print(L"*UNKNOWN*");
     }
 
-    void PrintInfo(const TexMetadata& info)
+    void PrintInfo(const TexMetadata& info, ConversionLog& log)
     {
-        wprintf(L" (%zux%zu", info.width, info.height);
+        log.Print(L" (%zux%zu", info.width, info.height);
 
         if (TEX_DIMENSION_TEXTURE3D == info.dimension)
-            wprintf(L"x%zu", info.depth);
+            log.Print(L"x%zu", info.depth);
 
         if (info.mipLevels > 1)
-            wprintf(L",%zu", info.mipLevels);
+            log.Print(L",%zu", info.mipLevels);
 
         if (info.arraySize > 1)
-            wprintf(L",%zu", info.arraySize);
+            log.Print(L",%zu", info.arraySize);
 
-        wprintf(L" ");
-        PrintFormat(info.format);
+        log.Print(L" ");
+        PrintFormat(info.format, log);
 
         switch (info.dimension)
         {
         case TEX_DIMENSION_TEXTURE1D:
-            wprintf(L"%ls", (info.arraySize > 1) ? L" 1DArray" : L" 1D");
+            log.Print(L"%ls", (info.arraySize > 1) ? L" 1DArray" : L" 1D");
             break;
 
         case TEX_DIMENSION_TEXTURE2D:
             if (info.IsCubemap())
             {
-                wprintf(L"%ls", (info.arraySize > 6) ? L" CubeArray" : L" Cube");
+                log.Print(L"%ls", (info.arraySize > 6) ? L" CubeArray" : L" Cube");
             }
             else
             {
-                wprintf(L"%ls", (info.arraySize > 1) ? L" 2DArray" : L" 2D");
+                log.Print(L"%ls", (info.arraySize > 1) ? L" 2DArray" : L" 2D");
             }
             break;
 
         case TEX_DIMENSION_TEXTURE3D:
-            wprintf(L" 3D");
+            log.Print(L" 3D");
             break;
         }
 
         switch (info.GetAlphaMode())
         {
         case TEX_ALPHA_MODE_OPAQUE:
-            wprintf(L" \x03B1:Opaque");
+            log.Print(L" \x03B1:Opaque");
             break;
         case TEX_ALPHA_MODE_PREMULTIPLIED:
-            wprintf(L" \x03B1:PM");
+            log.Print(L" \x03B1:PM");
             break;
         case TEX_ALPHA_MODE_STRAIGHT:
-            wprintf(L" \x03B1:NonPM");
+            log.Print(L" \x03B1:NonPM");
             break;
         case TEX_ALPHA_MODE_CUSTOM:
-            wprintf(L" \x03B1:Custom");
+            log.Print(L" \x03B1:Custom");
             break;
         case TEX_ALPHA_MODE_UNKNOWN:
             break;
         }
 
-        wprintf(L")");
+        log.Print(L")");
     }
 
     void PrintList(size_t cch, const SValue<uint32_t> *pValue)
@@ -826,6 +1142,7 @@ namespace
     {
         wchar_t version[32] = {};
 
+    #ifdef _WIN32
         wchar_t appName[_MAX_PATH] = {};
         if (GetModuleFileNameW(nullptr, appName, static_cast<UINT>(std::size(appName))))
         {
@@ -849,6 +1166,9 @@ namespace
         {
             swprintf_s(version, L"%03d (library)", DIRECTX_TEX_VERSION);
         }
+    #else
+        swprintf(version, std::size(version), L"%03d (library)", DIRECTX_TEX_VERSION);
+    #endif
 
         if (versionOnly)
         {
@@ -865,6 +1185,7 @@ namespace
         }
     }
 
+#ifdef _WIN32
     _Success_(return)
         bool GetDXGIFactory(_Outptr_ IDXGIFactory1** pFactory)
     {
@@ -890,6 +1211,7 @@ namespace
 
         return SUCCEEDED(s_CreateDXGIFactory1(IID_PPV_ARGS(pFactory)));
     }
+#endif
 
     void PrintUsage()
     {
@@ -906,7 +1228,7 @@ namespace
             L"   -w <n>              width\n"
             L"   -h <n>              height\n"
             L"   -m <n>              miplevels\n"
-            L"   -f <format>         format\n"
+            L"   -f <format>         format, or AUTO to pick the smallest adequate format (DDS only)\n"
             L"\n"
             L"   -if <filter>        image filtering\n"
             L"   -srgb{i|o}          sRGB {input, output}\n"
@@ -931,6 +1253,7 @@ namespace
             L"   -alpha              convert premultiplied alpha to straight alpha\n"
             L"   -at <threshold>     Alpha threshold used for BC1, RGBA5551, and WIC\n"
             L"                       (defaults to 0.5)\n"
+            L"   -autopsnr <dB>      Lowest PSNR accepted by -f AUTO (defaults to 40.0)\n"
             L"\n"
             L"   -fl <feature-level> Set maximum feature level target (defaults to 11.0)\n"
             L"   -pow2               resize to fit a power-of-2, respecting aspect ratio\n"
@@ -953,6 +1276,7 @@ namespace
             L"\n"
             L"                       (TGA output only)\n"
             L"   -tga20              Write file including TGA 2.0 extension area\n"
+            L"   -tgarle             Write RLE compressed file\n"
             L"\n"
             L"                       (BMP, PNG, JPG, TIF, WDP output only)\n"
             L"   -wicq <quality>     When writing images with WIC use quality (0.0 to 1.0)\n"
@@ -961,10 +1285,12 @@ namespace
             L"\n"
             L"   -nologo             suppress copyright message\n"
             L"   -timing             Display elapsed processing time\n"
+            L"   -timing-json <file> Write per-file and per-stage time, bytes, and peak memory\n"
             L"\n"
-        #ifdef _OPENMP
-            L"   -singleproc         Do not use multi-threaded compression\n"
-        #endif
+            L"   -singleproc         Do not use multi-threaded compression, and\n"
+            L"                       convert -r/-flist files one at a time\n"
+            L"   -cache <dir>        Reuse outputs of unchanged files from a content-addressed\n"
+            L"                       cache, and store new outputs there\n"
             L"   -gpu <adapter>      Select GPU for DirectCompute-based codecs (0 is default)\n"
             L"   -nogpu              Do not use DirectCompute-based codecs\n"
             L"\n"
@@ -1004,6 +1330,7 @@ namespace
         wprintf(L"\n   <feature-level>: ");
         PrintList(13, g_pFeatureLevels);
 
+    #ifdef _WIN32
         ComPtr<IDXGIFactory1> dxgiFactory;
         if (GetDXGIFactory(dxgiFactory.GetAddressOf()))
         {
@@ -1021,11 +1348,14 @@ namespace
                 }
             }
         }
+    #endif
     }
 
     const wchar_t* GetErrorDesc(HRESULT hr)
     {
-        static wchar_t desc[1024] = {};
+    #ifdef _WIN32
+        // Files can fail on several worker threads at once
+        thread_local wchar_t desc[1024] = {};
 
         LPWSTR errorText = nullptr;
 
@@ -1058,8 +1388,46 @@ namespace
         }
 
         return desc;
+    #else
+        // No FormatMessage here, so describe the codes the library and tool actually return
+        struct ErrorDesc
+        {
+            uint32_t        code;
+            const wchar_t*  desc;
+        };
+
+        static const ErrorDesc s_errors[] =
+        {
+            { 0x80004001, L": Not implemented" },
+            { 0x80004003, L": Invalid pointer" },
+            { 0x80004005, L": Unspecified failure" },
+            { 0x8000FFFF, L": Catastrophic failure" },
+            { 0x80070002, L": The system cannot find the file specified" },
+            { 0x80070003, L": The system cannot find the path specified" },
+            { 0x80070005, L": Access is denied" },
+            { 0x8007000D, L": The data is invalid" },
+            { 0x8007000E, L": Not enough memory resources are available" },
+            { 0x80070020, L": The file is in use by another process" },
+            { 0x80070026, L": Reached the end of the file" },
+            { 0x80070032, L": The request is not supported" },
+            { 0x80070050, L": The file exists" },
+            { 0x80070057, L": The parameter is incorrect" },
+            { 0x80070070, L": There is not enough space on the disk" },
+            { 0x800700DF, L": The file size exceeds the limit allowed" },
+            { 0x80070216, L": Arithmetic result exceeded 32 bits" },
+        };
+
+        for (const auto& it : s_errors)
+        {
+            if (it.code == static_cast<uint32_t>(hr))
+                return it.desc;
+        }
+
+        return L"";
+    #endif
     }
 
+#ifdef _WIN32
     _Success_(return)
         bool CreateDevice(int adapter, _Outptr_ ID3D11Device** pDevice)
     {
@@ -1157,6 +1525,7 @@ namespace
         else
             return false;
     }
+#endif
 
     void FitPowerOf2(size_t origx, size_t origy, _Inout_ size_t& targetx, _Inout_ size_t& targety, size_t maxsize)
     {
@@ -1286,16 +1655,100 @@ namespace
 
     inline float LinearToST2084(float normalizedLinearValue)
     {
-        const float ST2084 = pow((0.8359375f + 18.8515625f * pow(abs(normalizedLinearValue), 0.1593017578f)) / (1.0f + 18.6875f * pow(abs(normalizedLinearValue), 0.1593017578f)), 78.84375f);
+        const float ST2084 = powf((0.8359375f + 18.8515625f * powf(fabsf(normalizedLinearValue), 0.1593017578f)) / (1.0f + 18.6875f * powf(fabsf(normalizedLinearValue), 0.1593017578f)), 78.84375f);
         return ST2084;  // Don't clamp between [0..1], so we can still perform operations on scene values higher than 10,000 nits
     }
 
     inline float ST2084ToLinear(float ST2084)
     {
-        const float normalizedLinear = pow(std::max(pow(abs(ST2084), 1.0f / 78.84375f) - 0.8359375f, 0.0f) / (18.8515625f - 18.6875f * pow(abs(ST2084), 1.0f / 78.84375f)), 1.0f / 0.1593017578f);
+        const float normalizedLinear = powf(std::max(powf(fabsf(ST2084), 1.0f / 78.84375f) - 0.8359375f, 0.0f) / (18.8515625f - 18.6875f * powf(fabsf(ST2084), 1.0f / 78.84375f)), 1.0f / 0.1593017578f);
         return normalizedLinear;
     }
 
+    //--------------------------------------------------------------------------------------
+    // Queues per-pixel operations and runs them together as one TransformImage pass. Rows
+    // are processed in tiles small enough to stay in L1, with every queued operation applied
+    // to a tile before moving to the next, so any number of operations costs one read and
+    // one write of the image and a single intermediate ScratchImage.
+    //--------------------------------------------------------------------------------------
+    class PixelPipeline
+    {
+    public:
+        using Operation = std::function<void(_Inout_updates_all_(count) XMVECTOR* pixels, size_t count)>;
+
+        static constexpr size_t TILE_PIXELS = 256;
+
+        PixelPipeline() = default;
+
+        PixelPipeline(const PixelPipeline&) = delete;
+        PixelPipeline& operator=(const PixelPipeline&) = delete;
+
+        bool Empty() const noexcept { return m_ops.empty(); }
+
+        void Append(Operation op)
+        {
+            m_ops.emplace_back(std::move(op));
+        }
+
+        // Reads the image as it will look once the queued operations have run
+        HRESULT Evaluate(const ScratchImage& image,
+            std::function<void(_In_reads_(count) const XMVECTOR* pixels, size_t count)> pixelFunc) const
+        {
+            XMVECTOR tile[TILE_PIXELS];
+
+            return EvaluateImage(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+                [&](const XMVECTOR* pixels, size_t w, size_t y)
+                {
+                    UNREFERENCED_PARAMETER(y);
+
+                    if (m_ops.empty())
+                    {
+                        pixelFunc(pixels, w);
+                        return;
+                    }
+
+                    for (size_t x = 0; x < w; x += TILE_PIXELS)
+                    {
+                        const size_t count = std::min(TILE_PIXELS, w - x);
+                        memcpy(tile, pixels + x, sizeof(XMVECTOR) * count);
+                        Apply(tile, count);
+                        pixelFunc(tile, count);
+                    }
+                });
+        }
+
+        // Runs the queued operations into result and clears the queue
+        HRESULT Execute(const ScratchImage& image, ScratchImage& result)
+        {
+            const HRESULT hr = TransformImage(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+                [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                {
+                    UNREFERENCED_PARAMETER(y);
+
+                    for (size_t x = 0; x < w; x += TILE_PIXELS)
+                    {
+                        const size_t count = std::min(TILE_PIXELS, w - x);
+                        memcpy(outPixels + x, inPixels + x, sizeof(XMVECTOR) * count);
+                        Apply(outPixels + x, count);
+                    }
+                }, result);
+
+            m_ops.clear();
+            return hr;
+        }
+
+    private:
+        void Apply(XMVECTOR* pixels, size_t count) const
+        {
+            for (const auto& op : m_ops)
+            {
+                op(pixels, count);
+            }
+        }
+
+        std::vector<Operation> m_ops;
+    };
+
     bool ParseSwizzleMask(
         _In_reads_(4) const wchar_t* mask,
         _Out_writes_(4) uint32_t* swizzleElements,
@@ -1388,70 +1841,850 @@ namespace
 
         return true;
     }
-}
 
-//--------------------------------------------------------------------------------------
-// Entry-point
-//--------------------------------------------------------------------------------------
-#ifdef _PREFAST_
-#pragma prefast(disable : 28198, "Command-line tool, frees all memory on exit")
-#endif
+    //--------------------------------------------------------------------------------------
+    // Parallel file conversion
+    //--------------------------------------------------------------------------------------
+    enum CONV_RESULT
+    {
+        CONV_OK = 0,
+        CONV_FAILED,    // This file failed, continue with the next one
+        CONV_FATAL,     // Stop processing
+    };
 
-int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
-{
-    // Parameters and defaults
-    size_t width = 0;
-    size_t height = 0;
-    size_t mipLevels = 0;
-    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
-    TEX_FILTER_FLAGS dwFilter = TEX_FILTER_DEFAULT;
-    TEX_FILTER_FLAGS dwSRGB = TEX_FILTER_DEFAULT;
-    TEX_FILTER_FLAGS dwConvert = TEX_FILTER_DEFAULT;
-    TEX_COMPRESS_FLAGS dwCompress = TEX_COMPRESS_DEFAULT;
-    TEX_FILTER_FLAGS dwFilterOpts = TEX_FILTER_DEFAULT;
-    uint32_t FileType = CODEC_DDS;
-    uint32_t maxSize = 16384;
-    int adapter = -1;
-    float alphaThreshold = TEX_THRESHOLD_DEFAULT;
-    float alphaWeight = 1.f;
-    CNMAP_FLAGS dwNormalMap = CNMAP_DEFAULT;
-    float nmapAmplitude = 1.f;
-    float wicQuality = -1.f;
-    uint32_t colorKey = 0;
-    uint32_t dwRotateColor = 0;
-    float paperWhiteNits = 200.f;
-    float preserveAlphaCoverageRef = 0.0f;
-    bool keepRecursiveDirs = false;
-    uint32_t swizzleElements[4] = { 0, 1, 2, 3 };
-    uint32_t zeroElements[4] = {};
-    uint32_t oneElements[4] = {};
+    // Limits how much image memory the job queue has in flight at once; a job reserves
+    // its estimated peak before loading the source image and blocks until enough is free
+    class MemoryBudget
+    {
+    public:
+        explicit MemoryBudget(uint64_t limit) noexcept : m_limit(limit), m_inUse(0) {}
 
-    wchar_t szPrefix[MAX_PATH] = {};
-    wchar_t szSuffix[MAX_PATH] = {};
-    wchar_t szOutputDir[MAX_PATH] = {};
+        MemoryBudget(const MemoryBudget&) = delete;
+        MemoryBudget& operator=(const MemoryBudget&) = delete;
 
-    // Set locale for output since GetErrorDesc can get localized strings.
-    std::locale::global(std::locale(""));
+        uint64_t Acquire(uint64_t bytes)
+        {
+            // A job larger than the whole budget still runs, but only by itself
+            bytes = std::min(bytes, m_limit);
 
-    // Initialize COM (needed for WIC)
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-    if (FAILED(hr))
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return (m_inUse + bytes) <= m_limit; });
+            m_inUse += bytes;
+            return bytes;
+        }
+
+        void Release(uint64_t bytes)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inUse -= bytes;
+            }
+            m_cv.notify_all();
+        }
+
+    private:
+        std::mutex              m_mutex;
+        std::condition_variable m_cv;
+        uint64_t                m_limit;
+        uint64_t                m_inUse;
+    };
+
+    uint64_t GetPhysicalMemory() noexcept
     {
-        wprintf(L"Failed to initialize COM (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-        return 1;
+    #ifdef _WIN32
+        MEMORYSTATUSEX status = {};
+        status.dwLength = sizeof(status);
+        if (GlobalMemoryStatusEx(&status))
+            return status.ullTotalPhys;
+    #else
+        const long pages = sysconf(_SC_PHYS_PAGES);
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        if (pages > 0 && pageSize > 0)
+            return static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize);
+    #endif
+        return 0;
     }
 
-    // Process command line
-    uint64_t dwOptions = 0;
-    std::list<SConversion> conversion;
-    bool allowOpts = true;
-
-    for (int iArg = 1; iArg < argc; iArg++)
+    uint64_t EstimateConversionMemory(const TexMetadata& metadata) noexcept
     {
-        PWSTR pArg = argv[iArg];
+        uint64_t pixels = uint64_t(metadata.width) * uint64_t(metadata.height) * uint64_t(metadata.depth) * uint64_t(metadata.arraySize);
 
-        if (allowOpts
-            && ('-' == pArg[0]) && ('-' == pArg[1]))
+        // Allow for a full mip chain
+        pixels += pixels / 3;
+
+        // Compressed and planar sources are expanded to at least 32bpp, and the pipeline keeps
+        // the source, a working copy, and the converted or compressed result alive at once
+        const uint64_t bpp = std::max<uint64_t>(BitsPerPixel(metadata.format), 32);
+        return pixels * bpp / 8 * 3;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Streaming 64-bit xxHash, used to key the -cache content store
+    //--------------------------------------------------------------------------------------
+    class ContentHash
+    {
+    public:
+        explicit ContentHash(uint64_t seed = 0) noexcept :
+            m_acc{ seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 },
+            m_seed(seed),
+            m_total(0),
+            m_buffer{},
+            m_bufferSize(0)
+        {
+        }
+
+        void Update(_In_reads_bytes_(size) const void* data, size_t size) noexcept
+        {
+            auto p = static_cast<const uint8_t*>(data);
+            m_total += size;
+
+            if (m_bufferSize + size < sizeof(m_buffer))
+            {
+                memcpy(m_buffer + m_bufferSize, p, size);
+                m_bufferSize += size;
+                return;
+            }
+
+            if (m_bufferSize)
+            {
+                const size_t fill = sizeof(m_buffer) - m_bufferSize;
+                memcpy(m_buffer + m_bufferSize, p, fill);
+                ProcessStripe(m_buffer);
+                p += fill;
+                size -= fill;
+                m_bufferSize = 0;
+            }
+
+            for (; size >= sizeof(m_buffer); p += sizeof(m_buffer), size -= sizeof(m_buffer))
+            {
+                ProcessStripe(p);
+            }
+
+            memcpy(m_buffer, p, size);
+            m_bufferSize = size;
+        }
+
+        template<typename T>
+        void UpdateValue(const T& value) noexcept
+        {
+            Update(&value, sizeof(T));
+        }
+
+        uint64_t Finalize() const noexcept
+        {
+            uint64_t h;
+            if (m_total >= sizeof(m_buffer))
+            {
+                h = Rotl(m_acc[0], 1) + Rotl(m_acc[1], 7) + Rotl(m_acc[2], 12) + Rotl(m_acc[3], 18);
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    h = (h ^ Round(0, m_acc[j])) * PRIME1 + PRIME4;
+                }
+            }
+            else
+            {
+                h = m_seed + PRIME5;
+            }
+
+            h += m_total;
+
+            const uint8_t* p = m_buffer;
+            size_t size = m_bufferSize;
+            for (; size >= 8; p += 8, size -= 8)
+            {
+                h ^= Round(0, Read64(p));
+                h = Rotl(h, 27) * PRIME1 + PRIME4;
+            }
+
+            if (size >= 4)
+            {
+                h ^= uint64_t(Read32(p)) * PRIME1;
+                h = Rotl(h, 23) * PRIME2 + PRIME3;
+                p += 4;
+                size -= 4;
+            }
+
+            for (; size > 0; ++p, --size)
+            {
+                h ^= uint64_t(*p) * PRIME5;
+                h = Rotl(h, 11) * PRIME1;
+            }
+
+            h ^= h >> 33;
+            h *= PRIME2;
+            h ^= h >> 29;
+            h *= PRIME3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        static constexpr uint64_t PRIME1 = 11400714785074694791ULL;
+        static constexpr uint64_t PRIME2 = 14029467366897019727ULL;
+        static constexpr uint64_t PRIME3 = 1609587929392839161ULL;
+        static constexpr uint64_t PRIME4 = 9650029242287828579ULL;
+        static constexpr uint64_t PRIME5 = 2870177450012600261ULL;
+
+        static uint64_t Rotl(uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+
+        static uint64_t Round(uint64_t acc, uint64_t input) noexcept
+        {
+            acc += input * PRIME2;
+            return Rotl(acc, 31) * PRIME1;
+        }
+
+        // xxHash is defined over little-endian input
+        static uint64_t Read64(const uint8_t* p) noexcept { uint64_t v; memcpy(&v, p, sizeof(v)); return v; }
+        static uint32_t Read32(const uint8_t* p) noexcept { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+        void ProcessStripe(const uint8_t* p) noexcept
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                m_acc[j] = Round(m_acc[j], Read64(p + j * 8));
+            }
+        }
+
+        uint64_t    m_acc[4];
+        uint64_t    m_seed;
+        uint64_t    m_total;
+        uint8_t     m_buffer[32];
+        size_t      m_bufferSize;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Content-addressed store of converted files for -cache
+    //
+    //  <dir>/objects/xx/<key>.<ext>  output of a conversion, keyed by the hash of the source
+    //                                bytes and every option that affects the output
+    //  <dir>/stamps/xx/<key>         content key for a source path, size, and timestamp so
+    //                                unchanged files are not read at all
+    //--------------------------------------------------------------------------------------
+    class BuildCache
+    {
+    public:
+        BuildCache() noexcept :
+            m_optionsHash(0),
+            m_hits(0),
+            m_misses(0),
+            m_storeFailures(0)
+        {
+        }
+
+        bool Initialize(_In_z_ const wchar_t* szDir, uint64_t optionsHash, _In_z_ const wchar_t* szExt)
+        {
+            m_root = szDir;
+            m_optionsHash = optionsHash;
+            m_ext = szExt;
+
+            std::error_code ec;
+            std::filesystem::create_directories(m_root / L"objects", ec);
+            if (!ec)
+            {
+                std::filesystem::create_directories(m_root / L"stamps", ec);
+            }
+            return !ec;
+        }
+
+        // Returns false if the source can't be read, in which case the normal load reports the error
+        bool GetKey(_In_z_ const wchar_t* szSrc, uint64_t& key) const
+        {
+            key = 0;
+
+            const std::filesystem::path src(szSrc);
+
+            std::error_code ec;
+            const uintmax_t fileSize = std::filesystem::file_size(src, ec);
+            if (ec)
+                return false;
+
+            const auto fileTime = std::filesystem::last_write_time(src, ec);
+            if (ec)
+                return false;
+
+            auto absPath = std::filesystem::absolute(src, ec);
+            if (ec)
+            {
+                absPath = src;
+            }
+
+            const std::wstring name = absPath.wstring();
+
+            ContentHash stampHash(m_optionsHash);
+            stampHash.Update(name.c_str(), name.size() * sizeof(wchar_t));
+            stampHash.UpdateValue(static_cast<uint64_t>(fileSize));
+            stampHash.UpdateValue(static_cast<int64_t>(fileTime.time_since_epoch().count()));
+
+            const std::filesystem::path stamp = GetPath(L"stamps", stampHash.Finalize(), nullptr);
+            {
+                std::ifstream inFile(stamp, std::ios::in | std::ios::binary);
+                if (inFile && inFile.read(reinterpret_cast<char*>(&key), sizeof(key)) && key)
+                    return true;
+            }
+
+            // Hash the file type as well, since the same bytes load differently by extension
+            std::wstring ext = src.extension().wstring();
+            for (auto& ch : ext)
+            {
+                ch = static_cast<wchar_t>(towlower(static_cast<wint_t>(ch)));
+            }
+
+            ContentHash contentHash(m_optionsHash);
+            contentHash.Update(ext.c_str(), ext.size() * sizeof(wchar_t));
+
+            std::ifstream inFile(src, std::ios::in | std::ios::binary);
+            if (!inFile)
+                return false;
+
+            constexpr size_t c_chunkSize = 1024 * 1024;
+            std::unique_ptr<char[]> buffer(new (std::nothrow) char[c_chunkSize]);
+            if (!buffer)
+                return false;
+
+            uintmax_t bytesRead = 0;
+            while (inFile)
+            {
+                inFile.read(buffer.get(), c_chunkSize);
+                const auto count = static_cast<size_t>(inFile.gcount());
+                contentHash.Update(buffer.get(), count);
+                bytesRead += count;
+            }
+
+            if (!inFile.eof() || bytesRead != fileSize)
+                return false;
+
+            key = contentHash.Finalize();
+            if (!key)
+            {
+                // Zero marks a missing stamp
+                key = 1;
+            }
+
+            std::ignore = WriteAtomic(stamp, [&](const std::filesystem::path& temp)
+                {
+                    std::ofstream outFile(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+                    outFile.write(reinterpret_cast<const char*>(&key), sizeof(key));
+                    outFile.close();
+                    return !outFile.fail();
+                });
+
+            return true;
+        }
+
+        bool Fetch(uint64_t key, _In_z_ const wchar_t* szDest)
+        {
+            std::error_code ec;
+            if (!std::filesystem::copy_file(GetPath(L"objects", key, m_ext.c_str()), szDest,
+                std::filesystem::copy_options::overwrite_existing, ec) || ec)
+            {
+                ++m_misses;
+                return false;
+            }
+
+            ++m_hits;
+            return true;
+        }
+
+        void Store(uint64_t key, _In_z_ const wchar_t* szDest)
+        {
+            const bool stored = WriteAtomic(GetPath(L"objects", key, m_ext.c_str()), [&](const std::filesystem::path& temp)
+                {
+                    std::error_code ec;
+                    return std::filesystem::copy_file(szDest, temp, std::filesystem::copy_options::overwrite_existing, ec) && !ec;
+                });
+
+            if (!stored)
+            {
+                ++m_storeFailures;
+            }
+        }
+
+        size_t GetHits() const noexcept { return m_hits; }
+        size_t GetMisses() const noexcept { return m_misses; }
+        size_t GetStoreFailures() const noexcept { return m_storeFailures; }
+
+    private:
+        std::filesystem::path GetPath(_In_z_ const wchar_t* szKind, uint64_t key, _In_opt_z_ const wchar_t* szExt) const
+        {
+            wchar_t name[32] = {};
+            swprintf(name, std::size(name), L"%016llx", static_cast<unsigned long long>(key));
+
+            std::filesystem::path path = m_root / szKind / std::wstring(name, 2) / name;
+            if (szExt)
+            {
+                path += L".";
+                path += szExt;
+            }
+            return path;
+        }
+
+        // Writes to a private temporary then renames it into place, so concurrent jobs or
+        // processes never see a partial entry
+        template<typename Fn>
+        static bool WriteAtomic(const std::filesystem::path& target, Fn write)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(target.parent_path(), ec);
+            if (ec)
+                return false;
+
+            // Process id plus a per-process sequence number; thread id hashes repeat across processes
+        #ifdef _WIN32
+            const unsigned long pid = GetCurrentProcessId();
+        #else
+            const unsigned long pid = static_cast<unsigned long>(getpid());
+        #endif
+            static std::atomic<uint32_t> s_sequence(0);
+
+            wchar_t suffix[48] = {};
+            swprintf(suffix, std::size(suffix), L".%lx.%x.tmp", pid, s_sequence.fetch_add(1, std::memory_order_relaxed));
+
+            std::filesystem::path temp = target;
+            temp += suffix;
+
+            if (!write(temp))
+            {
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+
+            std::filesystem::rename(temp, target, ec);
+            if (ec)
+            {
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+
+            return true;
+        }
+
+        std::filesystem::path   m_root;
+        uint64_t                m_optionsHash;
+        std::wstring            m_ext;
+        std::atomic<size_t>     m_hits;
+        std::atomic<size_t>     m_misses;
+        std::atomic<size_t>     m_storeFailures;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Per-file, per-stage measurements for -timing-json
+    //--------------------------------------------------------------------------------------
+    struct StageTiming
+    {
+        const wchar_t*  name;
+        double          wallSeconds;
+        double          cpuSeconds;
+        uint64_t        bytesIn;
+        uint64_t        bytesOut;
+        uint64_t        peakBytes;
+    };
+
+    struct FileTiming
+    {
+        std::wstring                source;
+        std::wstring                dest;
+        bool                        started;
+        bool                        cached;
+        CONV_RESULT                 result;
+        double                      wallSeconds;
+        double                      cpuSeconds;
+        uint64_t                    bytesIn;
+        uint64_t                    bytesOut;
+        uint64_t                    peakBytes;
+        std::vector<StageTiming>    stages;
+    };
+
+    // CPU time of the calling thread, or of the whole process when the codecs may use other threads
+    double GetCPUSeconds(bool process) noexcept
+    {
+    #ifdef _WIN32
+        FILETIME creation, exitTime, kernel, user;
+        const BOOL result = (process)
+            ? GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)
+            : GetThreadTimes(GetCurrentThread(), &creation, &exitTime, &kernel, &user);
+        if (!result)
+            return 0.0;
+
+        const uint64_t k = (uint64_t(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+        const uint64_t u = (uint64_t(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+        return double(k + u) * 1e-7;
+    #else
+        timespec ts = {};
+        if (clock_gettime(process ? CLOCK_PROCESS_CPUTIME_ID : CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+            return 0.0;
+
+        return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+    #endif
+    }
+
+    uint64_t GetFileBytes(_In_z_ const wchar_t* szFile) noexcept
+    {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(szFile, ec);
+        return (ec) ? 0 : static_cast<uint64_t>(size);
+    }
+
+    // Splits a conversion into named stages. A stage is only recorded if it replaced the working
+    // image (or is forced, as for load and save), so options that aren't in use don't show up.
+    class StageClock
+    {
+    public:
+        StageClock(_In_opt_ FileTiming* record, BufferPool& pool, bool processCPU, bool resetPeak) noexcept :
+            m_record(record),
+            m_pool(pool),
+            m_processCPU(processCPU),
+            m_resetPeak(resetPeak),
+            m_fileWallStart{},
+            m_fileCPUStart(0),
+            m_stage(nullptr),
+            m_force(false),
+            m_image(nullptr),
+            m_bytesIn(0),
+            m_wallStart{},
+            m_cpuStart(0)
+        {
+            if (m_record)
+            {
+                m_record->started = true;
+                m_record->bytesIn = GetFileBytes(m_record->source.c_str());
+                m_fileWallStart = std::chrono::steady_clock::now();
+                m_fileCPUStart = GetCPUSeconds(m_processCPU);
+            }
+        }
+
+        StageClock(const StageClock&) = delete;
+        StageClock& operator=(const StageClock&) = delete;
+
+        ~StageClock()
+        {
+            if (!m_record)
+                return;
+
+            if (m_force)
+            {
+                End(m_image);
+            }
+
+            m_record->wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_fileWallStart).count();
+            m_record->cpuSeconds = GetCPUSeconds(m_processCPU) - m_fileCPUStart;
+            m_record->peakBytes = std::max<uint64_t>(m_record->peakBytes, m_pool.GetStats().peakBytes);
+
+            if (!m_record->dest.empty())
+            {
+                m_record->bytesOut = GetFileBytes(m_record->dest.c_str());
+            }
+        }
+
+        void Begin(_In_z_ const wchar_t* stage, _In_opt_ const ScratchImage* image, bool force = false)
+        {
+            if (!m_record)
+                return;
+
+            End(image);
+
+            if (m_resetPeak)
+            {
+                m_pool.ResetPeak();
+            }
+
+            m_stage = stage;
+            m_force = force;
+            m_image = image;
+            m_bytesIn = (image) ? image->GetPixelsSize() : m_record->bytesIn;
+            m_wallStart = std::chrono::steady_clock::now();
+            m_cpuStart = GetCPUSeconds(m_processCPU);
+        }
+
+        void End(_In_opt_ const ScratchImage* image, uint64_t bytesOut = 0)
+        {
+            if (!m_record || !m_stage)
+                return;
+
+            if (m_force || image != m_image)
+            {
+                StageTiming timing = {};
+                timing.name = m_stage;
+                timing.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_wallStart).count();
+                timing.cpuSeconds = GetCPUSeconds(m_processCPU) - m_cpuStart;
+                timing.bytesIn = m_bytesIn;
+                timing.bytesOut = (bytesOut) ? bytesOut : ((image) ? image->GetPixelsSize() : 0);
+                timing.peakBytes = m_pool.GetStats().peakBytes;
+                m_record->stages.push_back(timing);
+
+                m_record->peakBytes = std::max(m_record->peakBytes, timing.peakBytes);
+            }
+
+            m_stage = nullptr;
+        }
+
+        void SetCached() noexcept { if (m_record) m_record->cached = true; }
+        void SetDest(_In_z_ const wchar_t* szDest) { if (m_record) m_record->dest = szDest; }
+
+    private:
+        FileTiming*                             m_record;
+        BufferPool&                             m_pool;
+        bool                                    m_processCPU;
+        bool                                    m_resetPeak;
+        std::chrono::steady_clock::time_point   m_fileWallStart;
+        double                                  m_fileCPUStart;
+        const wchar_t*                          m_stage;
+        bool                                    m_force;
+        const ScratchImage*                     m_image;
+        uint64_t                                m_bytesIn;
+        std::chrono::steady_clock::time_point   m_wallStart;
+        double                                  m_cpuStart;
+    };
+
+    void AppendJSONString(std::string& out, const std::wstring& value)
+    {
+        out += '"';
+
+        for (size_t j = 0; j < value.size(); ++j)
+        {
+            uint32_t ch = static_cast<uint32_t>(value[j]);
+
+        #if WCHAR_MAX <= 0xFFFF
+            if (ch >= 0xD800 && ch <= 0xDBFF && (j + 1) < value.size())
+            {
+                const auto low = static_cast<uint32_t>(value[j + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    ch = 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+                    ++j;
+                }
+            }
+        #endif
+
+            switch (ch)
+            {
+            case '"':  out += "\\\""; continue;
+            case '\\': out += "\\\\"; continue;
+            case '\n': out += "\\n"; continue;
+            case '\r': out += "\\r"; continue;
+            case '\t': out += "\\t"; continue;
+            default: break;
+            }
+
+            if (ch < 0x20)
+            {
+                char buff[8] = {};
+                snprintf(buff, sizeof(buff), "\\u%04x", ch);
+                out += buff;
+            }
+            else if (ch < 0x80)
+            {
+                out += static_cast<char>(ch);
+            }
+            else if (ch < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (ch >> 6));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+            else if (ch < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (ch >> 12));
+                out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (ch >> 18));
+                out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+        }
+
+        out += '"';
+    }
+
+    void AppendJSONMeasurements(std::string& out, const char* indent,
+        double wallSeconds, double cpuSeconds, uint64_t bytesIn, uint64_t bytesOut, uint64_t peakBytes)
+    {
+        char buff[512] = {};
+        snprintf(buff, sizeof(buff),
+            "%s\"wallSeconds\": %.6f,\n"
+            "%s\"cpuSeconds\": %.6f,\n"
+            "%s\"bytesIn\": %llu,\n"
+            "%s\"bytesOut\": %llu,\n"
+            "%s\"peakBytes\": %llu",
+            indent, wallSeconds,
+            indent, cpuSeconds,
+            indent, static_cast<unsigned long long>(bytesIn),
+            indent, static_cast<unsigned long long>(bytesOut),
+            indent, static_cast<unsigned long long>(peakBytes));
+        out += buff;
+    }
+
+    HRESULT WriteTimingReport(_In_z_ const wchar_t* szFile, const std::vector<FileTiming>& files,
+        double totalSeconds, bool parallel, bool processCPU)
+    {
+        std::string out;
+        out.reserve(1024 + files.size() * 2048);
+
+        char buff[256] = {};
+        snprintf(buff, sizeof(buff),
+            "{\n"
+            "  \"version\": 1,\n"
+            "  \"texVersion\": %d,\n"
+            "  \"parallel\": %s,\n"
+            "  \"cpuClock\": \"%s\",\n"
+            "  \"totalWallSeconds\": %.6f,\n"
+            "  \"files\": [",
+            DIRECTX_TEX_VERSION,
+            parallel ? "true" : "false",
+            processCPU ? "process" : "thread",
+            totalSeconds);
+        out += buff;
+
+        for (size_t j = 0; j < files.size(); ++j)
+        {
+            const FileTiming& file = files[j];
+
+            const char* status = "skipped";
+            if (file.started)
+            {
+                switch (file.result)
+                {
+                case CONV_OK:       status = "ok"; break;
+                case CONV_FAILED:   status = "failed"; break;
+                default:            status = "fatal"; break;
+                }
+            }
+
+            out += (j > 0) ? ",\n    {\n" : "\n    {\n";
+            out += "      \"source\": ";
+            AppendJSONString(out, file.source);
+            out += ",\n      \"dest\": ";
+            AppendJSONString(out, file.dest);
+            out += ",\n      \"status\": \"";
+            out += status;
+            out += "\",\n      \"cached\": ";
+            out += (file.cached) ? "true" : "false";
+            out += ",\n";
+            AppendJSONMeasurements(out, "      ", file.wallSeconds, file.cpuSeconds, file.bytesIn, file.bytesOut, file.peakBytes);
+            out += ",\n      \"stages\": [";
+
+            for (size_t k = 0; k < file.stages.size(); ++k)
+            {
+                const StageTiming& stage = file.stages[k];
+
+                out += (k > 0) ? ",\n        {\n" : "\n        {\n";
+                out += "          \"name\": ";
+                AppendJSONString(out, stage.name);
+                out += ",\n";
+                AppendJSONMeasurements(out, "          ", stage.wallSeconds, stage.cpuSeconds, stage.bytesIn, stage.bytesOut, stage.peakBytes);
+                out += "\n        }";
+            }
+
+            out += (file.stages.empty()) ? "]\n    }" : "\n      ]\n    }";
+        }
+
+        out += (files.empty()) ? "]\n}\n" : "\n  ]\n}\n";
+
+        std::ofstream outFile(std::filesystem::path(szFile), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outFile)
+            return E_ACCESSDENIED;
+
+        outFile.write(out.data(), static_cast<std::streamsize>(out.size()));
+        outFile.close();
+        return (outFile.fail()) ? E_FAIL : S_OK;
+    }
+
+    // Installs an allocator as the library default for the lifetime of this object, so the
+    // default never outlives an allocator that lives on the stack
+    class DefaultAllocatorScope
+    {
+    public:
+        explicit DefaultAllocatorScope(_In_ IAllocator* allocator) noexcept { SetDefaultAllocator(allocator); }
+        ~DefaultAllocatorScope() { SetDefaultAllocator(nullptr); }
+
+        DefaultAllocatorScope(const DefaultAllocatorScope&) = delete;
+        DefaultAllocatorScope& operator=(const DefaultAllocatorScope&) = delete;
+    };
+}
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+#ifdef _PREFAST_
+#pragma prefast(disable : 28198, "Command-line tool, frees all memory on exit")
+#endif
+
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+{
+    // Parameters and defaults
+    size_t width = 0;
+    size_t height = 0;
+    size_t mipLevels = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    bool autoFormat = false;
+    float autoPSNR = 40.f;
+    TEX_FILTER_FLAGS dwFilter = TEX_FILTER_DEFAULT;
+    TEX_FILTER_FLAGS dwSRGB = TEX_FILTER_DEFAULT;
+    TEX_FILTER_FLAGS dwConvert = TEX_FILTER_DEFAULT;
+    TEX_COMPRESS_FLAGS dwCompress = TEX_COMPRESS_DEFAULT;
+    TEX_FILTER_FLAGS dwFilterOpts = TEX_FILTER_DEFAULT;
+    uint32_t FileType = CODEC_DDS;
+    uint32_t maxSize = 16384;
+    int adapter = -1;
+    float alphaThreshold = TEX_THRESHOLD_DEFAULT;
+    float alphaWeight = 1.f;
+    CNMAP_FLAGS dwNormalMap = CNMAP_DEFAULT;
+    float nmapAmplitude = 1.f;
+    float wicQuality = -1.f;
+    uint32_t colorKey = 0;
+    uint32_t dwRotateColor = 0;
+    float paperWhiteNits = 200.f;
+    float preserveAlphaCoverageRef = 0.0f;
+    bool keepRecursiveDirs = false;
+    uint32_t swizzleElements[4] = { 0, 1, 2, 3 };
+    uint32_t zeroElements[4] = {};
+    uint32_t oneElements[4] = {};
+
+    wchar_t szPrefix[MAX_PATH] = {};
+    wchar_t szSuffix[MAX_PATH] = {};
+    wchar_t szOutputDir[MAX_PATH] = {};
+    wchar_t szCacheDir[MAX_PATH] = {};
+    wchar_t szTimingFile[MAX_PATH] = {};
+
+    // Set locale for output since GetErrorDesc can get localized strings.
+    std::locale::global(std::locale(""));
+
+#ifdef _WIN32
+    // Initialize COM (needed for WIC)
+    {
+        const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        if (FAILED(hr))
+        {
+            wprintf(L"Failed to initialize COM (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+            return 1;
+        }
+    }
+#endif
+
+    // Recycle image buffers from one file to the next instead of returning them to the OS each time
+    BufferPool bufferPool;
+    const DefaultAllocatorScope defaultAllocator(&bufferPool);
+
+    // Process command line
+    uint64_t dwOptions = 0;
+    std::list<SConversion> conversion;
+    bool allowOpts = true;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        wchar_t* pArg = argv[iArg];
+
+    #ifdef _WIN32
+        const bool isOption = ('-' == pArg[0]) || ('/' == pArg[0]);
+    #else
+        // Absolute paths start with '/', so only '-' introduces an option
+        const bool isOption = ('-' == pArg[0]);
+    #endif
+
+        if (allowOpts
+            && ('-' == pArg[0]) && ('-' == pArg[1]))
         {
             if (pArg[2] == 0)
             {
@@ -1474,11 +2707,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 return 1;
             }
         }
-        else if (allowOpts
-            && (('-' == pArg[0]) || ('/' == pArg[0])))
+        else if (allowOpts && isOption)
         {
             pArg++;
-            PWSTR pValue;
+            wchar_t* pValue;
 
             for (pValue = pArg; *pValue && (':' != *pValue); pValue++);
 
@@ -1521,6 +2753,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_PAPER_WHITE_NITS:
             case OPT_PRESERVE_ALPHA_COVERAGE:
             case OPT_SWIZZLE:
+            case OPT_CACHE:
+            case OPT_TIMING_JSON:
+            case OPT_AUTO_PSNR:
                 // These support either "-arg:value" or "-arg value"
                 if (!*pValue)
                 {
@@ -1569,6 +2804,13 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 break;
 
             case OPT_FORMAT:
+                autoFormat = (_wcsicmp(pValue, L"AUTO") == 0);
+                if (autoFormat)
+                {
+                    format = DXGI_FORMAT_UNKNOWN;
+                    break;
+                }
+
                 format = static_cast<DXGI_FORMAT>(LookupByName(pValue, g_pFormats));
                 if (!format)
                 {
@@ -1636,7 +2878,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_OUTPUTDIR:
                 {
                     std::filesystem::path path(pValue);
-                    wcscpy_s(szOutputDir, path.make_preferred().c_str());
+                    wcscpy_s(szOutputDir, path.make_preferred().wstring().c_str());
+                }
+                break;
+
+            case OPT_CACHE:
+                {
+                    std::filesystem::path path(pValue);
+                    wcscpy_s(szCacheDir, path.make_preferred().wstring().c_str());
+                }
+                break;
+
+            case OPT_TIMING_JSON:
+                {
+                    std::filesystem::path path(pValue);
+                    wcscpy_s(szTimingFile, path.make_preferred().wstring().c_str());
                 }
                 break;
 
@@ -1934,7 +3190,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_FILELIST:
                 {
                     std::filesystem::path path(pValue);
-                    std::wifstream inFile(path.make_preferred().c_str());
+                    std::wifstream inFile(path.make_preferred());
                     if (!inFile)
                     {
                         wprintf(L"Error opening -flist file %ls\n", pValue);
@@ -1961,6 +3217,20 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
                 break;
 
+            case OPT_AUTO_PSNR:
+                if (swscanf_s(pValue, L"%f", &autoPSNR) != 1)
+                {
+                    wprintf(L"Invalid value specified with -autopsnr (%ls)\n\n", pValue);
+                    PrintUsage();
+                    return 1;
+                }
+                else if (autoPSNR <= 0.f)
+                {
+                    wprintf(L"-autopsnr (%ls) parameter must be greater than 0\n\n", pValue);
+                    return 1;
+                }
+                break;
+
             case OPT_PRESERVE_ALPHA_COVERAGE:
                 if (swscanf_s(pValue, L"%f", &preserveAlphaCoverageRef) != 1)
                 {
@@ -1994,7 +3264,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         {
             const size_t count = conversion.size();
             std::filesystem::path path(pArg);
-            SearchForFiles(path.make_preferred().c_str(), conversion, (dwOptions & (uint64_t(1) << OPT_RECURSIVE)) != 0, nullptr);
+            SearchForFiles(path.make_preferred().wstring().c_str(), conversion, (dwOptions & (uint64_t(1) << OPT_RECURSIVE)) != 0, nullptr);
             if (conversion.size() <= count)
             {
                 wprintf(L"No matching files found for %ls\n", pArg);
@@ -2005,7 +3275,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         {
             SConversion conv = {};
             std::filesystem::path path(pArg);
-            wcscpy_s(conv.szSrc, path.make_preferred().c_str());
+            wcscpy_s(conv.szSrc, path.make_preferred().wstring().c_str());
             conversion.push_back(conv);
         }
     }
@@ -2016,6 +3286,18 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         return 0;
     }
 
+    if (autoFormat && (dwOptions & (uint64_t(1) << OPT_NORMAL_MAP)))
+    {
+        wprintf(L"-f AUTO cannot be combined with -nmap, specify the normal map format instead\n");
+        return 1;
+    }
+
+    if (autoFormat && FileType != CODEC_DDS)
+    {
+        wprintf(L"-f AUTO requires DDS output (-ft dds), as other file types can't store the BC formats it selects\n");
+        return 1;
+    }
+
     if (~dwOptions & (uint64_t(1) << OPT_NOLOGO))
         PrintLogo(false);
 
@@ -2026,46 +3308,224 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         wcscat_s(szOutputDir, MAX_PATH, pSeparator);
     }
 
-    auto fileTypeName = LookupByValue(FileType, g_pSaveFileTypes);
+    auto fileTypeName = LookupByValue(FileType, g_pSaveFileTypes);
+
+    if (fileTypeName)
+    {
+        wcscat_s(szSuffix, MAX_PATH, L".");
+        wcscat_s(szSuffix, MAX_PATH, fileTypeName);
+    }
+    else
+    {
+        wcscat_s(szSuffix, MAX_PATH, L".unknown");
+    }
+
+    if (FileType != CODEC_DDS)
+    {
+        mipLevels = 1;
+    }
+
+    // The cache key covers every setting that can change the output; naming and
+    // reporting options are left out so they don't invalidate it
+    BuildCache cache;
+    const bool useCache = (dwOptions & (uint64_t(1) << OPT_CACHE)) != 0;
+    if (useCache)
+    {
+        constexpr uint64_t c_cacheIgnoredOptions =
+            (uint64_t(1) << OPT_RECURSIVE)
+            | (uint64_t(1) << OPT_FILELIST)
+            | (uint64_t(1) << OPT_PREFIX)
+            | (uint64_t(1) << OPT_SUFFIX)
+            | (uint64_t(1) << OPT_OUTPUTDIR)
+            | (uint64_t(1) << OPT_TOLOWER)
+            | (uint64_t(1) << OPT_OVERWRITE)
+            | (uint64_t(1) << OPT_NOLOGO)
+            | (uint64_t(1) << OPT_TIMING)
+            | (uint64_t(1) << OPT_TIMING_JSON)
+            | (uint64_t(1) << OPT_FORCE_SINGLEPROC)
+            | (uint64_t(1) << OPT_CACHE);
+
+        ContentHash optionsHash;
+        optionsHash.UpdateValue(static_cast<uint32_t>(DIRECTX_TEX_VERSION));
+        optionsHash.UpdateValue(dwOptions & ~c_cacheIgnoredOptions);
+        optionsHash.UpdateValue(static_cast<uint64_t>(width));
+        optionsHash.UpdateValue(static_cast<uint64_t>(height));
+        optionsHash.UpdateValue(static_cast<uint64_t>(mipLevels));
+        optionsHash.UpdateValue(format);
+        optionsHash.UpdateValue(autoFormat);
+        optionsHash.UpdateValue(autoPSNR);
+        optionsHash.UpdateValue(dwFilter);
+        optionsHash.UpdateValue(dwSRGB);
+        optionsHash.UpdateValue(dwConvert);
+        optionsHash.UpdateValue(dwCompress);
+        optionsHash.UpdateValue(dwFilterOpts);
+        optionsHash.UpdateValue(FileType);
+        optionsHash.UpdateValue(maxSize);
+        optionsHash.UpdateValue(adapter);
+        optionsHash.UpdateValue(alphaThreshold);
+        optionsHash.UpdateValue(alphaWeight);
+        optionsHash.UpdateValue(dwNormalMap);
+        optionsHash.UpdateValue(nmapAmplitude);
+        optionsHash.UpdateValue(wicQuality);
+        optionsHash.UpdateValue(colorKey);
+        optionsHash.UpdateValue(dwRotateColor);
+        optionsHash.UpdateValue(paperWhiteNits);
+        optionsHash.UpdateValue(preserveAlphaCoverageRef);
+        optionsHash.UpdateValue(swizzleElements);
+        optionsHash.UpdateValue(zeroElements);
+        optionsHash.UpdateValue(oneElements);
+
+        if (!cache.Initialize(szCacheDir, optionsHash.Finalize(), fileTypeName ? fileTypeName : L"unknown"))
+        {
+            wprintf(L"ERROR: Failed to create -cache directory %ls\n", szCacheDir);
+            return 1;
+        }
+    }
+
+    const auto tStart = std::chrono::steady_clock::now();
+
+    // Convert images
+    std::atomic<bool> sizewarn(false);
+    std::atomic<bool> nonpow2warn(false);
+    std::atomic<bool> non4bc(false);
+
+    // -r and -flist usually produce many files, so convert several at once unless -singleproc is used
+    const bool parallelJobs = (dwOptions & ((uint64_t(1) << OPT_RECURSIVE) | (uint64_t(1) << OPT_FILELIST)))
+        && !(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC))
+        && (conversion.size() > 1)
+        && (std::thread::hardware_concurrency() > 1);
+
+#ifdef _WIN32
+    // The DirectCompute codec uses the device's immediate context, which is single-threaded
+    std::mutex deviceMutex;
+    ComPtr<ID3D11Device> pDevice;
+#endif
+
+    // Figure out dest filename
+    auto getDestination = [&](const SConversion* pConv, wchar_t (&szDest)[1024], ConversionLog& log) -> bool
+    {
+        wchar_t *pchSlash, *pchDot;
+
+        wcscpy_s(szDest, szOutputDir);
+
+        if (keepRecursiveDirs && *pConv->szFolder)
+        {
+            wcscat_s(szDest, pConv->szFolder);
+
+        #ifdef _WIN32
+            wchar_t szPath[MAX_PATH] = {};
+            if (!GetFullPathNameW(szDest, MAX_PATH, szPath, nullptr))
+            {
+                log.Print(L" get full path FAILED (%08X%ls)\n",
+                    static_cast<unsigned int>(HRESULT_FROM_WIN32(GetLastError())), GetErrorDesc(HRESULT_FROM_WIN32(GetLastError())));
+                return false;
+            }
+
+            auto const err = static_cast<DWORD>(SHCreateDirectoryExW(nullptr, szPath, nullptr));
+            if (err != ERROR_SUCCESS && err != ERROR_ALREADY_EXISTS)
+            {
+                log.Print(L" directory creation FAILED (%08X%ls)\n",
+                    static_cast<unsigned int>(HRESULT_FROM_WIN32(err)), GetErrorDesc(HRESULT_FROM_WIN32(err)));
+                return false;
+            }
+        #else
+            std::error_code ec;
+            std::filesystem::create_directories(szDest, ec);
+            if (ec)
+            {
+                log.Print(L" directory creation FAILED (%d)\n", ec.value());
+                return false;
+            }
+        #endif
+        }
+
+        if (*szPrefix)
+            wcscat_s(szDest, szPrefix);
+
+        pchSlash = wcsrchr(pConv->szSrc, std::filesystem::path::preferred_separator);
+        if (pchSlash)
+            wcscat_s(szDest, pchSlash + 1);
+        else
+            wcscat_s(szDest, pConv->szSrc);
+
+        pchSlash = wcsrchr(szDest, std::filesystem::path::preferred_separator);
+        pchDot = wcsrchr(szDest, '.');
+
+        if (pchDot > pchSlash)
+            *pchDot = 0;
+
+        if (*szSuffix)
+            wcscat_s(szDest, szSuffix);
+
+        if (dwOptions & (uint64_t(1) << OPT_TOLOWER))
+        {
+            std::ignore = _wcslwr_s(szDest);
+        }
+
+        if (wcslen(szDest) > _MAX_PATH)
+        {
+            log.Print(L"\nERROR: Output filename exceeds max-path, skipping!\n");
+            return false;
+        }
+
+        return true;
+    };
 
-    if (fileTypeName)
-    {
-        wcscat_s(szSuffix, MAX_PATH, L".");
-        wcscat_s(szSuffix, MAX_PATH, fileTypeName);
-    }
-    else
+    auto canWrite = [&](const wchar_t* szDest, ConversionLog& log) -> bool
     {
-        wcscat_s(szSuffix, MAX_PATH, L".unknown");
-    }
+        if (~dwOptions & (uint64_t(1) << OPT_OVERWRITE))
+        {
+        #ifdef _WIN32
+            if (GetFileAttributesW(szDest) != INVALID_FILE_ATTRIBUTES)
+        #else
+            std::error_code ec;
+            if (std::filesystem::exists(szDest, ec))
+        #endif
+            {
+                log.Print(L"\nERROR: Output file already exists, use -y to overwrite:\n");
+                return false;
+            }
+        }
 
-    if (FileType != CODEC_DDS)
+        return true;
+    };
+
+    // With one file at a time the codecs may run on other threads, so measure process CPU time
+    // and reset the pool's high-water mark per stage; parallel jobs share both
+    auto processFile = [&](const SConversion* pConv, ConversionLog& log, FileTiming* timing) -> CONV_RESULT
     {
-        mipLevels = 1;
-    }
+        HRESULT hr = S_OK;
 
-    LARGE_INTEGER qpcFreq = {};
-    std::ignore = QueryPerformanceFrequency(&qpcFreq);
+        StageClock stageClock(timing, bufferPool, !parallelJobs, !parallelJobs);
 
-    LARGE_INTEGER qpcStart = {};
-    std::ignore = QueryPerformanceCounter(&qpcStart);
+        // --- Load source image -------------------------------------------------------
+        log.Print(L"reading %ls", pConv->szSrc);
+        log.Flush();
 
-    // Convert images
-    bool sizewarn = false;
-    bool nonpow2warn = false;
-    bool non4bc = false;
-    bool preserveAlphaCoverage = false;
-    ComPtr<ID3D11Device> pDevice;
+        // --- Look for a previous conversion of the same content ----------------------
+        uint64_t cacheKey = 0;
+        if (useCache)
+        {
+            stageClock.Begin(L"cache", nullptr, true);
+        }
 
-    int retVal = 0;
+        if (useCache && cache.GetKey(pConv->szSrc, cacheKey))
+        {
+            wchar_t szDest[1024] = {};
+            if (!getDestination(pConv, szDest, log))
+                return CONV_FAILED;
 
-    for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv)
-    {
-        if (pConv != conversion.begin())
-            wprintf(L"\n");
+            if (!canWrite(szDest, log))
+                return CONV_FAILED;
 
-        // --- Load source image -------------------------------------------------------
-        wprintf(L"reading %ls", pConv->szSrc);
-        fflush(stdout);
+            if (cache.Fetch(cacheKey, szDest))
+            {
+                stageClock.SetCached();
+                stageClock.SetDest(szDest);
+                log.Print(L" (cached)\nwriting %ls\n", szDest);
+                return CONV_OK;
+            }
+        }
 
         wchar_t ext[_MAX_EXT] = {};
         wchar_t fname[_MAX_FNAME] = {};
@@ -2076,10 +3536,12 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
         if (!image)
         {
-            wprintf(L"\nERROR: Memory allocation failed\n");
-            return 1;
+            log.Print(L"\nERROR: Memory allocation failed\n");
+            return CONV_FATAL;
         }
 
+        stageClock.Begin(L"load", nullptr, true);
+
         if (_wcsicmp(ext, L".dds") == 0)
         {
             DDS_FLAGS ddsFlags = DDS_FLAGS_ALLOW_LARGE_FILES;
@@ -2093,9 +3555,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromDDSFile(pConv->szSrc, ddsFlags, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
 
             if (IsTypeless(info.format))
@@ -2111,24 +3572,24 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                 if (IsTypeless(info.format))
                 {
-                    wprintf(L" FAILED due to Typeless format %d\n", info.format);
-                    retVal = 1;
-                    continue;
+                    log.Print(L" FAILED due to Typeless format %d\n", info.format);
+                    return CONV_FAILED;
                 }
 
                 image->OverrideFormat(info.format);
             }
         }
+    #ifdef _WIN32
         else if (_wcsicmp(ext, L".bmp") == 0)
         {
             hr = LoadFromBMPEx(pConv->szSrc, WIC_FLAGS_NONE | dwFilter, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
         }
+    #endif
         else if (_wcsicmp(ext, L".tga") == 0)
         {
             TGA_FLAGS tgaFlags = (IsBGR(format)) ? TGA_FLAGS_BGR : TGA_FLAGS_NONE;
@@ -2136,9 +3597,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromTGAFile(pConv->szSrc, tgaFlags, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
         }
         else if (_wcsicmp(ext, L".hdr") == 0)
@@ -2146,19 +3606,18 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromHDRFile(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
         }
+    #ifdef _WIN32
         else if (_wcsicmp(ext, L".ppm") == 0)
         {
             hr = LoadFromPortablePixMap(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
         }
         else if (_wcsicmp(ext, L".pfm") == 0)
@@ -2166,23 +3625,23 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromPortablePixMapHDR(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
         }
+    #endif
     #ifdef USE_OPENEXR
         else if (_wcsicmp(ext, L".exr") == 0)
         {
             hr = LoadFromEXRFile(pConv->szSrc, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
         }
     #endif
+    #ifdef _WIN32
         else
         {
             // WIC shares the same filter values for mode and dither
@@ -2200,32 +3659,40 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = LoadFromWICFile(pConv->szSrc, wicFlags, &info, *image);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
                 if (hr == static_cast<HRESULT>(0xc00d5212) /* MF_E_TOPO_CODEC_NOT_FOUND */)
                 {
                     if (_wcsicmp(ext, L".heic") == 0 || _wcsicmp(ext, L".heif") == 0)
                     {
-                        wprintf(L"INFO: This format requires installing the HEIF Image Extensions - https://aka.ms/heif\n");
+                        log.Print(L"INFO: This format requires installing the HEIF Image Extensions - https://aka.ms/heif\n");
                     }
                     else if (_wcsicmp(ext, L".webp") == 0)
                     {
-                        wprintf(L"INFO: This format requires installing the WEBP Image Extensions - https://www.microsoft.com/p/webp-image-extensions/9pg2dk419drg\n");
+                        log.Print(L"INFO: This format requires installing the WEBP Image Extensions - https://www.microsoft.com/p/webp-image-extensions/9pg2dk419drg\n");
                     }
                 }
-                continue;
+                return CONV_FAILED;
             }
         }
+    #else
+        else
+        {
+            // WIC, BMP, and PPM/PFM readers are Windows-only
+            log.Print(L" FAILED (unsupported file type)\n");
+            return CONV_FAILED;
+        }
+    #endif
 
-        PrintInfo(info);
+        PrintInfo(info, log);
 
         size_t tMips = (!mipLevels && info.mipLevels > 1) ? info.mipLevels : mipLevels;
 
         // Convert texture
-        wprintf(L" as");
-        fflush(stdout);
+        log.Print(L" as");
+        log.Flush();
 
         // --- Planar ------------------------------------------------------------------
+        stageClock.Begin(L"planar", image.get());
         if (IsPlanar(info.format))
         {
             auto img = image->GetImage(0, 0, 0);
@@ -2235,17 +3702,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             hr = ConvertToSinglePlane(img, nimg, info, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [converttosingleplane] (%08X%ls)\n",
+                log.Print(L" FAILED [converttosingleplane] (%08X%ls)\n",
                     static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                return CONV_FAILED;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2263,9 +3729,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             image.swap(timage);
         }
 
-        const DXGI_FORMAT tformat = (format == DXGI_FORMAT_UNKNOWN) ? info.format : format;
+        DXGI_FORMAT tformat = (format == DXGI_FORMAT_UNKNOWN) ? info.format : format;
 
         // --- Decompress --------------------------------------------------------------
+        stageClock.Begin(L"decompress", image.get());
         std::unique_ptr<ScratchImage> cimage;
         if (IsCompressed(info.format))
         {
@@ -2277,8 +3744,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                     if (!timage)
                     {
-                        wprintf(L"\nERROR: Memory allocation failed\n");
-                        return 1;
+                        log.Print(L"\nERROR: Memory allocation failed\n");
+                        return CONV_FATAL;
                     }
 
                     // If we started with < 4x4 then no need to generate mips
@@ -2295,9 +3762,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     hr = timage->Initialize(mdata);
                     if (FAILED(hr))
                     {
-                        wprintf(L" FAILED [BC non-multiple-of-4 fixup] (%08X%ls)\n",
+                        log.Print(L" FAILED [BC non-multiple-of-4 fixup] (%08X%ls)\n",
                             static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                        return 1;
+                        return CONV_FATAL;
                     }
 
                     if (mdata.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -2339,16 +3806,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             hr = Decompress(img, nimg, info, DXGI_FORMAT_UNKNOWN /* picks good default */, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [decompress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
-                continue;
+                log.Print(L" FAILED [decompress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2376,17 +3842,18 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Undo Premultiplied Alpha (if requested) ---------------------------------
+        stageClock.Begin(L"demultiply", image.get());
         if ((dwOptions & (uint64_t(1) << OPT_DEMUL_ALPHA))
             && HasAlpha(info.format)
             && info.format != DXGI_FORMAT_A8_UNORM)
         {
             if (info.GetAlphaMode() == TEX_ALPHA_MODE_STRAIGHT)
             {
-                printf("\nWARNING: Image is already using straight alpha\n");
+                log.Print(L"\nWARNING: Image is already using straight alpha\n");
             }
             else if (!info.IsPMAlpha())
             {
-                printf("\nWARNING: Image is not using premultipled alpha\n");
+                log.Print(L"\nWARNING: Image is not using premultipled alpha\n");
             }
             else
             {
@@ -2397,17 +3864,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    log.Print(L"\nERROR: Memory allocation failed\n");
+                    return CONV_FATAL;
                 }
 
                 hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_REVERSE | dwSRGB, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [demultiply alpha] (%08X%ls)\n",
+                    log.Print(L" FAILED [demultiply alpha] (%08X%ls)\n",
                         static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    retVal = 1;
-                    continue;
+                    return CONV_FAILED;
                 }
 
                 auto& tinfo = timage->GetMetadata();
@@ -2427,13 +3893,14 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Flip/Rotate -------------------------------------------------------------
+        stageClock.Begin(L"fliprotate", image.get());
         if (dwOptions & ((uint64_t(1) << OPT_HFLIP) | (uint64_t(1) << OPT_VFLIP)))
         {
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             TEX_FR_FLAGS dwFlags = TEX_FR_ROTATE0;
@@ -2449,8 +3916,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = FlipRotate(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwFlags, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [fliprotate] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [fliprotate] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2470,6 +3937,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Resize ------------------------------------------------------------------
+        stageClock.Begin(L"resize", image.get());
         size_t twidth = (!width) ? info.width : width;
         if (twidth > maxSize)
         {
@@ -2498,15 +3966,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             hr = Resize(image->GetImages(), image->GetImageCount(), image->GetMetadata(), twidth, theight, dwFilter | dwFilterOpts, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [resize] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [resize] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2539,6 +4007,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Swizzle (if requested) --------------------------------------------------
+        stageClock.Begin(L"swizzle", image.get());
         if (swizzleElements[0] != 0 || swizzleElements[1] != 1 || swizzleElements[2] != 2 || swizzleElements[3] != 3
             || zeroElements[0] != 0 || zeroElements[1] != 0 || zeroElements[2] != 0 || zeroElements[3] != 0
             || oneElements[0] != 0 || oneElements[1] != 0 || oneElements[2] != 0 || oneElements[3] != 0)
@@ -2546,30 +4015,23 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
-            const XMVECTOR zc = XMVectorSelectControl(zeroElements[0], zeroElements[1], zeroElements[2], zeroElements[3]);
-            const XMVECTOR oc = XMVectorSelectControl(oneElements[0], oneElements[1], oneElements[2], oneElements[3]);
-
-            hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                [&, zc, oc](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
-                {
-                    UNREFERENCED_PARAMETER(y);
+            uint32_t channels[4] = {};
+            for (size_t k = 0; k < 4; ++k)
+            {
+                channels[k] = (zeroElements[k]) ? uint32_t(TEX_SWIZZLE_ZERO)
+                    : (oneElements[k]) ? uint32_t(TEX_SWIZZLE_ONE)
+                    : swizzleElements[k];
+            }
 
-                    for (size_t j = 0; j < w; ++j)
-                    {
-                        XMVECTOR pixel = XMVectorSwizzle(inPixels[j],
-                            swizzleElements[0], swizzleElements[1], swizzleElements[2], swizzleElements[3]);
-                        pixel = XMVectorSelect(pixel, g_XMZero, zc);
-                        outPixels[j] = XMVectorSelect(pixel, g_XMOne, oc);
-                    }
-                }, *timage);
+            hr = SwizzleChannels(image->GetImages(), image->GetImageCount(), image->GetMetadata(), channels, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [swizzle] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [swizzle] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
         #ifndef NDEBUG
@@ -2589,7 +4051,52 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             cimage.reset();
         }
 
+        // --- Per-pixel operations ----------------------------------------------------
+        // Color rotation, tonemap, colorkey, inverty, and reconstructz are queued and run as a
+        // single fused pass when a later stage needs the pixels
+        PixelPipeline pixelOps;
+
+        auto applyPixelOps = [&]() -> bool
+        {
+            if (pixelOps.Empty())
+                return true;
+
+            stageClock.Begin(L"pixelops", image.get());
+
+            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
+            if (!timage)
+            {
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return false;
+            }
+
+            hr = pixelOps.Execute(*image, *timage);
+            if (FAILED(hr))
+            {
+                log.Print(L" FAILED [pixelops] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return false;
+            }
+
+        #ifndef NDEBUG
+            auto& tinfo = timage->GetMetadata();
+        #endif
+
+            assert(info.width == tinfo.width);
+            assert(info.height == tinfo.height);
+            assert(info.depth == tinfo.depth);
+            assert(info.arraySize == tinfo.arraySize);
+            assert(info.mipLevels == tinfo.mipLevels);
+            assert(info.miscFlags == tinfo.miscFlags);
+            assert(info.format == tinfo.format);
+            assert(info.dimension == tinfo.dimension);
+
+            image.swap(timage);
+            cimage.reset();
+            return true;
+        };
+
         // --- Color rotation (if requested) -------------------------------------------
+        stageClock.Begin(L"rotatecolor", image.get());
         if (dwRotateColor)
         {
             if (dwRotateColor == ROTATE_HDR10_TO_709 || dwRotateColor == ROTATE_P3D65_TO_709)
@@ -2597,16 +4104,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    log.Print(L"\nERROR: Memory allocation failed\n");
+                    return CONV_FATAL;
                 }
 
                 hr = Convert(image->GetImages(), image->GetImageCount(), image->GetMetadata(), DXGI_FORMAT_R16G16B16A16_FLOAT,
                     dwFilter | dwFilterOpts | dwSRGB | dwConvert, alphaThreshold, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    return 1;
+                    log.Print(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return CONV_FATAL;
                 }
 
             #ifndef NDEBUG
@@ -2628,26 +4135,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 cimage.reset();
             }
 
-            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
-            if (!timage)
-            {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
-            }
-
             switch (dwRotateColor)
             {
             case ROTATE_709_TO_HDR10:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         const XMVECTOR paperWhite = XMVectorReplicate(paperWhiteNits);
 
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             XMVECTOR nvalue = XMVector3Transform(value, c_from709to2020);
 
@@ -2665,41 +4162,35 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_709_TO_2020:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             const XMVECTOR nvalue = XMVector3Transform(value, c_from709to2020);
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_HDR10_TO_709:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         const XMVECTOR paperWhite = XMVectorReplicate(paperWhiteNits);
 
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             // Convert from ST.2084
                             XMFLOAT4A tmp;
@@ -2717,41 +4208,35 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_2020_TO_709:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             const XMVECTOR nvalue = XMVector3Transform(value, c_from2020to709);
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_P3D65_TO_HDR10:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         const XMVECTOR paperWhite = XMVectorReplicate(paperWhiteNits);
 
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             XMVECTOR nvalue = XMVector3Transform(value, c_fromP3D65to2020);
 
@@ -2769,66 +4254,57 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_P3D65_TO_2020:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             const XMVECTOR nvalue = XMVector3Transform(value, c_fromP3D65to2020);
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_709_TO_P3D65:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             const XMVECTOR nvalue = XMVector3Transform(value, c_from709toP3D65);
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             case ROTATE_P3D65_TO_709:
-                hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                    [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+                pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                     {
-                        UNREFERENCED_PARAMETER(y);
-
                         for (size_t j = 0; j < w; ++j)
                         {
-                            XMVECTOR value = inPixels[j];
+                            XMVECTOR value = pixels[j];
 
                             const XMVECTOR nvalue = XMVector3Transform(value, c_fromP3D65to709);
 
                             value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                            outPixels[j] = value;
+                            pixels[j] = value;
                         }
-                    }, *timage);
+                    });
                 break;
 
             default:
@@ -2837,45 +4313,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [rotate color apply] (%08X%ls)\n",
+                log.Print(L" FAILED [rotate color apply] (%08X%ls)\n",
                     static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                return CONV_FATAL;
             }
-
-        #ifndef NDEBUG
-            auto& tinfo = timage->GetMetadata();
-        #endif
-
-            assert(info.width == tinfo.width);
-            assert(info.height == tinfo.height);
-            assert(info.depth == tinfo.depth);
-            assert(info.arraySize == tinfo.arraySize);
-            assert(info.mipLevels == tinfo.mipLevels);
-            assert(info.miscFlags == tinfo.miscFlags);
-            assert(info.format == tinfo.format);
-            assert(info.dimension == tinfo.dimension);
-
-            image.swap(timage);
-            cimage.reset();
         }
 
         // --- Tonemap (if requested) --------------------------------------------------
+        stageClock.Begin(L"tonemap", image.get());
         if (dwOptions & uint64_t(1) << OPT_TONEMAP)
         {
-            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
-            if (!timage)
-            {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
-            }
-
-            // Compute max luminosity across all images
+            // Compute max luminosity across all images, as they look after any queued color rotation
             XMVECTOR maxLum = XMVectorZero();
-            hr = EvaluateImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                [&](const XMVECTOR* pixels, size_t w, size_t y)
+            hr = pixelOps.Evaluate(*image,
+                [&](const XMVECTOR* pixels, size_t w)
                 {
-                    UNREFERENCED_PARAMETER(y);
-
                     for (size_t j = 0; j < w; ++j)
                     {
                         static const XMVECTORF32 s_luminance = { { { 0.3f, 0.59f, 0.11f, 0.f } } };
@@ -2889,22 +4341,19 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 });
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [tonemap maxlum] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [tonemap maxlum] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             // Reinhard et al, "Photographic Tone Reproduction for Digital Images"
             // http://www.cs.utah.edu/~reinhard/cdrom/
             maxLum = XMVectorMultiply(maxLum, maxLum);
 
-            hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+            pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                 {
-                    UNREFERENCED_PARAMETER(y);
-
                     for (size_t j = 0; j < w; ++j)
                     {
-                        XMVECTOR value = inPixels[j];
+                        XMVECTOR value = pixels[j];
 
                         const XMVECTOR scale = XMVectorDivide(
                             XMVectorAdd(g_XMOne, XMVectorDivide(value, maxLum)),
@@ -2913,40 +4362,24 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                         value = XMVectorSelect(value, nvalue, g_XMSelect1110);
 
-                        outPixels[j] = value;
+                        pixels[j] = value;
                     }
-                }, *timage);
-            if (FAILED(hr))
-            {
-                wprintf(L" FAILED [tonemap apply] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
-            }
-
-        #ifndef NDEBUG
-            auto& tinfo = timage->GetMetadata();
-        #endif
-
-            assert(info.width == tinfo.width);
-            assert(info.height == tinfo.height);
-            assert(info.depth == tinfo.depth);
-            assert(info.arraySize == tinfo.arraySize);
-            assert(info.mipLevels == tinfo.mipLevels);
-            assert(info.miscFlags == tinfo.miscFlags);
-            assert(info.format == tinfo.format);
-            assert(info.dimension == tinfo.dimension);
-
-            image.swap(timage);
-            cimage.reset();
+                });
         }
 
         // --- Convert -----------------------------------------------------------------
+        if (((dwOptions & (uint64_t(1) << OPT_NORMAL_MAP)) || (info.format != tformat && !IsCompressed(tformat)))
+            && !applyPixelOps())
+            return CONV_FATAL;
+
+        stageClock.Begin(L"convert", image.get());
         if (dwOptions & (uint64_t(1) << OPT_NORMAL_MAP))
         {
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             DXGI_FORMAT nmfmt = tformat;
@@ -2970,11 +4403,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
             }
 
-            hr = ComputeNormalMap(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwNormalMap, nmapAmplitude, nmfmt, *timage);
+            // A full chain for a single-level 2D source is built with the normal map, renormalizing each
+            // level, unless alpha coverage needs the regular mipgen path
+            CNMAP_FLAGS nmapFlags = dwNormalMap;
+            if (info.dimension == TEX_DIMENSION_TEXTURE2D && info.mipLevels == 1
+                && (!tMips || tMips == CountMips(info.width, info.height))
+                && preserveAlphaCoverageRef <= 0.0f)
+            {
+                nmapFlags |= CNMAP_GENERATE_MIPS;
+            }
+
+            hr = ComputeNormalMap(image->GetImages(), image->GetImageCount(), image->GetMetadata(), nmapFlags, nmapAmplitude, nmfmt, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [normalmap] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [normalmap] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -2982,6 +4425,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             assert(tinfo.format == nmfmt);
             info.format = tinfo.format;
 
+            if (nmapFlags & CNMAP_GENERATE_MIPS)
+            {
+                info.mipLevels = tMips = tinfo.mipLevels;
+            }
+
             assert(info.width == tinfo.width);
             assert(info.height == tinfo.height);
             assert(info.depth == tinfo.depth);
@@ -2998,16 +4446,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             hr = Convert(image->GetImages(), image->GetImageCount(), image->GetMetadata(), tformat,
                 dwFilter | dwFilterOpts | dwSRGB | dwConvert, alphaThreshold, *timage);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -3031,25 +4479,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         if ((dwOptions & (uint64_t(1) << OPT_COLORKEY))
             && HasAlpha(info.format))
         {
-            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
-            if (!timage)
-            {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
-            }
-
-            XMVECTOR colorKeyValue = XMLoadColor(reinterpret_cast<const XMCOLOR*>(&colorKey));
+            const XMVECTOR colorKeyValue = XMLoadColor(reinterpret_cast<const XMCOLOR*>(&colorKey));
 
-            hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+            pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                 {
                     static const XMVECTORF32 s_tolerance = { { { 0.2f, 0.2f, 0.2f, 0.f } } };
 
-                    UNREFERENCED_PARAMETER(y);
-
                     for (size_t j = 0; j < w; ++j)
                     {
-                        XMVECTOR value = inPixels[j];
+                        XMVECTOR value = pixels[j];
 
                         if (XMVector3NearEqual(value, colorKeyValue, s_tolerance))
                         {
@@ -3060,103 +4498,41 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                             value = XMVectorSelect(g_XMOne, value, g_XMSelect1110);
                         }
 
-                        outPixels[j] = value;
+                        pixels[j] = value;
                     }
-                }, *timage);
-            if (FAILED(hr))
-            {
-                wprintf(L" FAILED [colorkey] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
-            }
-
-        #ifndef NDEBUG
-            auto& tinfo = timage->GetMetadata();
-        #endif
-
-            assert(info.width == tinfo.width);
-            assert(info.height == tinfo.height);
-            assert(info.depth == tinfo.depth);
-            assert(info.arraySize == tinfo.arraySize);
-            assert(info.mipLevels == tinfo.mipLevels);
-            assert(info.miscFlags == tinfo.miscFlags);
-            assert(info.format == tinfo.format);
-            assert(info.dimension == tinfo.dimension);
-
-            image.swap(timage);
-            cimage.reset();
+                });
         }
 
         // --- Invert Y Channel --------------------------------------------------------
         if (dwOptions & (uint64_t(1) << OPT_INVERT_Y))
         {
-            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
-            if (!timage)
-            {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
-            }
-
-            hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+            pixelOps.Append([](XMVECTOR* pixels, size_t w)
                 {
                     static const XMVECTORU32 s_selecty = { { { XM_SELECT_0, XM_SELECT_1, XM_SELECT_0, XM_SELECT_0 } } };
 
-                    UNREFERENCED_PARAMETER(y);
-
                     for (size_t j = 0; j < w; ++j)
                     {
-                        const XMVECTOR value = inPixels[j];
+                        const XMVECTOR value = pixels[j];
 
                         const XMVECTOR inverty = XMVectorSubtract(g_XMOne, value);
 
-                        outPixels[j] = XMVectorSelect(value, inverty, s_selecty);
-                    }
-                }, *timage);
-            if (FAILED(hr))
-            {
-                wprintf(L" FAILED [inverty] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
-            }
-
-        #ifndef NDEBUG
-            auto& tinfo = timage->GetMetadata();
-        #endif
-
-            assert(info.width == tinfo.width);
-            assert(info.height == tinfo.height);
-            assert(info.depth == tinfo.depth);
-            assert(info.arraySize == tinfo.arraySize);
-            assert(info.mipLevels == tinfo.mipLevels);
-            assert(info.miscFlags == tinfo.miscFlags);
-            assert(info.format == tinfo.format);
-            assert(info.dimension == tinfo.dimension);
-
-            image.swap(timage);
-            cimage.reset();
+                        pixels[j] = XMVectorSelect(value, inverty, s_selecty);
+                    }
+                });
         }
 
         // --- Reconstruct Z Channel ---------------------------------------------------
         if (dwOptions & (uint64_t(1) << OPT_RECONSTRUCT_Z))
         {
-            std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
-            if (!timage)
-            {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
-            }
-
-            bool isunorm = (FormatDataType(info.format) == FORMAT_TYPE_UNORM) != 0;
+            const bool isunorm = (FormatDataType(info.format) == FORMAT_TYPE_UNORM) != 0;
 
-            hr = TransformImage(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
-                [&](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t w, size_t y)
+            pixelOps.Append([=](XMVECTOR* pixels, size_t w)
                 {
                     static const XMVECTORU32 s_selectz = { { { XM_SELECT_0, XM_SELECT_0, XM_SELECT_1, XM_SELECT_0 } } };
 
-                    UNREFERENCED_PARAMETER(y);
-
                     for (size_t j = 0; j < w; ++j)
                     {
-                        const XMVECTOR value = inPixels[j];
+                        const XMVECTOR value = pixels[j];
 
                         XMVECTOR z;
                         if (isunorm)
@@ -3170,39 +4546,100 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                             z = XMVectorSqrt(XMVectorSubtract(g_XMOne, XMVector2Dot(value, value)));
                         }
 
-                        outPixels[j] = XMVectorSelect(value, z, s_selectz);
+                        pixels[j] = XMVectorSelect(value, z, s_selectz);
                     }
-                }, *timage);
-            if (FAILED(hr))
+                });
+        }
+
+        if (!applyPixelOps())
+            return CONV_FATAL;
+
+        // --- Select the most compact format (-f AUTO) ---------------------------------
+        // Runs after the per-pixel operations so channels written by -c, -inverty, or -reconstructz
+        // count towards the choice. -pmalpha runs later but never changes which channels carry data.
+        stageClock.Begin(L"autoformat", image.get());
+        if (autoFormat)
+        {
+            AutoFormatResult selection = {};
+            hr = SelectCompactFormat(image->GetImages(), image->GetImageCount(), image->GetMetadata(),
+                autoPSNR, AUTO_FORMAT_DEFAULT, selection);
+            if (hr == HRESULT_E_NOT_SUPPORTED)
             {
-                wprintf(L" FAILED [reconstructz] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                // HDR, signed, and non-finite content has no smaller UNORM equivalent
+                log.Print(L" [auto: kept ");
+                PrintFormat(info.format, log);
+                log.Print(L"]");
+                tformat = info.format;
+            }
+            else if (FAILED(hr))
+            {
+                log.Print(L" FAILED [autoformat] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FAILED;
+            }
+            else
+            {
+                log.Print(L" [auto: ");
+                PrintFormat(selection.format, log);
+                log.Print(L", %zu channel%ls", selection.channels, (selection.channels > 1) ? L"s" : L"");
+                if (selection.grayscale)
+                {
+                    log.Print(L", grayscale");
+                }
+                if (!selection.alphaOpaque)
+                {
+                    log.Print(L", %ls", (selection.alphaBinary) ? L"1-bit alpha" : L"alpha");
+                }
+                if (std::isinf(selection.psnr))
+                {
+                    log.Print(L", lossless]");
+                }
+                else
+                {
+                    log.Print(L", %.2f dB]", static_cast<double>(selection.psnr));
+                }
+                tformat = selection.format;
             }
 
-        #ifndef NDEBUG
-            auto& tinfo = timage->GetMetadata();
-        #endif
+            if (info.format != tformat && !IsCompressed(tformat))
+            {
+                std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
+                if (!timage)
+                {
+                    log.Print(L"\nERROR: Memory allocation failed\n");
+                    return CONV_FATAL;
+                }
 
-            assert(info.width == tinfo.width);
-            assert(info.height == tinfo.height);
-            assert(info.depth == tinfo.depth);
-            assert(info.arraySize == tinfo.arraySize);
-            assert(info.mipLevels == tinfo.mipLevels);
-            assert(info.miscFlags == tinfo.miscFlags);
-            assert(info.format == tinfo.format);
-            assert(info.dimension == tinfo.dimension);
+                hr = Convert(image->GetImages(), image->GetImageCount(), image->GetMetadata(), tformat,
+                    dwFilter | dwFilterOpts | dwSRGB | dwConvert, alphaThreshold, *timage);
+                if (FAILED(hr))
+                {
+                    log.Print(L" FAILED [convert] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return CONV_FATAL;
+                }
 
-            image.swap(timage);
-            cimage.reset();
+                auto& tinfo = timage->GetMetadata();
+
+                assert(tinfo.format == tformat);
+                info.format = tinfo.format;
+
+                assert(info.width == tinfo.width);
+                assert(info.height == tinfo.height);
+                assert(info.depth == tinfo.depth);
+                assert(info.arraySize == tinfo.arraySize);
+                assert(info.mipLevels == tinfo.mipLevels);
+                assert(info.miscFlags == tinfo.miscFlags);
+                assert(info.dimension == tinfo.dimension);
+
+                image.swap(timage);
+                cimage.reset();
+            }
         }
 
         // --- Determine whether preserve alpha coverage is required (if requested) ----
-        if (preserveAlphaCoverageRef > 0.0f && HasAlpha(info.format) && !image->IsAlphaAllOpaque())
-        {
-            preserveAlphaCoverage = true;
-        }
+        const bool preserveAlphaCoverage = (preserveAlphaCoverageRef > 0.0f && HasAlpha(info.format) && !image->IsAlphaAllOpaque());
 
         // --- Generate mips -----------------------------------------------------------
+        stageClock.Begin(L"mipgen", image.get());
         TEX_FILTER_FLAGS dwFilter3D = dwFilter;
         if (!ispow2(info.width) || !ispow2(info.height) || !ispow2(info.depth))
         {
@@ -3226,8 +4663,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             TexMetadata mdata = info;
@@ -3235,9 +4672,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             hr = timage->Initialize(mdata);
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [copy to single level] (%08X%ls)\n",
+                log.Print(L" FAILED [copy to single level] (%08X%ls)\n",
                     static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                return CONV_FATAL;
             }
 
             if (info.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -3248,9 +4685,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                         *timage->GetImage(0, 0, d), TEX_FILTER_DEFAULT, 0, 0);
                     if (FAILED(hr))
                     {
-                        wprintf(L" FAILED [copy to single level] (%08X%ls)\n",
+                        log.Print(L" FAILED [copy to single level] (%08X%ls)\n",
                             static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                        return 1;
+                        return CONV_FATAL;
                     }
                 }
             }
@@ -3262,8 +4699,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                         *timage->GetImage(0, i, 0), TEX_FILTER_DEFAULT, 0, 0);
                     if (FAILED(hr))
                     {
-                        wprintf(L" FAILED [copy to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                        return 1;
+                        log.Print(L" FAILED [copy to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                        return CONV_FATAL;
                     }
                 }
             }
@@ -3279,8 +4716,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 hr = timage->Initialize(mdata);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [copy compressed to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    return 1;
+                    log.Print(L" FAILED [copy compressed to single level] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return CONV_FATAL;
                 }
 
                 if (mdata.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -3317,8 +4754,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             if (info.dimension == TEX_DIMENSION_TEXTURE3D)
@@ -3331,8 +4768,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [mipmaps] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [mipmaps] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             auto& tinfo = timage->GetMetadata();
@@ -3351,20 +4788,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Preserve mipmap alpha coverage (if requested) ---------------------------
+        stageClock.Begin(L"alphacoverage", image.get());
         if (preserveAlphaCoverage && info.mipLevels != 1 && (info.dimension != TEX_DIMENSION_TEXTURE3D))
         {
             std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
             if (!timage)
             {
-                wprintf(L"\nERROR: Memory allocation failed\n");
-                return 1;
+                log.Print(L"\nERROR: Memory allocation failed\n");
+                return CONV_FATAL;
             }
 
             hr = timage->Initialize(image->GetMetadata());
             if (FAILED(hr))
             {
-                wprintf(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                log.Print(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                return CONV_FATAL;
             }
 
             const size_t items = image->GetMetadata().arraySize;
@@ -3376,8 +4814,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 hr = ScaleMipMapsAlphaForCoverage(img, info.mipLevels, info, item, preserveAlphaCoverageRef, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    return 1;
+                    log.Print(L" FAILED [keepcoverage] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return CONV_FATAL;
                 }
             }
 
@@ -3398,13 +4836,14 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Premultiplied alpha (if requested) --------------------------------------
+        stageClock.Begin(L"premultiply", image.get());
         if ((dwOptions & (uint64_t(1) << OPT_PREMUL_ALPHA))
             && HasAlpha(info.format)
             && info.format != DXGI_FORMAT_A8_UNORM)
         {
             if (info.IsPMAlpha())
             {
-                printf("\nWARNING: Image is already using premultiplied alpha\n");
+                log.Print(L"\nWARNING: Image is already using premultiplied alpha\n");
             }
             else
             {
@@ -3415,16 +4854,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    log.Print(L"\nERROR: Memory allocation failed\n");
+                    return CONV_FATAL;
                 }
 
                 hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_DEFAULT | dwSRGB, *timage);
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [premultiply alpha] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    retVal = 1;
-                    continue;
+                    log.Print(L" FAILED [premultiply alpha] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return CONV_FAILED;
                 }
 
                 auto& tinfo = timage->GetMetadata();
@@ -3444,6 +4882,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Compress ----------------------------------------------------------------
+        stageClock.Begin(L"compress", image.get());
         if (IsCompressed(tformat) && (FileType == CODEC_DDS))
         {
             if (cimage && (cimage->GetMetadata().format == tformat))
@@ -3478,10 +4917,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 std::unique_ptr<ScratchImage> timage(new (std::nothrow) ScratchImage);
                 if (!timage)
                 {
-                    wprintf(L"\nERROR: Memory allocation failed\n");
-                    return 1;
+                    log.Print(L"\nERROR: Memory allocation failed\n");
+                    return CONV_FATAL;
                 }
 
+            #ifdef _WIN32
                 bool bc6hbc7 = false;
                 switch (tformat)
                 {
@@ -3494,6 +4934,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     bc6hbc7 = true;
 
                     {
+                        std::lock_guard<std::mutex> lock(deviceMutex);
+
                         static bool s_tryonce = false;
 
                         if (!s_tryonce)
@@ -3503,11 +4945,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                             if (!(dwOptions & (uint64_t(1) << OPT_NOGPU)))
                             {
                                 if (!CreateDevice(adapter, pDevice.GetAddressOf()))
-                                    wprintf(L"\nWARNING: DirectCompute is not available, using BC6H / BC7 CPU codec\n");
+                                    log.Print(L"\nWARNING: DirectCompute is not available, using BC6H / BC7 CPU codec\n");
                             }
                             else
                             {
-                                wprintf(L"\nWARNING: using BC6H / BC7 CPU codec\n");
+                                log.Print(L"\nWARNING: using BC6H / BC7 CPU codec\n");
                             }
                         }
                     }
@@ -3516,9 +4958,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 default:
                     break;
                 }
+            #endif
 
                 TEX_COMPRESS_FLAGS cflags = dwCompress;
             #ifdef _OPENMP
+                // With the job queue, this is held to the job's share of the processors
                 if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
                 {
                     cflags |= TEX_COMPRESS_PARALLEL;
@@ -3530,19 +4974,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     non4bc = true;
                 }
 
+            #ifdef _WIN32
                 if (bc6hbc7 && pDevice)
                 {
+                    std::lock_guard<std::mutex> lock(deviceMutex);
                     hr = Compress(pDevice.Get(), img, nimg, info, tformat, dwCompress | dwSRGB, alphaWeight, *timage);
                 }
                 else
+            #endif
                 {
                     hr = Compress(img, nimg, info, tformat, cflags | dwSRGB, alphaThreshold, *timage);
                 }
                 if (FAILED(hr))
                 {
-                    wprintf(L" FAILED [compress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                    retVal = 1;
-                    continue;
+                    log.Print(L" FAILED [compress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return CONV_FAILED;
                 }
 
                 auto& tinfo = timage->GetMetadata();
@@ -3591,86 +5037,28 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
 
         // --- Save result -------------------------------------------------------------
+        stageClock.Begin(L"save", image.get(), true);
         {
             auto img = image->GetImage(0, 0, 0);
             assert(img);
             const size_t nimg = image->GetImageCount();
 
-            PrintInfo(info);
-            wprintf(L"\n");
+            PrintInfo(info, log);
+            log.Print(L"\n");
 
             // Figure out dest filename
-            wchar_t *pchSlash, *pchDot;
-
             wchar_t szDest[1024] = {};
-            wcscpy_s(szDest, szOutputDir);
-
-            if (keepRecursiveDirs && *pConv->szFolder)
-            {
-                wcscat_s(szDest, pConv->szFolder);
-
-                wchar_t szPath[MAX_PATH] = {};
-                if (!GetFullPathNameW(szDest, MAX_PATH, szPath, nullptr))
-                {
-                    wprintf(L" get full path FAILED (%08X%ls)\n",
-                        static_cast<unsigned int>(HRESULT_FROM_WIN32(GetLastError())), GetErrorDesc(HRESULT_FROM_WIN32(GetLastError())));
-                    retVal = 1;
-                    continue;
-                }
-
-                auto const err = static_cast<DWORD>(SHCreateDirectoryExW(nullptr, szPath, nullptr));
-                if (err != ERROR_SUCCESS && err != ERROR_ALREADY_EXISTS)
-                {
-                    wprintf(L" directory creation FAILED (%08X%ls)\n",
-                        static_cast<unsigned int>(HRESULT_FROM_WIN32(err)), GetErrorDesc(HRESULT_FROM_WIN32(err)));
-                    retVal = 1;
-                    continue;
-                }
-            }
-
-            if (*szPrefix)
-                wcscat_s(szDest, szPrefix);
-
-            pchSlash = wcsrchr(pConv->szSrc, std::filesystem::path::preferred_separator);
-            if (pchSlash)
-                wcscat_s(szDest, pchSlash + 1);
-            else
-                wcscat_s(szDest, pConv->szSrc);
-
-            pchSlash = wcsrchr(szDest, std::filesystem::path::preferred_separator);
-            pchDot = wcsrchr(szDest, '.');
-
-            if (pchDot > pchSlash)
-                *pchDot = 0;
-
-            if (*szSuffix)
-                wcscat_s(szDest, szSuffix);
-
-            if (dwOptions & (uint64_t(1) << OPT_TOLOWER))
-            {
-                std::ignore = _wcslwr_s(szDest);
-            }
+            if (!getDestination(pConv, szDest, log))
+                return CONV_FAILED;
 
-            if (wcslen(szDest) > _MAX_PATH)
-            {
-                wprintf(L"\nERROR: Output filename exceeds max-path, skipping!\n");
-                retVal = 1;
-                continue;
-            }
+            stageClock.SetDest(szDest);
 
             // Write texture
-            wprintf(L"writing %ls", szDest);
-            fflush(stdout);
+            log.Print(L"writing %ls", szDest);
+            log.Flush();
 
-            if (~dwOptions & (uint64_t(1) << OPT_OVERWRITE))
-            {
-                if (GetFileAttributesW(szDest) != INVALID_FILE_ATTRIBUTES)
-                {
-                    wprintf(L"\nERROR: Output file already exists, use -y to overwrite:\n");
-                    retVal = 1;
-                    continue;
-                }
-            }
+            if (!canWrite(szDest, log))
+                return CONV_FAILED;
 
             switch (FileType)
             {
@@ -3691,13 +5079,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
 
             case CODEC_TGA:
-                hr = SaveToTGAFile(img[0], TGA_FLAGS_NONE, szDest, (dwOptions & (uint64_t(1) << OPT_TGA20)) ? &info : nullptr);
+                hr = SaveToTGAFile(img[0],
+                    (dwOptions & (uint64_t(1) << OPT_TGA_RLE)) ? TGA_FLAGS_RLE : TGA_FLAGS_NONE,
+                    szDest, (dwOptions & (uint64_t(1) << OPT_TGA20)) ? &info : nullptr);
                 break;
 
             case CODEC_HDR:
                 hr = SaveToHDRFile(img[0], szDest);
                 break;
 
+        #ifdef _WIN32
             case CODEC_PPM:
                 hr = SaveToPortablePixMap(img[0], szDest);
                 break;
@@ -3705,6 +5096,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case CODEC_PFM:
                 hr = SaveToPortablePixMapHDR(img[0], szDest);
                 break;
+        #endif
 
             #ifdef USE_OPENEXR
             case CODEC_EXR:
@@ -3712,6 +5104,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 break;
             #endif
 
+        #ifdef _WIN32
             default:
                 {
                     const WICCodecs codec = (FileType == CODEC_HDP || FileType == CODEC_JXR) ? WIC_CODEC_WMP : static_cast<WICCodecs>(FileType);
@@ -3780,22 +5173,258 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                         });
                 }
                 break;
+        #else
+            default:
+                hr = E_NOTIMPL;
+                break;
+        #endif
             }
 
             if (FAILED(hr))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                retVal = 1;
+                log.Print(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+            #ifdef _WIN32
                 if ((hr == static_cast<HRESULT>(0xc00d5212) /* MF_E_TOPO_CODEC_NOT_FOUND */) && (FileType == WIC_CODEC_HEIF))
                 {
-                    wprintf(L"INFO: This format requires installing the HEIF Image Extensions - https://aka.ms/heif\n");
+                    log.Print(L"INFO: This format requires installing the HEIF Image Extensions - https://aka.ms/heif\n");
                 }
-                continue;
+            #endif
+                return CONV_FAILED;
+            }
+            log.Print(L"\n");
+
+            stageClock.End(image.get(), GetFileBytes(szDest));
+
+            if (cacheKey)
+            {
+                cache.Store(cacheKey, szDest);
+            }
+        }
+
+        return CONV_OK;
+    };
+
+    int retVal = 0;
+    bool fatalError = false;
+
+    std::vector<FileTiming> timings;
+    if (*szTimingFile)
+    {
+        timings.resize(conversion.size());
+
+        size_t index = 0;
+        for (const auto& it : conversion)
+        {
+            timings[index++].source = it.szSrc;
+        }
+    }
+
+    if (!parallelJobs)
+    {
+        ConversionLog log(false);
+
+        size_t index = 0;
+        for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv, ++index)
+        {
+            if (pConv != conversion.begin())
+                wprintf(L"\n");
+
+            FileTiming* timing = (timings.empty()) ? nullptr : &timings[index];
+
+            const CONV_RESULT result = processFile(&(*pConv), log, timing);
+            if (timing)
+                timing->result = result;
+
+            if (result == CONV_FATAL)
+            {
+                fatalError = true;
+                break;
+            }
+            else if (result != CONV_OK)
+                retVal = 1;
+        }
+    }
+    else
+    {
+        std::vector<const SConversion*> jobs;
+        jobs.reserve(conversion.size());
+        for (const auto& it : conversion)
+        {
+            jobs.push_back(&it);
+        }
+
+        // Sources that resolve to the same output file (e.g. equal basenames from different directories
+        // with -o) are grouped and converted one after another in list order, so the result never
+        // depends on which job finishes last
+        std::vector<std::vector<size_t>> groups;
+        groups.reserve(jobs.size());
+        {
+            std::map<std::wstring, size_t> destGroups;
+            for (size_t j = 0; j < jobs.size(); ++j)
+            {
+                wchar_t szDest[1024] = {};
+                ConversionLog quiet(true);
+                if (!getDestination(jobs[j], szDest, quiet))
+                {
+                    // processFile reports the problem
+                    groups.push_back({ j });
+                    continue;
+                }
+
+                std::wstring key = std::filesystem::path(szDest).lexically_normal().wstring();
+            #ifdef _WIN32
+                std::transform(key.begin(), key.end(), key.begin(), [](wchar_t c) { return static_cast<wchar_t>(towlower(c)); });
+            #endif
+
+                auto it = destGroups.find(key);
+                if (it == destGroups.end())
+                {
+                    destGroups.emplace(std::move(key), groups.size());
+                    groups.push_back({ j });
+                }
+                else
+                {
+                    auto& group = groups[it->second];
+                    if (group.size() == 1)
+                    {
+                        wprintf(L"WARNING: several sources write to %ls, converting them one at a time\n", szDest);
+                    }
+                    group.push_back(j);
+                }
+            }
+        }
+
+        // Read the image headers up front so each job knows how much memory it will need
+        std::vector<const wchar_t*> names(jobs.size());
+        std::vector<TexMetadata> headers(jobs.size());
+        std::vector<HRESULT> headerResults(jobs.size(), E_FAIL);
+        for (size_t j = 0; j < jobs.size(); ++j)
+        {
+            names[j] = jobs[j]->szSrc;
+        }
+
+        std::ignore = GetMetadataFromFiles(names.data(), names.size(), DDS_FLAGS_ALLOW_LARGE_FILES, TGA_FLAGS_NONE,
+            headers.data(), headerResults.data());
+
+        std::vector<uint64_t> estimates(jobs.size());
+        for (size_t j = 0; j < jobs.size(); ++j)
+        {
+            if (SUCCEEDED(headerResults[j]))
+            {
+                estimates[j] = EstimateConversionMemory(headers[j]);
+            }
+            else
+            {
+                // Formats without a cheap header probe (mostly compressed WIC formats)
+                std::error_code ec;
+                const uintmax_t fileSize = std::filesystem::file_size(jobs[j]->szSrc, ec);
+                estimates[j] = (ec) ? 0 : static_cast<uint64_t>(fileSize) * 8;
             }
-            wprintf(L"\n");
+        }
+
+        // Keep the images in flight to half of physical memory
+        uint64_t memoryLimit = GetPhysicalMemory() / 2;
+        if (!memoryLimit)
+        {
+            memoryLimit = uint64_t(4) * 1024 * 1024 * 1024;
+        }
+
+        MemoryBudget budget(memoryLimit);
+
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        std::atomic<bool> fatal(false);
+
+        const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        const size_t nthreads = std::min<size_t>(cores, groups.size());
+
+        // Each job still runs the library's parallel loops, so split the processors between the
+        // jobs rather than letting every one of them start a worker per core
+        ThreadPolicy jobPolicy = {};
+        jobPolicy.maxThreads = std::max<size_t>(cores / nthreads, 1);
+        jobPolicy.numaNode = -1;
+
+        auto worker = [&]()
+        {
+            std::ignore = SetCallingThreadPolicy(&jobPolicy);
+
+            for (;;)
+            {
+                if (fatal)
+                    break;
+
+                const size_t group = next.fetch_add(1);
+                if (group >= groups.size())
+                    break;
+
+                for (const size_t index : groups[group])
+                {
+                    if (fatal)
+                        break;
+
+                    const uint64_t reserved = budget.Acquire(estimates[index]);
+
+                    FileTiming* timing = (timings.empty()) ? nullptr : &timings[index];
+
+                    ConversionLog log(true);
+                    const CONV_RESULT result = processFile(jobs[index], log, timing);
+                    if (timing)
+                        timing->result = result;
+
+                    budget.Release(reserved);
+                    log.Commit();
+
+                    if (result == CONV_FATAL)
+                        fatal = true;
+                    else if (result != CONV_OK)
+                        failed = true;
+                }
+            }
+
+            std::ignore = SetCallingThreadPolicy(nullptr);
+        };
+
+        // The calling thread is one of the workers; if a thread can't be created the rest carry the load
+        std::vector<std::thread> workers;
+        try
+        {
+            workers.reserve(nthreads - 1);
+            for (size_t j = 1; j < nthreads; ++j)
+            {
+                workers.emplace_back(worker);
+            }
+        }
+        catch (...)
+        {
+        }
+
+        worker();
+
+        for (auto& it : workers)
+        {
+            it.join();
+        }
+
+        if (fatal)
+            fatalError = true;
+        else if (failed)
+            retVal = 1;
+    }
+
+    if (*szTimingFile)
+    {
+        const std::chrono::duration<double> delta = std::chrono::steady_clock::now() - tStart;
+        const HRESULT hr = WriteTimingReport(szTimingFile, timings, delta.count(), parallelJobs, !parallelJobs);
+        if (FAILED(hr))
+        {
+            wprintf(L"\nERROR: Failed to write -timing-json file %ls (%08X%ls)\n", szTimingFile, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+            retVal = 1;
         }
     }
 
+    if (fatalError)
+        return 1;
+
     if (sizewarn)
     {
         wprintf(L"\nWARNING: Target size exceeds maximum size for feature level (%u)\n", maxSize);
@@ -3810,14 +5439,46 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     if (non4bc)
         wprintf(L"\nWARNING: Direct3D requires BC image to be multiple of 4 in width & height\n");
 
-    if (dwOptions & (uint64_t(1) << OPT_TIMING))
+    if (useCache)
     {
-        LARGE_INTEGER qpcEnd = {};
-        std::ignore = QueryPerformanceCounter(&qpcEnd);
+        wprintf(L"\nCache: %zu hits, %zu misses", cache.GetHits(), cache.GetMisses());
+        if (cache.GetStoreFailures() > 0)
+        {
+            wprintf(L", %zu failed to store", cache.GetStoreFailures());
+        }
+        wprintf(L"\n");
+    }
 
-        const LONGLONG delta = qpcEnd.QuadPart - qpcStart.QuadPart;
-        wprintf(L"\n Processing time: %f seconds\n", double(delta) / double(qpcFreq.QuadPart));
+    if (dwOptions & (uint64_t(1) << OPT_TIMING))
+    {
+        const std::chrono::duration<double> delta = std::chrono::steady_clock::now() - tStart;
+        wprintf(L"\n Processing time: %f seconds\n", delta.count());
     }
 
     return retVal;
 }
+
+#ifndef _WIN32
+int main(int argc, char* argv[])
+{
+    // Command-line arguments arrive as multibyte strings in the current locale
+    std::locale::global(std::locale(""));
+
+    std::vector<std::wstring> args;
+    args.reserve(static_cast<size_t>(argc));
+    for (int iArg = 0; iArg < argc; ++iArg)
+    {
+        args.emplace_back(std::filesystem::path(argv[iArg]).wstring());
+    }
+
+    std::vector<wchar_t*> wargv;
+    wargv.reserve(args.size() + 1);
+    for (auto& it : args)
+    {
+        wargv.push_back(it.data());
+    }
+    wargv.push_back(nullptr);
+
+    return wmain(argc, wargv.data());
+}
+#endif
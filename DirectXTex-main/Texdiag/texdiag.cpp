@@ -93,6 +93,9 @@ enum OPTIONS : uint32_t
     OPT_DIFF_COLOR,
     OPT_THRESHOLD,
     OPT_FILELIST,
+    OPT_SSIM,
+    OPT_MSSSIM,
+    OPT_HEATMAP,
     OPT_MAX
 };
 
@@ -144,6 +147,9 @@ const SValue g_pOptions[] =
     { L"c",         OPT_DIFF_COLOR },
     { L"t",         OPT_THRESHOLD },
     { L"flist",     OPT_FILELIST },
+    { L"ssim",      OPT_SSIM },
+    { L"msssim",    OPT_MSSSIM },
+    { L"heatmap",   OPT_HEATMAP },
     { nullptr,      0 }
 };
 
@@ -679,7 +685,7 @@ namespace
             L"\n"
             L"   info                Output image metadata\n"
             L"   analyze             Analyze and summarize image information\n"
-            L"   compare             Compare two images with MSE error metric\n"
+            L"   compare             Compare two images with MSE (and optionally SSIM) error metrics\n"
             L"   diff                Generate difference image from two images\n"
             L"   dumpbc              Dump out compressed blocks (DDS BC only)\n"
             L"   dumpdds             Dump out all the images in a complex DDS\n"
@@ -701,6 +707,11 @@ namespace
             L"   -c <hex-RGB>        highlight difference color (defaults to off)\n"
             L"   -t <threshold>      highlight threshold (defaults to 0.25)\n"
             L"\n"
+            L"                       (compare only)\n"
+            L"   -ssim               also report structural similarity (SSIM)\n"
+            L"   -msssim             also report multi-scale structural similarity (MS-SSIM)\n"
+            L"   -heatmap <filename> write per-tile SSIM error (1 - SSIM) as an image\n"
+            L"\n"
             L"                       (dumpbc only)\n"
             L"   -targetx <num>      dump pixels at location x (defaults to all)\n"
             L"   -targety <num>      dump pixels at location y (defaults to all)\n"
@@ -764,6 +775,40 @@ namespace
         return desc;
     }
 
+    void GetImageArraySize(const TexMetadata& info, size_t& nimages, size_t& pixelSize) noexcept
+    {
+        // Matches the layout ScratchImage uses, for images that were only probed rather than loaded
+        nimages = pixelSize = 0;
+
+        const bool is3D = (info.dimension == TEX_DIMENSION_TEXTURE3D);
+        const size_t nitems = is3D ? 1 : info.arraySize;
+        for (size_t item = 0; item < nitems; ++item)
+        {
+            size_t w = info.width;
+            size_t h = info.height;
+            size_t d = is3D ? info.depth : 1;
+
+            for (size_t level = 0; level < info.mipLevels; ++level)
+            {
+                size_t rowPitch, slicePitch;
+                if (FAILED(ComputePitch(info.format, w, h, rowPitch, slicePitch, CP_FLAGS_NONE)))
+                    return;
+
+                nimages += d;
+                pixelSize += slicePitch * d;
+
+                if (h > 1)
+                    h >>= 1;
+
+                if (w > 1)
+                    w >>= 1;
+
+                if (d > 1)
+                    d >>= 1;
+            }
+        }
+    }
+
     HRESULT LoadImage(
         const wchar_t *fileName,
         uint32_t dwOptions,
@@ -877,126 +922,85 @@ namespace
         }
     }
 
+    // Tiles are written as 1 - SSIM so poorly matching areas show up bright
+    HRESULT SaveHeatmap(const ScratchImage& tileMap, const wchar_t *fileName, uint32_t codec)
+    {
+        const Image* tiles = tileMap.GetImage(0, 0, 0);
+        if (!tiles)
+            return E_POINTER;
+
+        ScratchImage errorMap;
+        HRESULT hr = TransformImage(*tiles, [](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t width, size_t)
+            {
+                for (size_t j = 0; j < width; ++j)
+                {
+                    const XMVECTOR error = XMVectorSaturate(XMVectorSubtract(g_XMOne, inPixels[j]));
+                    outPixels[j] = XMVectorSelect(g_XMOne, error, g_XMSelect1110);
+                }
+            }, errorMap);
+        if (FAILED(hr))
+            return hr;
+
+        ScratchImage heatmap;
+        hr = Convert(*errorMap.GetImage(0, 0, 0), DXGI_FORMAT_B8G8R8A8_UNORM, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, heatmap);
+        if (FAILED(hr))
+            return hr;
+
+        return SaveImage(heatmap.GetImage(0, 0, 0), fileName, codec);
+    }
+
     //--------------------------------------------------------------------------------------
     struct AnalyzeData
     {
-        XMFLOAT4 imageMin;
-        XMFLOAT4 imageMax;
-        XMFLOAT4 imageAvg;
-        XMFLOAT4 imageVariance;
-        XMFLOAT4 imageStdDev;
-        float luminance;
-        size_t   specials_x;
-        size_t   specials_y;
-        size_t   specials_z;
-        size_t   specials_w;
+        ImageStatistics stats;
 
         void Print()
         {
-            wprintf(L"\t  Minimum - (%f %f %f %f)\n", imageMin.x, imageMin.y, imageMin.z, imageMin.w);
-            wprintf(L"\t  Average - (%f %f %f %f)\n", imageAvg.x, imageAvg.y, imageAvg.z, imageAvg.w);
-            wprintf(L"\t  Maximum - (%f %f %f %f)\n", imageMax.x, imageMax.y, imageMax.z, imageMax.w);
-            wprintf(L"\t Variance - (%f %f %f %f)\n", imageVariance.x, imageVariance.y, imageVariance.z, imageVariance.w);
-            wprintf(L"\t  Std Dev - (%f %f %f %f)\n", imageStdDev.x, imageStdDev.y, imageStdDev.z, imageStdDev.w);
+            const ImageStatistics& s = stats;
+
+            wprintf(L"\t  Minimum - (%f %f %f %f)\n", s.minimum.x, s.minimum.y, s.minimum.z, s.minimum.w);
+            wprintf(L"\t  Average - (%f %f %f %f)\n", s.average.x, s.average.y, s.average.z, s.average.w);
+            wprintf(L"\t  Maximum - (%f %f %f %f)\n", s.maximum.x, s.maximum.y, s.maximum.z, s.maximum.w);
+            wprintf(L"\t Variance - (%f %f %f %f)\n", s.variance.x, s.variance.y, s.variance.z, s.variance.w);
+            wprintf(L"\t  Std Dev - (%f %f %f %f)\n", s.standardDeviation.x, s.standardDeviation.y, s.standardDeviation.z, s.standardDeviation.w);
 
-            wprintf(L"\tLuminance - %f (maximum)\n", luminance);
+            wprintf(L"\tLuminance - %f (maximum)\n", s.luminance);
 
-            if ((specials_x > 0) || (specials_y > 0) || (specials_z > 0) || (specials_w > 0))
+            if (s.nanCount[0] || s.nanCount[1] || s.nanCount[2] || s.nanCount[3])
             {
-                wprintf(L"     FP specials - (%zu %zu %zu %zu)\n", specials_x, specials_y, specials_z, specials_w);
+                wprintf(L"\t      NaN - (%zu %zu %zu %zu)\n", s.nanCount[0], s.nanCount[1], s.nanCount[2], s.nanCount[3]);
             }
-        }
-    };
 
-    HRESULT Analyze(const Image& image, _Out_ AnalyzeData& result)
-    {
-        memset(&result, 0, sizeof(AnalyzeData));
-
-        // First pass
-        XMVECTOR minv = g_XMFltMax;
-        XMVECTOR maxv = XMVectorNegate(g_XMFltMax);
-        XMVECTOR acc = g_XMZero;
-        XMVECTOR luminance = g_XMZero;
-
-        size_t totalPixels = 0;
+            if (s.infiniteCount[0] || s.infiniteCount[1] || s.infiniteCount[2] || s.infiniteCount[3])
+            {
+                wprintf(L"\t Infinity - (%zu %zu %zu %zu)\n", s.infiniteCount[0], s.infiniteCount[1], s.infiniteCount[2], s.infiniteCount[3]);
+            }
 
-        HRESULT hr = EvaluateImage(image, [&](const XMVECTOR * pixels, size_t width, size_t y)
+            if (s.denormalCount[0] || s.denormalCount[1] || s.denormalCount[2] || s.denormalCount[3])
             {
-                static const XMVECTORF32 s_luminance = { { {  0.3f, 0.59f, 0.11f, 0.f } } };
+                wprintf(L"\t Denormal - (%zu %zu %zu %zu)\n", s.denormalCount[0], s.denormalCount[1], s.denormalCount[2], s.denormalCount[3]);
+            }
 
-                UNREFERENCED_PARAMETER(y);
+            if (s.constantChannel[0] || s.constantChannel[1] || s.constantChannel[2] || s.constantChannel[3])
+            {
+                static const wchar_t* s_channels[4] = { L"R", L"G", L"B", L"A" };
 
-                for (size_t x = 0; x < width; ++x)
+                wprintf(L"\t Constant -");
+                for (size_t c = 0; c < 4; ++c)
                 {
-                    const XMVECTOR v = *pixels++;
-                    luminance = XMVectorMax(luminance, XMVector3Dot(v, s_luminance));
-                    minv = XMVectorMin(minv, v);
-                    maxv = XMVectorMax(maxv, v);
-                    acc = XMVectorAdd(v, acc);
-                    ++totalPixels;
-
-                    XMFLOAT4 f;
-                    XMStoreFloat4(&f, v);
-                    if (!isfinite(f.x))
-                    {
-                        ++result.specials_x;
-                    }
-
-                    if (!isfinite(f.y))
-                    {
-                        ++result.specials_y;
-                    }
-
-                    if (!isfinite(f.z))
+                    if (s.constantChannel[c])
                     {
-                        ++result.specials_z;
-                    }
-
-                    if (!isfinite(f.w))
-                    {
-                        ++result.specials_w;
+                        wprintf(L" %ls", s_channels[c]);
                     }
                 }
-            });
-        if (FAILED(hr))
-            return hr;
-
-        if (!totalPixels)
-            return S_FALSE;
-
-        result.luminance = XMVectorGetX(luminance);
-        XMStoreFloat4(&result.imageMin, minv);
-        XMStoreFloat4(&result.imageMax, maxv);
-
-        const XMVECTOR pixelv = XMVectorReplicate(float(totalPixels));
-        XMVECTOR avgv = XMVectorDivide(acc, pixelv);
-        XMStoreFloat4(&result.imageAvg, avgv);
-
-        // Second pass
-        acc = g_XMZero;
-
-        hr = EvaluateImage(image, [&](const XMVECTOR * pixels, size_t width, size_t y)
-            {
-                UNREFERENCED_PARAMETER(y);
-
-                for (size_t x = 0; x < width; ++x)
-                {
-                    const XMVECTOR v = *pixels++;
-
-                    const XMVECTOR diff = XMVectorSubtract(v, avgv);
-                    acc = XMVectorMultiplyAdd(diff, diff, acc);
-                }
-            });
-        if (FAILED(hr))
-            return hr;
-
-        XMStoreFloat4(&result.imageVariance, acc);
-
-        const XMVECTOR stddev = XMVectorSqrt(acc);
-
-        XMStoreFloat4(&result.imageStdDev, stddev);
+                wprintf(L"\n");
+            }
+        }
+    };
 
-        return S_OK;
+    HRESULT Analyze(const Image& image, _Out_ AnalyzeData& result)
+    {
+        return EvaluateImageStatistics(image, result.stats);
     }
 
     //--------------------------------------------------------------------------------------
@@ -3272,6 +3276,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     DXGI_FORMAT diffFormat = DXGI_FORMAT_B8G8R8A8_UNORM;
     uint32_t fileType = WIC_CODEC_BMP;
     wchar_t szOutputFile[MAX_PATH] = {};
+    uint32_t heatmapType = WIC_CODEC_BMP;
+    wchar_t szHeatmapFile[MAX_PATH] = {};
 
     // Set locale for output since GetErrorDesc can get localized strings.
     std::locale::global(std::locale(""));
@@ -3386,6 +3392,7 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_DIFF_COLOR:
             case OPT_THRESHOLD:
             case OPT_FILELIST:
+            case OPT_HEATMAP:
                 if (!*pValue)
                 {
                     if ((iArg + 1 >= argc))
@@ -3519,6 +3526,40 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
                 break;
 
+            case OPT_SSIM:
+            case OPT_MSSSIM:
+                if (dwCommand != CMD_COMPARE)
+                {
+                    wprintf(L"-ssim and -msssim only valid for use with compare command\n");
+                    return 1;
+                }
+                break;
+
+            case OPT_HEATMAP:
+                if (dwCommand != CMD_COMPARE)
+                {
+                    wprintf(L"-heatmap only valid for use with compare command\n");
+                    return 1;
+                }
+                else
+                {
+                    std::filesystem::path path(pValue);
+                    wcscpy_s(szHeatmapFile, path.make_preferred().c_str());
+
+                    wchar_t ext[_MAX_EXT] = {};
+                    _wsplitpath_s(szHeatmapFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+
+                    heatmapType = LookupByName(ext, g_pExtFileTypes);
+                    if (!heatmapType)
+                    {
+                        wprintf(L"Invalid output file type specified with -heatmap (%ls)\n", pValue);
+                        wprintf(L"\n");
+                        PrintUsage();
+                        return 1;
+                    }
+                }
+                break;
+
             case OPT_FILELIST:
                 {
                     std::filesystem::path path(pValue);
@@ -3619,6 +3660,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 return 1;
             }
 
+            const bool computeSSIM = (dwOptions & ((1 << OPT_SSIM) | (1 << OPT_MSSSIM) | (1 << OPT_HEATMAP))) != 0;
+            const CSSIM_FLAGS ssimFlags = (dwOptions & (1 << OPT_MSSSIM)) ? CSSIM_MULTISCALE : CSSIM_DEFAULT;
+            const wchar_t* ssimName = (ssimFlags & CSSIM_MULTISCALE) ? L"MS-SSIM" : L"SSIM";
+
             if (dwCommand == CMD_DIFF)
             {
                 if (!*szOutputFile)
@@ -3691,6 +3736,47 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                 wprintf(L"Result: %f (%f %f %f %f) PSNR %f dB\n", mse, mseV[0], mseV[1], mseV[2], mseV[3],
                     10.0 * log10(3.0 / (double(mseV[0]) + double(mseV[1]) + double(mseV[2]))));
+
+                if (computeSSIM)
+                {
+                    float ssim, ssimV[4];
+                    ScratchImage tileMap;
+                    hr = ComputeSSIM(*image1->GetImage(0, 0, 0), *image2->GetImage(0, 0, 0), ssim, ssimV, CMSE_DEFAULT, ssimFlags,
+                        (*szHeatmapFile) ? &tileMap : nullptr);
+                    if (FAILED(hr))
+                    {
+                        wprintf(L"Failed computing %ls (%08X%ls)\n", ssimName, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                        return 1;
+                    }
+
+                    wprintf(L"%ls: %f (%f %f %f %f)\n", ssimName, ssim, ssimV[0], ssimV[1], ssimV[2], ssimV[3]);
+
+                    if (*szHeatmapFile)
+                    {
+                        if (dwOptions & (1 << OPT_TOLOWER))
+                        {
+                            std::ignore = _wcslwr_s(szHeatmapFile);
+                        }
+
+                        if (~dwOptions & (1 << OPT_OVERWRITE))
+                        {
+                            if (GetFileAttributesW(szHeatmapFile) != INVALID_FILE_ATTRIBUTES)
+                            {
+                                wprintf(L"\nERROR: Heatmap file already exists, use -y to overwrite\n");
+                                return 1;
+                            }
+                        }
+
+                        hr = SaveHeatmap(tileMap, szHeatmapFile, heatmapType);
+                        if (FAILED(hr))
+                        {
+                            wprintf(L"Failed writing heatmap %ls (%08X%ls)\n", szHeatmapFile, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                            return 1;
+                        }
+
+                        wprintf(L"Heatmap %ls\n", szHeatmapFile);
+                    }
+                }
             }
             else
             {
@@ -3704,8 +3790,16 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 double sum_mse = 0;
                 double sum_mseV[4] = { 0, 0, 0, 0 };
 
+                float min_ssim = FLT_MAX;
+                float max_ssim = -FLT_MAX;
+                double sum_ssim = 0;
+                double sum_ssimV[4] = { 0, 0, 0, 0 };
+
                 size_t total_images = 0;
 
+                if (*szHeatmapFile)
+                    wprintf(L"WARNING: -heatmap is only written when comparing a single image\n");
+
                 if (info1.depth > 1)
                 {
                     wprintf(L"Results by mip (%3zu) and slice (%3zu)\n\n", info1.mipLevels, info1.depth);
@@ -3751,6 +3845,28 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                                 wprintf(L"[%3zu,%3zu]: %f (%f %f %f %f) PSNR %f dB\n", mip, slice, mse, mseV[0], mseV[1], mseV[2], mseV[3],
                                     10.0 * log10(3.0 / (double(mseV[0]) + double(mseV[1]) + double(mseV[2]))));
+
+                                if (computeSSIM)
+                                {
+                                    float ssim, ssimV[4];
+                                    hr = ComputeSSIM(*img1, *img2, ssim, ssimV, CMSE_DEFAULT, ssimFlags);
+                                    if (FAILED(hr))
+                                    {
+                                        wprintf(L"Failed computing %ls at slice %3zu, mip %3zu (%08X%ls)\n", ssimName, slice, mip, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                                        return 1;
+                                    }
+
+                                    min_ssim = std::min(min_ssim, ssim);
+                                    max_ssim = std::max(max_ssim, ssim);
+                                    sum_ssim += double(ssim);
+
+                                    for (size_t j = 0; j < 4; ++j)
+                                    {
+                                        sum_ssimV[j] += double(ssimV[j]);
+                                    }
+
+                                    wprintf(L"           %ls %f (%f %f %f %f)\n", ssimName, ssim, ssimV[0], ssimV[1], ssimV[2], ssimV[3]);
+                                }
                             }
                         }
 
@@ -3802,6 +3918,28 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
                                 wprintf(L"[%3zu,%3zu]: %f (%f %f %f %f) PSNR %f dB\n", item, mip, mse, mseV[0], mseV[1], mseV[2], mseV[3],
                                     10.0 * log10(3.0 / (double(mseV[0]) + double(mseV[1]) + double(mseV[2]))));
+
+                                if (computeSSIM)
+                                {
+                                    float ssim, ssimV[4];
+                                    hr = ComputeSSIM(*img1, *img2, ssim, ssimV, CMSE_DEFAULT, ssimFlags);
+                                    if (FAILED(hr))
+                                    {
+                                        wprintf(L"Failed computing %ls at item %3zu, mip %3zu (%08X%ls)\n", ssimName, item, mip, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                                        return 1;
+                                    }
+
+                                    min_ssim = std::min(min_ssim, ssim);
+                                    max_ssim = std::max(max_ssim, ssim);
+                                    sum_ssim += double(ssim);
+
+                                    for (size_t j = 0; j < 4; ++j)
+                                    {
+                                        sum_ssimV[j] += double(ssimV[j]);
+                                    }
+
+                                    wprintf(L"           %ls %f (%f %f %f %f)\n", ssimName, ssim, ssimV[0], ssimV[1], ssimV[2], ssimV[3]);
+                                }
                             }
                         }
                     }
@@ -3823,13 +3961,54 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                         10.0 * log10(3.0 / (total_mseV0 + total_mseV1 + total_mseV2)));
                     wprintf(L"    Maximum MSE: %f (%f %f %f %f) PSNR %f dB\n", max_mse, max_mseV[0], max_mseV[1], max_mseV[2], max_mseV[3],
                         10.0 * log10(3.0 / (double(max_mseV[0]) + double(max_mseV[1]) + double(max_mseV[2]))));
+
+                    if (computeSSIM)
+                    {
+                        wprintf(L"\n    Minimum %ls: %f\n", ssimName, min_ssim);
+                        wprintf(L"    Average %ls: %f (%f %f %f %f)\n", ssimName, sum_ssim / double(total_images),
+                            sum_ssimV[0] / double(total_images),
+                            sum_ssimV[1] / double(total_images),
+                            sum_ssimV[2] / double(total_images),
+                            sum_ssimV[3] / double(total_images));
+                        wprintf(L"    Maximum %ls: %f\n", ssimName, max_ssim);
+                    }
                 }
             }
         }
         break;
 
     default:
-        for (auto pConv = conversion.cbegin(); pConv != conversion.cend(); ++pConv)
+    {
+        // Info only needs the headers, so probe DDS, TGA, and HDR files concurrently up front
+        std::vector<TexMetadata> probeInfo;
+        std::vector<HRESULT> probeResults;
+        if (dwCommand == CMD_INFO)
+        {
+            std::vector<const wchar_t*> files;
+            files.reserve(conversion.size());
+            for (const auto& it : conversion)
+            {
+                files.push_back(it.szSrc);
+            }
+
+            DDS_FLAGS ddsFlags = DDS_FLAGS_ALLOW_LARGE_FILES;
+            if (dwOptions & (1 << OPT_DDS_DWORD_ALIGN))
+                ddsFlags |= DDS_FLAGS_LEGACY_DWORD;
+            if (dwOptions & (1 << OPT_EXPAND_LUMINANCE))
+                ddsFlags |= DDS_FLAGS_EXPAND_LUMINANCE;
+            if (dwOptions & (1 << OPT_DDS_BAD_DXTN_TAILS))
+                ddsFlags |= DDS_FLAGS_BAD_DXTN_TAILS;
+
+            probeInfo.resize(files.size());
+            probeResults.resize(files.size(), E_FAIL);
+            if (FAILED(GetMetadataFromFiles(files.data(), files.size(), ddsFlags, TGA_FLAGS_NONE, probeInfo.data(), probeResults.data())))
+            {
+                std::fill(probeResults.begin(), probeResults.end(), E_FAIL);
+            }
+        }
+
+        size_t index = 0;
+        for (auto pConv = conversion.cbegin(); pConv != conversion.cend(); ++pConv, ++index)
         {
             // Load source image
             if (pConv != conversion.begin())
@@ -3840,11 +4019,19 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
             TexMetadata info;
             std::unique_ptr<ScratchImage> image;
-            hr = LoadImage(pConv->szSrc, dwOptions, dwFilter, info, image);
-            if (FAILED(hr))
+            if (index < probeResults.size() && SUCCEEDED(probeResults[index]) && !IsTypeless(probeInfo[index].format))
             {
-                wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
-                return 1;
+                info = probeInfo[index];
+            }
+            else
+            {
+                // Other file types (and typeless overrides) go through the full loader
+                hr = LoadImage(pConv->szSrc, dwOptions, dwFilter, info, image);
+                if (FAILED(hr))
+                {
+                    wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
+                    return 1;
+                }
             }
 
             wprintf(L"\n");
@@ -3903,9 +4090,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     break;
                 }
 
-                wprintf(L"\n       images = %zu\n", image->GetImageCount());
+                size_t nimages = 0;
+                size_t pixelSize = 0;
+                if (image)
+                {
+                    nimages = image->GetImageCount();
+                    pixelSize = image->GetPixelsSize();
+                }
+                else
+                {
+                    GetImageArraySize(info, nimages, pixelSize);
+                }
+
+                wprintf(L"\n       images = %zu\n", nimages);
 
-                auto const sizeInKb = static_cast<uint32_t>(image->GetPixelsSize() / 1024);
+                auto const sizeInKb = static_cast<uint32_t>(pixelSize / 1024);
 
                 wprintf(L"   pixel size = %u (KB)\n\n", sizeInKb);
             }
@@ -4247,7 +4446,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
             }
         }
-        break;
+    }
+    break;
     }
 
     return 0;